@@ -224,6 +224,10 @@ RECENT REVISION HISTORY:
 // (at least this is true for iOS and Android). Therefore, the NEON support is
 // toggled by a build flag: define STBI_NEON to get NEON loops.
 //
+// With GCC and Clang, or when compiling for AVX2, the JPEG decoder also
+// checks for AVX2 at run time and then transforms two blocks at a time and
+// converts 16 pixels at a time to RGBA. Define STBI_NO_AVX2 to only use SSE2.
+//
 // If for some reason you do not want to use any of SIMD code, or if
 // you have issues compiling it, you can disable it entirely by
 // defining STBI_NO_SIMD.
@@ -379,6 +383,14 @@ STBIDEF stbi_uc *stbi_load_from_file  (FILE *f, int *x, int *y, int *channels_in
 STBIDEF stbi_uc *stbi_load_gif_from_memory(stbi_uc const *buffer, int len, int **delays, int *x, int *y, int *z, int *comp, int req_comp);
 #endif
 
+#ifndef STBI_NO_JPEG
+// decodes a JPEG straight into a caller-owned buffer instead of a new
+// allocation; fails if output_size is less than x*y*n bytes, where n is
+// desired_channels or, if that's 0, the *channels_in_file it reports.
+// Size the buffer from stbi_info_from_memory() first. Returns 1 on success.
+STBIDEF int      stbi_load_jpeg_from_memory_into(stbi_uc const *buffer, int len, stbi_uc *output, size_t output_size, int *x, int *y, int *channels_in_file, int desired_channels);
+#endif
+
 #ifdef STBI_WINDOWS_UTF8
 STBIDEF int stbi_convert_wchar_to_utf8(char *buffer, size_t bufferlen, const wchar_t* input);
 #endif
@@ -696,6 +708,28 @@ static int stbi__sse2_available(void)
 #endif
 #endif
 
+// AVX2 kernels are compiled with a target attribute, so they do not need
+// the whole file built for AVX2
+#if defined(STBI_SSE2) && !defined(STBI_NO_AVX2) && !defined(STBI_NO_JPEG)
+#if defined(__AVX2__)
+#define STBI_AVX2
+#define STBI__AVX2_TARGET
+#include <immintrin.h>
+static int stbi__avx2_available(void)
+{
+   return 1;
+}
+#elif defined(__GNUC__) || defined(__clang__)
+#define STBI_AVX2
+#define STBI__AVX2_TARGET __attribute__((target("avx2")))
+#include <immintrin.h>
+static int stbi__avx2_available(void)
+{
+   return __builtin_cpu_supports("avx2");
+}
+#endif
+#endif
+
 // ARM NEON
 #if defined(STBI_NO_SIMD) && defined(STBI_NEON)
 #undef STBI_NEON
@@ -1810,8 +1844,18 @@ typedef struct
 
 // kernels
    void (*idct_block_kernel)(stbi_uc *out, int out_stride, short data[64]);
+   void (*idct_block2_kernel)(stbi_uc *out0, int out0_stride, short data0[64], stbi_uc *out1, int out1_stride, short data1[64]);
    void (*YCbCr_to_RGB_kernel)(stbi_uc *out, const stbi_uc *y, const stbi_uc *pcb, const stbi_uc *pcr, int count, int step);
    stbi_uc *(*resample_row_hv_2_kernel)(stbi_uc *out, stbi_uc *in_near, stbi_uc *in_far, int w, int hs);
+
+   // with idct_block2_kernel, a block waiting for the next one
+   STBI_SIMD_ALIGN(short, idct_pending_data[64]);
+   stbi_uc *idct_pending_out;
+   int idct_pending_stride;
+
+   // if set, load_jpeg_image decodes into this instead of allocating
+   stbi_uc *output;
+   size_t output_size;
 } stbi__jpeg;
 
 static int stbi__build_huffman(stbi__huffman *h, int *count)
@@ -2504,6 +2548,177 @@ static void stbi__idct_simd(stbi_uc *out, int out_stride, short data[64])
 
 #endif // STBI_SSE2
 
+#ifdef STBI_AVX2
+// the sse2 IDCT with one block in each 128-bit lane, every step stays
+// within its lane so the results match the other versions exactly
+static STBI__AVX2_TARGET void stbi__idct_avx2(stbi_uc *out0, int out0_stride, short data0[64], stbi_uc *out1, int out1_stride, short data1[64])
+{
+   __m256i row0, row1, row2, row3, row4, row5, row6, row7;
+   __m256i tmp;
+
+   #define dct_const(x,y)  _mm256_setr_epi16((x),(y),(x),(y),(x),(y),(x),(y),(x),(y),(x),(y),(x),(y),(x),(y))
+
+   #define dct_rot(out0,out1, x,y,c0,c1) \
+      __m256i c0##lo = _mm256_unpacklo_epi16((x),(y)); \
+      __m256i c0##hi = _mm256_unpackhi_epi16((x),(y)); \
+      __m256i out0##_l = _mm256_madd_epi16(c0##lo, c0); \
+      __m256i out0##_h = _mm256_madd_epi16(c0##hi, c0); \
+      __m256i out1##_l = _mm256_madd_epi16(c0##lo, c1); \
+      __m256i out1##_h = _mm256_madd_epi16(c0##hi, c1)
+
+   #define dct_widen(out, in) \
+      __m256i out##_l = _mm256_srai_epi32(_mm256_unpacklo_epi16(_mm256_setzero_si256(), (in)), 4); \
+      __m256i out##_h = _mm256_srai_epi32(_mm256_unpackhi_epi16(_mm256_setzero_si256(), (in)), 4)
+
+   #define dct_wadd(out, a, b) \
+      __m256i out##_l = _mm256_add_epi32(a##_l, b##_l); \
+      __m256i out##_h = _mm256_add_epi32(a##_h, b##_h)
+
+   #define dct_wsub(out, a, b) \
+      __m256i out##_l = _mm256_sub_epi32(a##_l, b##_l); \
+      __m256i out##_h = _mm256_sub_epi32(a##_h, b##_h)
+
+   #define dct_bfly32o(out0, out1, a,b,bias,s) \
+      { \
+         __m256i abiased_l = _mm256_add_epi32(a##_l, bias); \
+         __m256i abiased_h = _mm256_add_epi32(a##_h, bias); \
+         dct_wadd(sum, abiased, b); \
+         dct_wsub(dif, abiased, b); \
+         out0 = _mm256_packs_epi32(_mm256_srai_epi32(sum_l, s), _mm256_srai_epi32(sum_h, s)); \
+         out1 = _mm256_packs_epi32(_mm256_srai_epi32(dif_l, s), _mm256_srai_epi32(dif_h, s)); \
+      }
+
+   #define dct_interleave8(a, b) \
+      tmp = a; \
+      a = _mm256_unpacklo_epi8(a, b); \
+      b = _mm256_unpackhi_epi8(tmp, b)
+
+   #define dct_interleave16(a, b) \
+      tmp = a; \
+      a = _mm256_unpacklo_epi16(a, b); \
+      b = _mm256_unpackhi_epi16(tmp, b)
+
+   #define dct_pass(bias,shift) \
+      { \
+         /* even part */ \
+         dct_rot(t2e,t3e, row2,row6, rot0_0,rot0_1); \
+         __m256i sum04 = _mm256_add_epi16(row0, row4); \
+         __m256i dif04 = _mm256_sub_epi16(row0, row4); \
+         dct_widen(t0e, sum04); \
+         dct_widen(t1e, dif04); \
+         dct_wadd(x0, t0e, t3e); \
+         dct_wsub(x3, t0e, t3e); \
+         dct_wadd(x1, t1e, t2e); \
+         dct_wsub(x2, t1e, t2e); \
+         /* odd part */ \
+         dct_rot(y0o,y2o, row7,row3, rot2_0,rot2_1); \
+         dct_rot(y1o,y3o, row5,row1, rot3_0,rot3_1); \
+         __m256i sum17 = _mm256_add_epi16(row1, row7); \
+         __m256i sum35 = _mm256_add_epi16(row3, row5); \
+         dct_rot(y4o,y5o, sum17,sum35, rot1_0,rot1_1); \
+         dct_wadd(x4, y0o, y4o); \
+         dct_wadd(x5, y1o, y5o); \
+         dct_wadd(x6, y2o, y5o); \
+         dct_wadd(x7, y3o, y4o); \
+         dct_bfly32o(row0,row7, x0,x7,bias,shift); \
+         dct_bfly32o(row1,row6, x1,x6,bias,shift); \
+         dct_bfly32o(row2,row5, x2,x5,bias,shift); \
+         dct_bfly32o(row3,row4, x3,x4,bias,shift); \
+      }
+
+   #define dct_load(row) \
+      _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_load_si128((const __m128i *) (data0 + (row)*8))), \
+                              _mm_load_si128((const __m128i *) (data1 + (row)*8)), 1)
+
+   #define dct_store(a, b) \
+      _mm_storel_epi64((__m128i *) out0, _mm256_castsi256_si128(a)); out0 += out0_stride; \
+      _mm_storel_epi64((__m128i *) out0, _mm256_castsi256_si128(b)); out0 += out0_stride; \
+      _mm_storel_epi64((__m128i *) out1, _mm256_extracti128_si256(a, 1)); out1 += out1_stride; \
+      _mm_storel_epi64((__m128i *) out1, _mm256_extracti128_si256(b, 1)); out1 += out1_stride
+
+   __m256i rot0_0 = dct_const(stbi__f2f(0.5411961f), stbi__f2f(0.5411961f) + stbi__f2f(-1.847759065f));
+   __m256i rot0_1 = dct_const(stbi__f2f(0.5411961f) + stbi__f2f( 0.765366865f), stbi__f2f(0.5411961f));
+   __m256i rot1_0 = dct_const(stbi__f2f(1.175875602f) + stbi__f2f(-0.899976223f), stbi__f2f(1.175875602f));
+   __m256i rot1_1 = dct_const(stbi__f2f(1.175875602f), stbi__f2f(1.175875602f) + stbi__f2f(-2.562915447f));
+   __m256i rot2_0 = dct_const(stbi__f2f(-1.961570560f) + stbi__f2f( 0.298631336f), stbi__f2f(-1.961570560f));
+   __m256i rot2_1 = dct_const(stbi__f2f(-1.961570560f), stbi__f2f(-1.961570560f) + stbi__f2f( 3.072711026f));
+   __m256i rot3_0 = dct_const(stbi__f2f(-0.390180644f) + stbi__f2f( 2.053119869f), stbi__f2f(-0.390180644f));
+   __m256i rot3_1 = dct_const(stbi__f2f(-0.390180644f), stbi__f2f(-0.390180644f) + stbi__f2f( 1.501321110f));
+
+   __m256i bias_0 = _mm256_set1_epi32(512);
+   __m256i bias_1 = _mm256_set1_epi32(65536 + (128<<17));
+
+   row0 = dct_load(0);
+   row1 = dct_load(1);
+   row2 = dct_load(2);
+   row3 = dct_load(3);
+   row4 = dct_load(4);
+   row5 = dct_load(5);
+   row6 = dct_load(6);
+   row7 = dct_load(7);
+
+   // column pass
+   dct_pass(bias_0, 10);
+
+   {
+      // 16bit 8x8 transposes
+      dct_interleave16(row0, row4);
+      dct_interleave16(row1, row5);
+      dct_interleave16(row2, row6);
+      dct_interleave16(row3, row7);
+
+      dct_interleave16(row0, row2);
+      dct_interleave16(row1, row3);
+      dct_interleave16(row4, row6);
+      dct_interleave16(row5, row7);
+
+      dct_interleave16(row0, row1);
+      dct_interleave16(row2, row3);
+      dct_interleave16(row4, row5);
+      dct_interleave16(row6, row7);
+   }
+
+   // row pass
+   dct_pass(bias_1, 17);
+
+   {
+      // pack and 8bit 8x8 transposes
+      __m256i p0 = _mm256_packus_epi16(row0, row1);
+      __m256i p1 = _mm256_packus_epi16(row2, row3);
+      __m256i p2 = _mm256_packus_epi16(row4, row5);
+      __m256i p3 = _mm256_packus_epi16(row6, row7);
+
+      dct_interleave8(p0, p2);
+      dct_interleave8(p1, p3);
+
+      dct_interleave8(p0, p1);
+      dct_interleave8(p2, p3);
+
+      dct_interleave8(p0, p2);
+      dct_interleave8(p1, p3);
+
+      // store
+      dct_store(p0, _mm256_shuffle_epi32(p0, 0x4e));
+      dct_store(p2, _mm256_shuffle_epi32(p2, 0x4e));
+      dct_store(p1, _mm256_shuffle_epi32(p1, 0x4e));
+      dct_store(p3, _mm256_shuffle_epi32(p3, 0x4e));
+   }
+
+#undef dct_const
+#undef dct_rot
+#undef dct_widen
+#undef dct_wadd
+#undef dct_wsub
+#undef dct_bfly32o
+#undef dct_interleave8
+#undef dct_interleave16
+#undef dct_pass
+#undef dct_load
+#undef dct_store
+}
+
+#endif // STBI_AVX2
+
 #ifdef STBI_NEON
 
 // NEON integer IDCT. should produce bit-identical
@@ -2746,6 +2961,30 @@ static void stbi__jpeg_reset(stbi__jpeg *j)
    // since we don't even allow 1<<30 pixels
 }
 
+// the output of a block is not read before the whole image is decoded, so
+// blocks can be held back to be transformed in pairs
+static void stbi__jpeg_idct(stbi__jpeg *z, stbi_uc *out, int out_stride, short data[64])
+{
+   if (!z->idct_block2_kernel) {
+      z->idct_block_kernel(out, out_stride, data);
+   } else if (z->idct_pending_out) {
+      z->idct_block2_kernel(z->idct_pending_out, z->idct_pending_stride, z->idct_pending_data, out, out_stride, data);
+      z->idct_pending_out = NULL;
+   } else {
+      memcpy(z->idct_pending_data, data, sizeof(z->idct_pending_data));
+      z->idct_pending_out = out;
+      z->idct_pending_stride = out_stride;
+   }
+}
+
+static void stbi__jpeg_idct_flush(stbi__jpeg *z)
+{
+   if (z->idct_pending_out) {
+      z->idct_block_kernel(z->idct_pending_out, z->idct_pending_stride, z->idct_pending_data);
+      z->idct_pending_out = NULL;
+   }
+}
+
 static int stbi__parse_entropy_coded_data(stbi__jpeg *z)
 {
    stbi__jpeg_reset(z);
@@ -2764,7 +3003,7 @@ static int stbi__parse_entropy_coded_data(stbi__jpeg *z)
             for (i=0; i < w; ++i) {
                int ha = z->img_comp[n].ha;
                if (!stbi__jpeg_decode_block(z, data, z->huff_dc+z->img_comp[n].hd, z->huff_ac+ha, z->fast_ac[ha], n, z->dequant[z->img_comp[n].tq])) return 0;
-               z->idct_block_kernel(z->img_comp[n].data+z->img_comp[n].w2*j*8+i*8, z->img_comp[n].w2, data);
+               stbi__jpeg_idct(z, z->img_comp[n].data+z->img_comp[n].w2*j*8+i*8, z->img_comp[n].w2, data);
                // every data block is an MCU, so countdown the restart interval
                if (--z->todo <= 0) {
                   if (z->code_bits < 24) stbi__grow_buffer_unsafe(z);
@@ -2792,7 +3031,7 @@ static int stbi__parse_entropy_coded_data(stbi__jpeg *z)
                         int y2 = (j*z->img_comp[n].v + y)*8;
                         int ha = z->img_comp[n].ha;
                         if (!stbi__jpeg_decode_block(z, data, z->huff_dc+z->img_comp[n].hd, z->huff_ac+ha, z->fast_ac[ha], n, z->dequant[z->img_comp[n].tq])) return 0;
-                        z->idct_block_kernel(z->img_comp[n].data+z->img_comp[n].w2*y2+x2, z->img_comp[n].w2, data);
+                        stbi__jpeg_idct(z, z->img_comp[n].data+z->img_comp[n].w2*y2+x2, z->img_comp[n].w2, data);
                      }
                   }
                }
@@ -2889,7 +3128,7 @@ static void stbi__jpeg_finish(stbi__jpeg *z)
             for (i=0; i < w; ++i) {
                short *data = z->img_comp[n].coeff + 64 * (i + j * z->img_comp[n].coeff_w);
                stbi__jpeg_dequantize(data, z->dequant[z->img_comp[n].tq]);
-               z->idct_block_kernel(z->img_comp[n].data+z->img_comp[n].w2*j*8+i*8, z->img_comp[n].w2, data);
+               stbi__jpeg_idct(z, z->img_comp[n].data+z->img_comp[n].w2*j*8+i*8, z->img_comp[n].w2, data);
             }
          }
       }
@@ -3214,6 +3453,7 @@ static int stbi__decode_jpeg_image(stbi__jpeg *j)
    }
    if (j->progressive)
       stbi__jpeg_finish(j);
+   stbi__jpeg_idct_flush(j);
    return 1;
 }
 
@@ -3588,12 +3828,79 @@ static void stbi__YCbCr_to_RGB_simd(stbi_uc *out, stbi_uc const *y, stbi_uc cons
 }
 #endif
 
+#ifdef STBI_AVX2
+// the sse2 conversion with 8 pixels in each 128-bit lane
+static STBI__AVX2_TARGET void stbi__YCbCr_to_RGB_avx2(stbi_uc *out, stbi_uc const *y, stbi_uc const *pcb, stbi_uc const *pcr, int count, int step)
+{
+   int i = 0;
+
+   if (step == 4) {
+      __m256i signflip  = _mm256_set1_epi8(-0x80);
+      __m256i cr_const0 = _mm256_set1_epi16(   (short) ( 1.40200f*4096.0f+0.5f));
+      __m256i cr_const1 = _mm256_set1_epi16( - (short) ( 0.71414f*4096.0f+0.5f));
+      __m256i cb_const0 = _mm256_set1_epi16( - (short) ( 0.34414f*4096.0f+0.5f));
+      __m256i cb_const1 = _mm256_set1_epi16(   (short) ( 1.77200f*4096.0f+0.5f));
+      __m256i y_bias = _mm256_set1_epi8((char) (unsigned char) 128);
+      __m256i xw = _mm256_set1_epi16(255); // alpha channel
+
+      for (; i+15 < count; i += 16) {
+         // load, pixels 0-7 go to the low lane and 8-15 to the high one
+         __m256i y_bytes = _mm256_permute4x64_epi64(_mm256_castsi128_si256(_mm_loadu_si128((__m128i *) (y+i))), 0x50);
+         __m256i cr_bytes = _mm256_permute4x64_epi64(_mm256_castsi128_si256(_mm_loadu_si128((__m128i *) (pcr+i))), 0x50);
+         __m256i cb_bytes = _mm256_permute4x64_epi64(_mm256_castsi128_si256(_mm_loadu_si128((__m128i *) (pcb+i))), 0x50);
+         __m256i cr_biased = _mm256_xor_si256(cr_bytes, signflip); // -128
+         __m256i cb_biased = _mm256_xor_si256(cb_bytes, signflip); // -128
+
+         // unpack to short (and left-shift cr, cb by 8)
+         __m256i yw  = _mm256_unpacklo_epi8(y_bias, y_bytes);
+         __m256i crw = _mm256_unpacklo_epi8(_mm256_setzero_si256(), cr_biased);
+         __m256i cbw = _mm256_unpacklo_epi8(_mm256_setzero_si256(), cb_biased);
+
+         // color transform
+         __m256i yws = _mm256_srli_epi16(yw, 4);
+         __m256i cr0 = _mm256_mulhi_epi16(cr_const0, crw);
+         __m256i cb0 = _mm256_mulhi_epi16(cb_const0, cbw);
+         __m256i cb1 = _mm256_mulhi_epi16(cbw, cb_const1);
+         __m256i cr1 = _mm256_mulhi_epi16(crw, cr_const1);
+         __m256i rws = _mm256_add_epi16(cr0, yws);
+         __m256i gwt = _mm256_add_epi16(cb0, yws);
+         __m256i bws = _mm256_add_epi16(yws, cb1);
+         __m256i gws = _mm256_add_epi16(gwt, cr1);
+
+         // descale
+         __m256i rw = _mm256_srai_epi16(rws, 4);
+         __m256i bw = _mm256_srai_epi16(bws, 4);
+         __m256i gw = _mm256_srai_epi16(gws, 4);
+
+         // back to byte, set up for transpose
+         __m256i brb = _mm256_packus_epi16(rw, bw);
+         __m256i gxb = _mm256_packus_epi16(gw, xw);
+
+         // transpose to interleave channels
+         __m256i t0 = _mm256_unpacklo_epi8(brb, gxb);
+         __m256i t1 = _mm256_unpackhi_epi8(brb, gxb);
+         __m256i o0 = _mm256_unpacklo_epi16(t0, t1);
+         __m256i o1 = _mm256_unpackhi_epi16(t0, t1);
+
+         // store, pixels 0-3 and 4-7 are in the low lanes of o0 and o1
+         _mm256_storeu_si256((__m256i *) (out + 0), _mm256_permute2x128_si256(o0, o1, 0x20));
+         _mm256_storeu_si256((__m256i *) (out + 32), _mm256_permute2x128_si256(o0, o1, 0x31));
+         out += 64;
+      }
+   }
+
+   stbi__YCbCr_to_RGB_simd(out, y + i, pcb + i, pcr + i, count - i, step);
+}
+#endif
+
 // set up the kernels
 static void stbi__setup_jpeg(stbi__jpeg *j)
 {
    j->idct_block_kernel = stbi__idct_block;
+   j->idct_block2_kernel = NULL;
    j->YCbCr_to_RGB_kernel = stbi__YCbCr_to_RGB_row;
    j->resample_row_hv_2_kernel = stbi__resample_row_hv_2;
+   j->idct_pending_out = NULL;
 
 #ifdef STBI_SSE2
    if (stbi__sse2_available()) {
@@ -3603,6 +3910,13 @@ static void stbi__setup_jpeg(stbi__jpeg *j)
    }
 #endif
 
+#ifdef STBI_AVX2
+   if (stbi__avx2_available()) {
+      j->idct_block2_kernel = stbi__idct_avx2;
+      j->YCbCr_to_RGB_kernel = stbi__YCbCr_to_RGB_avx2;
+   }
+#endif
+
 #ifdef STBI_NEON
    j->idct_block_kernel = stbi__idct_simd;
    j->YCbCr_to_RGB_kernel = stbi__YCbCr_to_RGB_simd;
@@ -3658,7 +3972,7 @@ static stbi_uc *load_jpeg_image(stbi__jpeg *z, int *out_x, int *out_y, int *comp
    {
       int k;
       unsigned int i,j;
-      stbi_uc *output;
+      stbi_uc *output, *last_row = NULL;
       stbi_uc *coutput[4];
 
       stbi__resample res_comp[4];
@@ -3686,12 +4000,21 @@ static stbi_uc *load_jpeg_image(stbi__jpeg *z, int *out_x, int *out_y, int *comp
       }
 
       // can't error after this so, this is safe
-      output = (stbi_uc *) stbi__malloc_mad3(n, z->s->img_x, z->s->img_y, 1);
-      if (!output) { stbi__cleanup_jpeg(z); return stbi__errpuc("outofmem", "Out of memory"); }
+      if (z->output) {
+         if (!stbi__mad3sizes_valid(n, z->s->img_x, z->s->img_y, 0) || z->output_size < (size_t) n * z->s->img_x * z->s->img_y) { stbi__cleanup_jpeg(z); return stbi__errpuc("output too small", "Output buffer too small"); }
+         // the converters may store one byte past the row, which the caller's
+         // buffer doesn't have room for after the last one
+         last_row = (stbi_uc *) stbi__malloc_mad2(n, z->s->img_x, 1);
+         if (!last_row) { stbi__cleanup_jpeg(z); return stbi__errpuc("outofmem", "Out of memory"); }
+         output = z->output;
+      } else {
+         output = (stbi_uc *) stbi__malloc_mad3(n, z->s->img_x, z->s->img_y, 1);
+         if (!output) { stbi__cleanup_jpeg(z); return stbi__errpuc("outofmem", "Out of memory"); }
+      }
 
       // now go ahead and resample
       for (j=0; j < z->s->img_y; ++j) {
-         stbi_uc *out = output + n * z->s->img_x * j;
+         stbi_uc *out = last_row && j == z->s->img_y-1 ? last_row : output + n * z->s->img_x * j;
          for (k=0; k < decode_n; ++k) {
             stbi__resample *r = &res_comp[k];
             int y_bot = r->ystep >= (r->vs >> 1);
@@ -3784,6 +4107,10 @@ static stbi_uc *load_jpeg_image(stbi__jpeg *z, int *out_x, int *out_y, int *comp
             }
          }
       }
+      if (last_row) {
+         memcpy(output + n * z->s->img_x * (z->s->img_y-1), last_row, n * z->s->img_x);
+         STBI_FREE(last_row);
+      }
       stbi__cleanup_jpeg(z);
       *out_x = z->s->img_x;
       *out_y = z->s->img_y;
@@ -3798,12 +4125,34 @@ static void *stbi__jpeg_load(stbi__context *s, int *x, int *y, int *comp, int re
    stbi__jpeg* j = (stbi__jpeg*) stbi__malloc(sizeof(stbi__jpeg));
    STBI_NOTUSED(ri);
    j->s = s;
+   j->output = NULL;
    stbi__setup_jpeg(j);
    result = load_jpeg_image(j, x,y,comp,req_comp);
    STBI_FREE(j);
    return result;
 }
 
+STBIDEF int stbi_load_jpeg_from_memory_into(stbi_uc const *buffer, int len, stbi_uc *output, size_t output_size, int *x, int *y, int *comp, int req_comp)
+{
+   unsigned char* result;
+   stbi__context s;
+   stbi__jpeg* j;
+   stbi__start_mem(&s,buffer,len);
+   if (!stbi__jpeg_test(&s)) return stbi__err("not JPEG", "Image not of JPEG type");
+   j = (stbi__jpeg*) stbi__malloc(sizeof(stbi__jpeg));
+   if (!j) return stbi__err("outofmem", "Out of memory");
+   j->s = &s;
+   j->output = output;
+   j->output_size = output_size;
+   stbi__setup_jpeg(j);
+   result = load_jpeg_image(j, x,y,comp,req_comp);
+   STBI_FREE(j);
+   if (!result) return 0;
+   if (stbi__vertically_flip_on_load)
+      stbi__vertical_flip(result, *x, *y, req_comp ? req_comp : s.img_n >= 3 ? 3 : 1);
+   return 1;
+}
+
 static int stbi__jpeg_test(stbi__context *s)
 {
    int r;
@@ -11,6 +11,7 @@
 
 #include <cstdio>
 #include <cstdlib>
+#include <atomic>
 #include <cassert>
 #include <iostream>
 #include <sstream>
@@ -436,6 +437,55 @@ TEST_CASE("serialize-empty-material", "[issue-294]") {
 
 }
 
+TEST_CASE("glb-stream-write", "[glb]") {
+
+  tinygltf::Model model;
+  tinygltf::TinyGLTF ctx;
+  std::string err;
+  std::string warn;
+
+  REQUIRE(ctx.LoadBinaryFromFile(&model, &err, &warn, "../models/box01.glb"));
+
+  // the first buffer goes into the BIN chunk, an odd size needs padding
+  model.buffers[0].uri.clear();
+  model.buffers[0].data.push_back(0x7f);
+  tinygltf::Light light;
+  light.type = "point";
+  model.lights.push_back(light);
+
+  std::stringstream gltf;
+  REQUIRE(ctx.WriteGltfSceneToStream(&model, gltf, false, false));
+  std::stringstream glb;
+  REQUIRE(ctx.WriteGltfSceneToStream(&model, glb, false, true));
+
+  const std::string bytes = glb.str();
+  uint32_t header[5];
+  REQUIRE(bytes.size() > sizeof(header));
+  memcpy(header, bytes.data(), sizeof(header));
+  REQUIRE(header[0] == 0x46546C67);
+  REQUIRE(header[1] == 2);
+  REQUIRE(header[2] == bytes.size());
+  REQUIRE(header[3] % 4 == 0);
+  REQUIRE(header[4] == 0x4E4F534A);
+  REQUIRE(bytes.size() % 4 == 0);
+
+  // the streamed JSON chunk matches the document the .gltf is built from,
+  // where the first buffer is a data uri instead
+  nlohmann::json expected = nlohmann::json::parse(gltf.str());
+  nlohmann::json actual = nlohmann::json::parse(bytes.substr(20, header[3]));
+  REQUIRE(actual["buffers"][0].count("uri") == 0);
+  expected["buffers"][0].erase("uri");
+  REQUIRE(actual == expected);
+
+  tinygltf::Model loaded;
+  REQUIRE(ctx.LoadBinaryFromMemory(
+      &loaded, &err, &warn, reinterpret_cast<const unsigned char *>(bytes.data()),
+      static_cast<unsigned int>(bytes.size())));
+  REQUIRE(loaded.buffers[0].data == model.buffers[0].data);
+  REQUIRE(loaded.meshes.size() == model.meshes.size());
+  REQUIRE(loaded.lights.size() == 1);
+}
+
 TEST_CASE("empty-skeleton-id", "[issue-321]") {
 
   tinygltf::Model model;
@@ -482,3 +532,685 @@ TEST_CASE("expandpath-utf-8", "[pr-226]") {
 
 }
 #endif
+
+static bool LoadWithParser(tinygltf::Model *model, std::string *err,
+                           std::string *warn, const std::string &filename,
+                           bool streaming, unsigned int threads = 0) {
+  tinygltf::TinyGLTF ctx;
+  ctx.SetStreamingParser(streaming);
+  ctx.SetExternalFileThreads(threads);
+
+  if (filename.size() > 4 &&
+      filename.compare(filename.size() - 4, 4, ".glb") == 0) {
+    return ctx.LoadBinaryFromFile(model, err, warn, filename);
+  }
+  return ctx.LoadASCIIFromFile(model, err, warn, filename);
+}
+
+static bool LoadStringWithParser(tinygltf::Model *model, std::string *err,
+                                 const std::string &json, bool streaming) {
+  tinygltf::TinyGLTF ctx;
+  ctx.SetStreamingParser(streaming);
+
+  std::string warn;
+  return ctx.LoadASCIIFromString(model, err, &warn, json.c_str(),
+                                 static_cast<unsigned int>(json.size()), "",
+                                 tinygltf::REQUIRE_VERSION);
+}
+
+TEST_CASE("streaming-parser-models", "[streaming]") {
+
+  const char *filenames[] = {
+      "../models/Cube/Cube.gltf",
+      "../models/Cube-texture-ext/Cube-textransform.gltf",
+      "../models/CubeImageUriSpaces/CubeImageUriSpaces.gltf",
+      "../models/CubeImageUriSpaces/CubeImageUriMultipleSpaces.gltf",
+      "../models/Extensions-issue97/test.gltf",
+      "../models/Extensions-overwrite-issue261/issue-261.gltf",
+      "../models/SparseMorphTargets-issue280/singleBlendshapeCube_sparse.glb",
+      "../models/BoundsChecking/integer-out-of-bounds.gltf",
+      "../models/BoundsChecking/invalid-buffer-index.gltf",
+      "../models/regression/unassigned-skeleton.gltf",
+      "../models/box01.glb"};
+
+  for (const char *filename : filenames) {
+    INFO(filename);
+
+    tinygltf::Model dom_model;
+    std::string dom_err;
+    std::string dom_warn;
+    bool dom_ret =
+        LoadWithParser(&dom_model, &dom_err, &dom_warn, filename, false);
+
+    tinygltf::Model stream_model;
+    std::string stream_err;
+    std::string stream_warn;
+    bool stream_ret = LoadWithParser(&stream_model, &stream_err,
+                                     &stream_warn, filename, true);
+
+    REQUIRE(dom_ret == stream_ret);
+    REQUIRE(dom_err == stream_err);
+    REQUIRE(dom_warn == stream_warn);
+    REQUIRE(dom_model == stream_model);
+  }
+}
+
+TEST_CASE("streaming-parser-json", "[streaming]") {
+
+  // Escapes, unicode, duplicate keys, number kinds and nulls, which the
+  // streaming parser has to read the same way the JSON DOM does.
+  std::string json = R"({
+    "asset": {"version": "2.0", "generator": "t\u00e9st \"q\" \ud83d\ude00 \\ \/ \b\f\n\r\t"},
+    "scene": 0,
+    "scenes": [{"nodes": [0, 1], "name": "first", "name": "second"}],
+    "nodes": [
+      {"name": "\u0061b\u00e9", "translation": [1, -2.5, 3e2], "children": [1]},
+      {"matrix": [1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1],
+       "mesh": 0, "weights": [0.25, 1E-3],
+       "extras": {"int": -7, "big": 12345678901234567890, "neg": -9223372036854775808,
+                  "float": 1.0, "exp": -1.5e-300, "null": null, "empty": {},
+                  "list": [true, false, null, "s", {"a": [[]]}],
+                  "dup": 1, "dup": "two"}}
+    ],
+    "meshes": [{"primitives": [{"attributes": {"POSITION": 0, "NORMAL": 1.5, "UV": 2},
+                                 "targets": [{"POSITION": 0, "NORMAL": "x"}],
+                                 "mode": 4}]}],
+    "accessors": [{"componentType": 5126, "count": 3, "type": "VEC3",
+                   "min": [-1, -1, -1], "max": [1, 1, 1]}],
+    "materials": [{"name": "mat", "pbrMetallicRoughness": {"baseColorFactor": [1, 0.5, 0.25, 1],
+                   "metallicFactor": 0}, "doubleSided": true, "alphaMode": "MASK",
+                   "emissiveFactor": [0, 0, 0], "custom": {"x": 1}}],
+    "extensionsUsed": ["KHR_lights_punctual"],
+    "extensions": {"KHR_lights_punctual": {"lights": [
+      {"type": "spot", "spot": {"outerConeAngle": 0.5}, "color": [1, 1, 1]},
+      {"type": "point", "intensity": 2}]}, "EXT_empty": {}},
+    "extras": null
+  })";
+
+  tinygltf::Model dom_model;
+  std::string dom_err;
+  bool dom_ret = LoadStringWithParser(&dom_model, &dom_err, json, false);
+
+  tinygltf::Model stream_model;
+  std::string stream_err;
+  bool stream_ret = LoadStringWithParser(&stream_model, &stream_err, json, true);
+
+  REQUIRE(true == dom_ret);
+  REQUIRE(true == stream_ret);
+  REQUIRE(dom_err == stream_err);
+  REQUIRE(dom_model == stream_model);
+
+  REQUIRE(stream_model.scenes[0].name == "second");
+  REQUIRE(stream_model.nodes[0].name == "ab\xc3\xa9");
+  REQUIRE(stream_model.nodes[1].extras.Get("dup").Get<std::string>() == "two");
+  REQUIRE(stream_model.lights.size() == 2);
+}
+
+TEST_CASE("streaming-parser-errors", "[streaming]") {
+
+  const char *documents[] = {
+      "{\"asset\": {\"version\": \"2.0\"},}",
+      "{\"asset\": {\"version\": \"2.0\"}} trailing",
+      "{\"asset\": {\"version\": \"2.0\"}, \"nodes\": [1e999]}",
+      "{\"asset\": {\"version\": \"\\ud800\"}}",
+      "{\"asset\": {\"version\": \"2.0\"}, \"nodes\": [01]}",
+      "{\"asset\": {\"version\": \"2.0\"}, \"nodes\": [",
+      "[{\"asset\": {\"version\": \"2.0\"}}]",
+      "{\"asset\": {\"generator\": \"none\"}}",
+      "{\"asset\": {\"version\": \"2.0\"}, \"buffers\": [1]}",
+      "{\"asset\": {\"version\": \"2.0\"}, \"accessors\": [{\"count\": 1}]}"};
+
+  for (const char *document : documents) {
+    INFO(document);
+
+    tinygltf::Model dom_model;
+    std::string dom_err;
+    bool dom_ret = LoadStringWithParser(&dom_model, &dom_err, document, false);
+
+    tinygltf::Model stream_model;
+    std::string stream_err;
+    bool stream_ret =
+        LoadStringWithParser(&stream_model, &stream_err, document, true);
+
+    REQUIRE(false == dom_ret);
+    REQUIRE(false == stream_ret);
+    REQUIRE(!stream_err.empty());
+  }
+
+  // Errors found after the JSON is read are reported the same way.
+  const char *not_object = "[{\"asset\": {\"version\": \"2.0\"}}]";
+  const char *no_version = "{\"asset\": {\"generator\": \"none\"}}";
+  for (const char *document : {not_object, no_version}) {
+    tinygltf::Model dom_model;
+    std::string dom_err;
+    LoadStringWithParser(&dom_model, &dom_err, document, false);
+
+    tinygltf::Model stream_model;
+    std::string stream_err;
+    LoadStringWithParser(&stream_model, &stream_err, document, true);
+
+    REQUIRE(dom_err == stream_err);
+  }
+}
+
+TEST_CASE("value-object", "[value]") {
+
+  tinygltf::Value::Object o;
+  o["b"] = tinygltf::Value(2);
+  o["a"] = tinygltf::Value(1);
+  REQUIRE(o.emplace("c", tinygltf::Value(3)).second);
+  REQUIRE(!o.emplace("a", tinygltf::Value(4)).second);  // keeps the first
+
+  // iterated in key order like std::map
+  std::vector<std::string> keys;
+  for (const auto &it : o) keys.push_back(it.first);
+  REQUIRE(keys == std::vector<std::string>({"a", "b", "c"}));
+  REQUIRE(o.find("a")->second.Get<int>() == 1);
+  REQUIRE(o.count("d") == 0);
+  REQUIRE(o.erase("b") == 1);
+  REQUIRE(o.size() == 2);
+
+  // unsorted pairs, the last duplicate wins
+  std::vector<tinygltf::Value::Object::value_type> members;
+  members.emplace_back("z", tinygltf::Value(1));
+  members.emplace_back("y", tinygltf::Value(2));
+  members.emplace_back("z", tinygltf::Value(3));
+  tinygltf::Value::Object sorted(std::move(members));
+  REQUIRE(sorted.size() == 2);
+  REQUIRE(sorted.begin()->first == "y");
+  REQUIRE(sorted.find("z")->second.Get<int>() == 3);
+
+  tinygltf::Value value(std::move(o));
+  REQUIRE(value.IsObject());
+  REQUIRE(value.Has("c"));
+  REQUIRE(value.Get("c").Get<int>() == 3);
+  REQUIRE(value.Keys() == std::vector<std::string>({"a", "c"}));
+  REQUIRE(value.Size() == 2);
+
+  // copies are deep, moves keep the type
+  tinygltf::Value copy = value;
+  copy.Get<tinygltf::Value::Object>()["d"] = tinygltf::Value(std::string("x"));
+  REQUIRE(value.Size() == 2);
+  REQUIRE(copy.Size() == 3);
+  REQUIRE(!(copy == value));
+
+  tinygltf::Value moved = std::move(copy);
+  REQUIRE(moved.IsObject());
+  REQUIRE(moved.Get("d").Get<std::string>() == "x");
+
+  // payloads of other types read as empty
+  tinygltf::Value number(1.5);
+  const tinygltf::Value &const_number = number;
+  REQUIRE(const_number.Get<std::string>().empty());
+  REQUIRE(const_number.Get<tinygltf::Value::Array>().empty());
+  REQUIRE(const_number.Get<tinygltf::Value::Object>().empty());
+  REQUIRE(number.IsReal());
+
+  // a null value is switched to by mutable access, writes are not lost
+  tinygltf::Value switched;
+  switched.Get<tinygltf::Value::Array>().push_back(tinygltf::Value(2));
+  REQUIRE(switched.IsArray());
+  REQUIRE(switched.ArrayLen() == 1);
+
+  // any other type is kept, a mistyped read does not erase it
+  switched.Get<std::string>() = "text";
+  REQUIRE(switched.IsArray());
+  REQUIRE(switched.ArrayLen() == 1);
+  tinygltf::Value &object = value;
+  REQUIRE(object.Get<tinygltf::Value::Array>().empty());
+  REQUIRE(object.Get<std::string>().empty());
+  REQUIRE(object.IsObject());
+  REQUIRE(object.Size() == 2);
+  REQUIRE(object.Get("c").Get<int>() == 3);
+  REQUIRE(number.Get<tinygltf::Value::Object>().empty());
+  REQUIRE(number.IsReal());
+
+  number = tinygltf::Value(std::string("text"));
+  REQUIRE(number.Get<std::string>() == "text");
+  number = value;
+  REQUIRE(number == value);
+}
+
+TEST_CASE("base64-round-trip", "[base64]") {
+
+  // every length around the 12/24 byte vector steps
+  std::vector<unsigned char> bytes;
+  for (size_t len = 0; len < 200; len++) {
+    std::string encoded = tinygltf::base64_encode(
+        bytes.data(), static_cast<unsigned int>(bytes.size()));
+    REQUIRE(encoded.size() == (len + 2) / 3 * 4);
+
+    std::vector<unsigned char> decoded;
+    tinygltf::base64_decode(encoded.data(), encoded.size(), &decoded);
+    REQUIRE(decoded == bytes);
+    REQUIRE(tinygltf::base64_decode(encoded) ==
+            std::string(bytes.begin(), bytes.end()));
+
+    bytes.push_back(static_cast<unsigned char>(len * 37 + 11));
+  }
+
+  REQUIRE(tinygltf::base64_encode(
+              reinterpret_cast<const unsigned char *>("sponza"), 6) ==
+          "c3Bvbnph");
+  REQUIRE(tinygltf::base64_encode(
+              reinterpret_cast<const unsigned char *>("gltf!"), 5) ==
+          "Z2x0ZiE=");
+
+  // decoding stops at the first invalid character, inside the vector
+  // steps as well as in the tail
+  std::string long_text(100, 'A');
+  long_text[70] = '*';
+  REQUIRE(tinygltf::base64_decode(long_text).size() == 70 / 4 * 3 + 1);
+  REQUIRE(tinygltf::base64_decode("Z2x0ZiE=Z2x0").size() == 5);
+  REQUIRE(tinygltf::base64_decode("Z2x0Z").size() == 3);
+  REQUIRE(tinygltf::base64_decode("").empty());
+}
+
+TEST_CASE("datauri-decode", "[base64]") {
+
+  std::vector<unsigned char> bytes(1000);
+  for (size_t i = 0; i < bytes.size(); i++) {
+    bytes[i] = static_cast<unsigned char>(i * 7);
+  }
+  std::string payload = tinygltf::base64_encode(
+      bytes.data(), static_cast<unsigned int>(bytes.size()));
+
+  std::vector<unsigned char> out;
+  std::string mime_type;
+  REQUIRE(tinygltf::IsDataURI("data:image/png;base64," + payload));
+  REQUIRE(tinygltf::DecodeDataURI(&out, mime_type,
+                                  "data:image/png;base64," + payload, 0,
+                                  false));
+  REQUIRE(mime_type == "image/png");
+  REQUIRE(out == bytes);
+
+  mime_type.clear();
+  REQUIRE(tinygltf::DecodeDataURI(
+      &out, mime_type, "data:application/octet-stream;base64," + payload,
+      bytes.size(), true));
+  REQUIRE(mime_type.empty());
+  REQUIRE(out == bytes);
+
+  REQUIRE(!tinygltf::DecodeDataURI(
+      &out, mime_type, "data:application/gltf-buffer;base64," + payload,
+      bytes.size() + 1, true));
+  REQUIRE(!tinygltf::IsDataURI("image.png#data:image/png;base64,AAAA"));
+  REQUIRE(!tinygltf::DecodeDataURI(&out, mime_type,
+                                   "data:image/png;base64,", 0, false));
+}
+
+static void AppendToVector(void *context, void *data, int size) {
+  const unsigned char *bytes = static_cast<const unsigned char *>(data);
+  static_cast<std::vector<unsigned char> *>(context)->insert(
+      static_cast<std::vector<unsigned char> *>(context)->end(), bytes,
+      bytes + size);
+}
+
+static void CheckLoadImageData(const std::vector<unsigned char> &png,
+                               bool preserve_channels) {
+  INFO(preserve_channels);
+
+  tinygltf::LoadImageDataOption option;
+  option.preserve_channels = preserve_channels;
+  tinygltf::Image image;
+  std::string err;
+  std::string warn;
+  REQUIRE(tinygltf::LoadImageData(&image, 0, &err, &warn, 0, 0, png.data(),
+                                  static_cast<int>(png.size()), &option));
+
+  int w, h, comp;
+  unsigned char *expected =
+      stbi_load_from_memory(png.data(), static_cast<int>(png.size()), &w, &h,
+                            &comp, preserve_channels ? 0 : 4);
+  REQUIRE(expected);
+  REQUIRE(image.width == w);
+  REQUIRE(image.height == h);
+  REQUIRE(image.component == (preserve_channels ? comp : 4));
+  REQUIRE(image.image == std::vector<unsigned char>(
+                             expected, expected + w * h * image.component));
+  stbi_image_free(expected);
+}
+
+TEST_CASE("png-decode", "[image]") {
+
+  // stb_image_write picks a filter per row, every channel count decodes
+  // like stb_image does
+  const int width = 61;
+  const int height = 37;
+  for (int comp = 1; comp <= 4; comp++) {
+    INFO(comp);
+
+    std::vector<unsigned char> pixels(width * height * comp);
+    for (size_t i = 0; i < pixels.size(); i++) {
+      pixels[i] = static_cast<unsigned char>(i * 7 + (i * i) % 13);
+    }
+    std::vector<unsigned char> png;
+    REQUIRE(stbi_write_png_to_func(AppendToVector, &png, width, height, comp,
+                                   pixels.data(), 0));
+
+    CheckLoadImageData(png, false);
+    CheckLoadImageData(png, true);
+
+    tinygltf::Image image;
+    std::string err;
+    std::string warn;
+    REQUIRE(tinygltf::LoadImageData(&image, 0, &err, &warn, width, height,
+                                    png.data(), static_cast<int>(png.size()),
+                                    nullptr));
+    REQUIRE(!tinygltf::LoadImageData(&image, 0, &err, &warn, width + 1,
+                                     height, png.data(),
+                                     static_cast<int>(png.size()), nullptr));
+    png.resize(png.size() / 2);
+    REQUIRE(!tinygltf::LoadImageData(&image, 0, &err, &warn, 0, 0,
+                                     png.data(), static_cast<int>(png.size()),
+                                     nullptr));
+  }
+
+  // zlib compressed files with dynamic codes
+  const char *filenames[] = {"../models/Cube/Cube_BaseColor.png",
+                             "../models/Cube/Cube_MetallicRoughness.png"};
+  for (const char *filename : filenames) {
+    INFO(filename);
+
+    std::vector<unsigned char> png;
+    std::string err;
+    REQUIRE(tinygltf::ReadWholeFile(&png, &err, filename, nullptr));
+    CheckLoadImageData(png, false);
+    CheckLoadImageData(png, true);
+  }
+}
+
+TEST_CASE("jpeg-decode", "[image]") {
+
+  // an odd number of 8x8 blocks leaves one for the last transform, partial
+  // blocks at the edges
+  const int width = 61;
+  const int height = 37;
+  std::vector<unsigned char> pixels(width * height * 3);
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x++) {
+      unsigned char *p = &pixels[(y * width + x) * 3];
+      p[0] = static_cast<unsigned char>(x * 4);
+      p[1] = static_cast<unsigned char>(y * 6);
+      p[2] = static_cast<unsigned char>(255 - x * 2 - y);
+    }
+  }
+  std::vector<unsigned char> jpeg;
+  REQUIRE(stbi_write_jpg_to_func(AppendToVector, &jpeg, width, height, 3,
+                                 pixels.data(), 95));
+
+  tinygltf::Image image;
+  std::string err;
+  std::string warn;
+  REQUIRE(tinygltf::LoadImageData(&image, 0, &err, &warn, width, height,
+                                  jpeg.data(), static_cast<int>(jpeg.size()),
+                                  nullptr));
+  REQUIRE(image.component == 4);
+
+  double error = 0.0;
+  bool opaque = true;
+  for (int i = 0; i < width * height; i++) {
+    for (int c = 0; c < 3; c++) {
+      error += std::abs(image.image[i * 4 + c] - pixels[i * 3 + c]);
+    }
+    opaque &= image.image[i * 4 + 3] == 255;
+  }
+  REQUIRE(error / (width * height * 3) < 4.0);
+  REQUIRE(opaque);
+
+  // decoded in place, same pixels as a separate stb_image allocation
+  tinygltf::LoadImageDataOption option;
+  option.preserve_channels = true;
+  tinygltf::Image rgb;
+  REQUIRE(tinygltf::LoadImageData(&rgb, 0, &err, &warn, 0, 0, jpeg.data(),
+                                  static_cast<int>(jpeg.size()), &option));
+  REQUIRE(rgb.component == 3);
+  REQUIRE(rgb.image.size() == size_t(width * height * 3));
+
+  int w, h, comp;
+  stbi_uc *expected_rgb = stbi_load_from_memory(
+      jpeg.data(), static_cast<int>(jpeg.size()), &w, &h, &comp, 0);
+  REQUIRE(expected_rgb);
+  REQUIRE(memcmp(expected_rgb, rgb.image.data(), rgb.image.size()) == 0);
+  stbi_image_free(expected_rgb);
+
+  REQUIRE_FALSE(stbi_load_jpeg_from_memory_into(
+      jpeg.data(), static_cast<int>(jpeg.size()), rgb.image.data(),
+      rgb.image.size() - 1, &w, &h, &comp, 0));
+  REQUIRE(tinygltf::LoadImageData(&image, 0, &err, &warn, width, height,
+                                  jpeg.data(), static_cast<int>(jpeg.size()),
+                                  nullptr));
+  REQUIRE_FALSE(tinygltf::LoadImageData(&image, 0, &err, &warn, width + 1,
+                                        height, jpeg.data(),
+                                        static_cast<int>(jpeg.size()),
+                                        nullptr));
+
+#ifdef STBI_AVX2
+  // the two block transform matches the generic one
+  if (stbi__avx2_available()) {
+    STBI_SIMD_ALIGN(short, blocks[2][64]);
+    STBI_SIMD_ALIGN(short, copies[2][64]);
+    stbi_uc expected[2][64];
+    stbi_uc actual[2][64];
+    for (int run = 0; run < 100; run++) {
+      for (int i = 0; i < 128; i++) {
+        blocks[i / 64][i % 64] = static_cast<short>(
+            ((run * 131 + i * 71) % 257 - 128) * (i % 64 < 8 ? 8 : 1));
+      }
+      memcpy(copies, blocks, sizeof(blocks));
+      stbi__idct_block(expected[0], 8, copies[0]);
+      stbi__idct_block(expected[1], 8, copies[1]);
+      stbi__idct_avx2(actual[0], 8, blocks[0], actual[1], 8, blocks[1]);
+      REQUIRE(memcmp(expected, actual, sizeof(expected)) == 0);
+    }
+  }
+#endif
+}
+
+static bool CountingReadWholeFile(std::vector<unsigned char> *out,
+                                  std::string *err,
+                                  const std::string &filepath,
+                                  void *user_data) {
+  static_cast<std::atomic<int> *>(user_data)->fetch_add(1);
+  return tinygltf::ReadWholeFile(out, err, filepath, nullptr);
+}
+
+TEST_CASE("external-file-threads", "[threads]") {
+
+  const char *filenames[] = {
+      "../models/Cube/Cube.gltf",
+      "../models/CubeImageUriSpaces/CubeImageUriMultipleSpaces.gltf",
+      "../models/BoundsChecking/invalid-buffer-index.gltf",
+      "../models/box01.glb"};
+
+  for (const char *filename : filenames) {
+    for (bool streaming : {false, true}) {
+      INFO(filename << (streaming ? " streaming" : " dom"));
+
+      tinygltf::Model models[2];
+      std::string errs[2];
+      std::string warns[2];
+      bool rets[2];
+
+      for (int i = 0; i < 2; i++) {
+        rets[i] = LoadWithParser(&models[i], &errs[i], &warns[i], filename,
+                                 streaming, i == 0 ? 0 : 3);
+      }
+
+      REQUIRE(rets[0] == rets[1]);
+      REQUIRE(errs[0] == errs[1]);
+      REQUIRE(warns[0] == warns[1]);
+      REQUIRE(models[0] == models[1]);
+    }
+  }
+
+  // every external file is read once, by whoever gets to it first
+  std::atomic<int> reads(0);
+  tinygltf::FsCallbacks fs = {&tinygltf::FileExists, &tinygltf::ExpandFilePath,
+                              &CountingReadWholeFile, &tinygltf::WriteWholeFile,
+                              &reads};
+
+  tinygltf::TinyGLTF ctx;
+  ctx.SetFsCallbacks(fs);
+  ctx.SetExternalFileThreads(2);
+
+  tinygltf::Model model;
+  std::string err;
+  std::string warn;
+  REQUIRE(ctx.LoadASCIIFromFile(&model, &err, &warn,
+                                "../models/Cube/Cube.gltf"));
+  REQUIRE(reads == 4);  // the .gltf, Cube.bin and two textures
+  REQUIRE(model.images.size() == 2);
+  REQUIRE(!model.images[0].image.empty());
+
+  // a window of one file still reads every file once
+  reads = 0;
+  ctx.SetExternalFileReadAhead(1);
+  REQUIRE(ctx.LoadASCIIFromFile(&model, &err, &warn,
+                                "../models/Cube/Cube.gltf"));
+  REQUIRE(reads == 4);
+  REQUIRE(!model.images[1].image.empty());
+}
+
+struct MockAsyncReads {
+  std::map<uint64_t, std::string> submitted;
+  int completed = 0;
+  int max_in_flight = 0;
+  bool fail_submits = false;
+};
+
+static bool MockSubmitRead(uint64_t *ticket, std::string *err,
+                           const std::string &filepath, void *user_data) {
+  (void)err;
+  MockAsyncReads *reads = static_cast<MockAsyncReads *>(user_data);
+  if (reads->fail_submits) return false;
+  *ticket = reads->submitted.size() + 100;
+  reads->submitted[*ticket] = filepath;
+  reads->max_in_flight =
+      std::max(reads->max_in_flight,
+               static_cast<int>(reads->submitted.size()) - reads->completed);
+  return true;
+}
+
+static bool MockCompleteRead(std::vector<unsigned char> *out, std::string *err,
+                             uint64_t ticket, void *user_data) {
+  MockAsyncReads *reads = static_cast<MockAsyncReads *>(user_data);
+  reads->completed++;
+  return tinygltf::ReadWholeFile(out, err, reads->submitted.at(ticket),
+                                 nullptr);
+}
+
+TEST_CASE("async-fs-callbacks", "[threads]") {
+
+  const char *filename = "../models/Cube/Cube.gltf";
+
+  tinygltf::Model expected;
+  std::string err;
+  std::string warn;
+  REQUIRE(LoadWithParser(&expected, &err, &warn, filename, true));
+
+  for (bool fail_submits : {false, true}) {
+    INFO(fail_submits);
+
+    MockAsyncReads reads;
+    reads.fail_submits = fail_submits;
+    tinygltf::AsyncFsCallbacks async_fs = {&MockSubmitRead, &MockCompleteRead,
+                                           &reads};
+
+    tinygltf::TinyGLTF ctx;
+    ctx.SetStreamingParser(true);
+    ctx.SetAsyncFsCallbacks(async_fs);
+
+    // files that cannot be submitted are read through FsCallbacks
+    tinygltf::Model model;
+    REQUIRE(ctx.LoadASCIIFromFile(&model, &err, &warn, filename));
+    REQUIRE(model == expected);
+    REQUIRE(reads.submitted.size() == (fail_submits ? 0u : 3u));
+    REQUIRE(reads.completed == static_cast<int>(reads.submitted.size()));
+  }
+
+  // submits stay within the read-ahead window, the rest follow as the parser
+  // takes files
+  for (unsigned int read_ahead : {1u, 2u}) {
+    INFO(read_ahead);
+
+    MockAsyncReads reads;
+    tinygltf::AsyncFsCallbacks async_fs = {&MockSubmitRead, &MockCompleteRead,
+                                           &reads};
+
+    tinygltf::TinyGLTF ctx;
+    ctx.SetStreamingParser(true);
+    ctx.SetAsyncFsCallbacks(async_fs);
+    ctx.SetExternalFileReadAhead(read_ahead);
+
+    tinygltf::Model model;
+    REQUIRE(ctx.LoadASCIIFromFile(&model, &err, &warn, filename));
+    REQUIRE(model == expected);
+    REQUIRE(reads.submitted.size() == 3u);
+    REQUIRE(reads.max_in_flight == static_cast<int>(read_ahead));
+  }
+
+  // reads submitted for a document that fails to parse are completed too
+  MockAsyncReads reads;
+  tinygltf::AsyncFsCallbacks async_fs = {&MockSubmitRead, &MockCompleteRead,
+                                         &reads};
+  tinygltf::TinyGLTF ctx;
+  ctx.SetAsyncFsCallbacks(async_fs);
+
+  tinygltf::Model model;
+  REQUIRE(!ctx.LoadASCIIFromFile(
+      &model, &err, &warn,
+      "../models/BoundsChecking/invalid-buffer-index.gltf"));
+  REQUIRE(reads.completed == static_cast<int>(reads.submitted.size()));
+}
+
+#ifdef TINYGLTF_USE_IO_URING
+TEST_CASE("io-uring-file-reader", "[threads]") {
+
+  const char *filename = "../models/Cube/Cube.gltf";
+
+  tinygltf::Model expected;
+  std::string err;
+  std::string warn;
+  REQUIRE(LoadWithParser(&expected, &err, &warn, filename, true));
+
+  for (bool direct : {false, true}) {
+    INFO(direct);
+
+    tinygltf::IoUringFileReader reader(4, direct);
+    if (!reader.IsValid()) {
+      WARN("io_uring is not available");
+      return;
+    }
+
+    tinygltf::TinyGLTF ctx;
+    ctx.SetStreamingParser(true);
+    ctx.SetAsyncFsCallbacks(reader.GetCallbacks());
+
+    tinygltf::Model model;
+    REQUIRE(ctx.LoadASCIIFromFile(&model, &err, &warn, filename));
+    REQUIRE(model == expected);
+
+    // more reads than ring entries, completed out of order
+    tinygltf::AsyncFsCallbacks async_fs = reader.GetCallbacks();
+    std::vector<uint64_t> tickets(10);
+    for (uint64_t &ticket : tickets) {
+      REQUIRE(async_fs.SubmitRead(&ticket, &err, "../models/Cube/Cube.bin",
+                                  async_fs.user_data));
+    }
+    std::vector<unsigned char> bin;
+    REQUIRE(tinygltf::ReadWholeFile(&bin, &err, "../models/Cube/Cube.bin",
+                                    nullptr));
+    for (size_t i = tickets.size(); i-- > 0;) {
+      std::vector<unsigned char> data;
+      REQUIRE(async_fs.CompleteRead(&data, &err, tickets[i],
+                                    async_fs.user_data));
+      REQUIRE(data == bin);
+    }
+
+    uint64_t ticket;
+    REQUIRE(!async_fs.SubmitRead(&ticket, &err, "../models/missing.bin",
+                                 async_fs.user_data));
+  }
+}
+#endif
@@ -53,6 +53,7 @@
 #ifndef TINY_GLTF_H_
 #define TINY_GLTF_H_
 
+#include <algorithm>
 #include <array>
 #include <cassert>
 #include <cmath>  // std::fabs
@@ -61,7 +62,9 @@
 #include <cstring>
 #include <limits>
 #include <map>
+#include <new>
 #include <string>
+#include <utility>
 #include <vector>
 
 #ifndef TINYGLTF_USE_CPP14
@@ -257,45 +260,212 @@ bool DecodeDataURI(std::vector<unsigned char> *out, std::string &mime_type,
 #pragma clang diagnostic ignored "-Wpadded"
 #endif
 
+// Object of a Value. A vector of key/value pairs sorted by key, with the
+// subset of the std::map interface Value::Object used to have, so an object
+// costs one allocation instead of one per member. Unlike std::map, inserting
+// or erasing invalidates iterators and references.
+template <typename T>
+class ValueMap {
+ public:
+  typedef std::string key_type;
+  typedef T mapped_type;
+  typedef std::pair<std::string, T> value_type;
+  typedef size_t size_type;
+  typedef typename std::vector<value_type>::iterator iterator;
+  typedef typename std::vector<value_type>::const_iterator const_iterator;
+
+  ValueMap() = default;
+
+  // Takes unsorted pairs, of duplicate keys the last one is kept.
+  explicit ValueMap(std::vector<value_type> &&items) : items_(std::move(items)) {
+    std::stable_sort(items_.begin(), items_.end(), KeyLess());
+
+    size_t count = 0;
+    for (size_t i = 0; i < items_.size(); i++) {
+      if ((i + 1 < items_.size()) && (items_[i].first == items_[i + 1].first)) {
+        continue;
+      }
+      if (count != i) {
+        items_[count] = std::move(items_[i]);
+      }
+      count++;
+    }
+    items_.erase(items_.begin() + static_cast<std::ptrdiff_t>(count),
+                 items_.end());
+  }
+
+  iterator begin() { return items_.begin(); }
+  iterator end() { return items_.end(); }
+  const_iterator begin() const { return items_.begin(); }
+  const_iterator end() const { return items_.end(); }
+  const_iterator cbegin() const { return items_.begin(); }
+  const_iterator cend() const { return items_.end(); }
+
+  size_t size() const { return items_.size(); }
+  bool empty() const { return items_.empty(); }
+  void clear() { items_.clear(); }
+  void reserve(size_t n) { items_.reserve(n); }
+
+  iterator find(const std::string &key) {
+    iterator it = LowerBound(key);
+    return ((it != items_.end()) && (it->first == key)) ? it : items_.end();
+  }
+
+  const_iterator find(const std::string &key) const {
+    const_iterator it =
+        std::lower_bound(items_.begin(), items_.end(), key, KeyLess());
+    return ((it != items_.end()) && (it->first == key)) ? it : items_.end();
+  }
+
+  size_t count(const std::string &key) const {
+    return (find(key) != items_.end()) ? 1 : 0;
+  }
+
+  T &operator[](const std::string &key) {
+    iterator it = LowerBound(key);
+    if ((it == items_.end()) || (it->first != key)) {
+      it = items_.insert(it, value_type(key, T()));
+    }
+    return it->second;
+  }
+
+  // Does nothing when the key is already present, like std::map.
+  template <typename K, typename V>
+  std::pair<iterator, bool> emplace(K &&key, V &&value) {
+    std::string k(std::forward<K>(key));
+    iterator it = LowerBound(k);
+    if ((it != items_.end()) && (it->first == k)) {
+      return std::make_pair(it, false);
+    }
+    it = items_.insert(it, value_type(std::move(k), T(std::forward<V>(value))));
+    return std::make_pair(it, true);
+  }
+
+  std::pair<iterator, bool> insert(const value_type &item) {
+    return emplace(item.first, item.second);
+  }
+
+  std::pair<iterator, bool> insert(value_type &&item) {
+    return emplace(std::move(item.first), std::move(item.second));
+  }
+
+  iterator erase(const_iterator it) {
+    return items_.erase(items_.begin() + (it - items_.cbegin()));
+  }
+
+  size_t erase(const std::string &key) {
+    iterator it = find(key);
+    if (it == items_.end()) return 0;
+    items_.erase(it);
+    return 1;
+  }
+
+  void swap(ValueMap &other) { items_.swap(other.items_); }
+
+  bool operator==(const ValueMap &other) const { return items_ == other.items_; }
+  bool operator!=(const ValueMap &other) const { return !(*this == other); }
+
+ private:
+  struct KeyLess {
+    bool operator()(const value_type &a, const value_type &b) const {
+      return a.first < b.first;
+    }
+    bool operator()(const value_type &a, const std::string &b) const {
+      return a.first < b;
+    }
+  };
+
+  iterator LowerBound(const std::string &key) {
+    return std::lower_bound(items_.begin(), items_.end(), key, KeyLess());
+  }
+
+  std::vector<value_type> items_;
+};
+
 // Simple class to represent JSON object
+//
+// Numbers and booleans are stored inline, only the payload of the current
+// string, binary, array or object type exists, so a Value is a few words plus
+// that one container.
 class Value {
  public:
   typedef std::vector<Value> Array;
-  typedef std::map<std::string, Value> Object;
+  typedef ValueMap<Value> Object;
 
   Value()
       : type_(NULL_TYPE),
+        boolean_value_(false),
         int_value_(0),
-        real_value_(0.0),
-        boolean_value_(false) {}
+        real_value_(0.0) {}
 
-  explicit Value(bool b) : type_(BOOL_TYPE) { boolean_value_ = b; }
-  explicit Value(int i) : type_(INT_TYPE) {
+  explicit Value(bool b) : Value() {
+    type_ = BOOL_TYPE;
+    boolean_value_ = b;
+  }
+  explicit Value(int i) : Value() {
+    type_ = INT_TYPE;
     int_value_ = i;
     real_value_ = i;
   }
-  explicit Value(double n) : type_(REAL_TYPE) { real_value_ = n; }
-  explicit Value(const std::string &s) : type_(STRING_TYPE) {
-    string_value_ = s;
+  explicit Value(double n) : Value() {
+    type_ = REAL_TYPE;
+    real_value_ = n;
+  }
+  explicit Value(const std::string &s) : Value() {
+    new (&string_value_) std::string(s);
+    type_ = STRING_TYPE;
   }
-  explicit Value(std::string &&s)
-      : type_(STRING_TYPE), string_value_(std::move(s)) {}
-  explicit Value(const unsigned char *p, size_t n) : type_(BINARY_TYPE) {
-    binary_value_.resize(n);
-    memcpy(binary_value_.data(), p, n);
+  explicit Value(std::string &&s) : Value() {
+    new (&string_value_) std::string(std::move(s));
+    type_ = STRING_TYPE;
   }
-  explicit Value(std::vector<unsigned char> &&v) noexcept
-      : type_(BINARY_TYPE),
-        binary_value_(std::move(v)) {}
-  explicit Value(const Array &a) : type_(ARRAY_TYPE) { array_value_ = a; }
-  explicit Value(Array &&a) noexcept : type_(ARRAY_TYPE),
-                                       array_value_(std::move(a)) {}
+  explicit Value(const unsigned char *p, size_t n) : Value() {
+    new (&binary_value_) std::vector<unsigned char>(p, p + n);
+    type_ = BINARY_TYPE;
+  }
+  explicit Value(std::vector<unsigned char> &&v) noexcept : Value() {
+    new (&binary_value_) std::vector<unsigned char>(std::move(v));
+    type_ = BINARY_TYPE;
+  }
+  explicit Value(const Array &a) : Value() {
+    new (&array_value_) Array(a);
+    type_ = ARRAY_TYPE;
+  }
+  explicit Value(Array &&a) noexcept : Value() {
+    new (&array_value_) Array(std::move(a));
+    type_ = ARRAY_TYPE;
+  }
+
+  explicit Value(const Object &o) : Value() {
+    new (&object_value_) Object(o);
+    type_ = OBJECT_TYPE;
+  }
+  explicit Value(Object &&o) noexcept : Value() {
+    new (&object_value_) Object(std::move(o));
+    type_ = OBJECT_TYPE;
+  }
+
+  ~Value() { DestroyPayload(); }
 
-  explicit Value(const Object &o) : type_(OBJECT_TYPE) { object_value_ = o; }
-  explicit Value(Object &&o) noexcept : type_(OBJECT_TYPE),
-                                        object_value_(std::move(o)) {}
+  Value(const Value &other) : Value() { CopyFrom(other); }
+  Value(Value &&other) TINYGLTF_NOEXCEPT : Value() { MoveFrom(other); }
 
-  DEFAULT_METHODS(Value)
+  Value &operator=(const Value &other) {
+    if (this != &other) {
+      Value copy(other);
+      DestroyPayload();
+      MoveFrom(copy);
+    }
+    return *this;
+  }
+
+  Value &operator=(Value &&other) TINYGLTF_NOEXCEPT {
+    if (this != &other) {
+      DestroyPayload();
+      MoveFrom(other);
+    }
+    return *this;
+  }
 
   char Type() const { return static_cast<char>(type_); }
 
@@ -335,6 +505,11 @@ class Value {
   }
 
   // Accessor
+  //
+  // Getting a string, binary, array or object from a value of another type
+  // returns an empty one, which is not stored in the value. The non-const
+  // getter of a null value turns it into an empty one of the requested type
+  // first, like nlohmann::json's operator[].
   template <typename T>
   const T &Get() const;
   template <typename T>
@@ -345,7 +520,7 @@ class Value {
     static Value null_value;
     assert(IsArray());
     assert(idx >= 0);
-    return (static_cast<size_t>(idx) < array_value_.size())
+    return (IsArray() && (static_cast<size_t>(idx) < array_value_.size()))
                ? array_value_[static_cast<size_t>(idx)]
                : null_value;
   }
@@ -354,6 +529,7 @@ class Value {
   const Value &Get(const std::string &key) const {
     static Value null_value;
     assert(IsObject());
+    if (!IsObject()) return null_value;
     Object::const_iterator it = object_value_.find(key);
     return (it != object_value_.end()) ? it->second : null_value;
   }
@@ -375,6 +551,7 @@ class Value {
     std::vector<std::string> keys;
     if (!IsObject()) return keys;  // empty
 
+    keys.reserve(object_value_.size());
     for (Object::const_iterator it = object_value_.begin();
          it != object_value_.end(); ++it) {
       keys.push_back(it->first);
@@ -383,20 +560,97 @@ class Value {
     return keys;
   }
 
-  size_t Size() const { return (IsArray() ? ArrayLen() : Keys().size()); }
+  size_t Size() const {
+    return (IsArray() ? ArrayLen() : (IsObject() ? object_value_.size() : 0));
+  }
 
   bool operator==(const tinygltf::Value &other) const;
 
  protected:
-  int type_ = NULL_TYPE;
-
+  template <typename T>
+  static void Destroy(T *p) {
+    p->~T();
+  }
+
+  void DestroyPayload() {
+    switch (type_) {
+      case STRING_TYPE:
+        Destroy(&string_value_);
+        break;
+      case BINARY_TYPE:
+        Destroy(&binary_value_);
+        break;
+      case ARRAY_TYPE:
+        Destroy(&array_value_);
+        break;
+      case OBJECT_TYPE:
+        Destroy(&object_value_);
+        break;
+      default:
+        break;
+    }
+    type_ = NULL_TYPE;
+  }
+
+  // Both expect this value to have no payload.
+  void CopyFrom(const Value &other) {
+    switch (other.type_) {
+      case STRING_TYPE:
+        new (&string_value_) std::string(other.string_value_);
+        break;
+      case BINARY_TYPE:
+        new (&binary_value_) std::vector<unsigned char>(other.binary_value_);
+        break;
+      case ARRAY_TYPE:
+        new (&array_value_) Array(other.array_value_);
+        break;
+      case OBJECT_TYPE:
+        new (&object_value_) Object(other.object_value_);
+        break;
+      default:
+        break;
+    }
+    type_ = other.type_;
+    boolean_value_ = other.boolean_value_;
+    int_value_ = other.int_value_;
+    real_value_ = other.real_value_;
+  }
+
+  void MoveFrom(Value &other) {
+    switch (other.type_) {
+      case STRING_TYPE:
+        new (&string_value_) std::string(std::move(other.string_value_));
+        break;
+      case BINARY_TYPE:
+        new (&binary_value_)
+            std::vector<unsigned char>(std::move(other.binary_value_));
+        break;
+      case ARRAY_TYPE:
+        new (&array_value_) Array(std::move(other.array_value_));
+        break;
+      case OBJECT_TYPE:
+        new (&object_value_) Object(std::move(other.object_value_));
+        break;
+      default:
+        break;
+    }
+    type_ = other.type_;
+    boolean_value_ = other.boolean_value_;
+    int_value_ = other.int_value_;
+    real_value_ = other.real_value_;
+  }
+
+  char type_ = NULL_TYPE;
+  bool boolean_value_ = false;
   int int_value_ = 0;
   double real_value_ = 0.0;
-  std::string string_value_;
-  std::vector<unsigned char> binary_value_;
-  Array array_value_;
-  Object object_value_;
-  bool boolean_value_ = false;
+
+  union {
+    std::string string_value_;
+    std::vector<unsigned char> binary_value_;
+    Array array_value_;
+    Object object_value_;
+  };
 };
 
 #ifdef __clang__
@@ -415,10 +669,32 @@ class Value {
 TINYGLTF_VALUE_GET(bool, boolean_value_)
 TINYGLTF_VALUE_GET(double, real_value_)
 TINYGLTF_VALUE_GET(int, int_value_)
-TINYGLTF_VALUE_GET(std::string, string_value_)
-TINYGLTF_VALUE_GET(std::vector<unsigned char>, binary_value_)
-TINYGLTF_VALUE_GET(Value::Array, array_value_)
-TINYGLTF_VALUE_GET(Value::Object, object_value_)
+#undef TINYGLTF_VALUE_GET
+
+// A null value becomes an empty payload of the requested type, so writes
+// through the reference are kept. Any other type is left alone and a detached
+// empty payload, reset on every call, is handed out instead.
+#define TINYGLTF_VALUE_GET(ctype, var, type)           \
+  template <>                                          \
+  inline const ctype &Value::Get<ctype>() const {      \
+    static const ctype empty_value;                    \
+    return (type_ == type) ? var : empty_value;        \
+  }                                                    \
+  template <>                                          \
+  inline ctype &Value::Get<ctype>() {                  \
+    if (type_ == NULL_TYPE) {                          \
+      new (&var) ctype();                              \
+      type_ = type;                                    \
+    }                                                  \
+    if (type_ == type) return var;                     \
+    static thread_local ctype empty_value;             \
+    empty_value = ctype();                             \
+    return empty_value;                                \
+  }
+TINYGLTF_VALUE_GET(std::string, string_value_, STRING_TYPE)
+TINYGLTF_VALUE_GET(std::vector<unsigned char>, binary_value_, BINARY_TYPE)
+TINYGLTF_VALUE_GET(Value::Array, array_value_, ARRAY_TYPE)
+TINYGLTF_VALUE_GET(Value::Object, object_value_, OBJECT_TYPE)
 #undef TINYGLTF_VALUE_GET
 
 #ifdef __clang__
@@ -1272,6 +1548,62 @@ bool WriteWholeFile(std::string *err, const std::string &filepath,
                     const std::vector<unsigned char> &contents, void *);
 #endif
 
+///
+/// SubmitReadFunction type. Starts reading a whole file and sets `ticket` to
+/// an id for CompleteRead. Returning false makes the loader read the file
+/// through FsCallbacks::ReadWholeFile instead.
+///
+typedef bool (*SubmitReadFunction)(uint64_t *ticket, std::string *err,
+                                   const std::string &filepath, void *);
+
+///
+/// CompleteReadFunction type. Waits for a submitted read and moves the file
+/// contents into `out`. Called exactly once for every successful submit.
+///
+typedef bool (*CompleteReadFunction)(std::vector<unsigned char> *out,
+                                     std::string *err, uint64_t ticket,
+                                     void *);
+
+///
+/// Asynchronous reads of external files. All of them are submitted before
+/// parsing and completed when the parser reaches them. Both functions are
+/// only called from the thread that loads the model.
+///
+struct AsyncFsCallbacks {
+  SubmitReadFunction SubmitRead;
+  CompleteReadFunction CompleteRead;
+
+  void *user_data;  // An argument that is passed to all async fs callbacks
+};
+
+#ifdef TINYGLTF_USE_IO_URING
+///
+/// AsyncFsCallbacks reading through a Linux io_uring, files are opened when
+/// submitted and read with one request each. With `direct` the reads bypass
+/// the page cache (O_DIRECT) into page aligned buffers, which are copied to
+/// the output once complete. Falls back to buffered reads for files that
+/// cannot be opened with O_DIRECT. IsValid() is false when the kernel does
+/// not provide io_uring, GetCallbacks() then fails every submit.
+///
+class IoUringFileReader {
+ public:
+  explicit IoUringFileReader(unsigned int queue_depth = 64,
+                             bool direct = false);
+  ~IoUringFileReader();
+
+  IoUringFileReader(const IoUringFileReader &) = delete;
+  IoUringFileReader &operator=(const IoUringFileReader &) = delete;
+
+  bool IsValid() const;
+
+  AsyncFsCallbacks GetCallbacks();
+
+ private:
+  struct Ring;
+  Ring *ring_;
+};
+#endif
+
 ///
 /// glTF Parser/Serialier context.
 ///
@@ -1364,6 +1696,13 @@ class TinyGLTF {
   ///
   void SetFsCallbacks(FsCallbacks callbacks);
 
+  ///
+  /// Set callbacks to read external buffers and images asynchronously. They
+  /// are tried before the FsCallbacks, together with the external file
+  /// threads when those are set. Ignored when TINYGLTF_NO_THREADS is defined.
+  ///
+  void SetAsyncFsCallbacks(AsyncFsCallbacks callbacks);
+
   ///
   /// Set serializing default values(default = false).
   /// When true, default values are force serialized to .glTF.
@@ -1402,6 +1741,43 @@ class TinyGLTF {
 
   bool GetPreserveImageChannels() const { return preserve_image_channels_; }
 
+  ///
+  /// Parse glTF JSON with the streaming parser instead of building a JSON DOM
+  /// first. Loads the same Model, but is faster and uses less memory on
+  /// large files. Ignored (the DOM is used) when original JSON strings are
+  /// stored for extras and extensions, or when Draco support is enabled.
+  ///
+  void SetStreamingParser(bool onoff) { streaming_parser_ = onoff; }
+
+  bool GetStreamingParser() const { return streaming_parser_; }
+
+  ///
+  /// Read the external files (buffers and images) of a .gltf on up to
+  /// `num_threads` threads while it is parsed. 0 (the default) reads them
+  /// one after another when they are reached. Needs a thread safe
+  /// FsCallbacks::ReadWholeFile, ignored when TINYGLTF_NO_THREADS is defined.
+  ///
+  void SetExternalFileThreads(unsigned int num_threads) {
+    external_file_threads_ = num_threads;
+  }
+
+  unsigned int GetExternalFileThreads() const {
+    return external_file_threads_;
+  }
+
+  ///
+  /// Limit how many external files are read or submitted ahead of the
+  /// parser (default = 16, at least 1). Files the parser has not taken yet
+  /// stay in memory, so this bounds the memory held by read-ahead.
+  ///
+  void SetExternalFileReadAhead(unsigned int num_files) {
+    external_file_read_ahead_ = num_files;
+  }
+
+  unsigned int GetExternalFileReadAhead() const {
+    return external_file_read_ahead_;
+  }
+
  private:
   ///
   /// Loads glTF asset from string(memory).
@@ -1413,6 +1789,12 @@ class TinyGLTF {
                       const char *str, const unsigned int length,
                       const std::string &base_dir, unsigned int check_sections);
 
+  bool LoadFromStringStreaming(Model *model, std::string *err,
+                               std::string *warn, const char *str,
+                               const unsigned int length,
+                               const std::string &base_dir,
+                               unsigned int check_sections);
+
   const unsigned char *bin_data_ = nullptr;
   size_t bin_size_ = 0;
   bool is_binary_ = false;
@@ -1424,6 +1806,13 @@ class TinyGLTF {
   bool preserve_image_channels_ = false;  /// Default false(expand channels to
                                           /// RGBA) for backward compatibility.
 
+  bool streaming_parser_ = false;
+
+  unsigned int external_file_threads_ = 0;
+  unsigned int external_file_read_ahead_ = 16;
+
+  AsyncFsCallbacks async_fs_ = {nullptr, nullptr, nullptr};
+
   FsCallbacks fs = {
 #ifndef TINYGLTF_NO_FS
       &tinygltf::FileExists, &tinygltf::ExpandFilePath,
@@ -1466,11 +1855,34 @@ class TinyGLTF {
 #if defined(TINYGLTF_IMPLEMENTATION) || defined(__INTELLISENSE__)
 #include <algorithm>
 //#include <cassert>
+#include <clocale>
+#if defined(__GLIBC__) || defined(__APPLE__) || defined(__FreeBSD__)
+#include <locale.h>
+#if defined(__APPLE__) || defined(__FreeBSD__)
+#include <xlocale.h>
+#endif
+#define TINYGLTF_INTERNAL_HAS_STRTOD_L
+#endif
 #ifndef TINYGLTF_NO_FS
 #include <cstdio>
 #include <fstream>
 #endif
 #include <sstream>
+#ifndef TINYGLTF_NO_THREADS
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+#ifdef TINYGLTF_USE_IO_URING
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#endif
 
 #ifdef __clang__
 // Disable some warnings for external files.
@@ -1608,6 +2020,24 @@ class TinyGLTF {
 #include <wordexp.h>
 #endif
 
+// Vectorized base64 when the compiler targets SSSE3, scalar otherwise. The
+// AVX2 decoder is compiled with a target attribute and picked at runtime, so
+// it does not need the whole file built for AVX2.
+#if !defined(TINYGLTF_NO_SIMD) && (defined(__SSSE3__) || defined(__AVX2__))
+#include <immintrin.h>
+#define TINYGLTF_BASE64_SSSE3
+#endif
+
+#if !defined(TINYGLTF_NO_SIMD) && defined(__AVX2__)
+#define TINYGLTF_BASE64_AVX2
+#define TINYGLTF_AVX2_TARGET
+#elif !defined(TINYGLTF_NO_SIMD) && (defined(__GNUC__) || defined(__clang__)) && \
+    (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define TINYGLTF_BASE64_AVX2
+#define TINYGLTF_AVX2_TARGET __attribute__((target("avx2")))
+#endif
+
 #if defined(__sparcv9) || defined(__powerpc__)
 // Big endian
 #else
@@ -1616,6 +2046,17 @@ class TinyGLTF {
 #endif
 #endif
 
+// PNG decoder for the common 8 bit formats, used by LoadImageData before
+// falling back to stb_image.
+#if defined(TINYGLTF_LITTLE_ENDIAN) && !defined(TINYGLTF_NO_STB_IMAGE) && \
+    !defined(TINYGLTF_NO_FAST_PNG)
+#define TINYGLTF_FAST_PNG
+#if !defined(TINYGLTF_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64))
+#include <emmintrin.h>
+#define TINYGLTF_PNG_SSE2
+#endif
+#endif
+
 namespace {
 #ifdef TINYGLTF_USE_RAPIDJSON
 
@@ -1735,8 +2176,8 @@ static bool Equals(const tinygltf::Value &one, const tinygltf::Value &other) {
     case INT_TYPE:
       return one.Get<int>() == other.Get<int>();
     case OBJECT_TYPE: {
-      auto oneObj = one.Get<tinygltf::Value::Object>();
-      auto otherObj = other.Get<tinygltf::Value::Object>();
+      const auto &oneObj = one.Get<tinygltf::Value::Object>();
+      const auto &otherObj = other.Get<tinygltf::Value::Object>();
       if (oneObj.size() != otherObj.size()) return false;
       for (auto &it : oneObj) {
         auto otherIt = otherObj.find(it.first);
@@ -2050,6 +2491,12 @@ static std::string GetBaseFilename(const std::string &filepath) {
 std::string base64_encode(unsigned char const *, unsigned int len);
 std::string base64_decode(std::string const &s);
 
+// Decodes `len` characters of `encoded` straight into `out`, which is resized
+// to the decoded size. Like the std::string version, decoding stops at the
+// first '=' or non-base64 character.
+void base64_decode(const char *encoded, size_t len,
+                   std::vector<unsigned char> *out);
+
 /*
    base64.cpp and base64.h
 
@@ -2075,6 +2522,10 @@ std::string base64_decode(std::string const &s);
 
    René Nyffenegger rene.nyffenegger@adp-gmbh.ch
 
+   Altered: table driven, writes into preallocated output and converts 12
+   bytes per step with SSSE3 when the compiler targets it, 24 with AVX2 when
+   the CPU has it.
+
 */
 
 #ifdef __clang__
@@ -2083,109 +2534,353 @@ std::string base64_decode(std::string const &s);
 #pragma clang diagnostic ignored "-Wconversion"
 #endif
 
-static inline bool is_base64(unsigned char c) {
-  return (isalnum(c) || (c == '+') || (c == '/'));
+namespace {
+
+const char kBase64Chars[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+    "abcdefghijklmnopqrstuvwxyz"
+    "0123456789+/";
+
+// 6 bit value of every base64 character, 0xff for anything else (incl. '=').
+const unsigned char kBase64Values[256] = {
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 62,  255,
+    255, 255, 63,  52,  53,  54,  55,  56,  57,  58,  59,  60,  61,  255, 255,
+    255, 255, 255, 255, 255, 0,   1,   2,   3,   4,   5,   6,   7,   8,   9,
+    10,  11,  12,  13,  14,  15,  16,  17,  18,  19,  20,  21,  22,  23,  24,
+    25,  255, 255, 255, 255, 255, 255, 26,  27,  28,  29,  30,  31,  32,  33,
+    34,  35,  36,  37,  38,  39,  40,  41,  42,  43,  44,  45,  46,  47,  48,
+    49,  50,  51,  255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255};
+
+inline size_t Base64EncodedSize(size_t len) { return (len + 2) / 3 * 4; }
+
+// Upper bound of the decoded size, Base64Decode() needs this much room.
+inline size_t Base64DecodedCapacity(size_t len) { return len / 4 * 3 + 3; }
+
+#ifdef TINYGLTF_BASE64_SSSE3
+// Maps 16 characters to their 6 bit values, false if any of them is not a
+// base64 character.
+inline bool Base64Values16(__m128i in, __m128i *values) {
+  const __m128i upper =
+      _mm_and_si128(_mm_cmpgt_epi8(in, _mm_set1_epi8('A' - 1)),
+                    _mm_cmplt_epi8(in, _mm_set1_epi8('Z' + 1)));
+  const __m128i lower =
+      _mm_and_si128(_mm_cmpgt_epi8(in, _mm_set1_epi8('a' - 1)),
+                    _mm_cmplt_epi8(in, _mm_set1_epi8('z' + 1)));
+  const __m128i digit =
+      _mm_and_si128(_mm_cmpgt_epi8(in, _mm_set1_epi8('0' - 1)),
+                    _mm_cmplt_epi8(in, _mm_set1_epi8('9' + 1)));
+  const __m128i plus = _mm_cmpeq_epi8(in, _mm_set1_epi8('+'));
+  const __m128i slash = _mm_cmpeq_epi8(in, _mm_set1_epi8('/'));
+
+  const __m128i valid = _mm_or_si128(
+      _mm_or_si128(_mm_or_si128(upper, lower), _mm_or_si128(digit, plus)),
+      slash);
+  if (_mm_movemask_epi8(valid) != 0xffff) {
+    return false;
+  }
+
+  const __m128i shift = _mm_or_si128(
+      _mm_or_si128(_mm_and_si128(upper, _mm_set1_epi8(-65)),
+                   _mm_and_si128(lower, _mm_set1_epi8(-71))),
+      _mm_or_si128(_mm_or_si128(_mm_and_si128(digit, _mm_set1_epi8(4)),
+                                _mm_and_si128(plus, _mm_set1_epi8(19))),
+                   _mm_and_si128(slash, _mm_set1_epi8(16))));
+  *values = _mm_add_epi8(in, shift);
+  return true;
 }
 
-std::string base64_encode(unsigned char const *bytes_to_encode,
-                          unsigned int in_len) {
-  std::string ret;
-  int i = 0;
-  int j = 0;
-  unsigned char char_array_3[3];
-  unsigned char char_array_4[4];
+// Packs four 6 bit values per 32 bit lane into the lane's low 3 bytes, most
+// significant byte first after the shuffle.
+inline __m128i Base64Pack16(__m128i values) {
+  const __m128i merged =
+      _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+  const __m128i packed = _mm_madd_epi16(merged, _mm_set1_epi32(0x00011000));
+  return _mm_shuffle_epi8(packed, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14,
+                                                13, 12, -1, -1, -1, -1));
+}
+
+// Spreads 12 input bytes over 16 lanes of 6 bit indices and maps them to
+// base64 characters.
+inline __m128i Base64Chars16(__m128i in) {
+  in = _mm_shuffle_epi8(
+      in, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+  const __m128i t0 = _mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00));
+  const __m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+  const __m128i t2 = _mm_and_si128(in, _mm_set1_epi32(0x003f03f0));
+  const __m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+  const __m128i indices = _mm_or_si128(t1, t3);
+
+  // 'A' - 0, 'a' - 26, '0' - 52, '+' - 62, '/' - 63
+  const __m128i above_25 = _mm_cmpgt_epi8(indices, _mm_set1_epi8(25));
+  const __m128i above_51 = _mm_cmpgt_epi8(indices, _mm_set1_epi8(51));
+  const __m128i above_61 = _mm_cmpgt_epi8(indices, _mm_set1_epi8(61));
+  const __m128i is_63 = _mm_cmpeq_epi8(indices, _mm_set1_epi8(63));
+  __m128i shift = _mm_set1_epi8(65);
+  shift = _mm_add_epi8(shift, _mm_and_si128(above_25, _mm_set1_epi8(6)));
+  shift = _mm_add_epi8(shift, _mm_and_si128(above_51, _mm_set1_epi8(-75)));
+  shift = _mm_add_epi8(shift, _mm_and_si128(above_61, _mm_set1_epi8(-15)));
+  shift = _mm_add_epi8(shift, _mm_and_si128(is_63, _mm_set1_epi8(3)));
+  return _mm_add_epi8(indices, shift);
+}
+#endif
+
+#ifdef TINYGLTF_BASE64_AVX2
+inline bool Base64HasAVX2() {
+#ifdef __AVX2__
+  return true;
+#else
+  static const bool has_avx2 = __builtin_cpu_supports("avx2") != 0;
+  return has_avx2;
+#endif
+}
 
-  const char *base64_chars =
-      "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
-      "abcdefghijklmnopqrstuvwxyz"
-      "0123456789+/";
+TINYGLTF_AVX2_TARGET inline bool Base64Values32(__m256i in, __m256i *values) {
+  const __m256i upper =
+      _mm256_and_si256(_mm256_cmpgt_epi8(in, _mm256_set1_epi8('A' - 1)),
+                       _mm256_cmpgt_epi8(_mm256_set1_epi8('Z' + 1), in));
+  const __m256i lower =
+      _mm256_and_si256(_mm256_cmpgt_epi8(in, _mm256_set1_epi8('a' - 1)),
+                       _mm256_cmpgt_epi8(_mm256_set1_epi8('z' + 1), in));
+  const __m256i digit =
+      _mm256_and_si256(_mm256_cmpgt_epi8(in, _mm256_set1_epi8('0' - 1)),
+                       _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), in));
+  const __m256i plus = _mm256_cmpeq_epi8(in, _mm256_set1_epi8('+'));
+  const __m256i slash = _mm256_cmpeq_epi8(in, _mm256_set1_epi8('/'));
+
+  const __m256i valid = _mm256_or_si256(
+      _mm256_or_si256(_mm256_or_si256(upper, lower),
+                      _mm256_or_si256(digit, plus)),
+      slash);
+  if (_mm256_movemask_epi8(valid) != -1) {
+    return false;
+  }
 
-  while (in_len--) {
-    char_array_3[i++] = *(bytes_to_encode++);
-    if (i == 3) {
-      char_array_4[0] = (char_array_3[0] & 0xfc) >> 2;
-      char_array_4[1] =
-          ((char_array_3[0] & 0x03) << 4) + ((char_array_3[1] & 0xf0) >> 4);
-      char_array_4[2] =
-          ((char_array_3[1] & 0x0f) << 2) + ((char_array_3[2] & 0xc0) >> 6);
-      char_array_4[3] = char_array_3[2] & 0x3f;
+  const __m256i shift = _mm256_or_si256(
+      _mm256_or_si256(_mm256_and_si256(upper, _mm256_set1_epi8(-65)),
+                      _mm256_and_si256(lower, _mm256_set1_epi8(-71))),
+      _mm256_or_si256(
+          _mm256_or_si256(_mm256_and_si256(digit, _mm256_set1_epi8(4)),
+                          _mm256_and_si256(plus, _mm256_set1_epi8(19))),
+          _mm256_and_si256(slash, _mm256_set1_epi8(16))));
+  *values = _mm256_add_epi8(in, shift);
+  return true;
+}
 
-      for (i = 0; (i < 4); i++) ret += base64_chars[char_array_4[i]];
-      i = 0;
+// Same as Base64Pack16() per 128 bit lane, then the two 12 byte halves are
+// moved next to each other.
+TINYGLTF_AVX2_TARGET inline __m256i Base64Pack32(__m256i values) {
+  const __m256i merged =
+      _mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140));
+  const __m256i packed =
+      _mm256_madd_epi16(merged, _mm256_set1_epi32(0x00011000));
+  const __m256i shuffled = _mm256_shuffle_epi8(
+      packed,
+      _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+                       2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+  return _mm256_permutevar8x32_epi32(shuffled,
+                                     _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7));
+}
+
+// Decodes 32 characters per step while they are all base64 characters and at
+// least 48 are left. Advances `i` and `o` past what was decoded.
+TINYGLTF_AVX2_TARGET void Base64DecodeAVX2(const char *src, size_t len,
+                                           unsigned char *dst, size_t *i,
+                                           size_t *o) {
+  for (; *i + 48 <= len; *i += 32, *o += 24) {
+    __m256i values;
+    if (!Base64Values32(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + *i)),
+            &values)) {
+      break;
     }
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + *o),
+                        Base64Pack32(values));
   }
+}
+#endif
 
-  if (i) {
-    for (j = i; j < 3; j++) char_array_3[j] = '\0';
-
-    char_array_4[0] = (char_array_3[0] & 0xfc) >> 2;
-    char_array_4[1] =
-        ((char_array_3[0] & 0x03) << 4) + ((char_array_3[1] & 0xf0) >> 4);
-    char_array_4[2] =
-        ((char_array_3[1] & 0x0f) << 2) + ((char_array_3[2] & 0xc0) >> 6);
+// Writes Base64EncodedSize(len) characters to `dst`.
+void Base64Encode(const unsigned char *src, size_t len, char *dst) {
+  size_t i = 0;
 
-    for (j = 0; (j < i + 1); j++) ret += base64_chars[char_array_4[j]];
+#ifdef TINYGLTF_BASE64_SSSE3
+  // Loads 16 bytes and uses 12 of them.
+  for (; i + 16 <= len; i += 12) {
+    const __m128i in =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst), Base64Chars16(in));
+    dst += 16;
+  }
+#endif
 
-    while ((i++ < 3)) ret += '=';
+  for (; i + 3 <= len; i += 3) {
+    const unsigned int v = (unsigned int)src[i] << 16 |
+                           (unsigned int)src[i + 1] << 8 | src[i + 2];
+    dst[0] = kBase64Chars[(v >> 18) & 0x3f];
+    dst[1] = kBase64Chars[(v >> 12) & 0x3f];
+    dst[2] = kBase64Chars[(v >> 6) & 0x3f];
+    dst[3] = kBase64Chars[v & 0x3f];
+    dst += 4;
   }
 
-  return ret;
+  if (i < len) {
+    const unsigned int v =
+        (unsigned int)src[i] << 16 |
+        (i + 1 < len ? (unsigned int)src[i + 1] << 8 : 0u);
+    dst[0] = kBase64Chars[(v >> 18) & 0x3f];
+    dst[1] = kBase64Chars[(v >> 12) & 0x3f];
+    dst[2] = i + 1 < len ? kBase64Chars[(v >> 6) & 0x3f] : '=';
+    dst[3] = '=';
+  }
 }
 
-std::string base64_decode(std::string const &encoded_string) {
-  int in_len = static_cast<int>(encoded_string.size());
-  int i = 0;
-  int j = 0;
-  int in_ = 0;
-  unsigned char char_array_4[4], char_array_3[3];
-  std::string ret;
+// Decodes up to the first '=' or non-base64 character into `dst`, which must
+// have Base64DecodedCapacity(len) bytes. A trailing group of n < 4 characters
+// gives n - 1 bytes. Returns the decoded size.
+size_t Base64Decode(const char *src, size_t len, unsigned char *dst) {
+  size_t i = 0;
+  size_t o = 0;
+
+  // The vector stores write a few bytes past the decoded ones, the loop
+  // bounds keep them inside the capacity.
+
+#ifdef TINYGLTF_BASE64_AVX2
+  if (Base64HasAVX2()) {
+    Base64DecodeAVX2(src, len, dst, &i, &o);
+  }
+#endif
 
-  const std::string base64_chars =
-      "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
-      "abcdefghijklmnopqrstuvwxyz"
-      "0123456789+/";
+#ifdef TINYGLTF_BASE64_SSSE3
+  for (; i + 24 <= len; i += 16, o += 12) {
+    __m128i values;
+    if (!Base64Values16(
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i)),
+            &values)) {
+      break;
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + o),
+                     Base64Pack16(values));
+  }
+#endif
 
-  while (in_len-- && (encoded_string[in_] != '=') &&
-         is_base64(encoded_string[in_])) {
-    char_array_4[i++] = encoded_string[in_];
-    in_++;
-    if (i == 4) {
-      for (i = 0; i < 4; i++)
-        char_array_4[i] =
-            static_cast<unsigned char>(base64_chars.find(char_array_4[i]));
+  const unsigned char *s = reinterpret_cast<const unsigned char *>(src);
 
-      char_array_3[0] =
-          (char_array_4[0] << 2) + ((char_array_4[1] & 0x30) >> 4);
-      char_array_3[1] =
-          ((char_array_4[1] & 0xf) << 4) + ((char_array_4[2] & 0x3c) >> 2);
-      char_array_3[2] = ((char_array_4[2] & 0x3) << 6) + char_array_4[3];
+  for (; i + 4 <= len; i += 4, o += 3) {
+    const unsigned int a = kBase64Values[s[i]];
+    const unsigned int b = kBase64Values[s[i + 1]];
+    const unsigned int c = kBase64Values[s[i + 2]];
+    const unsigned int d = kBase64Values[s[i + 3]];
+    if ((a | b | c | d) & 0x80) {
+      break;
+    }
+    const unsigned int v = a << 18 | b << 12 | c << 6 | d;
+    dst[o] = (unsigned char)(v >> 16);
+    dst[o + 1] = (unsigned char)(v >> 8);
+    dst[o + 2] = (unsigned char)v;
+  }
 
-      for (i = 0; (i < 3); i++) ret += char_array_3[i];
-      i = 0;
+  // Last group, or the one holding the terminating character.
+  unsigned int v = 0;
+  size_t n = 0;
+  for (; i < len && n < 4; i++, n++) {
+    const unsigned int value = kBase64Values[s[i]];
+    if (value & 0x80) {
+      break;
     }
+    v |= value << (18 - 6 * n);
   }
 
-  if (i) {
-    for (j = i; j < 4; j++) char_array_4[j] = 0;
+  if (n > 1) {
+    dst[o++] = (unsigned char)(v >> 16);
+  }
+  if (n > 2) {
+    dst[o++] = (unsigned char)(v >> 8);
+  }
+  if (n > 3) {
+    dst[o++] = (unsigned char)v;
+  }
 
-    for (j = 0; j < 4; j++)
-      char_array_4[j] =
-          static_cast<unsigned char>(base64_chars.find(char_array_4[j]));
+  return o;
+}
 
-    char_array_3[0] = (char_array_4[0] << 2) + ((char_array_4[1] & 0x30) >> 4);
-    char_array_3[1] =
-        ((char_array_4[1] & 0xf) << 4) + ((char_array_4[2] & 0x3c) >> 2);
-    char_array_3[2] = ((char_array_4[2] & 0x3) << 6) + char_array_4[3];
+}  // namespace
 
-    for (j = 0; (j < i - 1); j++) ret += char_array_3[j];
+std::string base64_encode(unsigned char const *bytes_to_encode,
+                          unsigned int in_len) {
+  std::string ret(Base64EncodedSize(in_len), '\0');
+  if (in_len) {
+    Base64Encode(bytes_to_encode, in_len, &ret[0]);
   }
+  return ret;
+}
 
+std::string base64_decode(std::string const &encoded_string) {
+  std::string ret(Base64DecodedCapacity(encoded_string.size()), '\0');
+  ret.resize(Base64Decode(encoded_string.data(), encoded_string.size(),
+                          reinterpret_cast<unsigned char *>(&ret[0])));
   return ret;
 }
+
+void base64_decode(const char *encoded, size_t len,
+                   std::vector<unsigned char> *out) {
+  out->resize(Base64DecodedCapacity(len));
+  out->resize(Base64Decode(encoded, len, out->data()));
+}
 #ifdef __clang__
 #pragma clang diagnostic pop
 #endif
 
+namespace {
+
+struct DataURIHeader {
+  const char *header;
+  size_t size;
+  const char *mime_type;  // nullptr leaves the caller's mime type alone
+};
+
+const DataURIHeader kDataURIHeaders[] = {
+    {"data:application/octet-stream;base64,", 37, nullptr},
+    {"data:image/jpeg;base64,", 23, "image/jpeg"},
+    {"data:image/png;base64,", 22, "image/png"},
+    {"data:image/bmp;base64,", 22, "image/bmp"},
+    {"data:image/gif;base64,", 22, "image/gif"},
+    {"data:text/plain;base64,", 23, "text/plain"},
+    {"data:application/gltf-buffer;base64,", 36, nullptr}};
+
+// Only looks at the start of `in`, data URIs can be megabytes long.
+const DataURIHeader *FindDataURIHeader(const std::string &in) {
+  for (const DataURIHeader &header : kDataURIHeaders) {
+    if (in.compare(0, header.size, header.header) == 0) {
+      return &header;
+    }
+  }
+  return nullptr;
+}
+
+// `header` followed by the base64 encoded `bytes`, built in one allocation.
+std::string EncodeDataURI(const std::string &header,
+                          const unsigned char *bytes, size_t len) {
+  std::string uri(header.size() + Base64EncodedSize(len), '\0');
+  std::copy(header.begin(), header.end(), uri.begin());
+  if (len) {
+    Base64Encode(bytes, len, &uri[header.size()]);
+  }
+  return uri;
+}
+
+}  // namespace
+
 // https://github.com/syoyo/tinygltf/issues/228
 // TODO(syoyo): Use uriparser https://uriparser.github.io/ for stricter Uri
 // decoding?
@@ -2324,795 +3019,2166 @@ static bool LoadExternalFile(std::vector<unsigned char> *out, std::string *err,
   return true;
 }
 
-void TinyGLTF::SetImageLoader(LoadImageDataFunction func, void *user_data) {
-  LoadImageData = func;
-  load_image_user_data_ = user_data;
-  user_image_loader_ = true;
-}
-
-void TinyGLTF::RemoveImageLoader() {
-  LoadImageData =
-#ifndef TINYGLTF_NO_STB_IMAGE
-      &tinygltf::LoadImageData;
-#else
-      nullptr;
-#endif
+#ifndef TINYGLTF_NO_THREADS
+namespace {
 
-  load_image_user_data_ = nullptr;
-  user_image_loader_ = false;
-}
+// Reads the external files of a glTF on worker threads or through
+// AsyncFsCallbacks while it is parsed. Every uri is resolved up front, then
+// GetCallbacks() forwards to the user's FsCallbacks except for
+// ReadWholeFile, which hands out a prefetched file, waits for one that is
+// being read, or reads one nobody started yet itself. The parser consumes
+// files in document order while later ones are in flight, and image decoding
+// in LoadImageData callbacks overlaps the reads. At most `read_ahead` files
+// are in flight or waiting to be taken, further ones are started as the
+// parser takes them. The user's ReadWholeFile must be thread safe when worker
+// threads are used.
+class ExternalFilePrefetch {
+ public:
+  ExternalFilePrefetch(const FsCallbacks &fs, const AsyncFsCallbacks &async_fs)
+      : fs_(fs), async_fs_(async_fs) {
+    callbacks_.FileExists = &FileExistsCallback;
+    callbacks_.ExpandFilePath = &ExpandFilePathCallback;
+    callbacks_.ReadWholeFile = &ReadWholeFileCallback;
+    callbacks_.WriteWholeFile = &WriteWholeFileCallback;
+    callbacks_.user_data = this;
+  }
 
-#ifndef TINYGLTF_NO_STB_IMAGE
-bool LoadImageData(Image *image, const int image_idx, std::string *err,
-                   std::string *warn, int req_width, int req_height,
-                   const unsigned char *bytes, int size, void *user_data) {
-  (void)warn;
+  ~ExternalFilePrefetch() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      cancel_ = true;
+    }
+    window_.notify_all();
+    for (std::thread &thread : threads_) {
+      thread.join();
+    }
 
-  LoadImageDataOption option;
-  if (user_data) {
-    option = *reinterpret_cast<LoadImageDataOption *>(user_data);
+    // Submitted reads the parser never got to, e.g. after an error.
+    for (File &file : files_) {
+      if (file.state == kSubmitted) {
+        std::vector<unsigned char> data;
+        async_fs_.CompleteRead(&data, nullptr, file.ticket,
+                               async_fs_.user_data);
+      }
+    }
   }
 
-  int w = 0, h = 0, comp = 0, req_comp = 0;
+  ExternalFilePrefetch(const ExternalFilePrefetch &) = delete;
+  ExternalFilePrefetch &operator=(const ExternalFilePrefetch &) = delete;
 
-  unsigned char *data = nullptr;
+  // `uri` as written in the glTF. Data URIs and missing files are skipped,
+  // LoadExternalFile reports those.
+  void Add(const std::string &uri, const std::string &basedir) {
+    if (uri.empty() || IsDataURI(uri)) {
+      return;
+    }
 
-  // preserve_channels true: Use channels stored in the image file.
-  // false: force 32-bit textures for common Vulkan compatibility. It appears
-  // that some GPU drivers do not support 24-bit images for Vulkan
-  req_comp = option.preserve_channels ? 0 : 4;
-  int bits = 8;
-  int pixel_type = TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE;
+    std::vector<std::string> paths;
+    paths.push_back(basedir);
+    paths.push_back(".");
 
-  // It is possible that the image we want to load is a 16bit per channel image
-  // We are going to attempt to load it as 16bit per channel, and if it worked,
-  // set the image data accodingly. We are casting the returned pointer into
-  // unsigned char, because we are representing "bytes". But we are updating
-  // the Image metadata to signal that this image uses 2 bytes (16bits) per
-  // channel:
-  if (stbi_is_16_bit_from_memory(bytes, size)) {
-    data = reinterpret_cast<unsigned char *>(
-        stbi_load_16_from_memory(bytes, size, &w, &h, &comp, req_comp));
-    if (data) {
-      bits = 16;
-      pixel_type = TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT;
+    std::string filepath = FindFile(paths, dlib::urldecode(uri), &fs_);
+    if (filepath.empty() || index_.count(filepath)) {
+      return;
     }
+
+    index_[filepath] = files_.size();
+    files_.push_back(File());
+    files_.back().path = filepath;
   }
 
-  // at this point, if data is still NULL, it means that the image wasn't
-  // 16bit per channel, we are going to load it as a normal 8bit per channel
-  // mage as we used to do:
-  // if image cannot be decoded, ignore parsing and keep it by its path
-  // don't break in this case
-  // FIXME we should only enter this function if the image is embedded. If
-  // image->uri references
-  // an image file, it should be left as it is. Image loading should not be
-  // mandatory (to support other formats)
-  if (!data) data = stbi_load_from_memory(bytes, size, &w, &h, &comp, req_comp);
-  if (!data) {
-    // NOTE: you can use `warn` instead of `err`
-    if (err) {
-      (*err) +=
-          "Unknown image format. STB cannot decode image data for image[" +
-          std::to_string(image_idx) + "] name = \"" + image->name + "\".\n";
+  void Start(unsigned int num_threads, unsigned int read_ahead) {
+    read_ahead_ = std::max(size_t(read_ahead), size_t(1));
+    Submit();
+
+    // Workers read whatever could not be submitted.
+    num_threads = static_cast<unsigned int>(
+        std::min(size_t(num_threads), std::min(files_.size(), read_ahead_)));
+    for (unsigned int i = 0; i < num_threads; i++) {
+      threads_.emplace_back([this] { Worker(); });
     }
-    return false;
   }
 
-  if ((w < 1) || (h < 1)) {
-    stbi_image_free(data);
-    if (err) {
-      (*err) += "Invalid image data for image[" + std::to_string(image_idx) +
-                "] name = \"" + image->name + "\"\n";
+  FsCallbacks *GetCallbacks() { return &callbacks_; }
+
+ private:
+  enum FileState { kPending, kSubmitted, kReading, kRead, kTaken };
+
+  struct File {
+    std::string path;
+    std::vector<unsigned char> data;
+    std::string err;
+    bool ok = false;
+    uint64_t ticket = 0;
+    FileState state = kPending;
+    bool submit_failed = false;
+  };
+
+  // Submits pending files in document order while the window has room. Only
+  // called by the parser thread, which is also the only one completing them.
+  void Submit() {
+    if (async_fs_.SubmitRead == nullptr || async_fs_.CompleteRead == nullptr) {
+      return;
+    }
+
+    for (;;) {
+      File *file = nullptr;
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        while (next_submit_ < files_.size() &&
+               (files_[next_submit_].state != kPending ||
+                files_[next_submit_].submit_failed)) {
+          next_submit_++;
+        }
+        if (next_submit_ == files_.size() || outstanding_ >= read_ahead_) {
+          return;
+        }
+        file = &files_[next_submit_++];
+        file->state = kSubmitted;
+        outstanding_++;
+      }
+
+      if (!async_fs_.SubmitRead(&file->ticket, nullptr, file->path,
+                                async_fs_.user_data)) {
+        {
+          std::lock_guard<std::mutex> lock(mutex_);
+          file->state = kPending;
+          file->submit_failed = true;
+          outstanding_--;
+        }
+        window_.notify_all();
+      }
     }
-    return false;
   }
 
-  if (req_width > 0) {
-    if (req_width != w) {
-      stbi_image_free(data);
-      if (err) {
-        (*err) += "Image width mismatch for image[" +
-                  std::to_string(image_idx) + "] name = \"" + image->name +
-                  "\"\n";
+  void Worker() {
+    for (;;) {
+      File *file = nullptr;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (;;) {
+          while (next_ < files_.size() && files_[next_].state != kPending) {
+            next_++;
+          }
+          if (cancel_ || next_ == files_.size()) {
+            return;
+          }
+          if (outstanding_ < read_ahead_) {
+            break;
+          }
+          window_.wait(lock);
+        }
+        file = &files_[next_++];
+        file->state = kReading;
+        outstanding_++;
       }
-      return false;
+
+      std::vector<unsigned char> data;
+      std::string err;
+      bool ok = fs_.ReadWholeFile(&data, &err, file->path, fs_.user_data);
+
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        file->data.swap(data);
+        file->err.swap(err);
+        file->ok = ok;
+        file->state = kRead;
+      }
+      read_.notify_all();
     }
   }
 
-  if (req_height > 0) {
-    if (req_height != h) {
-      stbi_image_free(data);
+  bool Read(std::vector<unsigned char> *out, std::string *err,
+            const std::string &filepath) {
+    std::map<std::string, size_t>::const_iterator it = index_.find(filepath);
+    if (it == index_.end()) {
+      return fs_.ReadWholeFile(out, err, filepath, fs_.user_data);
+    }
+
+    File &file = files_[it->second];
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    if (file.state == kPending || file.state == kTaken) {
+      // Nobody got to it yet, or it is read a second time.
+      file.state = kTaken;
+      lock.unlock();
+      return fs_.ReadWholeFile(out, err, filepath, fs_.user_data);
+    }
+
+    bool ok;
+    if (file.state == kSubmitted) {
+      file.state = kTaken;
+      lock.unlock();
+      ok = async_fs_.CompleteRead(out, err, file.ticket, async_fs_.user_data);
+      lock.lock();
+    } else {
+      read_.wait(lock, [&file] { return file.state == kRead; });
+      file.state = kTaken;
+      out->swap(file.data);
       if (err) {
-        (*err) += "Image height mismatch. for image[" +
-                  std::to_string(image_idx) + "] name = \"" + image->name +
-                  "\"\n";
+        (*err) += file.err;
       }
-      return false;
+      ok = file.ok;
     }
+
+    // The file left the window, start the next ones.
+    outstanding_--;
+    lock.unlock();
+    window_.notify_all();
+    Submit();
+    return ok;
   }
 
-  if (req_comp != 0) {
-    // loaded data has `req_comp` channels(components)
-    comp = req_comp;
+  static bool FileExistsCallback(const std::string &abs_filename,
+                                 void *user_data) {
+    ExternalFilePrefetch *self = static_cast<ExternalFilePrefetch *>(user_data);
+    return self->fs_.FileExists(abs_filename, self->fs_.user_data);
   }
 
-  image->width = w;
-  image->height = h;
-  image->component = comp;
-  image->bits = bits;
-  image->pixel_type = pixel_type;
-  image->image.resize(static_cast<size_t>(w * h * comp) * size_t(bits / 8));
-  std::copy(data, data + w * h * comp * (bits / 8), image->image.begin());
-  stbi_image_free(data);
+  static std::string ExpandFilePathCallback(const std::string &filepath,
+                                            void *user_data) {
+    ExternalFilePrefetch *self = static_cast<ExternalFilePrefetch *>(user_data);
+    return self->fs_.ExpandFilePath(filepath, self->fs_.user_data);
+  }
 
-  return true;
-}
-#endif
+  static bool ReadWholeFileCallback(std::vector<unsigned char> *out,
+                                    std::string *err,
+                                    const std::string &filepath,
+                                    void *user_data) {
+    return static_cast<ExternalFilePrefetch *>(user_data)->Read(out, err,
+                                                                filepath);
+  }
 
-void TinyGLTF::SetImageWriter(WriteImageDataFunction func, void *user_data) {
-  WriteImageData = func;
-  write_image_user_data_ = user_data;
-}
+  static bool WriteWholeFileCallback(std::string *err,
+                                     const std::string &filepath,
+                                     const std::vector<unsigned char> &contents,
+                                     void *user_data) {
+    ExternalFilePrefetch *self = static_cast<ExternalFilePrefetch *>(user_data);
+    return self->fs_.WriteWholeFile(err, filepath, contents,
+                                    self->fs_.user_data);
+  }
 
-#ifndef TINYGLTF_NO_STB_IMAGE_WRITE
-static void WriteToMemory_stbi(void *context, void *data, int size) {
-  std::vector<unsigned char> *buffer =
-      reinterpret_cast<std::vector<unsigned char> *>(context);
+  FsCallbacks fs_;
+  AsyncFsCallbacks async_fs_;
+  FsCallbacks callbacks_;
 
-  unsigned char *pData = reinterpret_cast<unsigned char *>(data);
+  // Not resized once the workers run.
+  std::vector<File> files_;
+  std::map<std::string, size_t> index_;
 
-  buffer->insert(buffer->end(), pData, pData + size);
-}
+  std::vector<std::thread> threads_;
+  std::mutex mutex_;
+  std::condition_variable read_;
+  std::condition_variable window_;
+  size_t next_ = 0;         // next file for the workers
+  size_t next_submit_ = 0;  // next file to submit
+  size_t outstanding_ = 0;  // submitted, reading or read but not taken
+  size_t read_ahead_ = 1;
+  bool cancel_ = false;
+};
 
-bool WriteImageData(const std::string *basepath, const std::string *filename,
-                    Image *image, bool embedImages, void *fsPtr) {
-  const std::string ext = GetFilePathExtension(*filename);
+}  // namespace
+#endif
 
-  // Write image to temporary buffer
-  std::string header;
-  std::vector<unsigned char> data;
+#ifdef TINYGLTF_USE_IO_URING
+struct IoUringFileReader::Ring {
+  // Alignment of O_DIRECT offsets, lengths and buffers. The logical block
+  // size of the device is at most this on anything current.
+  static const size_t kDirectAlignment = 4096;
+
+  struct Request {
+    int fd = -1;
+    bool direct = false;
+    size_t size = 0;   // file size
+    size_t done = 0;   // bytes read so far
+    bool complete = false;
+    int error = 0;     // errno of a failed read
+    std::vector<unsigned char> data;
+    unsigned char *aligned = nullptr;  // O_DIRECT staging buffer
+  };
 
-  if (ext == "png") {
-    if ((image->bits != 8) ||
-        (image->pixel_type != TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE)) {
-      // Unsupported pixel format
-      return false;
+  int fd = -1;
+  bool direct = false;
+  unsigned int entries = 0;
+  unsigned int in_flight = 0;
+
+  void *sq_ring = MAP_FAILED;
+  size_t sq_ring_size = 0;
+  void *cq_ring = MAP_FAILED;
+  size_t cq_ring_size = 0;
+  io_uring_sqe *sqes = static_cast<io_uring_sqe *>(MAP_FAILED);
+  size_t sqes_size = 0;
+
+  unsigned *sq_tail = nullptr;
+  unsigned *sq_mask = nullptr;
+  unsigned *sq_array = nullptr;
+  unsigned *cq_head = nullptr;
+  unsigned *cq_tail = nullptr;
+  unsigned *cq_mask = nullptr;
+  io_uring_cqe *cqes = nullptr;
+
+  uint64_t next_ticket = 1;
+  std::map<uint64_t, Request> requests;
+
+  Ring(unsigned int queue_depth, bool use_direct) : direct(use_direct) {
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    fd = static_cast<int>(syscall(__NR_io_uring_setup, queue_depth, &params));
+    if (fd < 0) {
+      return;
+    }
+
+    entries = params.sq_entries;
+    sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_ring_size =
+        params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+      sq_ring_size = cq_ring_size = std::max(sq_ring_size, cq_ring_size);
+    }
+
+    sq_ring = mmap(nullptr, sq_ring_size, PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+      cq_ring = sq_ring;
+    } else if (sq_ring != MAP_FAILED) {
+      cq_ring = mmap(nullptr, cq_ring_size, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+    }
+    sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+    if (cq_ring != MAP_FAILED) {
+      sqes = static_cast<io_uring_sqe *>(
+          mmap(nullptr, sqes_size, PROT_READ | PROT_WRITE,
+               MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES));
+    }
+    if (sqes == MAP_FAILED) {
+      Close();
+      return;
+    }
+
+    unsigned char *sq = static_cast<unsigned char *>(sq_ring);
+    unsigned char *cq = static_cast<unsigned char *>(cq_ring);
+    sq_tail = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+    sq_mask = reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+    sq_array = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+    cq_head = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+    cq_tail = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+    cq_mask = reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+    cqes = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+  }
+
+  ~Ring() {
+    // Wait for reads in flight, the kernel still writes into their buffers.
+    while (in_flight > 0 && Reap(true)) {
+    }
+    for (std::map<uint64_t, Request>::iterator it = requests.begin();
+         it != requests.end(); ++it) {
+      Release(&it->second);
+    }
+    Close();
+  }
+
+  void Close() {
+    if (sqes != MAP_FAILED) munmap(sqes, sqes_size);
+    if (cq_ring != MAP_FAILED && cq_ring != sq_ring) {
+      munmap(cq_ring, cq_ring_size);
+    }
+    if (sq_ring != MAP_FAILED) munmap(sq_ring, sq_ring_size);
+    if (fd >= 0) close(fd);
+    sqes = static_cast<io_uring_sqe *>(MAP_FAILED);
+    cq_ring = sq_ring = MAP_FAILED;
+    fd = -1;
+  }
+
+  static void Release(Request *request) {
+    if (request->fd >= 0) close(request->fd);
+    free(request->aligned);
+    request->fd = -1;
+    request->aligned = nullptr;
+  }
+
+  // Queues a read of the rest of the file, one request reads it all unless
+  // the kernel returns short.
+  bool SubmitRemaining(uint64_t ticket, Request *request) {
+    while (in_flight == entries) {
+      if (!Reap(true)) {
+        return false;
+      }
     }
 
-    if (!stbi_write_png_to_func(WriteToMemory_stbi, &data, image->width,
-                                image->height, image->component,
-                                &image->image[0], 0)) {
+    size_t length = request->size - request->done;
+    unsigned char *dst = request->data.data() + request->done;
+    if (request->direct) {
+      length = (length + kDirectAlignment - 1) & ~(kDirectAlignment - 1);
+      dst = request->aligned + request->done;
+    }
+    // A single read transfers at most 2 GB.
+    length = std::min(length, static_cast<size_t>(0x7ffff000));
+
+    unsigned tail = *sq_tail;
+    unsigned index = tail & *sq_mask;
+    io_uring_sqe *sqe = &sqes[index];
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = request->fd;
+    sqe->addr = reinterpret_cast<uint64_t>(dst);
+    sqe->len = static_cast<uint32_t>(length);
+    sqe->off = request->done;
+    sqe->user_data = ticket;
+    sq_array[index] = index;
+    __atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+    int ret;
+    do {
+      ret = static_cast<int>(
+          syscall(__NR_io_uring_enter, fd, 1, 0, 0, nullptr, 0));
+    } while (ret < 0 && errno == EINTR);
+    if (ret < 1) {
+      // The entry was not consumed, take it back.
+      __atomic_store_n(sq_tail, tail, __ATOMIC_RELEASE);
       return false;
     }
-    header = "data:image/png;base64,";
-  } else if (ext == "jpg") {
-    if (!stbi_write_jpg_to_func(WriteToMemory_stbi, &data, image->width,
-                                image->height, image->component,
-                                &image->image[0], 100)) {
-      return false;
+
+    in_flight++;
+    return true;
+  }
+
+  // Processes the completions that are there, waits for one with `wait`.
+  // False when waiting failed.
+  bool Reap(bool wait) {
+    unsigned head = *cq_head;
+    if (wait && head == __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE)) {
+      int ret;
+      do {
+        ret = static_cast<int>(syscall(__NR_io_uring_enter, fd, 0, 1,
+                                       IORING_ENTER_GETEVENTS, nullptr, 0));
+      } while (ret < 0 && errno == EINTR);
+      if (ret < 0) {
+        return false;
+      }
     }
-    header = "data:image/jpeg;base64,";
-  } else if (ext == "bmp") {
-    if (!stbi_write_bmp_to_func(WriteToMemory_stbi, &data, image->width,
-                                image->height, image->component,
-                                &image->image[0])) {
-      return false;
+
+    unsigned tail = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+    for (; head != tail; head++) {
+      const io_uring_cqe &cqe = cqes[head & *cq_mask];
+      in_flight--;
+
+      std::map<uint64_t, Request>::iterator it = requests.find(cqe.user_data);
+      if (it != requests.end()) {
+        OnRead(it->first, &it->second, cqe.res);
+      }
     }
-    header = "data:image/bmp;base64,";
-  } else if (!embedImages) {
-    // Error: can't output requested format to file
-    return false;
+    __atomic_store_n(cq_head, head, __ATOMIC_RELEASE);
+    return true;
   }
 
-  if (embedImages) {
-    // Embed base64-encoded image into URI
-    if (data.size()) {
-      image->uri =
-          header +
-          base64_encode(&data[0], static_cast<unsigned int>(data.size()));
-    } else {
-      // Throw error?
+  void OnRead(uint64_t ticket, Request *request, int res) {
+    if (res < 0) {
+      request->error = -res;
+      request->complete = true;
+      return;
     }
-  } else {
-    // Write image to disc
-    FsCallbacks *fs = reinterpret_cast<FsCallbacks *>(fsPtr);
-    if ((fs != nullptr) && (fs->WriteWholeFile != nullptr)) {
-      const std::string imagefilepath = JoinPath(*basepath, *filename);
-      std::string writeError;
-      if (!fs->WriteWholeFile(&writeError, imagefilepath, data,
-                              fs->user_data)) {
-        // Could not write image file to disc; Throw error ?
-        return false;
-      }
-    } else {
-      // Throw error?
+
+    request->done += static_cast<size_t>(res);
+    if (res == 0 || request->done >= request->size) {
+      // Done, or the file got shorter since it was opened.
+      request->size = std::min(request->size, request->done);
+      request->complete = true;
+      return;
+    }
+
+    if (request->direct && (request->done % kDirectAlignment) != 0) {
+      // Short O_DIRECT reads can only continue at aligned offsets.
+      request->error = EIO;
+      request->complete = true;
+      return;
+    }
+
+    if (!SubmitRemaining(ticket, request)) {
+      request->error = EIO;
+      request->complete = true;
     }
-    image->uri = *filename;
   }
 
-  return true;
-}
-#endif
+  bool Submit(uint64_t *ticket, std::string *err, const std::string &path) {
+    if (fd < 0) {
+      return false;
+    }
 
-void TinyGLTF::SetFsCallbacks(FsCallbacks callbacks) { fs = callbacks; }
+    Request request;
+    if (direct) {
+      request.fd = open(path.c_str(), O_RDONLY | O_CLOEXEC | O_DIRECT);
+      request.direct = request.fd >= 0;
+    }
+    if (request.fd < 0) {
+      request.fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    }
 
-#ifdef _WIN32
-static inline std::wstring UTF8ToWchar(const std::string &str) {
-  int wstr_size =
-      MultiByteToWideChar(CP_UTF8, 0, str.data(), (int)str.size(), nullptr, 0);
-  std::wstring wstr(wstr_size, 0);
-  MultiByteToWideChar(CP_UTF8, 0, str.data(), (int)str.size(), &wstr[0],
-                      (int)wstr.size());
-  return wstr;
-}
+    struct stat st;
+    if (request.fd < 0 || fstat(request.fd, &st) != 0) {
+      if (err) {
+        (*err) += "File open error : " + path + " : " + strerror(errno) + "\n";
+      }
+      Release(&request);
+      return false;
+    }
 
-static inline std::string WcharToUTF8(const std::wstring &wstr) {
-  int str_size = WideCharToMultiByte(CP_UTF8, 0, wstr.data(), (int)wstr.size(),
-                                     nullptr, 0, NULL, NULL);
-  std::string str(str_size, 0);
-  WideCharToMultiByte(CP_UTF8, 0, wstr.data(), (int)wstr.size(), &str[0],
-                      (int)str.size(), NULL, NULL);
-  return str;
-}
-#endif
+    request.size = static_cast<size_t>(st.st_size);
+    if (request.direct) {
+      size_t capacity = (request.size + kDirectAlignment - 1) &
+                        ~(kDirectAlignment - 1);
+      void *aligned = nullptr;
+      if (capacity == 0 ||
+          posix_memalign(&aligned, kDirectAlignment, capacity) != 0) {
+        aligned = nullptr;
+      }
+      request.aligned = static_cast<unsigned char *>(aligned);
+    } else {
+      request.data.resize(request.size);
+    }
 
-#ifndef TINYGLTF_NO_FS
-// Default implementations of filesystem functions
+    uint64_t id = next_ticket++;
+    Request &queued = requests[id];
+    queued = std::move(request);
 
-bool FileExists(const std::string &abs_filename, void *) {
-  bool ret;
-#ifdef TINYGLTF_ANDROID_LOAD_FROM_ASSETS
-  if (asset_manager) {
-    AAsset *asset = AAssetManager_open(asset_manager, abs_filename.c_str(),
-                                       AASSET_MODE_STREAMING);
-    if (!asset) {
+    if (queued.size == 0) {
+      // Nothing to read, LoadExternalFile reports empty files.
+      queued.complete = true;
+    } else if ((queued.direct && queued.aligned == nullptr) ||
+               !SubmitRemaining(id, &queued)) {
+      Release(&queued);
+      requests.erase(id);
       return false;
     }
-    AAsset_close(asset);
-    ret = true;
-  } else {
-    return false;
+
+    *ticket = id;
+    return true;
   }
-#else
-#ifdef _WIN32
-#if defined(_MSC_VER) || defined(__GLIBCXX__)
-  FILE *fp = nullptr;
-  errno_t err = _wfopen_s(&fp, UTF8ToWchar(abs_filename).c_str(), L"rb");
-  if (err != 0) {
-    return false;
+
+  bool Complete(std::vector<unsigned char> *out, std::string *err,
+                uint64_t ticket) {
+    std::map<uint64_t, Request>::iterator it = requests.find(ticket);
+    if (it == requests.end()) {
+      return false;
+    }
+
+    Request &request = it->second;
+    while (!request.complete) {
+      if (!Reap(true)) {
+        request.error = errno;
+        break;
+      }
+    }
+
+    bool ok = request.error == 0;
+    if (!ok) {
+      if (err) {
+        (*err) += strerror(request.error);
+      }
+    } else if (request.direct) {
+      out->assign(request.aligned, request.aligned + request.size);
+    } else {
+      request.data.resize(request.size);
+      out->swap(request.data);
+    }
+
+    Release(&request);
+    requests.erase(it);
+    return ok;
   }
-#else
-  FILE *fp = nullptr;
-  errno_t err = fopen_s(&fp, abs_filename.c_str(), "rb");
-  if (err != 0) {
-    return false;
+
+  static bool SubmitRead(uint64_t *ticket, std::string *err,
+                         const std::string &filepath, void *user_data) {
+    return static_cast<Ring *>(user_data)->Submit(ticket, err, filepath);
   }
-#endif
 
-#else
-  FILE *fp = fopen(abs_filename.c_str(), "rb");
-#endif
-  if (fp) {
-    ret = true;
-    fclose(fp);
-  } else {
-    ret = false;
+  static bool CompleteRead(std::vector<unsigned char> *out, std::string *err,
+                           uint64_t ticket, void *user_data) {
+    return static_cast<Ring *>(user_data)->Complete(out, err, ticket);
   }
-#endif
+};
 
-  return ret;
-}
+IoUringFileReader::IoUringFileReader(unsigned int queue_depth, bool direct)
+    : ring_(new Ring(queue_depth, direct)) {}
 
-std::string ExpandFilePath(const std::string &filepath, void *) {
-#ifdef _WIN32
-  // Assume input `filepath` is encoded in UTF-8
-  std::wstring wfilepath = UTF8ToWchar(filepath);
-  DWORD wlen = ExpandEnvironmentStringsW(wfilepath.c_str(), nullptr, 0);
-  wchar_t *wstr = new wchar_t[wlen];
-  ExpandEnvironmentStringsW(wfilepath.c_str(), wstr, wlen);
+IoUringFileReader::~IoUringFileReader() { delete ring_; }
 
-  std::wstring ws(wstr);
-  delete[] wstr;
-  return WcharToUTF8(ws);
+bool IoUringFileReader::IsValid() const { return ring_->fd >= 0; }
 
-#else
-
-#if defined(TARGET_OS_IPHONE) || defined(TARGET_IPHONE_SIMULATOR) || \
-    defined(__ANDROID__) || defined(__EMSCRIPTEN__) || defined(__OpenBSD__)
-  // no expansion
-  std::string s = filepath;
-#else
-  std::string s;
-  wordexp_t p;
-
-  if (filepath.empty()) {
-    return "";
-  }
-
-  // Quote the string to keep any spaces in filepath intact.
-  std::string quoted_path = "\"" + filepath + "\"";
-  // char** w;
-  int ret = wordexp(quoted_path.c_str(), &p, 0);
-  if (ret) {
-    // err
-    s = filepath;
-    return s;
-  }
+AsyncFsCallbacks IoUringFileReader::GetCallbacks() {
+  AsyncFsCallbacks callbacks = {&Ring::SubmitRead, &Ring::CompleteRead, ring_};
+  return callbacks;
+}
+#endif
 
-  // Use first element only.
-  if (p.we_wordv) {
-    s = std::string(p.we_wordv[0]);
-    wordfree(&p);
-  } else {
-    s = filepath;
-  }
+void TinyGLTF::SetImageLoader(LoadImageDataFunction func, void *user_data) {
+  LoadImageData = func;
+  load_image_user_data_ = user_data;
+  user_image_loader_ = true;
+}
 
+void TinyGLTF::RemoveImageLoader() {
+  LoadImageData =
+#ifndef TINYGLTF_NO_STB_IMAGE
+      &tinygltf::LoadImageData;
+#else
+      nullptr;
 #endif
 
-  return s;
-#endif
+  load_image_user_data_ = nullptr;
+  user_image_loader_ = false;
 }
 
-bool ReadWholeFile(std::vector<unsigned char> *out, std::string *err,
-                   const std::string &filepath, void *) {
-#ifdef TINYGLTF_ANDROID_LOAD_FROM_ASSETS
-  if (asset_manager) {
-    AAsset *asset = AAssetManager_open(asset_manager, filepath.c_str(),
-                                       AASSET_MODE_STREAMING);
-    if (!asset) {
-      if (err) {
-        (*err) += "File open error : " + filepath + "\n";
-      }
+#ifdef TINYGLTF_FAST_PNG
+namespace {
+
+// Inflate (RFC 1951) of the zlib stream of a PNG into a preallocated buffer.
+// Decoding reads 64 bits at a time and resolves one or two literals or a
+// whole length code with a single table lookup, codes longer than the table
+// fall back to a canonical decode. The input must be followed by
+// kInflatePadding readable bytes.
+
+const size_t kInflatePadding = 32;
+
+const unsigned short kInflateLengthBase[29] = {
+    3,  4,  5,  6,  7,  8,  9,  10, 11,  13,  15,  17,  19,  23, 27,
+    31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+const unsigned char kInflateLengthExtra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1,
+                                               1, 1, 2, 2, 2, 2, 3, 3, 3, 3,
+                                               4, 4, 4, 4, 5, 5, 5, 5, 0};
+const unsigned short kInflateDistBase[30] = {
+    1,    2,    3,    4,    5,    7,     9,     13,    17,   25,
+    33,   49,   65,   97,   129,  193,   257,   385,   513,  769,
+    1025, 1537, 2049, 3073, 4097, 6145,  8193,  12289, 16385, 24577};
+const unsigned char kInflateDistExtra[30] = {
+    0, 0, 0, 0, 1, 1, 2, 2,   3,  3,  4,  4,  5,  5,  6,
+    6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+class Inflater {
+ public:
+  Inflater(const unsigned char *in, size_t in_size, unsigned char *out,
+           size_t out_size)
+      : in_(in),
+        in_end_(in + in_size),
+        out_begin_(out),
+        out_(out),
+        out_end_(out + out_size) {}
+
+  // Decodes the zlib stream, false when it is invalid or does not fit.
+  // Returns the number of bytes written in `out_size`.
+  bool Run(size_t *out_size) {
+    if (in_end_ - in_ < 2) {
       return false;
     }
-    size_t size = AAsset_getLength(asset);
-    if (size == 0) {
-      if (err) {
-        (*err) += "Invalid file size : " + filepath +
-                  " (does the path point to a directory?)";
-      }
+    const unsigned cmf = in_[0];
+    const unsigned flg = in_[1];
+    if ((cmf & 15) != 8 || ((cmf << 8) | flg) % 31 != 0 || (flg & 32)) {
       return false;
     }
-    out->resize(size);
-    AAsset_read(asset, reinterpret_cast<char *>(&out->at(0)), size);
-    AAsset_close(asset);
-    return true;
-  } else {
-    if (err) {
-      (*err) += "No asset manager specified : " + filepath + "\n";
-    }
-    return false;
-  }
-#else
-#ifdef _WIN32
-#if defined(__GLIBCXX__)  // mingw
-  int file_descriptor =
-      _wopen(UTF8ToWchar(filepath).c_str(), _O_RDONLY | _O_BINARY);
-  __gnu_cxx::stdio_filebuf<char> wfile_buf(file_descriptor, std::ios_base::in);
-  std::istream f(&wfile_buf);
-#elif defined(_MSC_VER) || defined(_LIBCPP_VERSION)
-  // For libcxx, assume _LIBCPP_HAS_OPEN_WITH_WCHAR is defined to accept
-  // `wchar_t *`
-  std::ifstream f(UTF8ToWchar(filepath).c_str(), std::ifstream::binary);
-#else
-  // Unknown compiler/runtime
-  std::ifstream f(filepath.c_str(), std::ifstream::binary);
-#endif
-#else
-  std::ifstream f(filepath.c_str(), std::ifstream::binary);
-#endif
-  if (!f) {
-    if (err) {
-      (*err) += "File open error : " + filepath + "\n";
-    }
-    return false;
-  }
+    in_ += 2;
 
-  f.seekg(0, f.end);
-  size_t sz = static_cast<size_t>(f.tellg());
-  f.seekg(0, f.beg);
+    for (;;) {
+      if (in_ > in_end_ + 8) {
+        return false;
+      }
+      Refill();
+      const unsigned final_block = Bits(1);
+      const unsigned type = Bits(2);
 
-  if (int64_t(sz) < 0) {
-    if (err) {
-      (*err) += "Invalid file size : " + filepath +
-                " (does the path point to a directory?)";
-    }
-    return false;
-  } else if (sz == 0) {
-    if (err) {
-      (*err) += "File is empty : " + filepath + "\n";
+      bool ok = false;
+      if (type == 0) {
+        ok = Stored();
+      } else if (type == 1) {
+        ok = BuildFixed() && Codes();
+      } else if (type == 2) {
+        ok = BuildDynamic() && Codes();
+      }
+
+      if (!ok || in_ > in_end_ + 8) {
+        return false;
+      }
+      if (final_block) {
+        break;
+      }
     }
-    return false;
+
+    *out_size = static_cast<size_t>(out_ - out_begin_);
+    return true;
   }
 
-  out->resize(sz);
-  f.read(reinterpret_cast<char *>(&out->at(0)),
-         static_cast<std::streamsize>(sz));
+ private:
+  static const int kLitLenBits = 11;
+  static const int kDistBits = 9;
+  static const int kCodeLenBits = 7;
+
+  // Table entries: bits 0-7 code length, 8-10 kind, 11-15 extra bits,
+  // 16-31 base value, literal(s) or symbol.
+  enum Kind {
+    kLiteral,
+    kLiteral2,
+    kLength,
+    kEnd,
+    kDistance,
+    kSymbol,
+    kSlow,
+    kInvalid
+  };
 
-  return true;
-#endif
-}
+  enum Alphabet { kLitLenAlphabet, kDistAlphabet, kCodeLenAlphabet };
 
-bool WriteWholeFile(std::string *err, const std::string &filepath,
-                    const std::vector<unsigned char> &contents, void *) {
-#ifdef _WIN32
-#if defined(__GLIBCXX__)  // mingw
-  int file_descriptor = _wopen(UTF8ToWchar(filepath).c_str(),
-                               _O_CREAT | _O_WRONLY | _O_TRUNC | _O_BINARY);
-  __gnu_cxx::stdio_filebuf<char> wfile_buf(
-      file_descriptor, std::ios_base::out | std::ios_base::binary);
-  std::ostream f(&wfile_buf);
-#elif defined(_MSC_VER)
-  std::ofstream f(UTF8ToWchar(filepath).c_str(), std::ofstream::binary);
-#else  // clang?
-  std::ofstream f(filepath.c_str(), std::ofstream::binary);
-#endif
-#else
-  std::ofstream f(filepath.c_str(), std::ofstream::binary);
-#endif
-  if (!f) {
-    if (err) {
-      (*err) += "File open error for writing : " + filepath + "\n";
+  struct Huffman {
+    unsigned short counts[16];
+    unsigned short symbols[288];
+    int table_bits;
+    uint32_t table[1 << kLitLenBits];
+  };
+
+  static uint32_t Entry(Alphabet alphabet, unsigned symbol, unsigned length) {
+    if (alphabet == kCodeLenAlphabet) {
+      return length | (kSymbol << 8) | (symbol << 16);
     }
-    return false;
+    if (alphabet == kDistAlphabet) {
+      if (symbol >= 30) {
+        return length | (kInvalid << 8);
+      }
+      return length | (kDistance << 8) |
+             (uint32_t(kInflateDistExtra[symbol]) << 11) |
+             (uint32_t(kInflateDistBase[symbol]) << 16);
+    }
+    if (symbol < 256) {
+      return length | (kLiteral << 8) | (symbol << 16);
+    }
+    if (symbol == 256) {
+      return length | (kEnd << 8);
+    }
+    if (symbol >= 286) {
+      return length | (kInvalid << 8);
+    }
+    return length | (kLength << 8) |
+           (uint32_t(kInflateLengthExtra[symbol - 257]) << 11) |
+           (uint32_t(kInflateLengthBase[symbol - 257]) << 16);
   }
 
-  f.write(reinterpret_cast<const char *>(&contents.at(0)),
-          static_cast<std::streamsize>(contents.size()));
-  if (!f) {
-    if (err) {
-      (*err) += "File write error: " + filepath + "\n";
+  static bool Build(Huffman *h, Alphabet alphabet, const unsigned char *lengths,
+                    unsigned n, int table_bits) {
+    memset(h->counts, 0, sizeof(h->counts));
+    for (unsigned i = 0; i < n; i++) {
+      h->counts[lengths[i]]++;
     }
-    return false;
-  }
+    h->counts[0] = 0;
 
-  return true;
-}
+    int left = 1;
+    for (int len = 1; len < 16; len++) {
+      left = (left << 1) - h->counts[len];
+      if (left < 0) {
+        return false;  // over-subscribed
+      }
+    }
 
-#endif  // TINYGLTF_NO_FS
+    unsigned short offsets[16];
+    offsets[1] = 0;
+    for (int len = 1; len < 15; len++) {
+      offsets[len + 1] = offsets[len] + h->counts[len];
+    }
+    for (unsigned i = 0; i < n; i++) {
+      if (lengths[i]) {
+        h->symbols[offsets[lengths[i]]++] = static_cast<unsigned short>(i);
+      }
+    }
 
-static std::string MimeToExt(const std::string &mimeType) {
-  if (mimeType == "image/jpeg") {
-    return "jpg";
-  } else if (mimeType == "image/png") {
-    return "png";
-  } else if (mimeType == "image/bmp") {
-    return "bmp";
-  } else if (mimeType == "image/gif") {
-    return "gif";
-  }
+    // Incomplete codes are allowed, unused entries stay invalid.
+    const unsigned size = 1u << table_bits;
+    h->table_bits = table_bits;
+    for (unsigned i = 0; i < size; i++) {
+      h->table[i] = kInvalid << 8;
+    }
 
-  return "";
-}
+    unsigned code = 0;
+    unsigned index = 0;
+    for (int len = 1; len < 16; len++, code <<= 1) {
+      for (unsigned k = 0; k < h->counts[len]; k++, code++) {
+        unsigned reversed = 0;
+        for (int b = 0; b < len; b++) {
+          reversed |= ((code >> b) & 1) << (len - 1 - b);
+        }
+        const unsigned symbol = h->symbols[index++];
+        if (len <= table_bits) {
+          const uint32_t entry =
+              Entry(alphabet, symbol, static_cast<unsigned>(len));
+          for (unsigned i = reversed; i < size; i += 1u << len) {
+            h->table[i] = entry;
+          }
+        } else {
+          h->table[reversed & (size - 1)] = kSlow << 8;
+        }
+      }
+    }
 
-static void UpdateImageObject(Image &image, std::string &baseDir, int index,
-                              bool embedImages,
-                              WriteImageDataFunction *WriteImageData = nullptr,
-                              void *user_data = nullptr) {
-  std::string filename;
-  std::string ext;
-  // If image has uri, use it it as a filename
-  if (image.uri.size()) {
-    filename = GetBaseFilename(image.uri);
-    ext = GetFilePathExtension(filename);
-  } else if (image.bufferView != -1) {
-    // If there's no URI and the data exists in a buffer,
-    // don't change properties or write images
-  } else if (image.name.size()) {
-    ext = MimeToExt(image.mimeType);
-    // Otherwise use name as filename
-    filename = image.name + "." + ext;
-  } else {
-    ext = MimeToExt(image.mimeType);
-    // Fallback to index of image as filename
-    filename = std::to_string(index) + "." + ext;
-  }
+    if (alphabet != kLitLenAlphabet) {
+      return true;
+    }
 
-  // If callback is set, modify image data object
-  if (*WriteImageData != nullptr && !filename.empty()) {
-    std::string uri;
-    (*WriteImageData)(&baseDir, &filename, &image, embedImages, user_data);
-  }
-}
+    // Pairs of literals that fit the table together. Entries are only
+    // combined with the single ones, which come first in `single`.
+    uint32_t single[1 << kLitLenBits];
+    memcpy(single, h->table, size * sizeof(uint32_t));
+    for (unsigned i = 0; i < size; i++) {
+      const uint32_t first = single[i];
+      const unsigned first_len = first & 0xff;
+      if (((first >> 8) & 7) != kLiteral || first_len >= unsigned(table_bits)) {
+        continue;
+      }
+      const uint32_t second = single[i >> first_len];
+      const unsigned second_len = second & 0xff;
+      if (((second >> 8) & 7) != kLiteral ||
+          first_len + second_len > unsigned(table_bits)) {
+        continue;
+      }
+      h->table[i] = (first_len + second_len) | (kLiteral2 << 8) |
+                    (first & 0x00ff0000) | ((second & 0x00ff0000) << 8);
+    }
 
-bool IsDataURI(const std::string &in) {
-  std::string header = "data:application/octet-stream;base64,";
-  if (in.find(header) == 0) {
     return true;
   }
 
-  header = "data:image/jpeg;base64,";
-  if (in.find(header) == 0) {
-    return true;
+  void Refill() {
+    uint64_t v;
+    memcpy(&v, in_, sizeof(v));
+    bitbuf_ |= v << bitcount_;
+    in_ += (63 - bitcount_) >> 3;
+    bitcount_ |= 56;
   }
 
-  header = "data:image/png;base64,";
-  if (in.find(header) == 0) {
-    return true;
+  unsigned Bits(unsigned n) {
+    const unsigned v = static_cast<unsigned>(bitbuf_ & ((1ull << n) - 1));
+    Consume(n);
+    return v;
   }
 
-  header = "data:image/bmp;base64,";
-  if (in.find(header) == 0) {
-    return true;
+  void Consume(unsigned n) {
+    bitbuf_ >>= n;
+    bitcount_ -= n;
   }
 
-  header = "data:image/gif;base64,";
-  if (in.find(header) == 0) {
-    return true;
+  // Canonical decode for codes longer than the table, puff style.
+  bool DecodeSlow(const Huffman &h, Alphabet alphabet, uint32_t *entry) {
+    int code = 0;
+    int first = 0;
+    int index = 0;
+    for (unsigned len = 1; len < 16; len++) {
+      code |= static_cast<int>((bitbuf_ >> (len - 1)) & 1);
+      const int count = h.counts[len];
+      if (code - first < count) {
+        Consume(len);
+        *entry = Entry(alphabet, h.symbols[index + (code - first)], 0);
+        return true;
+      }
+      index += count;
+      first = (first + count) << 1;
+      code <<= 1;
+    }
+    return false;
   }
 
-  header = "data:text/plain;base64,";
-  if (in.find(header) == 0) {
-    return true;
-  }
+  bool Stored() {
+    // Back to the first unread byte.
+    Consume(bitcount_ & 7);
+    in_ -= bitcount_ >> 3;
+    bitbuf_ = 0;
+    bitcount_ = 0;
 
-  header = "data:application/gltf-buffer;base64,";
-  if (in.find(header) == 0) {
+    if (in_end_ - in_ < 4) {
+      return false;
+    }
+    const size_t len = size_t(in_[0]) | (size_t(in_[1]) << 8);
+    const size_t nlen = size_t(in_[2]) | (size_t(in_[3]) << 8);
+    in_ += 4;
+    if ((len ^ 0xffff) != nlen || size_t(in_end_ - in_) < len ||
+        size_t(out_end_ - out_) < len) {
+      return false;
+    }
+    memcpy(out_, in_, len);
+    in_ += len;
+    out_ += len;
     return true;
   }
 
-  return false;
-}
-
-bool DecodeDataURI(std::vector<unsigned char> *out, std::string &mime_type,
-                   const std::string &in, size_t reqBytes, bool checkSize) {
-  std::string header = "data:application/octet-stream;base64,";
-  std::string data;
-  if (in.find(header) == 0) {
-    data = base64_decode(in.substr(header.size()));  // cut mime string.
-  }
-
-  if (data.empty()) {
-    header = "data:image/jpeg;base64,";
-    if (in.find(header) == 0) {
-      mime_type = "image/jpeg";
-      data = base64_decode(in.substr(header.size()));  // cut mime string.
+  bool BuildFixed() {
+    unsigned char lengths[288];
+    memset(lengths, 8, 144);
+    memset(lengths + 144, 9, 112);
+    memset(lengths + 256, 7, 24);
+    memset(lengths + 280, 8, 8);
+    if (!Build(&litlen_, kLitLenAlphabet, lengths, 288, kLitLenBits)) {
+      return false;
     }
+    memset(lengths, 5, 30);
+    return Build(&dist_, kDistAlphabet, lengths, 30, kDistBits);
   }
 
-  if (data.empty()) {
-    header = "data:image/png;base64,";
-    if (in.find(header) == 0) {
-      mime_type = "image/png";
-      data = base64_decode(in.substr(header.size()));  // cut mime string.
+  bool BuildDynamic() {
+    static const unsigned char kOrder[19] = {16, 17, 18, 0, 8,  7, 9,
+                                             6,  10, 5,  11, 4, 12, 3,
+                                             13, 2,  14, 1,  15};
+    const unsigned hlit = Bits(5) + 257;
+    const unsigned hdist = Bits(5) + 1;
+    const unsigned hclen = Bits(4) + 4;
+    if (hlit > 286 || hdist > 30) {
+      return false;
     }
-  }
 
-  if (data.empty()) {
-    header = "data:image/bmp;base64,";
-    if (in.find(header) == 0) {
-      mime_type = "image/bmp";
-      data = base64_decode(in.substr(header.size()));  // cut mime string.
+    unsigned char lengths[286 + 30];
+    memset(lengths, 0, 19);
+    for (unsigned i = 0; i < hclen; i++) {
+      if (in_ > in_end_ + 8) {
+        return false;
+      }
+      Refill();
+      lengths[kOrder[i]] = static_cast<unsigned char>(Bits(3));
     }
-  }
-
-  if (data.empty()) {
-    header = "data:image/gif;base64,";
-    if (in.find(header) == 0) {
-      mime_type = "image/gif";
-      data = base64_decode(in.substr(header.size()));  // cut mime string.
+    if (!Build(&codelen_, kCodeLenAlphabet, lengths, 19, kCodeLenBits)) {
+      return false;
     }
-  }
 
-  if (data.empty()) {
-    header = "data:text/plain;base64,";
-    if (in.find(header) == 0) {
-      mime_type = "text/plain";
-      data = base64_decode(in.substr(header.size()));
+    for (unsigned i = 0; i < hlit + hdist;) {
+      if (in_ > in_end_ + 8) {
+        return false;
+      }
+      Refill();
+      const uint32_t entry =
+          codelen_.table[bitbuf_ & ((1u << kCodeLenBits) - 1)];
+      if (((entry >> 8) & 7) != kSymbol) {
+        return false;
+      }
+      Consume(entry & 0xff);
+
+      const unsigned symbol = entry >> 16;
+      if (symbol < 16) {
+        lengths[i++] = static_cast<unsigned char>(symbol);
+        continue;
+      }
+
+      unsigned char value = 0;
+      unsigned repeat;
+      if (symbol == 16) {
+        if (i == 0) {
+          return false;
+        }
+        value = lengths[i - 1];
+        repeat = 3 + Bits(2);
+      } else if (symbol == 17) {
+        repeat = 3 + Bits(3);
+      } else {
+        repeat = 11 + Bits(7);
+      }
+      if (i + repeat > hlit + hdist) {
+        return false;
+      }
+      memset(lengths + i, value, repeat);
+      i += repeat;
     }
-  }
 
-  if (data.empty()) {
-    header = "data:application/gltf-buffer;base64,";
-    if (in.find(header) == 0) {
-      data = base64_decode(in.substr(header.size()));
+    if (lengths[256] == 0) {
+      return false;  // no end of block code
     }
+
+    return Build(&litlen_, kLitLenAlphabet, lengths, hlit, kLitLenBits) &&
+           Build(&dist_, kDistAlphabet, lengths + hlit, hdist, kDistBits);
   }
 
-  // TODO(syoyo): Allow empty buffer? #229
-  if (data.empty()) {
-    return false;
+  // Writes one or two literals, the caller makes sure there is room for
+  // two.
+  void PutLiterals(uint32_t entry) {
+    Consume(entry & 0xff);
+    out_[0] = static_cast<unsigned char>(entry >> 16);
+    out_[1] = static_cast<unsigned char>(entry >> 24);
+    out_ += 1 + ((entry >> 8) & 1);
   }
 
-  if (checkSize) {
-    if (data.size() != reqBytes) {
-      return false;
+  bool Codes() {
+    const uint32_t litlen_mask = (1u << kLitLenBits) - 1;
+    const uint32_t dist_mask = (1u << kDistBits) - 1;
+
+    for (;;) {
+      // One refill covers the longest length/distance pair, 48 bits, or
+      // the literals before it and another refill.
+      if (in_ > in_end_ + 8) {
+        return false;
+      }
+      Refill();
+
+      uint32_t entry = litlen_.table[bitbuf_ & litlen_mask];
+
+      // Up to three table hits of literals fit in one refill.
+      if (((entry >> 8) & 7) <= kLiteral2 && out_end_ - out_ >= 6) {
+        PutLiterals(entry);
+        entry = litlen_.table[bitbuf_ & litlen_mask];
+        if (((entry >> 8) & 7) <= kLiteral2) {
+          PutLiterals(entry);
+          entry = litlen_.table[bitbuf_ & litlen_mask];
+          if (((entry >> 8) & 7) <= kLiteral2) {
+            PutLiterals(entry);
+            continue;
+          }
+        }
+        Refill();
+      }
+
+      if (((entry >> 8) & 7) == kSlow &&
+          !DecodeSlow(litlen_, kLitLenAlphabet, &entry)) {
+        return false;
+      }
+      Consume(entry & 0xff);
+
+      switch ((entry >> 8) & 7) {
+        case kLiteral:
+          if (out_ == out_end_) {
+            return false;
+          }
+          *out_++ = static_cast<unsigned char>(entry >> 16);
+          break;
+
+        case kLiteral2:
+          if (out_end_ - out_ < 2) {
+            return false;
+          }
+          out_[0] = static_cast<unsigned char>(entry >> 16);
+          out_[1] = static_cast<unsigned char>(entry >> 24);
+          out_ += 2;
+          break;
+
+        case kEnd:
+          return true;
+
+        case kLength: {
+          const size_t length = (entry >> 16) + Bits((entry >> 11) & 31);
+
+          uint32_t dist_entry = dist_.table[bitbuf_ & dist_mask];
+          if (((dist_entry >> 8) & 7) == kSlow &&
+              !DecodeSlow(dist_, kDistAlphabet, &dist_entry)) {
+            return false;
+          }
+          if (((dist_entry >> 8) & 7) != kDistance) {
+            return false;
+          }
+          Consume(dist_entry & 0xff);
+          const size_t dist =
+              (dist_entry >> 16) + Bits((dist_entry >> 11) & 31);
+
+          if (dist > size_t(out_ - out_begin_) ||
+              length > size_t(out_end_ - out_)) {
+            return false;
+          }
+          Copy(length, dist);
+          break;
+        }
+
+        default:
+          return false;
+      }
     }
-    out->resize(reqBytes);
-  } else {
-    out->resize(data.size());
   }
-  std::copy(data.begin(), data.end(), out->begin());
-  return true;
-}
 
-namespace {
-bool GetInt(const json &o, int &val) {
-#ifdef TINYGLTF_USE_RAPIDJSON
-  if (!o.IsDouble()) {
-    if (o.IsInt()) {
-      val = o.GetInt();
-      return true;
-    } else if (o.IsUint()) {
-      val = static_cast<int>(o.GetUint());
-      return true;
-    } else if (o.IsInt64()) {
-      val = static_cast<int>(o.GetInt64());
-      return true;
-    } else if (o.IsUint64()) {
-      val = static_cast<int>(o.GetUint64());
-      return true;
+  void Copy(size_t length, size_t dist) {
+    const unsigned char *src = out_ - dist;
+    unsigned char *dst = out_;
+    out_ += length;
+
+    if (size_t(out_end_ - dst) < length + 16) {
+      for (size_t i = 0; i < length; i++) {
+        dst[i] = src[i];
+      }
+      return;
     }
-  }
 
-  return false;
-#else
-  auto type = o.type();
+    // Shorter distances repeat a pattern, after its first 8 bytes the same
+    // bytes also sit a multiple of `dist` of at least 8 back.
+    size_t i = 0;
+    if (dist < 8) {
+      for (; i < 8; i++) {
+        dst[i] = src[i];
+      }
+      src = dst + i - (8 / dist + (8 % dist != 0)) * dist;
+      dst += i;
+    }
 
-  if ((type == json::value_t::number_integer) ||
-      (type == json::value_t::number_unsigned)) {
-    val = static_cast<int>(o.get<int64_t>());
-    return true;
+    // 8 byte steps never read bytes this copy has not written yet.
+    for (; i < length; i += 8, src += 8, dst += 8) {
+      uint64_t v;
+      memcpy(&v, src, 8);
+      memcpy(dst, &v, 8);
+    }
   }
 
-  return false;
-#endif
-}
+  const unsigned char *in_;
+  const unsigned char *in_end_;
+  unsigned char *out_begin_;
+  unsigned char *out_;
+  unsigned char *out_end_;
+  uint64_t bitbuf_ = 0;
+  unsigned bitcount_ = 0;
 
-#ifdef TINYGLTF_USE_RAPIDJSON
-bool GetDouble(const json &o, double &val) {
-  if (o.IsDouble()) {
-    val = o.GetDouble();
-    return true;
-  }
+  Huffman litlen_;
+  Huffman dist_;
+  Huffman codelen_;
+};
 
-  return false;
+inline unsigned char Paeth(int a, int b, int c) {
+  const int pa = std::abs(b - c);
+  const int pb = std::abs(a - c);
+  const int pc = std::abs(a + b - c - c);
+  if (pa <= pb && pa <= pc) return static_cast<unsigned char>(a);
+  if (pb <= pc) return static_cast<unsigned char>(b);
+  return static_cast<unsigned char>(c);
+}
+
+#ifdef TINYGLTF_PNG_SSE2
+// One pixel of 3 or 4 bytes in the low lanes.
+template <int Bpp>
+inline __m128i LoadPixel(const unsigned char *p) {
+  int v = 0;
+  memcpy(&v, p, Bpp);
+  return _mm_cvtsi32_si128(v);
+}
+
+template <int Bpp>
+inline void StorePixel(unsigned char *p, __m128i v) {
+  const int i = _mm_cvtsi128_si32(v);
+  memcpy(p, &i, Bpp);
+}
+
+// Sub, Avg and Paeth depend on the pixel to the left, so these go one pixel
+// at a time with all its bytes in parallel.
+template <int Bpp>
+void UnfilterRowSSE2(int filter, const unsigned char *src,
+                     const unsigned char *prev, unsigned char *dst,
+                     size_t stride) {
+  const __m128i zero = _mm_setzero_si128();
+
+  if (filter == 1) {
+    __m128i a = zero;
+    for (size_t i = 0; i < stride; i += Bpp) {
+      a = _mm_add_epi8(a, LoadPixel<Bpp>(src + i));
+      StorePixel<Bpp>(dst + i, a);
+    }
+  } else if (filter == 3) {
+    __m128i a = zero;
+    for (size_t i = 0; i < stride; i += Bpp) {
+      const __m128i b = LoadPixel<Bpp>(prev + i);
+      // (a + b) >> 1 without overflow, _mm_avg_epu8 rounds up.
+      const __m128i avg = _mm_sub_epi8(
+          _mm_avg_epu8(a, b),
+          _mm_and_si128(_mm_xor_si128(a, b), _mm_set1_epi8(1)));
+      a = _mm_add_epi8(avg, LoadPixel<Bpp>(src + i));
+      StorePixel<Bpp>(dst + i, a);
+    }
+  } else {
+    // Paeth in 16 bit lanes, c and a start out as zero for the first pixel.
+    __m128i b = zero;
+    __m128i d = zero;
+    for (size_t i = 0; i < stride; i += Bpp) {
+      const __m128i c = b;
+      const __m128i a = d;
+      b = _mm_unpacklo_epi8(LoadPixel<Bpp>(prev + i), zero);
+      d = _mm_unpacklo_epi8(LoadPixel<Bpp>(src + i), zero);
+
+      __m128i pa = _mm_sub_epi16(b, c);  // p - a
+      __m128i pb = _mm_sub_epi16(a, c);  // p - b
+      __m128i pc = _mm_add_epi16(pa, pb);  // p - c
+      pa = _mm_max_epi16(pa, _mm_sub_epi16(zero, pa));
+      pb = _mm_max_epi16(pb, _mm_sub_epi16(zero, pb));
+      pc = _mm_max_epi16(pc, _mm_sub_epi16(zero, pc));
+
+      // Ties prefer a, then b.
+      const __m128i smallest = _mm_min_epi16(pc, _mm_min_epi16(pa, pb));
+      const __m128i use_a = _mm_cmpeq_epi16(smallest, pa);
+      const __m128i use_b = _mm_cmpeq_epi16(smallest, pb);
+      const __m128i b_or_c = _mm_or_si128(_mm_and_si128(use_b, b),
+                                          _mm_andnot_si128(use_b, c));
+      const __m128i nearest = _mm_or_si128(_mm_and_si128(use_a, a),
+                                           _mm_andnot_si128(use_a, b_or_c));
+
+      d = _mm_add_epi8(d, nearest);
+      StorePixel<Bpp>(dst + i, _mm_packus_epi16(d, d));
+    }
+  }
 }
 #endif
 
-bool GetNumber(const json &o, double &val) {
-#ifdef TINYGLTF_USE_RAPIDJSON
-  if (o.IsNumber()) {
-    val = o.GetDouble();
-    return true;
-  }
-
-  return false;
-#else
-  if (o.is_number()) {
-    val = o.get<double>();
-    return true;
-  }
+// Reverses the PNG filter (PNG spec 9) of one scanline. `prev` is the
+// previous unfiltered scanline, zeros for the first one. `dst` may start
+// before `src` in the same buffer, source bytes are read before anything
+// is written over them.
+bool UnfilterRow(int filter, const unsigned char *src,
+                 const unsigned char *prev, unsigned char *dst, size_t stride,
+                 int bpp) {
+  switch (filter) {
+    case 0:
+      memmove(dst, src, stride);
+      return true;
 
-  return false;
+    case 2: {
+      size_t i = 0;
+#ifdef TINYGLTF_PNG_SSE2
+      for (; i + 16 <= stride; i += 16) {
+        const __m128i s =
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        const __m128i p =
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(prev + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i),
+                         _mm_add_epi8(s, p));
+      }
 #endif
-}
+      for (; i < stride; i++) {
+        dst[i] = static_cast<unsigned char>(src[i] + prev[i]);
+      }
+      return true;
+    }
 
-bool GetString(const json &o, std::string &val) {
-#ifdef TINYGLTF_USE_RAPIDJSON
-  if (o.IsString()) {
-    val = o.GetString();
-    return true;
+    case 1:
+    case 3:
+    case 4:
+      break;
+
+    default:
+      return false;
   }
 
-  return false;
-#else
-  if (o.type() == json::value_t::string) {
-    val = o.get<std::string>();
+#ifdef TINYGLTF_PNG_SSE2
+  if (bpp == 4) {
+    UnfilterRowSSE2<4>(filter, src, prev, dst, stride);
+    return true;
+  }
+  if (bpp == 3) {
+    UnfilterRowSSE2<3>(filter, src, prev, dst, stride);
     return true;
   }
-
-  return false;
-#endif
-}
-
-bool IsArray(const json &o) {
-#ifdef TINYGLTF_USE_RAPIDJSON
-  return o.IsArray();
-#else
-  return o.is_array();
 #endif
-}
 
-json_const_array_iterator ArrayBegin(const json &o) {
-#ifdef TINYGLTF_USE_RAPIDJSON
-  return o.Begin();
-#else
-  return o.begin();
-#endif
+  const size_t n = static_cast<size_t>(bpp);
+  if (filter == 1) {
+    memmove(dst, src, n);
+    for (size_t i = n; i < stride; i++) {
+      dst[i] = static_cast<unsigned char>(src[i] + dst[i - n]);
+    }
+  } else if (filter == 3) {
+    for (size_t i = 0; i < n; i++) {
+      dst[i] = static_cast<unsigned char>(src[i] + (prev[i] >> 1));
+    }
+    for (size_t i = n; i < stride; i++) {
+      dst[i] =
+          static_cast<unsigned char>(src[i] + ((dst[i - n] + prev[i]) >> 1));
+    }
+  } else {
+    for (size_t i = 0; i < n; i++) {
+      dst[i] = static_cast<unsigned char>(src[i] + prev[i]);
+    }
+    for (size_t i = n; i < stride; i++) {
+      dst[i] = static_cast<unsigned char>(
+          src[i] + Paeth(dst[i - n], prev[i], prev[i - n]));
+    }
+  }
+  return true;
 }
 
-json_const_array_iterator ArrayEnd(const json &o) {
-#ifdef TINYGLTF_USE_RAPIDJSON
-  return o.End();
-#else
-  return o.end();
-#endif
+uint32_t ReadBigEndian32(const unsigned char *p) {
+  return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) |
+         (uint32_t(p[2]) << 8) | uint32_t(p[3]);
 }
 
-bool IsObject(const json &o) {
-#ifdef TINYGLTF_USE_RAPIDJSON
-  return o.IsObject();
-#else
-  return o.is_object();
-#endif
-}
+// Decodes non-interlaced 8 bit gray, gray + alpha, RGB and RGBA PNGs into
+// `out` with `req_comp` channels (0 keeps the file's), converted like
+// stb_image does. False for anything else, including broken files, so the
+// caller can hand those to stb_image.
+bool DecodePng8(const unsigned char *bytes, size_t size, int req_comp,
+                std::vector<unsigned char> *out, int *width, int *height,
+                int *components) {
+  static const unsigned char kSignature[8] = {137, 80, 78, 71, 13, 10, 26, 10};
+  if (size < 8 + 25 || memcmp(bytes, kSignature, 8) != 0) {
+    return false;
+  }
 
-json_const_iterator ObjectBegin(const json &o) {
-#ifdef TINYGLTF_USE_RAPIDJSON
-  return o.MemberBegin();
-#else
-  return o.begin();
-#endif
-}
+  // IHDR comes first, the IDAT chunks are gathered into one zlib stream.
+  uint32_t w = 0;
+  uint32_t h = 0;
+  int comp = 0;
+  size_t idat_size = 0;
+  for (size_t pos = 8; pos + 12 <= size;) {
+    const size_t length = ReadBigEndian32(bytes + pos);
+    const unsigned char *type = bytes + pos + 4;
+    if (length > size - pos - 12) {
+      return false;
+    }
 
-json_const_iterator ObjectEnd(const json &o) {
-#ifdef TINYGLTF_USE_RAPIDJSON
-  return o.MemberEnd();
-#else
-  return o.end();
-#endif
-}
+    if (pos == 8) {
+      if (memcmp(type, "IHDR", 4) != 0 || length != 13) {
+        return false;
+      }
+      const unsigned char *ihdr = bytes + pos + 8;
+      w = ReadBigEndian32(ihdr);
+      h = ReadBigEndian32(ihdr + 4);
+      const int depth = ihdr[8];
+      const int color = ihdr[9];
+      const int interlace = ihdr[12];
+      comp = color == 0   ? 1
+             : color == 4 ? 2
+             : color == 2 ? 3
+             : color == 6 ? 4
+                          : 0;
+      if (depth != 8 || comp == 0 || ihdr[10] != 0 || ihdr[11] != 0 ||
+          interlace != 0) {
+        return false;
+      }
+    } else if (memcmp(type, "IDAT", 4) == 0) {
+      idat_size += length;
+    } else if (memcmp(type, "tRNS", 4) == 0 || memcmp(type, "CgBI", 4) == 0) {
+      // Color key transparency and Apple's variant are left to stb_image.
+      return false;
+    } else if (memcmp(type, "IEND", 4) == 0) {
+      break;
+    }
 
-// Making this a const char* results in a pointer to a temporary when
-// TINYGLTF_USE_RAPIDJSON is off.
-std::string GetKey(json_const_iterator &it) {
-#ifdef TINYGLTF_USE_RAPIDJSON
-  return it->name.GetString();
-#else
-  return it.key().c_str();
-#endif
-}
+    pos += length + 12;
+  }
 
-bool FindMember(const json &o, const char *member, json_const_iterator &it) {
-#ifdef TINYGLTF_USE_RAPIDJSON
-  if (!o.IsObject()) {
+  const int out_comp = req_comp ? req_comp : comp;
+  if (w == 0 || h == 0 || w > (1u << 24) || h > (1u << 24) ||
+      idat_size == 0 ||
+      (out_comp != comp && out_comp != 4) ||
+      uint64_t(w) * h * 4 > 0x7fffffffull) {
     return false;
   }
-  it = o.FindMember(member);
-  return it != o.MemberEnd();
-#else
-  it = o.find(member);
-  return it != o.end();
-#endif
-}
 
-const json &GetValue(json_const_iterator &it) {
-#ifdef TINYGLTF_USE_RAPIDJSON
-  return it->value;
-#else
-  return it.value();
-#endif
-}
+  std::vector<unsigned char> zlib(idat_size + kInflatePadding);
+  size_t zlib_size = 0;
+  for (size_t pos = 8; pos + 12 <= size;) {
+    const size_t length = ReadBigEndian32(bytes + pos);
+    if (memcmp(bytes + pos + 4, "IDAT", 4) == 0) {
+      memcpy(zlib.data() + zlib_size, bytes + pos + 8, length);
+      zlib_size += length;
+    } else if (memcmp(bytes + pos + 4, "IEND", 4) == 0) {
+      break;
+    }
+    pos += length + 12;
+  }
 
-std::string JsonToString(const json &o, int spacing = -1) {
-#ifdef TINYGLTF_USE_RAPIDJSON
-  using namespace rapidjson;
-  StringBuffer buffer;
-  if (spacing == -1) {
-    Writer<StringBuffer> writer(buffer);
-    // TODO: Better error handling.
-    // https://github.com/syoyo/tinygltf/issues/332
-    if (!o.Accept(writer)) {
-      return "tiny_gltf::JsonToString() failed rapidjson conversion";
+  // Filtered scanlines, each with a filter type byte. Some slack lets the
+  // match copies write 8 bytes at a time. When the channels stay the same
+  // the scanlines are inflated into `out` and reconstructed in place, every
+  // row moves to the front by the filter bytes above and including it.
+  const size_t stride = size_t(w) * size_t(comp);
+  const size_t filtered_size = size_t(h) * (stride + 1);
+  const bool in_place = out_comp == comp;
+  std::vector<unsigned char> expanded;
+  std::vector<unsigned char> &filtered = in_place ? *out : expanded;
+  filtered.resize(filtered_size + 16);
+
+  size_t inflated = 0;
+  Inflater inflater(zlib.data(), zlib_size, filtered.data(), filtered.size());
+  if (!inflater.Run(&inflated) || inflated < filtered_size) {
+    return false;
+  }
+
+  if (in_place) {
+    expanded.assign(stride, 0);
+    const unsigned char *prev = expanded.data();
+    for (uint32_t y = 0; y < h; y++) {
+      const unsigned char *src = out->data() + y * (stride + 1);
+      unsigned char *dst = out->data() + y * stride;
+      if (!UnfilterRow(src[0], src + 1, prev, dst, stride, comp)) {
+        return false;
+      }
+      prev = dst;
     }
+    out->resize(size_t(h) * stride);
   } else {
-    PrettyWriter<StringBuffer> writer(buffer);
-    writer.SetIndent(' ', uint32_t(spacing));
-    if (!o.Accept(writer)) {
-      return "tiny_gltf::JsonToString() failed rapidjson conversion";
+    // Two scanlines after a zero one, the rows are expanded to RGBA.
+    out->resize(size_t(w) * size_t(h) * 4);
+    std::vector<unsigned char> rows(stride * 3, 0);
+    const unsigned char *prev = rows.data();
+    unsigned char *cur = rows.data() + stride;
+
+    for (uint32_t y = 0; y < h; y++) {
+      const unsigned char *src = filtered.data() + y * (stride + 1);
+      unsigned char *dst = out->data() + y * size_t(w) * 4;
+      if (!UnfilterRow(src[0], src + 1, prev, cur, stride, comp)) {
+        return false;
+      }
+      for (uint32_t x = 0; x < w; x++) {
+        const unsigned char *c = cur + x * size_t(comp);
+        unsigned char *d = dst + x * 4;
+        if (comp == 1) {
+          d[0] = d[1] = d[2] = c[0];
+          d[3] = 255;
+        } else if (comp == 2) {
+          d[0] = d[1] = d[2] = c[0];
+          d[3] = c[1];
+        } else {
+          d[0] = c[0];
+          d[1] = c[1];
+          d[2] = c[2];
+          d[3] = 255;
+        }
+      }
+      prev = cur;
+      cur = cur == rows.data() + stride ? rows.data() + 2 * stride
+                                        : rows.data() + stride;
     }
   }
-  return buffer.GetString();
-#else
-  return o.dump(spacing);
-#endif
+
+  *width = static_cast<int>(w);
+  *height = static_cast<int>(h);
+  *components = comp;
+  return true;
 }
 
 }  // namespace
+#endif
 
-static bool ParseJsonAsValue(Value *ret, const json &o) {
+#ifndef TINYGLTF_NO_STB_IMAGE
+bool LoadImageData(Image *image, const int image_idx, std::string *err,
+                   std::string *warn, int req_width, int req_height,
+                   const unsigned char *bytes, int size, void *user_data) {
+  (void)warn;
+
+  LoadImageDataOption option;
+  if (user_data) {
+    option = *reinterpret_cast<LoadImageDataOption *>(user_data);
+  }
+
+  int w = 0, h = 0, comp = 0, req_comp = 0;
+
+  unsigned char *data = nullptr;
+
+  // preserve_channels true: Use channels stored in the image file.
+  // false: force 32-bit textures for common Vulkan compatibility. It appears
+  // that some GPU drivers do not support 24-bit images for Vulkan
+  req_comp = option.preserve_channels ? 0 : 4;
+  int bits = 8;
+  int pixel_type = TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE;
+
+#ifdef TINYGLTF_FAST_PNG
+  // 8 bit PNGs are decoded straight into the image storage.
+  {
+    std::vector<unsigned char> pixels;
+    if (size > 0 && DecodePng8(bytes, static_cast<size_t>(size), req_comp,
+                               &pixels, &w, &h, &comp)) {
+      if ((req_width > 0 && req_width != w) ||
+          (req_height > 0 && req_height != h)) {
+        if (err) {
+          (*err) += "Image size mismatch for image[" +
+                    std::to_string(image_idx) + "] name = \"" + image->name +
+                    "\"\n";
+        }
+        return false;
+      }
+
+      image->width = w;
+      image->height = h;
+      image->component = req_comp ? req_comp : comp;
+      image->bits = bits;
+      image->pixel_type = pixel_type;
+      image->image.swap(pixels);
+      return true;
+    }
+  }
+#endif
+
+#if !defined(TINYGLTF_NO_INCLUDE_STB_IMAGE) && !defined(STBI_NO_JPEG)
+  // JPEGs are decoded by stb_image straight into the image storage. Size
+  // mismatches fall through, so they are reported the same way as below.
+  if (size > 2 && bytes[0] == 0xFF && bytes[1] == 0xD8 &&
+      stbi_info_from_memory(bytes, size, &w, &h, &comp) && w > 0 && h > 0 &&
+      (req_width <= 0 || req_width == w) &&
+      (req_height <= 0 || req_height == h)) {
+    std::vector<unsigned char> pixels(static_cast<size_t>(w) *
+                                      static_cast<size_t>(h) *
+                                      size_t(req_comp ? req_comp : comp));
+    if (stbi_load_jpeg_from_memory_into(bytes, size, pixels.data(),
+                                        pixels.size(), &w, &h, &comp,
+                                        req_comp)) {
+      image->width = w;
+      image->height = h;
+      image->component = req_comp ? req_comp : comp;
+      image->bits = bits;
+      image->pixel_type = pixel_type;
+      image->image.swap(pixels);
+      return true;
+    }
+  }
+#endif
+
+  // It is possible that the image we want to load is a 16bit per channel image
+  // We are going to attempt to load it as 16bit per channel, and if it worked,
+  // set the image data accodingly. We are casting the returned pointer into
+  // unsigned char, because we are representing "bytes". But we are updating
+  // the Image metadata to signal that this image uses 2 bytes (16bits) per
+  // channel:
+  if (stbi_is_16_bit_from_memory(bytes, size)) {
+    data = reinterpret_cast<unsigned char *>(
+        stbi_load_16_from_memory(bytes, size, &w, &h, &comp, req_comp));
+    if (data) {
+      bits = 16;
+      pixel_type = TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT;
+    }
+  }
+
+  // at this point, if data is still NULL, it means that the image wasn't
+  // 16bit per channel, we are going to load it as a normal 8bit per channel
+  // mage as we used to do:
+  // if image cannot be decoded, ignore parsing and keep it by its path
+  // don't break in this case
+  // FIXME we should only enter this function if the image is embedded. If
+  // image->uri references
+  // an image file, it should be left as it is. Image loading should not be
+  // mandatory (to support other formats)
+  if (!data) data = stbi_load_from_memory(bytes, size, &w, &h, &comp, req_comp);
+  if (!data) {
+    // NOTE: you can use `warn` instead of `err`
+    if (err) {
+      (*err) +=
+          "Unknown image format. STB cannot decode image data for image[" +
+          std::to_string(image_idx) + "] name = \"" + image->name + "\".\n";
+    }
+    return false;
+  }
+
+  if ((w < 1) || (h < 1)) {
+    stbi_image_free(data);
+    if (err) {
+      (*err) += "Invalid image data for image[" + std::to_string(image_idx) +
+                "] name = \"" + image->name + "\"\n";
+    }
+    return false;
+  }
+
+  if (req_width > 0) {
+    if (req_width != w) {
+      stbi_image_free(data);
+      if (err) {
+        (*err) += "Image width mismatch for image[" +
+                  std::to_string(image_idx) + "] name = \"" + image->name +
+                  "\"\n";
+      }
+      return false;
+    }
+  }
+
+  if (req_height > 0) {
+    if (req_height != h) {
+      stbi_image_free(data);
+      if (err) {
+        (*err) += "Image height mismatch. for image[" +
+                  std::to_string(image_idx) + "] name = \"" + image->name +
+                  "\"\n";
+      }
+      return false;
+    }
+  }
+
+  if (req_comp != 0) {
+    // loaded data has `req_comp` channels(components)
+    comp = req_comp;
+  }
+
+  image->width = w;
+  image->height = h;
+  image->component = comp;
+  image->bits = bits;
+  image->pixel_type = pixel_type;
+  image->image.resize(static_cast<size_t>(w * h * comp) * size_t(bits / 8));
+  std::copy(data, data + w * h * comp * (bits / 8), image->image.begin());
+  stbi_image_free(data);
+
+  return true;
+}
+#endif
+
+void TinyGLTF::SetImageWriter(WriteImageDataFunction func, void *user_data) {
+  WriteImageData = func;
+  write_image_user_data_ = user_data;
+}
+
+#ifndef TINYGLTF_NO_STB_IMAGE_WRITE
+static void WriteToMemory_stbi(void *context, void *data, int size) {
+  std::vector<unsigned char> *buffer =
+      reinterpret_cast<std::vector<unsigned char> *>(context);
+
+  unsigned char *pData = reinterpret_cast<unsigned char *>(data);
+
+  buffer->insert(buffer->end(), pData, pData + size);
+}
+
+bool WriteImageData(const std::string *basepath, const std::string *filename,
+                    Image *image, bool embedImages, void *fsPtr) {
+  const std::string ext = GetFilePathExtension(*filename);
+
+  // Write image to temporary buffer
+  std::string header;
+  std::vector<unsigned char> data;
+
+  if (ext == "png") {
+    if ((image->bits != 8) ||
+        (image->pixel_type != TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE)) {
+      // Unsupported pixel format
+      return false;
+    }
+
+    if (!stbi_write_png_to_func(WriteToMemory_stbi, &data, image->width,
+                                image->height, image->component,
+                                &image->image[0], 0)) {
+      return false;
+    }
+    header = "data:image/png;base64,";
+  } else if (ext == "jpg") {
+    if (!stbi_write_jpg_to_func(WriteToMemory_stbi, &data, image->width,
+                                image->height, image->component,
+                                &image->image[0], 100)) {
+      return false;
+    }
+    header = "data:image/jpeg;base64,";
+  } else if (ext == "bmp") {
+    if (!stbi_write_bmp_to_func(WriteToMemory_stbi, &data, image->width,
+                                image->height, image->component,
+                                &image->image[0])) {
+      return false;
+    }
+    header = "data:image/bmp;base64,";
+  } else if (!embedImages) {
+    // Error: can't output requested format to file
+    return false;
+  }
+
+  if (embedImages) {
+    // Embed base64-encoded image into URI
+    if (data.size()) {
+      image->uri = EncodeDataURI(header, &data[0], data.size());
+    } else {
+      // Throw error?
+    }
+  } else {
+    // Write image to disc
+    FsCallbacks *fs = reinterpret_cast<FsCallbacks *>(fsPtr);
+    if ((fs != nullptr) && (fs->WriteWholeFile != nullptr)) {
+      const std::string imagefilepath = JoinPath(*basepath, *filename);
+      std::string writeError;
+      if (!fs->WriteWholeFile(&writeError, imagefilepath, data,
+                              fs->user_data)) {
+        // Could not write image file to disc; Throw error ?
+        return false;
+      }
+    } else {
+      // Throw error?
+    }
+    image->uri = *filename;
+  }
+
+  return true;
+}
+#endif
+
+void TinyGLTF::SetFsCallbacks(FsCallbacks callbacks) { fs = callbacks; }
+
+void TinyGLTF::SetAsyncFsCallbacks(AsyncFsCallbacks callbacks) {
+  async_fs_ = callbacks;
+}
+
+#ifdef _WIN32
+static inline std::wstring UTF8ToWchar(const std::string &str) {
+  int wstr_size =
+      MultiByteToWideChar(CP_UTF8, 0, str.data(), (int)str.size(), nullptr, 0);
+  std::wstring wstr(wstr_size, 0);
+  MultiByteToWideChar(CP_UTF8, 0, str.data(), (int)str.size(), &wstr[0],
+                      (int)wstr.size());
+  return wstr;
+}
+
+static inline std::string WcharToUTF8(const std::wstring &wstr) {
+  int str_size = WideCharToMultiByte(CP_UTF8, 0, wstr.data(), (int)wstr.size(),
+                                     nullptr, 0, NULL, NULL);
+  std::string str(str_size, 0);
+  WideCharToMultiByte(CP_UTF8, 0, wstr.data(), (int)wstr.size(), &str[0],
+                      (int)str.size(), NULL, NULL);
+  return str;
+}
+#endif
+
+#ifndef TINYGLTF_NO_FS
+// Default implementations of filesystem functions
+
+bool FileExists(const std::string &abs_filename, void *) {
+  bool ret;
+#ifdef TINYGLTF_ANDROID_LOAD_FROM_ASSETS
+  if (asset_manager) {
+    AAsset *asset = AAssetManager_open(asset_manager, abs_filename.c_str(),
+                                       AASSET_MODE_STREAMING);
+    if (!asset) {
+      return false;
+    }
+    AAsset_close(asset);
+    ret = true;
+  } else {
+    return false;
+  }
+#else
+#ifdef _WIN32
+#if defined(_MSC_VER) || defined(__GLIBCXX__)
+  FILE *fp = nullptr;
+  errno_t err = _wfopen_s(&fp, UTF8ToWchar(abs_filename).c_str(), L"rb");
+  if (err != 0) {
+    return false;
+  }
+#else
+  FILE *fp = nullptr;
+  errno_t err = fopen_s(&fp, abs_filename.c_str(), "rb");
+  if (err != 0) {
+    return false;
+  }
+#endif
+
+#else
+  FILE *fp = fopen(abs_filename.c_str(), "rb");
+#endif
+  if (fp) {
+    ret = true;
+    fclose(fp);
+  } else {
+    ret = false;
+  }
+#endif
+
+  return ret;
+}
+
+std::string ExpandFilePath(const std::string &filepath, void *) {
+#ifdef _WIN32
+  // Assume input `filepath` is encoded in UTF-8
+  std::wstring wfilepath = UTF8ToWchar(filepath);
+  DWORD wlen = ExpandEnvironmentStringsW(wfilepath.c_str(), nullptr, 0);
+  wchar_t *wstr = new wchar_t[wlen];
+  ExpandEnvironmentStringsW(wfilepath.c_str(), wstr, wlen);
+
+  std::wstring ws(wstr);
+  delete[] wstr;
+  return WcharToUTF8(ws);
+
+#else
+
+#if defined(TARGET_OS_IPHONE) || defined(TARGET_IPHONE_SIMULATOR) || \
+    defined(__ANDROID__) || defined(__EMSCRIPTEN__) || defined(__OpenBSD__)
+  // no expansion
+  std::string s = filepath;
+#else
+  std::string s;
+  wordexp_t p;
+
+  if (filepath.empty()) {
+    return "";
+  }
+
+  // Quote the string to keep any spaces in filepath intact.
+  std::string quoted_path = "\"" + filepath + "\"";
+  // char** w;
+  int ret = wordexp(quoted_path.c_str(), &p, 0);
+  if (ret) {
+    // err
+    s = filepath;
+    return s;
+  }
+
+  // Use first element only.
+  if (p.we_wordv) {
+    s = std::string(p.we_wordv[0]);
+    wordfree(&p);
+  } else {
+    s = filepath;
+  }
+
+#endif
+
+  return s;
+#endif
+}
+
+bool ReadWholeFile(std::vector<unsigned char> *out, std::string *err,
+                   const std::string &filepath, void *) {
+#ifdef TINYGLTF_ANDROID_LOAD_FROM_ASSETS
+  if (asset_manager) {
+    AAsset *asset = AAssetManager_open(asset_manager, filepath.c_str(),
+                                       AASSET_MODE_STREAMING);
+    if (!asset) {
+      if (err) {
+        (*err) += "File open error : " + filepath + "\n";
+      }
+      return false;
+    }
+    size_t size = AAsset_getLength(asset);
+    if (size == 0) {
+      if (err) {
+        (*err) += "Invalid file size : " + filepath +
+                  " (does the path point to a directory?)";
+      }
+      return false;
+    }
+    out->resize(size);
+    AAsset_read(asset, reinterpret_cast<char *>(&out->at(0)), size);
+    AAsset_close(asset);
+    return true;
+  } else {
+    if (err) {
+      (*err) += "No asset manager specified : " + filepath + "\n";
+    }
+    return false;
+  }
+#else
+#ifdef _WIN32
+#if defined(__GLIBCXX__)  // mingw
+  int file_descriptor =
+      _wopen(UTF8ToWchar(filepath).c_str(), _O_RDONLY | _O_BINARY);
+  __gnu_cxx::stdio_filebuf<char> wfile_buf(file_descriptor, std::ios_base::in);
+  std::istream f(&wfile_buf);
+#elif defined(_MSC_VER) || defined(_LIBCPP_VERSION)
+  // For libcxx, assume _LIBCPP_HAS_OPEN_WITH_WCHAR is defined to accept
+  // `wchar_t *`
+  std::ifstream f(UTF8ToWchar(filepath).c_str(), std::ifstream::binary);
+#else
+  // Unknown compiler/runtime
+  std::ifstream f(filepath.c_str(), std::ifstream::binary);
+#endif
+#else
+  std::ifstream f(filepath.c_str(), std::ifstream::binary);
+#endif
+  if (!f) {
+    if (err) {
+      (*err) += "File open error : " + filepath + "\n";
+    }
+    return false;
+  }
+
+  f.seekg(0, f.end);
+  size_t sz = static_cast<size_t>(f.tellg());
+  f.seekg(0, f.beg);
+
+  if (int64_t(sz) < 0) {
+    if (err) {
+      (*err) += "Invalid file size : " + filepath +
+                " (does the path point to a directory?)";
+    }
+    return false;
+  } else if (sz == 0) {
+    if (err) {
+      (*err) += "File is empty : " + filepath + "\n";
+    }
+    return false;
+  }
+
+  out->resize(sz);
+  f.read(reinterpret_cast<char *>(&out->at(0)),
+         static_cast<std::streamsize>(sz));
+
+  return true;
+#endif
+}
+
+bool WriteWholeFile(std::string *err, const std::string &filepath,
+                    const std::vector<unsigned char> &contents, void *) {
+#ifdef _WIN32
+#if defined(__GLIBCXX__)  // mingw
+  int file_descriptor = _wopen(UTF8ToWchar(filepath).c_str(),
+                               _O_CREAT | _O_WRONLY | _O_TRUNC | _O_BINARY);
+  __gnu_cxx::stdio_filebuf<char> wfile_buf(
+      file_descriptor, std::ios_base::out | std::ios_base::binary);
+  std::ostream f(&wfile_buf);
+#elif defined(_MSC_VER)
+  std::ofstream f(UTF8ToWchar(filepath).c_str(), std::ofstream::binary);
+#else  // clang?
+  std::ofstream f(filepath.c_str(), std::ofstream::binary);
+#endif
+#else
+  std::ofstream f(filepath.c_str(), std::ofstream::binary);
+#endif
+  if (!f) {
+    if (err) {
+      (*err) += "File open error for writing : " + filepath + "\n";
+    }
+    return false;
+  }
+
+  f.write(reinterpret_cast<const char *>(&contents.at(0)),
+          static_cast<std::streamsize>(contents.size()));
+  if (!f) {
+    if (err) {
+      (*err) += "File write error: " + filepath + "\n";
+    }
+    return false;
+  }
+
+  return true;
+}
+
+#endif  // TINYGLTF_NO_FS
+
+static std::string MimeToExt(const std::string &mimeType) {
+  if (mimeType == "image/jpeg") {
+    return "jpg";
+  } else if (mimeType == "image/png") {
+    return "png";
+  } else if (mimeType == "image/bmp") {
+    return "bmp";
+  } else if (mimeType == "image/gif") {
+    return "gif";
+  }
+
+  return "";
+}
+
+static void UpdateImageObject(Image &image, std::string &baseDir, int index,
+                              bool embedImages,
+                              WriteImageDataFunction *WriteImageData = nullptr,
+                              void *user_data = nullptr) {
+  std::string filename;
+  std::string ext;
+  // If image has uri, use it it as a filename
+  if (image.uri.size()) {
+    filename = GetBaseFilename(image.uri);
+    ext = GetFilePathExtension(filename);
+  } else if (image.bufferView != -1) {
+    // If there's no URI and the data exists in a buffer,
+    // don't change properties or write images
+  } else if (image.name.size()) {
+    ext = MimeToExt(image.mimeType);
+    // Otherwise use name as filename
+    filename = image.name + "." + ext;
+  } else {
+    ext = MimeToExt(image.mimeType);
+    // Fallback to index of image as filename
+    filename = std::to_string(index) + "." + ext;
+  }
+
+  // If callback is set, modify image data object
+  if (*WriteImageData != nullptr && !filename.empty()) {
+    std::string uri;
+    (*WriteImageData)(&baseDir, &filename, &image, embedImages, user_data);
+  }
+}
+
+bool IsDataURI(const std::string &in) {
+  return FindDataURIHeader(in) != nullptr;
+}
+
+bool DecodeDataURI(std::vector<unsigned char> *out, std::string &mime_type,
+                   const std::string &in, size_t reqBytes, bool checkSize) {
+  const DataURIHeader *header = FindDataURIHeader(in);
+  if (header == nullptr) {
+    return false;
+  }
+
+  if (header->mime_type != nullptr) {
+    mime_type = header->mime_type;
+  }
+
+  // Decode in place, `out` is usually the Buffer::data or Image::image the
+  // payload ends up in.
+  base64_decode(in.data() + header->size, in.size() - header->size, out);
+
+  // TODO(syoyo): Allow empty buffer? #229
+  if (out->empty()) {
+    return false;
+  }
+
+  if (checkSize && out->size() != reqBytes) {
+    out->clear();
+    return false;
+  }
+
+  return true;
+}
+
+namespace {
+bool GetInt(const json &o, int &val) {
+#ifdef TINYGLTF_USE_RAPIDJSON
+  if (!o.IsDouble()) {
+    if (o.IsInt()) {
+      val = o.GetInt();
+      return true;
+    } else if (o.IsUint()) {
+      val = static_cast<int>(o.GetUint());
+      return true;
+    } else if (o.IsInt64()) {
+      val = static_cast<int>(o.GetInt64());
+      return true;
+    } else if (o.IsUint64()) {
+      val = static_cast<int>(o.GetUint64());
+      return true;
+    }
+  }
+
+  return false;
+#else
+  auto type = o.type();
+
+  if ((type == json::value_t::number_integer) ||
+      (type == json::value_t::number_unsigned)) {
+    val = static_cast<int>(o.get<int64_t>());
+    return true;
+  }
+
+  return false;
+#endif
+}
+
+#ifdef TINYGLTF_USE_RAPIDJSON
+bool GetDouble(const json &o, double &val) {
+  if (o.IsDouble()) {
+    val = o.GetDouble();
+    return true;
+  }
+
+  return false;
+}
+#endif
+
+bool GetNumber(const json &o, double &val) {
+#ifdef TINYGLTF_USE_RAPIDJSON
+  if (o.IsNumber()) {
+    val = o.GetDouble();
+    return true;
+  }
+
+  return false;
+#else
+  if (o.is_number()) {
+    val = o.get<double>();
+    return true;
+  }
+
+  return false;
+#endif
+}
+
+bool GetString(const json &o, std::string &val) {
+#ifdef TINYGLTF_USE_RAPIDJSON
+  if (o.IsString()) {
+    val = o.GetString();
+    return true;
+  }
+
+  return false;
+#else
+  if (o.type() == json::value_t::string) {
+    val = o.get<std::string>();
+    return true;
+  }
+
+  return false;
+#endif
+}
+
+bool IsArray(const json &o) {
+#ifdef TINYGLTF_USE_RAPIDJSON
+  return o.IsArray();
+#else
+  return o.is_array();
+#endif
+}
+
+json_const_array_iterator ArrayBegin(const json &o) {
+#ifdef TINYGLTF_USE_RAPIDJSON
+  return o.Begin();
+#else
+  return o.begin();
+#endif
+}
+
+json_const_array_iterator ArrayEnd(const json &o) {
+#ifdef TINYGLTF_USE_RAPIDJSON
+  return o.End();
+#else
+  return o.end();
+#endif
+}
+
+bool IsObject(const json &o) {
+#ifdef TINYGLTF_USE_RAPIDJSON
+  return o.IsObject();
+#else
+  return o.is_object();
+#endif
+}
+
+json_const_iterator ObjectBegin(const json &o) {
+#ifdef TINYGLTF_USE_RAPIDJSON
+  return o.MemberBegin();
+#else
+  return o.begin();
+#endif
+}
+
+json_const_iterator ObjectEnd(const json &o) {
+#ifdef TINYGLTF_USE_RAPIDJSON
+  return o.MemberEnd();
+#else
+  return o.end();
+#endif
+}
+
+// Making this a const char* results in a pointer to a temporary when
+// TINYGLTF_USE_RAPIDJSON is off.
+std::string GetKey(json_const_iterator &it) {
+#ifdef TINYGLTF_USE_RAPIDJSON
+  return it->name.GetString();
+#else
+  return it.key().c_str();
+#endif
+}
+
+bool FindMember(const json &o, const char *member, json_const_iterator &it) {
+#ifdef TINYGLTF_USE_RAPIDJSON
+  if (!o.IsObject()) {
+    return false;
+  }
+  it = o.FindMember(member);
+  return it != o.MemberEnd();
+#else
+  it = o.find(member);
+  return it != o.end();
+#endif
+}
+
+const json &GetValue(json_const_iterator &it) {
+#ifdef TINYGLTF_USE_RAPIDJSON
+  return it->value;
+#else
+  return it.value();
+#endif
+}
+
+std::string JsonToString(const json &o, int spacing = -1) {
+#ifdef TINYGLTF_USE_RAPIDJSON
+  using namespace rapidjson;
+  StringBuffer buffer;
+  if (spacing == -1) {
+    Writer<StringBuffer> writer(buffer);
+    // TODO: Better error handling.
+    // https://github.com/syoyo/tinygltf/issues/332
+    if (!o.Accept(writer)) {
+      return "tiny_gltf::JsonToString() failed rapidjson conversion";
+    }
+  } else {
+    PrettyWriter<StringBuffer> writer(buffer);
+    writer.SetIndent(' ', uint32_t(spacing));
+    if (!o.Accept(writer)) {
+      return "tiny_gltf::JsonToString() failed rapidjson conversion";
+    }
+  }
+  return buffer.GetString();
+#else
+  return o.dump(spacing);
+#endif
+}
+
+}  // namespace
+
+static bool ParseJsonAsValue(Value *ret, const json &o) {
   Value val{};
 #ifdef TINYGLTF_USE_RAPIDJSON
   using rapidjson::Type;
@@ -3121,603 +5187,2378 @@ static bool ParseJsonAsValue(Value *ret, const json &o) {
       Value::Object value_object;
       for (auto it = o.MemberBegin(); it != o.MemberEnd(); ++it) {
         Value entry;
-        ParseJsonAsValue(&entry, it->value);
+        ParseJsonAsValue(&entry, it->value);
+        if (entry.Type() != NULL_TYPE)
+          value_object.emplace(GetKey(it), std::move(entry));
+      }
+      if (value_object.size() > 0) val = Value(std::move(value_object));
+    } break;
+    case Type::kArrayType: {
+      Value::Array value_array;
+      value_array.reserve(o.Size());
+      for (auto it = o.Begin(); it != o.End(); ++it) {
+        Value entry;
+        ParseJsonAsValue(&entry, *it);
+        if (entry.Type() != NULL_TYPE)
+          value_array.emplace_back(std::move(entry));
+      }
+      if (value_array.size() > 0) val = Value(std::move(value_array));
+    } break;
+    case Type::kStringType:
+      val = Value(std::string(o.GetString()));
+      break;
+    case Type::kFalseType:
+    case Type::kTrueType:
+      val = Value(o.GetBool());
+      break;
+    case Type::kNumberType:
+      if (!o.IsDouble()) {
+        int i = 0;
+        GetInt(o, i);
+        val = Value(i);
+      } else {
+        double d = 0.0;
+        GetDouble(o, d);
+        val = Value(d);
+      }
+      break;
+    case Type::kNullType:
+      break;
+      // all types are covered, so no `case default`
+  }
+#else
+  switch (o.type()) {
+    case json::value_t::object: {
+      Value::Object value_object;
+      for (auto it = o.begin(); it != o.end(); it++) {
+        Value entry;
+        ParseJsonAsValue(&entry, it.value());
+        if (entry.Type() != NULL_TYPE)
+          value_object.emplace(it.key(), std::move(entry));
+      }
+      if (value_object.size() > 0) val = Value(std::move(value_object));
+    } break;
+    case json::value_t::array: {
+      Value::Array value_array;
+      value_array.reserve(o.size());
+      for (auto it = o.begin(); it != o.end(); it++) {
+        Value entry;
+        ParseJsonAsValue(&entry, it.value());
         if (entry.Type() != NULL_TYPE)
-          value_object.emplace(GetKey(it), std::move(entry));
+          value_array.emplace_back(std::move(entry));
+      }
+      if (value_array.size() > 0) val = Value(std::move(value_array));
+    } break;
+    case json::value_t::string:
+      val = Value(o.get<std::string>());
+      break;
+    case json::value_t::boolean:
+      val = Value(o.get<bool>());
+      break;
+    case json::value_t::number_integer:
+    case json::value_t::number_unsigned:
+      val = Value(static_cast<int>(o.get<int64_t>()));
+      break;
+    case json::value_t::number_float:
+      val = Value(o.get<double>());
+      break;
+    case json::value_t::null:
+    case json::value_t::discarded:
+    case json::value_t::binary:
+      // default:
+      break;
+  }
+#endif
+  if (ret) *ret = std::move(val);
+
+  return val.Type() != NULL_TYPE;
+}
+
+static bool ParseExtrasProperty(Value *ret, const json &o) {
+  json_const_iterator it;
+  if (!FindMember(o, "extras", it)) {
+    return false;
+  }
+
+  return ParseJsonAsValue(ret, GetValue(it));
+}
+
+static bool ParseBooleanProperty(bool *ret, std::string *err, const json &o,
+                                 const std::string &property,
+                                 const bool required,
+                                 const std::string &parent_node = "") {
+  json_const_iterator it;
+  if (!FindMember(o, property.c_str(), it)) {
+    if (required) {
+      if (err) {
+        (*err) += "'" + property + "' property is missing";
+        if (!parent_node.empty()) {
+          (*err) += " in " + parent_node;
+        }
+        (*err) += ".\n";
+      }
+    }
+    return false;
+  }
+
+  auto &value = GetValue(it);
+
+  bool isBoolean;
+  bool boolValue = false;
+#ifdef TINYGLTF_USE_RAPIDJSON
+  isBoolean = value.IsBool();
+  if (isBoolean) {
+    boolValue = value.GetBool();
+  }
+#else
+  isBoolean = value.is_boolean();
+  if (isBoolean) {
+    boolValue = value.get<bool>();
+  }
+#endif
+  if (!isBoolean) {
+    if (required) {
+      if (err) {
+        (*err) += "'" + property + "' property is not a bool type.\n";
+      }
+    }
+    return false;
+  }
+
+  if (ret) {
+    (*ret) = boolValue;
+  }
+
+  return true;
+}
+
+static bool ParseIntegerProperty(int *ret, std::string *err, const json &o,
+                                 const std::string &property,
+                                 const bool required,
+                                 const std::string &parent_node = "") {
+  json_const_iterator it;
+  if (!FindMember(o, property.c_str(), it)) {
+    if (required) {
+      if (err) {
+        (*err) += "'" + property + "' property is missing";
+        if (!parent_node.empty()) {
+          (*err) += " in " + parent_node;
+        }
+        (*err) += ".\n";
+      }
+    }
+    return false;
+  }
+
+  int intValue;
+  bool isInt = GetInt(GetValue(it), intValue);
+  if (!isInt) {
+    if (required) {
+      if (err) {
+        (*err) += "'" + property + "' property is not an integer type.\n";
+      }
+    }
+    return false;
+  }
+
+  if (ret) {
+    (*ret) = intValue;
+  }
+
+  return true;
+}
+
+static bool ParseUnsignedProperty(size_t *ret, std::string *err, const json &o,
+                                  const std::string &property,
+                                  const bool required,
+                                  const std::string &parent_node = "") {
+  json_const_iterator it;
+  if (!FindMember(o, property.c_str(), it)) {
+    if (required) {
+      if (err) {
+        (*err) += "'" + property + "' property is missing";
+        if (!parent_node.empty()) {
+          (*err) += " in " + parent_node;
+        }
+        (*err) += ".\n";
+      }
+    }
+    return false;
+  }
+
+  auto &value = GetValue(it);
+
+  size_t uValue = 0;
+  bool isUValue;
+#ifdef TINYGLTF_USE_RAPIDJSON
+  isUValue = false;
+  if (value.IsUint()) {
+    uValue = value.GetUint();
+    isUValue = true;
+  } else if (value.IsUint64()) {
+    uValue = value.GetUint64();
+    isUValue = true;
+  }
+#else
+  isUValue = value.is_number_unsigned();
+  if (isUValue) {
+    uValue = value.get<size_t>();
+  }
+#endif
+  if (!isUValue) {
+    if (required) {
+      if (err) {
+        (*err) += "'" + property + "' property is not a positive integer.\n";
+      }
+    }
+    return false;
+  }
+
+  if (ret) {
+    (*ret) = uValue;
+  }
+
+  return true;
+}
+
+static bool ParseNumberProperty(double *ret, std::string *err, const json &o,
+                                const std::string &property,
+                                const bool required,
+                                const std::string &parent_node = "") {
+  json_const_iterator it;
+
+  if (!FindMember(o, property.c_str(), it)) {
+    if (required) {
+      if (err) {
+        (*err) += "'" + property + "' property is missing";
+        if (!parent_node.empty()) {
+          (*err) += " in " + parent_node;
+        }
+        (*err) += ".\n";
+      }
+    }
+    return false;
+  }
+
+  double numberValue;
+  bool isNumber = GetNumber(GetValue(it), numberValue);
+
+  if (!isNumber) {
+    if (required) {
+      if (err) {
+        (*err) += "'" + property + "' property is not a number type.\n";
+      }
+    }
+    return false;
+  }
+
+  if (ret) {
+    (*ret) = numberValue;
+  }
+
+  return true;
+}
+
+static bool ParseNumberArrayProperty(std::vector<double> *ret, std::string *err,
+                                     const json &o, const std::string &property,
+                                     bool required,
+                                     const std::string &parent_node = "") {
+  json_const_iterator it;
+  if (!FindMember(o, property.c_str(), it)) {
+    if (required) {
+      if (err) {
+        (*err) += "'" + property + "' property is missing";
+        if (!parent_node.empty()) {
+          (*err) += " in " + parent_node;
+        }
+        (*err) += ".\n";
+      }
+    }
+    return false;
+  }
+
+  if (!IsArray(GetValue(it))) {
+    if (required) {
+      if (err) {
+        (*err) += "'" + property + "' property is not an array";
+        if (!parent_node.empty()) {
+          (*err) += " in " + parent_node;
+        }
+        (*err) += ".\n";
+      }
+    }
+    return false;
+  }
+
+  ret->clear();
+  auto end = ArrayEnd(GetValue(it));
+  for (auto i = ArrayBegin(GetValue(it)); i != end; ++i) {
+    double numberValue;
+    const bool isNumber = GetNumber(*i, numberValue);
+    if (!isNumber) {
+      if (required) {
+        if (err) {
+          (*err) += "'" + property + "' property is not a number.\n";
+          if (!parent_node.empty()) {
+            (*err) += " in " + parent_node;
+          }
+          (*err) += ".\n";
+        }
+      }
+      return false;
+    }
+    ret->push_back(numberValue);
+  }
+
+  return true;
+}
+
+static bool ParseIntegerArrayProperty(std::vector<int> *ret, std::string *err,
+                                      const json &o,
+                                      const std::string &property,
+                                      bool required,
+                                      const std::string &parent_node = "") {
+  json_const_iterator it;
+  if (!FindMember(o, property.c_str(), it)) {
+    if (required) {
+      if (err) {
+        (*err) += "'" + property + "' property is missing";
+        if (!parent_node.empty()) {
+          (*err) += " in " + parent_node;
+        }
+        (*err) += ".\n";
+      }
+    }
+    return false;
+  }
+
+  if (!IsArray(GetValue(it))) {
+    if (required) {
+      if (err) {
+        (*err) += "'" + property + "' property is not an array";
+        if (!parent_node.empty()) {
+          (*err) += " in " + parent_node;
+        }
+        (*err) += ".\n";
+      }
+    }
+    return false;
+  }
+
+  ret->clear();
+  auto end = ArrayEnd(GetValue(it));
+  for (auto i = ArrayBegin(GetValue(it)); i != end; ++i) {
+    int numberValue;
+    bool isNumber = GetInt(*i, numberValue);
+    if (!isNumber) {
+      if (required) {
+        if (err) {
+          (*err) += "'" + property + "' property is not an integer type.\n";
+          if (!parent_node.empty()) {
+            (*err) += " in " + parent_node;
+          }
+          (*err) += ".\n";
+        }
+      }
+      return false;
+    }
+    ret->push_back(numberValue);
+  }
+
+  return true;
+}
+
+static bool ParseStringProperty(
+    std::string *ret, std::string *err, const json &o,
+    const std::string &property, bool required,
+    const std::string &parent_node = std::string()) {
+  json_const_iterator it;
+  if (!FindMember(o, property.c_str(), it)) {
+    if (required) {
+      if (err) {
+        (*err) += "'" + property + "' property is missing";
+        if (parent_node.empty()) {
+          (*err) += ".\n";
+        } else {
+          (*err) += " in `" + parent_node + "'.\n";
+        }
+      }
+    }
+    return false;
+  }
+
+  std::string strValue;
+  if (!GetString(GetValue(it), strValue)) {
+    if (required) {
+      if (err) {
+        (*err) += "'" + property + "' property is not a string type.\n";
+      }
+    }
+    return false;
+  }
+
+  if (ret) {
+    (*ret) = std::move(strValue);
+  }
+
+  return true;
+}
+
+static bool ParseStringIntegerProperty(std::map<std::string, int> *ret,
+                                       std::string *err, const json &o,
+                                       const std::string &property,
+                                       bool required,
+                                       const std::string &parent = "") {
+  json_const_iterator it;
+  if (!FindMember(o, property.c_str(), it)) {
+    if (required) {
+      if (err) {
+        if (!parent.empty()) {
+          (*err) +=
+              "'" + property + "' property is missing in " + parent + ".\n";
+        } else {
+          (*err) += "'" + property + "' property is missing.\n";
+        }
+      }
+    }
+    return false;
+  }
+
+  const json &dict = GetValue(it);
+
+  // Make sure we are dealing with an object / dictionary.
+  if (!IsObject(dict)) {
+    if (required) {
+      if (err) {
+        (*err) += "'" + property + "' property is not an object.\n";
+      }
+    }
+    return false;
+  }
+
+  ret->clear();
+
+  json_const_iterator dictIt(ObjectBegin(dict));
+  json_const_iterator dictItEnd(ObjectEnd(dict));
+
+  for (; dictIt != dictItEnd; ++dictIt) {
+    int intVal;
+    if (!GetInt(GetValue(dictIt), intVal)) {
+      if (required) {
+        if (err) {
+          (*err) += "'" + property + "' value is not an integer type.\n";
+        }
+      }
+      return false;
+    }
+
+    // Insert into the list.
+    (*ret)[GetKey(dictIt)] = intVal;
+  }
+  return true;
+}
+
+static bool ParseJSONProperty(std::map<std::string, double> *ret,
+                              std::string *err, const json &o,
+                              const std::string &property, bool required) {
+  json_const_iterator it;
+  if (!FindMember(o, property.c_str(), it)) {
+    if (required) {
+      if (err) {
+        (*err) += "'" + property + "' property is missing. \n'";
+      }
+    }
+    return false;
+  }
+
+  const json &obj = GetValue(it);
+
+  if (!IsObject(obj)) {
+    if (required) {
+      if (err) {
+        (*err) += "'" + property + "' property is not a JSON object.\n";
+      }
+    }
+    return false;
+  }
+
+  ret->clear();
+
+  json_const_iterator it2(ObjectBegin(obj));
+  json_const_iterator itEnd(ObjectEnd(obj));
+  for (; it2 != itEnd; ++it2) {
+    double numVal;
+    if (GetNumber(GetValue(it2), numVal))
+      ret->emplace(std::string(GetKey(it2)), numVal);
+  }
+
+  return true;
+}
+
+static bool ParseParameterProperty(Parameter *param, std::string *err,
+                                   const json &o, const std::string &prop,
+                                   bool required) {
+  // A parameter value can either be a string or an array of either a boolean or
+  // a number. Booleans of any kind aren't supported here. Granted, it
+  // complicates the Parameter structure and breaks it semantically in the sense
+  // that the client probably works off the assumption that if the string is
+  // empty the vector is used, etc. Would a tagged union work?
+  if (ParseStringProperty(&param->string_value, err, o, prop, false)) {
+    // Found string property.
+    return true;
+  } else if (ParseNumberArrayProperty(&param->number_array, err, o, prop,
+                                      false)) {
+    // Found a number array.
+    return true;
+  } else if (ParseNumberProperty(&param->number_value, err, o, prop, false)) {
+    return param->has_number_value = true;
+  } else if (ParseJSONProperty(&param->json_double_value, err, o, prop,
+                               false)) {
+    return true;
+  } else if (ParseBooleanProperty(&param->bool_value, err, o, prop, false)) {
+    return true;
+  } else {
+    if (required) {
+      if (err) {
+        (*err) += "parameter must be a string or number / number array.\n";
+      }
+    }
+    return false;
+  }
+}
+
+static bool ParseExtensionsProperty(ExtensionMap *ret, std::string *err,
+                                    const json &o) {
+  (void)err;
+
+  json_const_iterator it;
+  if (!FindMember(o, "extensions", it)) {
+    return false;
+  }
+
+  auto &obj = GetValue(it);
+  if (!IsObject(obj)) {
+    return false;
+  }
+  ExtensionMap extensions;
+  json_const_iterator extIt = ObjectBegin(obj);  // it.value().begin();
+  json_const_iterator extEnd = ObjectEnd(obj);
+  for (; extIt != extEnd; ++extIt) {
+    auto &itObj = GetValue(extIt);
+    if (!IsObject(itObj)) continue;
+    std::string key(GetKey(extIt));
+    if (!ParseJsonAsValue(&extensions[key], itObj)) {
+      if (!key.empty()) {
+        // create empty object so that an extension object is still of type
+        // object
+        extensions[key] = Value{Value::Object{}};
+      }
+    }
+  }
+  if (ret) {
+    (*ret) = std::move(extensions);
+  }
+  return true;
+}
+
+static bool ParseAsset(Asset *asset, std::string *err, const json &o,
+                       bool store_original_json_for_extras_and_extensions) {
+  ParseStringProperty(&asset->version, err, o, "version", true, "Asset");
+  ParseStringProperty(&asset->generator, err, o, "generator", false, "Asset");
+  ParseStringProperty(&asset->minVersion, err, o, "minVersion", false, "Asset");
+  ParseStringProperty(&asset->copyright, err, o, "copyright", false, "Asset");
+
+  ParseExtensionsProperty(&asset->extensions, err, o);
+
+  // Unity exporter version is added as extra here
+  ParseExtrasProperty(&(asset->extras), o);
+
+  if (store_original_json_for_extras_and_extensions) {
+    {
+      json_const_iterator it;
+      if (FindMember(o, "extensions", it)) {
+        asset->extensions_json_string = JsonToString(GetValue(it));
+      }
+    }
+    {
+      json_const_iterator it;
+      if (FindMember(o, "extras", it)) {
+        asset->extras_json_string = JsonToString(GetValue(it));
+      }
+    }
+  }
+
+  return true;
+}
+
+static bool LoadImageFromURI(Image *image, const int image_idx,
+                             std::string *err, std::string *warn,
+                             const std::string &uri,
+                             const std::string &basedir, FsCallbacks *fs,
+                             LoadImageDataFunction *LoadImageData,
+                             void *load_image_user_data) {
+  std::vector<unsigned char> img;
+
+  if (IsDataURI(uri)) {
+    if (!DecodeDataURI(&img, image->mimeType, uri, 0, false)) {
+      if (err) {
+        (*err) += "Failed to decode 'uri' for image[" +
+                  std::to_string(image_idx) + "] name = [" + image->name +
+                  "]\n";
+      }
+      return false;
+    }
+  } else {
+    // Assume external file
+    // Keep texture path (for textures that cannot be decoded)
+    image->uri = uri;
+#ifdef TINYGLTF_NO_EXTERNAL_IMAGE
+    return true;
+#endif
+    std::string decoded_uri = dlib::urldecode(uri);
+    if (!LoadExternalFile(&img, err, warn, decoded_uri, basedir,
+                          /* required */ false, /* required bytes */ 0,
+                          /* checksize */ false, fs)) {
+      if (warn) {
+        (*warn) += "Failed to load external 'uri' for image[" +
+                   std::to_string(image_idx) + "] name = [" + image->name +
+                   "]\n";
+      }
+      // If the image cannot be loaded, keep uri as image->uri.
+      return true;
+    }
+
+    if (img.empty()) {
+      if (warn) {
+        (*warn) += "Image data is empty for image[" +
+                   std::to_string(image_idx) + "] name = [" + image->name +
+                   "] \n";
+      }
+      return false;
+    }
+  }
+
+  if (*LoadImageData == nullptr) {
+    if (err) {
+      (*err) += "No LoadImageData callback specified.\n";
+    }
+    return false;
+  }
+  return (*LoadImageData)(image, image_idx, err, warn, 0, 0, &img.at(0),
+                          static_cast<int>(img.size()), load_image_user_data);
+}
+
+static bool ParseImage(Image *image, const int image_idx, std::string *err,
+                       std::string *warn, const json &o,
+                       bool store_original_json_for_extras_and_extensions,
+                       const std::string &basedir, FsCallbacks *fs,
+                       LoadImageDataFunction *LoadImageData = nullptr,
+                       void *load_image_user_data = nullptr) {
+  // A glTF image must either reference a bufferView or an image uri
+
+  // schema says oneOf [`bufferView`, `uri`]
+  // TODO(syoyo): Check the type of each parameters.
+  json_const_iterator it;
+  bool hasBufferView = FindMember(o, "bufferView", it);
+  bool hasURI = FindMember(o, "uri", it);
+
+  ParseStringProperty(&image->name, err, o, "name", false);
+
+  if (hasBufferView && hasURI) {
+    // Should not both defined.
+    if (err) {
+      (*err) +=
+          "Only one of `bufferView` or `uri` should be defined, but both are "
+          "defined for image[" +
+          std::to_string(image_idx) + "] name = \"" + image->name + "\"\n";
+    }
+    return false;
+  }
+
+  if (!hasBufferView && !hasURI) {
+    if (err) {
+      (*err) += "Neither required `bufferView` nor `uri` defined for image[" +
+                std::to_string(image_idx) + "] name = \"" + image->name +
+                "\"\n";
+    }
+    return false;
+  }
+
+  ParseExtensionsProperty(&image->extensions, err, o);
+  ParseExtrasProperty(&image->extras, o);
+
+  if (store_original_json_for_extras_and_extensions) {
+    {
+      json_const_iterator eit;
+      if (FindMember(o, "extensions", eit)) {
+        image->extensions_json_string = JsonToString(GetValue(eit));
+      }
+    }
+    {
+      json_const_iterator eit;
+      if (FindMember(o, "extras", eit)) {
+        image->extras_json_string = JsonToString(GetValue(eit));
+      }
+    }
+  }
+
+  if (hasBufferView) {
+    int bufferView = -1;
+    if (!ParseIntegerProperty(&bufferView, err, o, "bufferView", true)) {
+      if (err) {
+        (*err) += "Failed to parse `bufferView` for image[" +
+                  std::to_string(image_idx) + "] name = \"" + image->name +
+                  "\"\n";
+      }
+      return false;
+    }
+
+    std::string mime_type;
+    ParseStringProperty(&mime_type, err, o, "mimeType", false);
+
+    int width = 0;
+    ParseIntegerProperty(&width, err, o, "width", false);
+
+    int height = 0;
+    ParseIntegerProperty(&height, err, o, "height", false);
+
+    // Just only save some information here. Loading actual image data from
+    // bufferView is done after this `ParseImage` function.
+    image->bufferView = bufferView;
+    image->mimeType = mime_type;
+    image->width = width;
+    image->height = height;
+
+    return true;
+  }
+
+  // Parse URI & Load image data.
+
+  std::string uri;
+  std::string tmp_err;
+  if (!ParseStringProperty(&uri, &tmp_err, o, "uri", true)) {
+    if (err) {
+      (*err) += "Failed to parse `uri` for image[" + std::to_string(image_idx) +
+                "] name = \"" + image->name + "\".\n";
+    }
+    return false;
+  }
+
+  return LoadImageFromURI(image, image_idx, err, warn, uri, basedir, fs,
+                          LoadImageData, load_image_user_data);
+}
+
+static bool ParseTexture(Texture *texture, std::string *err, const json &o,
+                         bool store_original_json_for_extras_and_extensions,
+                         const std::string &basedir) {
+  (void)basedir;
+  int sampler = -1;
+  int source = -1;
+  ParseIntegerProperty(&sampler, err, o, "sampler", false);
+
+  ParseIntegerProperty(&source, err, o, "source", false);
+
+  texture->sampler = sampler;
+  texture->source = source;
+
+  ParseExtensionsProperty(&texture->extensions, err, o);
+  ParseExtrasProperty(&texture->extras, o);
+
+  if (store_original_json_for_extras_and_extensions) {
+    {
+      json_const_iterator it;
+      if (FindMember(o, "extensions", it)) {
+        texture->extensions_json_string = JsonToString(GetValue(it));
+      }
+    }
+    {
+      json_const_iterator it;
+      if (FindMember(o, "extras", it)) {
+        texture->extras_json_string = JsonToString(GetValue(it));
+      }
+    }
+  }
+
+  ParseStringProperty(&texture->name, err, o, "name", false);
+
+  return true;
+}
+
+static bool ParseTextureInfo(
+    TextureInfo *texinfo, std::string *err, const json &o,
+    bool store_original_json_for_extras_and_extensions) {
+  if (texinfo == nullptr) {
+    return false;
+  }
+
+  if (!ParseIntegerProperty(&texinfo->index, err, o, "index",
+                            /* required */ true, "TextureInfo")) {
+    return false;
+  }
+
+  ParseIntegerProperty(&texinfo->texCoord, err, o, "texCoord", false);
+
+  ParseExtensionsProperty(&texinfo->extensions, err, o);
+  ParseExtrasProperty(&texinfo->extras, o);
+
+  if (store_original_json_for_extras_and_extensions) {
+    {
+      json_const_iterator it;
+      if (FindMember(o, "extensions", it)) {
+        texinfo->extensions_json_string = JsonToString(GetValue(it));
+      }
+    }
+    {
+      json_const_iterator it;
+      if (FindMember(o, "extras", it)) {
+        texinfo->extras_json_string = JsonToString(GetValue(it));
+      }
+    }
+  }
+
+  return true;
+}
+
+static bool ParseNormalTextureInfo(
+    NormalTextureInfo *texinfo, std::string *err, const json &o,
+    bool store_original_json_for_extras_and_extensions) {
+  if (texinfo == nullptr) {
+    return false;
+  }
+
+  if (!ParseIntegerProperty(&texinfo->index, err, o, "index",
+                            /* required */ true, "NormalTextureInfo")) {
+    return false;
+  }
+
+  ParseIntegerProperty(&texinfo->texCoord, err, o, "texCoord", false);
+  ParseNumberProperty(&texinfo->scale, err, o, "scale", false);
+
+  ParseExtensionsProperty(&texinfo->extensions, err, o);
+  ParseExtrasProperty(&texinfo->extras, o);
+
+  if (store_original_json_for_extras_and_extensions) {
+    {
+      json_const_iterator it;
+      if (FindMember(o, "extensions", it)) {
+        texinfo->extensions_json_string = JsonToString(GetValue(it));
+      }
+    }
+    {
+      json_const_iterator it;
+      if (FindMember(o, "extras", it)) {
+        texinfo->extras_json_string = JsonToString(GetValue(it));
+      }
+    }
+  }
+
+  return true;
+}
+
+static bool ParseOcclusionTextureInfo(
+    OcclusionTextureInfo *texinfo, std::string *err, const json &o,
+    bool store_original_json_for_extras_and_extensions) {
+  if (texinfo == nullptr) {
+    return false;
+  }
+
+  if (!ParseIntegerProperty(&texinfo->index, err, o, "index",
+                            /* required */ true, "NormalTextureInfo")) {
+    return false;
+  }
+
+  ParseIntegerProperty(&texinfo->texCoord, err, o, "texCoord", false);
+  ParseNumberProperty(&texinfo->strength, err, o, "strength", false);
+
+  ParseExtensionsProperty(&texinfo->extensions, err, o);
+  ParseExtrasProperty(&texinfo->extras, o);
+
+  if (store_original_json_for_extras_and_extensions) {
+    {
+      json_const_iterator it;
+      if (FindMember(o, "extensions", it)) {
+        texinfo->extensions_json_string = JsonToString(GetValue(it));
+      }
+    }
+    {
+      json_const_iterator it;
+      if (FindMember(o, "extras", it)) {
+        texinfo->extras_json_string = JsonToString(GetValue(it));
+      }
+    }
+  }
+
+  return true;
+}
+
+static bool LoadBufferData(Buffer *buffer, std::string *err,
+                           size_t byteLength, FsCallbacks *fs,
+                           const std::string &basedir, bool is_binary,
+                           const unsigned char *bin_data, size_t bin_size) {
+  // having an empty uri for a non embedded image should not be valid
+  if (!is_binary && buffer->uri.empty()) {
+    if (err) {
+      (*err) += "'uri' is missing from non binary glTF file buffer.\n";
+    }
+  }
+
+  if (is_binary) {
+    // Still binary glTF accepts external dataURI.
+    if (!buffer->uri.empty()) {
+      // First try embedded data URI.
+      if (IsDataURI(buffer->uri)) {
+        std::string mime_type;
+        if (!DecodeDataURI(&buffer->data, mime_type, buffer->uri, byteLength,
+                           true)) {
+          if (err) {
+            (*err) +=
+                "Failed to decode 'uri' : " + buffer->uri + " in Buffer\n";
+          }
+          return false;
+        }
+      } else {
+        // External .bin file.
+        std::string decoded_uri = dlib::urldecode(buffer->uri);
+        if (!LoadExternalFile(&buffer->data, err, /* warn */ nullptr,
+                              decoded_uri, basedir, /* required */ true,
+                              byteLength, /* checkSize */ true, fs)) {
+          return false;
+        }
+      }
+    } else {
+      // load data from (embedded) binary data
+
+      if ((bin_size == 0) || (bin_data == nullptr)) {
+        if (err) {
+          (*err) += "Invalid binary data in `Buffer'.\n";
+        }
+        return false;
+      }
+
+      if (byteLength > bin_size) {
+        if (err) {
+          std::stringstream ss;
+          ss << "Invalid `byteLength'. Must be equal or less than binary size: "
+                "`byteLength' = "
+             << byteLength << ", binary size = " << bin_size << std::endl;
+          (*err) += ss.str();
+        }
+        return false;
+      }
+
+      // Read buffer data
+      buffer->data.resize(static_cast<size_t>(byteLength));
+      memcpy(&(buffer->data.at(0)), bin_data, static_cast<size_t>(byteLength));
+    }
+
+  } else {
+    if (IsDataURI(buffer->uri)) {
+      std::string mime_type;
+      if (!DecodeDataURI(&buffer->data, mime_type, buffer->uri, byteLength,
+                         true)) {
+        if (err) {
+          (*err) += "Failed to decode 'uri' : " + buffer->uri + " in Buffer\n";
+        }
+        return false;
+      }
+    } else {
+      // Assume external .bin file.
+      std::string decoded_uri = dlib::urldecode(buffer->uri);
+      if (!LoadExternalFile(&buffer->data, err, /* warn */ nullptr, decoded_uri,
+                            basedir, /* required */ true, byteLength,
+                            /* checkSize */ true, fs)) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+static bool ParseBuffer(Buffer *buffer, std::string *err, const json &o,
+                        bool store_original_json_for_extras_and_extensions,
+                        FsCallbacks *fs, const std::string &basedir,
+                        bool is_binary = false,
+                        const unsigned char *bin_data = nullptr,
+                        size_t bin_size = 0) {
+  size_t byteLength;
+  if (!ParseUnsignedProperty(&byteLength, err, o, "byteLength", true,
+                             "Buffer")) {
+    return false;
+  }
+
+  // In glTF 2.0, uri is not mandatory anymore
+  buffer->uri.clear();
+  ParseStringProperty(&buffer->uri, err, o, "uri", false, "Buffer");
+
+  json_const_iterator type;
+  if (FindMember(o, "type", type)) {
+    std::string typeStr;
+    if (GetString(GetValue(type), typeStr)) {
+      if (typeStr.compare("arraybuffer") == 0) {
+        // buffer.type = "arraybuffer";
+      }
+    }
+  }
+
+  if (!LoadBufferData(buffer, err, byteLength, fs, basedir, is_binary,
+                      bin_data, bin_size)) {
+    return false;
+  }
+
+  ParseStringProperty(&buffer->name, err, o, "name", false);
+
+  ParseExtensionsProperty(&buffer->extensions, err, o);
+  ParseExtrasProperty(&buffer->extras, o);
+
+  if (store_original_json_for_extras_and_extensions) {
+    {
+      json_const_iterator it;
+      if (FindMember(o, "extensions", it)) {
+        buffer->extensions_json_string = JsonToString(GetValue(it));
+      }
+    }
+    {
+      json_const_iterator it;
+      if (FindMember(o, "extras", it)) {
+        buffer->extras_json_string = JsonToString(GetValue(it));
+      }
+    }
+  }
+
+  return true;
+}
+
+static bool ParseBufferView(
+    BufferView *bufferView, std::string *err, const json &o,
+    bool store_original_json_for_extras_and_extensions) {
+  int buffer = -1;
+  if (!ParseIntegerProperty(&buffer, err, o, "buffer", true, "BufferView")) {
+    return false;
+  }
+
+  size_t byteOffset = 0;
+  ParseUnsignedProperty(&byteOffset, err, o, "byteOffset", false);
+
+  size_t byteLength = 1;
+  if (!ParseUnsignedProperty(&byteLength, err, o, "byteLength", true,
+                             "BufferView")) {
+    return false;
+  }
+
+  size_t byteStride = 0;
+  if (!ParseUnsignedProperty(&byteStride, err, o, "byteStride", false)) {
+    // Spec says: When byteStride of referenced bufferView is not defined, it
+    // means that accessor elements are tightly packed, i.e., effective stride
+    // equals the size of the element.
+    // We cannot determine the actual byteStride until Accessor are parsed, thus
+    // set 0(= tightly packed) here(as done in OpenGL's VertexAttribPoiner)
+    byteStride = 0;
+  }
+
+  if ((byteStride > 252) || ((byteStride % 4) != 0)) {
+    if (err) {
+      std::stringstream ss;
+      ss << "Invalid `byteStride' value. `byteStride' must be the multiple of "
+            "4 : "
+         << byteStride << std::endl;
+
+      (*err) += ss.str();
+    }
+    return false;
+  }
+
+  int target = 0;
+  ParseIntegerProperty(&target, err, o, "target", false);
+  if ((target == TINYGLTF_TARGET_ARRAY_BUFFER) ||
+      (target == TINYGLTF_TARGET_ELEMENT_ARRAY_BUFFER)) {
+    // OK
+  } else {
+    target = 0;
+  }
+  bufferView->target = target;
+
+  ParseStringProperty(&bufferView->name, err, o, "name", false);
+
+  ParseExtensionsProperty(&bufferView->extensions, err, o);
+  ParseExtrasProperty(&bufferView->extras, o);
+
+  if (store_original_json_for_extras_and_extensions) {
+    {
+      json_const_iterator it;
+      if (FindMember(o, "extensions", it)) {
+        bufferView->extensions_json_string = JsonToString(GetValue(it));
+      }
+    }
+    {
+      json_const_iterator it;
+      if (FindMember(o, "extras", it)) {
+        bufferView->extras_json_string = JsonToString(GetValue(it));
+      }
+    }
+  }
+
+  bufferView->buffer = buffer;
+  bufferView->byteOffset = byteOffset;
+  bufferView->byteLength = byteLength;
+  bufferView->byteStride = byteStride;
+  return true;
+}
+
+static bool ParseSparseAccessor(Accessor *accessor, std::string *err,
+                                const json &o) {
+  accessor->sparse.isSparse = true;
+
+  int count = 0;
+  if (!ParseIntegerProperty(&count, err, o, "count", true, "SparseAccessor")) {
+    return false;
+  }
+
+  json_const_iterator indices_iterator;
+  json_const_iterator values_iterator;
+  if (!FindMember(o, "indices", indices_iterator)) {
+    (*err) = "the sparse object of this accessor doesn't have indices";
+    return false;
+  }
+
+  if (!FindMember(o, "values", values_iterator)) {
+    (*err) = "the sparse object ob ths accessor doesn't have values";
+    return false;
+  }
+
+  const json &indices_obj = GetValue(indices_iterator);
+  const json &values_obj = GetValue(values_iterator);
+
+  int indices_buffer_view = 0, indices_byte_offset = 0, component_type = 0;
+  if (!ParseIntegerProperty(&indices_buffer_view, err, indices_obj, "bufferView",
+                       true, "SparseAccessor")) {
+    return false;
+  }
+  ParseIntegerProperty(&indices_byte_offset, err, indices_obj, "byteOffset",
+                       false);
+  if (!ParseIntegerProperty(&component_type, err, indices_obj, "componentType",
+                       true, "SparseAccessor")) {
+    return false;
+  }
+
+  int values_buffer_view = 0, values_byte_offset = 0;
+  if (!ParseIntegerProperty(&values_buffer_view, err, values_obj, "bufferView",
+                       true, "SparseAccessor")) {
+    return false;
+  }
+  ParseIntegerProperty(&values_byte_offset, err, values_obj, "byteOffset",
+                       false);
+
+  accessor->sparse.count = count;
+  accessor->sparse.indices.bufferView = indices_buffer_view;
+  accessor->sparse.indices.byteOffset = indices_byte_offset;
+  accessor->sparse.indices.componentType = component_type;
+  accessor->sparse.values.bufferView = values_buffer_view;
+  accessor->sparse.values.byteOffset = values_byte_offset;
+
+  return true;
+}
+
+static bool ParseAccessor(Accessor *accessor, std::string *err, const json &o,
+                          bool store_original_json_for_extras_and_extensions) {
+  int bufferView = -1;
+  ParseIntegerProperty(&bufferView, err, o, "bufferView", false, "Accessor");
+
+  size_t byteOffset = 0;
+  ParseUnsignedProperty(&byteOffset, err, o, "byteOffset", false, "Accessor");
+
+  bool normalized = false;
+  ParseBooleanProperty(&normalized, err, o, "normalized", false, "Accessor");
+
+  size_t componentType = 0;
+  if (!ParseUnsignedProperty(&componentType, err, o, "componentType", true,
+                             "Accessor")) {
+    return false;
+  }
+
+  size_t count = 0;
+  if (!ParseUnsignedProperty(&count, err, o, "count", true, "Accessor")) {
+    return false;
+  }
+
+  std::string type;
+  if (!ParseStringProperty(&type, err, o, "type", true, "Accessor")) {
+    return false;
+  }
+
+  if (type.compare("SCALAR") == 0) {
+    accessor->type = TINYGLTF_TYPE_SCALAR;
+  } else if (type.compare("VEC2") == 0) {
+    accessor->type = TINYGLTF_TYPE_VEC2;
+  } else if (type.compare("VEC3") == 0) {
+    accessor->type = TINYGLTF_TYPE_VEC3;
+  } else if (type.compare("VEC4") == 0) {
+    accessor->type = TINYGLTF_TYPE_VEC4;
+  } else if (type.compare("MAT2") == 0) {
+    accessor->type = TINYGLTF_TYPE_MAT2;
+  } else if (type.compare("MAT3") == 0) {
+    accessor->type = TINYGLTF_TYPE_MAT3;
+  } else if (type.compare("MAT4") == 0) {
+    accessor->type = TINYGLTF_TYPE_MAT4;
+  } else {
+    std::stringstream ss;
+    ss << "Unsupported `type` for accessor object. Got \"" << type << "\"\n";
+    if (err) {
+      (*err) += ss.str();
+    }
+    return false;
+  }
+
+  ParseStringProperty(&accessor->name, err, o, "name", false);
+
+  accessor->minValues.clear();
+  accessor->maxValues.clear();
+  ParseNumberArrayProperty(&accessor->minValues, err, o, "min", false,
+                           "Accessor");
+
+  ParseNumberArrayProperty(&accessor->maxValues, err, o, "max", false,
+                           "Accessor");
+
+  accessor->count = count;
+  accessor->bufferView = bufferView;
+  accessor->byteOffset = byteOffset;
+  accessor->normalized = normalized;
+  {
+    if (componentType >= TINYGLTF_COMPONENT_TYPE_BYTE &&
+        componentType <= TINYGLTF_COMPONENT_TYPE_DOUBLE) {
+      // OK
+      accessor->componentType = int(componentType);
+    } else {
+      std::stringstream ss;
+      ss << "Invalid `componentType` in accessor. Got " << componentType
+         << "\n";
+      if (err) {
+        (*err) += ss.str();
+      }
+      return false;
+    }
+  }
+
+  ParseExtensionsProperty(&(accessor->extensions), err, o);
+  ParseExtrasProperty(&(accessor->extras), o);
+
+  if (store_original_json_for_extras_and_extensions) {
+    {
+      json_const_iterator it;
+      if (FindMember(o, "extensions", it)) {
+        accessor->extensions_json_string = JsonToString(GetValue(it));
+      }
+    }
+    {
+      json_const_iterator it;
+      if (FindMember(o, "extras", it)) {
+        accessor->extras_json_string = JsonToString(GetValue(it));
+      }
+    }
+  }
+
+  // check if accessor has a "sparse" object:
+  json_const_iterator iterator;
+  if (FindMember(o, "sparse", iterator)) {
+    // here this accessor has a "sparse" subobject
+    return ParseSparseAccessor(accessor, err, GetValue(iterator));
+  }
+
+  return true;
+}
+
+#ifdef TINYGLTF_ENABLE_DRACO
+
+static void DecodeIndexBuffer(draco::Mesh *mesh, size_t componentSize,
+                              std::vector<uint8_t> &outBuffer) {
+  if (componentSize == 4) {
+    assert(sizeof(mesh->face(draco::FaceIndex(0))[0]) == componentSize);
+    memcpy(outBuffer.data(), &mesh->face(draco::FaceIndex(0))[0],
+           outBuffer.size());
+  } else {
+    size_t faceStride = componentSize * 3;
+    for (draco::FaceIndex f(0); f < mesh->num_faces(); ++f) {
+      const draco::Mesh::Face &face = mesh->face(f);
+      if (componentSize == 2) {
+        uint16_t indices[3] = {(uint16_t)face[0].value(),
+                               (uint16_t)face[1].value(),
+                               (uint16_t)face[2].value()};
+        memcpy(outBuffer.data() + f.value() * faceStride, &indices[0],
+               faceStride);
+      } else {
+        uint8_t indices[3] = {(uint8_t)face[0].value(),
+                              (uint8_t)face[1].value(),
+                              (uint8_t)face[2].value()};
+        memcpy(outBuffer.data() + f.value() * faceStride, &indices[0],
+               faceStride);
+      }
+    }
+  }
+}
+
+template <typename T>
+static bool GetAttributeForAllPoints(draco::Mesh *mesh,
+                                     const draco::PointAttribute *pAttribute,
+                                     std::vector<uint8_t> &outBuffer) {
+  size_t byteOffset = 0;
+  T values[4] = {0, 0, 0, 0};
+  for (draco::PointIndex i(0); i < mesh->num_points(); ++i) {
+    const draco::AttributeValueIndex val_index = pAttribute->mapped_index(i);
+    if (!pAttribute->ConvertValue<T>(val_index, pAttribute->num_components(),
+                                     values))
+      return false;
+
+    memcpy(outBuffer.data() + byteOffset, &values[0],
+           sizeof(T) * pAttribute->num_components());
+    byteOffset += sizeof(T) * pAttribute->num_components();
+  }
+
+  return true;
+}
+
+static bool GetAttributeForAllPoints(uint32_t componentType, draco::Mesh *mesh,
+                                     const draco::PointAttribute *pAttribute,
+                                     std::vector<uint8_t> &outBuffer) {
+  bool decodeResult = false;
+  switch (componentType) {
+    case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+      decodeResult =
+          GetAttributeForAllPoints<uint8_t>(mesh, pAttribute, outBuffer);
+      break;
+    case TINYGLTF_COMPONENT_TYPE_BYTE:
+      decodeResult =
+          GetAttributeForAllPoints<int8_t>(mesh, pAttribute, outBuffer);
+      break;
+    case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+      decodeResult =
+          GetAttributeForAllPoints<uint16_t>(mesh, pAttribute, outBuffer);
+      break;
+    case TINYGLTF_COMPONENT_TYPE_SHORT:
+      decodeResult =
+          GetAttributeForAllPoints<int16_t>(mesh, pAttribute, outBuffer);
+      break;
+    case TINYGLTF_COMPONENT_TYPE_INT:
+      decodeResult =
+          GetAttributeForAllPoints<int32_t>(mesh, pAttribute, outBuffer);
+      break;
+    case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:
+      decodeResult =
+          GetAttributeForAllPoints<uint32_t>(mesh, pAttribute, outBuffer);
+      break;
+    case TINYGLTF_COMPONENT_TYPE_FLOAT:
+      decodeResult =
+          GetAttributeForAllPoints<float>(mesh, pAttribute, outBuffer);
+      break;
+    case TINYGLTF_COMPONENT_TYPE_DOUBLE:
+      decodeResult =
+          GetAttributeForAllPoints<double>(mesh, pAttribute, outBuffer);
+      break;
+    default:
+      return false;
+  }
+
+  return decodeResult;
+}
+
+static bool ParseDracoExtension(Primitive *primitive, Model *model,
+                                std::string *err,
+                                const Value &dracoExtensionValue) {
+  (void)err;
+  auto bufferViewValue = dracoExtensionValue.Get("bufferView");
+  if (!bufferViewValue.IsInt()) return false;
+  auto attributesValue = dracoExtensionValue.Get("attributes");
+  if (!attributesValue.IsObject()) return false;
+
+  const auto &attributesObject = attributesValue.Get<Value::Object>();
+  int bufferView = bufferViewValue.Get<int>();
+
+  BufferView &view = model->bufferViews[bufferView];
+  Buffer &buffer = model->buffers[view.buffer];
+  // BufferView has already been decoded
+  if (view.dracoDecoded) return true;
+  view.dracoDecoded = true;
+
+  const char *bufferViewData =
+      reinterpret_cast<const char *>(buffer.data.data() + view.byteOffset);
+  size_t bufferViewSize = view.byteLength;
+
+  // decode draco
+  draco::DecoderBuffer decoderBuffer;
+  decoderBuffer.Init(bufferViewData, bufferViewSize);
+  draco::Decoder decoder;
+  auto decodeResult = decoder.DecodeMeshFromBuffer(&decoderBuffer);
+  if (!decodeResult.ok()) {
+    return false;
+  }
+  const std::unique_ptr<draco::Mesh> &mesh = decodeResult.value();
+
+  // create new bufferView for indices
+  if (primitive->indices >= 0) {
+    int32_t componentSize = GetComponentSizeInBytes(
+        model->accessors[primitive->indices].componentType);
+    Buffer decodedIndexBuffer;
+    decodedIndexBuffer.data.resize(mesh->num_faces() * 3 * componentSize);
+
+    DecodeIndexBuffer(mesh.get(), componentSize, decodedIndexBuffer.data);
+
+    model->buffers.emplace_back(std::move(decodedIndexBuffer));
+
+    BufferView decodedIndexBufferView;
+    decodedIndexBufferView.buffer = int(model->buffers.size() - 1);
+    decodedIndexBufferView.byteLength =
+        int(mesh->num_faces() * 3 * componentSize);
+    decodedIndexBufferView.byteOffset = 0;
+    decodedIndexBufferView.byteStride = 0;
+    decodedIndexBufferView.target = TINYGLTF_TARGET_ARRAY_BUFFER;
+    model->bufferViews.emplace_back(std::move(decodedIndexBufferView));
+
+    model->accessors[primitive->indices].bufferView =
+        int(model->bufferViews.size() - 1);
+    model->accessors[primitive->indices].count = int(mesh->num_faces() * 3);
+  }
+
+  for (const auto &attribute : attributesObject) {
+    if (!attribute.second.IsInt()) return false;
+    auto primitiveAttribute = primitive->attributes.find(attribute.first);
+    if (primitiveAttribute == primitive->attributes.end()) return false;
+
+    int dracoAttributeIndex = attribute.second.Get<int>();
+    const auto pAttribute = mesh->GetAttributeByUniqueId(dracoAttributeIndex);
+    const auto componentType =
+        model->accessors[primitiveAttribute->second].componentType;
+
+    // Create a new buffer for this decoded buffer
+    Buffer decodedBuffer;
+    size_t bufferSize = mesh->num_points() * pAttribute->num_components() *
+                        GetComponentSizeInBytes(componentType);
+    decodedBuffer.data.resize(bufferSize);
+
+    if (!GetAttributeForAllPoints(componentType, mesh.get(), pAttribute,
+                                  decodedBuffer.data))
+      return false;
+
+    model->buffers.emplace_back(std::move(decodedBuffer));
+
+    BufferView decodedBufferView;
+    decodedBufferView.buffer = int(model->buffers.size() - 1);
+    decodedBufferView.byteLength = bufferSize;
+    decodedBufferView.byteOffset = pAttribute->byte_offset();
+    decodedBufferView.byteStride = pAttribute->byte_stride();
+    decodedBufferView.target = primitive->indices >= 0
+                                   ? TINYGLTF_TARGET_ELEMENT_ARRAY_BUFFER
+                                   : TINYGLTF_TARGET_ARRAY_BUFFER;
+    model->bufferViews.emplace_back(std::move(decodedBufferView));
+
+    model->accessors[primitiveAttribute->second].bufferView =
+        int(model->bufferViews.size() - 1);
+    model->accessors[primitiveAttribute->second].count =
+        int(mesh->num_points());
+  }
+
+  return true;
+}
+#endif
+
+static bool ParsePrimitive(Primitive *primitive, Model *model, std::string *err,
+                           const json &o,
+                           bool store_original_json_for_extras_and_extensions) {
+  int material = -1;
+  ParseIntegerProperty(&material, err, o, "material", false);
+  primitive->material = material;
+
+  int mode = TINYGLTF_MODE_TRIANGLES;
+  ParseIntegerProperty(&mode, err, o, "mode", false);
+  primitive->mode = mode;  // Why only triangled were supported ?
+
+  int indices = -1;
+  ParseIntegerProperty(&indices, err, o, "indices", false);
+  primitive->indices = indices;
+  if (!ParseStringIntegerProperty(&primitive->attributes, err, o, "attributes",
+                                  true, "Primitive")) {
+    return false;
+  }
+
+  // Look for morph targets
+  json_const_iterator targetsObject;
+  if (FindMember(o, "targets", targetsObject) &&
+      IsArray(GetValue(targetsObject))) {
+    auto targetsObjectEnd = ArrayEnd(GetValue(targetsObject));
+    for (json_const_array_iterator i = ArrayBegin(GetValue(targetsObject));
+         i != targetsObjectEnd; ++i) {
+      std::map<std::string, int> targetAttribues;
+
+      const json &dict = *i;
+      if (IsObject(dict)) {
+        json_const_iterator dictIt(ObjectBegin(dict));
+        json_const_iterator dictItEnd(ObjectEnd(dict));
+
+        for (; dictIt != dictItEnd; ++dictIt) {
+          int iVal;
+          if (GetInt(GetValue(dictIt), iVal))
+            targetAttribues[GetKey(dictIt)] = iVal;
+        }
+        primitive->targets.emplace_back(std::move(targetAttribues));
+      }
+    }
+  }
+
+  ParseExtrasProperty(&(primitive->extras), o);
+  ParseExtensionsProperty(&primitive->extensions, err, o);
+
+  if (store_original_json_for_extras_and_extensions) {
+    {
+      json_const_iterator it;
+      if (FindMember(o, "extensions", it)) {
+        primitive->extensions_json_string = JsonToString(GetValue(it));
+      }
+    }
+    {
+      json_const_iterator it;
+      if (FindMember(o, "extras", it)) {
+        primitive->extras_json_string = JsonToString(GetValue(it));
+      }
+    }
+  }
+
+#ifdef TINYGLTF_ENABLE_DRACO
+  auto dracoExtension =
+      primitive->extensions.find("KHR_draco_mesh_compression");
+  if (dracoExtension != primitive->extensions.end()) {
+    ParseDracoExtension(primitive, model, err, dracoExtension->second);
+  }
+#else
+  (void)model;
+#endif
+
+  return true;
+}
+
+static bool ParseMesh(Mesh *mesh, Model *model, std::string *err, const json &o,
+                      bool store_original_json_for_extras_and_extensions) {
+  ParseStringProperty(&mesh->name, err, o, "name", false);
+
+  mesh->primitives.clear();
+  json_const_iterator primObject;
+  if (FindMember(o, "primitives", primObject) &&
+      IsArray(GetValue(primObject))) {
+    json_const_array_iterator primEnd = ArrayEnd(GetValue(primObject));
+    for (json_const_array_iterator i = ArrayBegin(GetValue(primObject));
+         i != primEnd; ++i) {
+      Primitive primitive;
+      if (ParsePrimitive(&primitive, model, err, *i,
+                         store_original_json_for_extras_and_extensions)) {
+        // Only add the primitive if the parsing succeeds.
+        mesh->primitives.emplace_back(std::move(primitive));
+      }
+    }
+  }
+
+  // Should probably check if has targets and if dimensions fit
+  ParseNumberArrayProperty(&mesh->weights, err, o, "weights", false);
+
+  ParseExtensionsProperty(&mesh->extensions, err, o);
+  ParseExtrasProperty(&(mesh->extras), o);
+
+  if (store_original_json_for_extras_and_extensions) {
+    {
+      json_const_iterator it;
+      if (FindMember(o, "extensions", it)) {
+        mesh->extensions_json_string = JsonToString(GetValue(it));
+      }
+    }
+    {
+      json_const_iterator it;
+      if (FindMember(o, "extras", it)) {
+        mesh->extras_json_string = JsonToString(GetValue(it));
+      }
+    }
+  }
+
+  return true;
+}
+
+static bool ParseNode(Node *node, std::string *err, const json &o,
+                      bool store_original_json_for_extras_and_extensions) {
+  ParseStringProperty(&node->name, err, o, "name", false);
+
+  int skin = -1;
+  ParseIntegerProperty(&skin, err, o, "skin", false);
+  node->skin = skin;
+
+  // Matrix and T/R/S are exclusive
+  if (!ParseNumberArrayProperty(&node->matrix, err, o, "matrix", false)) {
+    ParseNumberArrayProperty(&node->rotation, err, o, "rotation", false);
+    ParseNumberArrayProperty(&node->scale, err, o, "scale", false);
+    ParseNumberArrayProperty(&node->translation, err, o, "translation", false);
+  }
+
+  int camera = -1;
+  ParseIntegerProperty(&camera, err, o, "camera", false);
+  node->camera = camera;
+
+  int mesh = -1;
+  ParseIntegerProperty(&mesh, err, o, "mesh", false);
+  node->mesh = mesh;
+
+  node->children.clear();
+  ParseIntegerArrayProperty(&node->children, err, o, "children", false);
+
+  ParseNumberArrayProperty(&node->weights, err, o, "weights", false);
+
+  ParseExtensionsProperty(&node->extensions, err, o);
+  ParseExtrasProperty(&(node->extras), o);
+
+  if (store_original_json_for_extras_and_extensions) {
+    {
+      json_const_iterator it;
+      if (FindMember(o, "extensions", it)) {
+        node->extensions_json_string = JsonToString(GetValue(it));
       }
-      if (value_object.size() > 0) val = Value(std::move(value_object));
-    } break;
-    case Type::kArrayType: {
-      Value::Array value_array;
-      value_array.reserve(o.Size());
-      for (auto it = o.Begin(); it != o.End(); ++it) {
-        Value entry;
-        ParseJsonAsValue(&entry, *it);
-        if (entry.Type() != NULL_TYPE)
-          value_array.emplace_back(std::move(entry));
+    }
+    {
+      json_const_iterator it;
+      if (FindMember(o, "extras", it)) {
+        node->extras_json_string = JsonToString(GetValue(it));
       }
-      if (value_array.size() > 0) val = Value(std::move(value_array));
-    } break;
-    case Type::kStringType:
-      val = Value(std::string(o.GetString()));
-      break;
-    case Type::kFalseType:
-    case Type::kTrueType:
-      val = Value(o.GetBool());
-      break;
-    case Type::kNumberType:
-      if (!o.IsDouble()) {
-        int i = 0;
-        GetInt(o, i);
-        val = Value(i);
-      } else {
-        double d = 0.0;
-        GetDouble(o, d);
-        val = Value(d);
+    }
+  }
+
+  return true;
+}
+
+static bool ParseScene(Scene *scene, std::string *err, const json &o,
+                       bool store_original_json_for_extras_and_extensions) {
+  std::vector<int> nodes;
+  ParseIntegerArrayProperty(&nodes, err, o, "nodes", false);
+
+  scene->nodes = std::move(nodes);
+
+  ParseStringProperty(&scene->name, err, o, "name", false);
+
+  ParseExtensionsProperty(&scene->extensions, err, o);
+  ParseExtrasProperty(&scene->extras, o);
+
+  if (store_original_json_for_extras_and_extensions) {
+    {
+      json_const_iterator it;
+      if (FindMember(o, "extensions", it)) {
+        scene->extensions_json_string = JsonToString(GetValue(it));
       }
-      break;
-    case Type::kNullType:
-      break;
-      // all types are covered, so no `case default`
+    }
+    {
+      json_const_iterator it;
+      if (FindMember(o, "extras", it)) {
+        scene->extras_json_string = JsonToString(GetValue(it));
+      }
+    }
   }
-#else
-  switch (o.type()) {
-    case json::value_t::object: {
-      Value::Object value_object;
-      for (auto it = o.begin(); it != o.end(); it++) {
-        Value entry;
-        ParseJsonAsValue(&entry, it.value());
-        if (entry.Type() != NULL_TYPE)
-          value_object.emplace(it.key(), std::move(entry));
+
+  return true;
+}
+
+static bool ParsePbrMetallicRoughness(
+    PbrMetallicRoughness *pbr, std::string *err, const json &o,
+    bool store_original_json_for_extras_and_extensions) {
+  if (pbr == nullptr) {
+    return false;
+  }
+
+  std::vector<double> baseColorFactor;
+  if (ParseNumberArrayProperty(&baseColorFactor, err, o, "baseColorFactor",
+                               /* required */ false)) {
+    if (baseColorFactor.size() != 4) {
+      if (err) {
+        (*err) +=
+            "Array length of `baseColorFactor` parameter in "
+            "pbrMetallicRoughness must be 4, but got " +
+            std::to_string(baseColorFactor.size()) + "\n";
+      }
+      return false;
+    }
+    pbr->baseColorFactor = baseColorFactor;
+  }
+
+  {
+    json_const_iterator it;
+    if (FindMember(o, "baseColorTexture", it)) {
+      ParseTextureInfo(&pbr->baseColorTexture, err, GetValue(it),
+                       store_original_json_for_extras_and_extensions);
+    }
+  }
+
+  {
+    json_const_iterator it;
+    if (FindMember(o, "metallicRoughnessTexture", it)) {
+      ParseTextureInfo(&pbr->metallicRoughnessTexture, err, GetValue(it),
+                       store_original_json_for_extras_and_extensions);
+    }
+  }
+
+  ParseNumberProperty(&pbr->metallicFactor, err, o, "metallicFactor", false);
+  ParseNumberProperty(&pbr->roughnessFactor, err, o, "roughnessFactor", false);
+
+  ParseExtensionsProperty(&pbr->extensions, err, o);
+  ParseExtrasProperty(&pbr->extras, o);
+
+  if (store_original_json_for_extras_and_extensions) {
+    {
+      json_const_iterator it;
+      if (FindMember(o, "extensions", it)) {
+        pbr->extensions_json_string = JsonToString(GetValue(it));
+      }
+    }
+    {
+      json_const_iterator it;
+      if (FindMember(o, "extras", it)) {
+        pbr->extras_json_string = JsonToString(GetValue(it));
+      }
+    }
+  }
+
+  return true;
+}
+
+static bool ParseMaterial(Material *material, std::string *err, const json &o,
+                          bool store_original_json_for_extras_and_extensions) {
+  ParseStringProperty(&material->name, err, o, "name", /* required */ false);
+
+  if (ParseNumberArrayProperty(&material->emissiveFactor, err, o,
+                               "emissiveFactor",
+                               /* required */ false)) {
+    if (material->emissiveFactor.size() != 3) {
+      if (err) {
+        (*err) +=
+            "Array length of `emissiveFactor` parameter in "
+            "material must be 3, but got " +
+            std::to_string(material->emissiveFactor.size()) + "\n";
+      }
+      return false;
+    }
+  } else {
+    // fill with default values
+    material->emissiveFactor = {0.0, 0.0, 0.0};
+  }
+
+  ParseStringProperty(&material->alphaMode, err, o, "alphaMode",
+                      /* required */ false);
+  ParseNumberProperty(&material->alphaCutoff, err, o, "alphaCutoff",
+                      /* required */ false);
+  ParseBooleanProperty(&material->doubleSided, err, o, "doubleSided",
+                       /* required */ false);
+
+  {
+    json_const_iterator it;
+    if (FindMember(o, "pbrMetallicRoughness", it)) {
+      ParsePbrMetallicRoughness(&material->pbrMetallicRoughness, err,
+                                GetValue(it),
+                                store_original_json_for_extras_and_extensions);
+    }
+  }
+
+  {
+    json_const_iterator it;
+    if (FindMember(o, "normalTexture", it)) {
+      ParseNormalTextureInfo(&material->normalTexture, err, GetValue(it),
+                             store_original_json_for_extras_and_extensions);
+    }
+  }
+
+  {
+    json_const_iterator it;
+    if (FindMember(o, "occlusionTexture", it)) {
+      ParseOcclusionTextureInfo(&material->occlusionTexture, err, GetValue(it),
+                                store_original_json_for_extras_and_extensions);
+    }
+  }
+
+  {
+    json_const_iterator it;
+    if (FindMember(o, "emissiveTexture", it)) {
+      ParseTextureInfo(&material->emissiveTexture, err, GetValue(it),
+                       store_original_json_for_extras_and_extensions);
+    }
+  }
+
+  // Old code path. For backward compatibility, we still store material values
+  // as Parameter. This will create duplicated information for
+  // example(pbrMetallicRoughness), but should be neglible in terms of memory
+  // consumption.
+  // TODO(syoyo): Remove in the next major release.
+  material->values.clear();
+  material->additionalValues.clear();
+
+  json_const_iterator it(ObjectBegin(o));
+  json_const_iterator itEnd(ObjectEnd(o));
+
+  for (; it != itEnd; ++it) {
+    std::string key(GetKey(it));
+    if (key == "pbrMetallicRoughness") {
+      if (IsObject(GetValue(it))) {
+        const json &values_object = GetValue(it);
+
+        json_const_iterator itVal(ObjectBegin(values_object));
+        json_const_iterator itValEnd(ObjectEnd(values_object));
+
+        for (; itVal != itValEnd; ++itVal) {
+          Parameter param;
+          if (ParseParameterProperty(&param, err, values_object, GetKey(itVal),
+                                     false)) {
+            material->values.emplace(GetKey(itVal), std::move(param));
+          }
+        }
+      }
+    } else if (key == "extensions" || key == "extras") {
+      // done later, skip, otherwise poorly parsed contents will be saved in the
+      // parametermap and serialized again later
+    } else {
+      Parameter param;
+      if (ParseParameterProperty(&param, err, o, key, false)) {
+        // names of materials have already been parsed. Putting it in this map
+        // doesn't correctly reflext the glTF specification
+        if (key != "name")
+          material->additionalValues.emplace(std::move(key), std::move(param));
+      }
+    }
+  }
+
+  material->extensions.clear();
+  ParseExtensionsProperty(&material->extensions, err, o);
+  ParseExtrasProperty(&(material->extras), o);
+
+  if (store_original_json_for_extras_and_extensions) {
+    {
+      json_const_iterator eit;
+      if (FindMember(o, "extensions", eit)) {
+        material->extensions_json_string = JsonToString(GetValue(eit));
       }
-      if (value_object.size() > 0) val = Value(std::move(value_object));
-    } break;
-    case json::value_t::array: {
-      Value::Array value_array;
-      value_array.reserve(o.size());
-      for (auto it = o.begin(); it != o.end(); it++) {
-        Value entry;
-        ParseJsonAsValue(&entry, it.value());
-        if (entry.Type() != NULL_TYPE)
-          value_array.emplace_back(std::move(entry));
+    }
+    {
+      json_const_iterator eit;
+      if (FindMember(o, "extras", eit)) {
+        material->extras_json_string = JsonToString(GetValue(eit));
       }
-      if (value_array.size() > 0) val = Value(std::move(value_array));
-    } break;
-    case json::value_t::string:
-      val = Value(o.get<std::string>());
-      break;
-    case json::value_t::boolean:
-      val = Value(o.get<bool>());
-      break;
-    case json::value_t::number_integer:
-    case json::value_t::number_unsigned:
-      val = Value(static_cast<int>(o.get<int64_t>()));
-      break;
-    case json::value_t::number_float:
-      val = Value(o.get<double>());
-      break;
-    case json::value_t::null:
-    case json::value_t::discarded:
-    case json::value_t::binary:
-      // default:
-      break;
+    }
   }
-#endif
-  if (ret) *ret = std::move(val);
 
-  return val.Type() != NULL_TYPE;
+  return true;
 }
 
-static bool ParseExtrasProperty(Value *ret, const json &o) {
-  json_const_iterator it;
-  if (!FindMember(o, "extras", it)) {
+static bool ParseAnimationChannel(
+    AnimationChannel *channel, std::string *err, const json &o,
+    bool store_original_json_for_extras_and_extensions) {
+  int samplerIndex = -1;
+  int targetIndex = -1;
+  if (!ParseIntegerProperty(&samplerIndex, err, o, "sampler", true,
+                            "AnimationChannel")) {
+    if (err) {
+      (*err) += "`sampler` field is missing in animation channels\n";
+    }
     return false;
   }
 
-  return ParseJsonAsValue(ret, GetValue(it));
-}
+  json_const_iterator targetIt;
+  if (FindMember(o, "target", targetIt) && IsObject(GetValue(targetIt))) {
+    const json &target_object = GetValue(targetIt);
 
-static bool ParseBooleanProperty(bool *ret, std::string *err, const json &o,
-                                 const std::string &property,
-                                 const bool required,
-                                 const std::string &parent_node = "") {
-  json_const_iterator it;
-  if (!FindMember(o, property.c_str(), it)) {
-    if (required) {
+    if (!ParseIntegerProperty(&targetIndex, err, target_object, "node", true)) {
       if (err) {
-        (*err) += "'" + property + "' property is missing";
-        if (!parent_node.empty()) {
-          (*err) += " in " + parent_node;
-        }
-        (*err) += ".\n";
+        (*err) += "`node` field is missing in animation.channels.target\n";
       }
+      return false;
     }
-    return false;
-  }
-
-  auto &value = GetValue(it);
 
-  bool isBoolean;
-  bool boolValue = false;
-#ifdef TINYGLTF_USE_RAPIDJSON
-  isBoolean = value.IsBool();
-  if (isBoolean) {
-    boolValue = value.GetBool();
-  }
-#else
-  isBoolean = value.is_boolean();
-  if (isBoolean) {
-    boolValue = value.get<bool>();
-  }
-#endif
-  if (!isBoolean) {
-    if (required) {
+    if (!ParseStringProperty(&channel->target_path, err, target_object, "path",
+                             true)) {
       if (err) {
-        (*err) += "'" + property + "' property is not a bool type.\n";
+        (*err) += "`path` field is missing in animation.channels.target\n";
+      }
+      return false;
+    }
+    ParseExtensionsProperty(&channel->target_extensions, err, target_object);
+    if (store_original_json_for_extras_and_extensions) {
+      json_const_iterator it;
+      if (FindMember(target_object, "extensions", it)) {
+        channel->target_extensions_json_string = JsonToString(GetValue(it));
       }
     }
-    return false;
   }
 
-  if (ret) {
-    (*ret) = boolValue;
+  channel->sampler = samplerIndex;
+  channel->target_node = targetIndex;
+
+  ParseExtensionsProperty(&channel->extensions, err, o);
+  ParseExtrasProperty(&(channel->extras), o);
+
+  if (store_original_json_for_extras_and_extensions) {
+    {
+      json_const_iterator it;
+      if (FindMember(o, "extensions", it)) {
+        channel->extensions_json_string = JsonToString(GetValue(it));
+      }
+    }
+    {
+      json_const_iterator it;
+      if (FindMember(o, "extras", it)) {
+        channel->extras_json_string = JsonToString(GetValue(it));
+      }
+    }
   }
 
   return true;
 }
 
-static bool ParseIntegerProperty(int *ret, std::string *err, const json &o,
-                                 const std::string &property,
-                                 const bool required,
-                                 const std::string &parent_node = "") {
-  json_const_iterator it;
-  if (!FindMember(o, property.c_str(), it)) {
-    if (required) {
-      if (err) {
-        (*err) += "'" + property + "' property is missing";
-        if (!parent_node.empty()) {
-          (*err) += " in " + parent_node;
+static bool ParseAnimation(Animation *animation, std::string *err,
+                           const json &o,
+                           bool store_original_json_for_extras_and_extensions) {
+  {
+    json_const_iterator channelsIt;
+    if (FindMember(o, "channels", channelsIt) &&
+        IsArray(GetValue(channelsIt))) {
+      json_const_array_iterator channelEnd = ArrayEnd(GetValue(channelsIt));
+      for (json_const_array_iterator i = ArrayBegin(GetValue(channelsIt));
+           i != channelEnd; ++i) {
+        AnimationChannel channel;
+        if (ParseAnimationChannel(
+                &channel, err, *i,
+                store_original_json_for_extras_and_extensions)) {
+          // Only add the channel if the parsing succeeds.
+          animation->channels.emplace_back(std::move(channel));
         }
-        (*err) += ".\n";
       }
     }
-    return false;
   }
 
-  int intValue;
-  bool isInt = GetInt(GetValue(it), intValue);
-  if (!isInt) {
-    if (required) {
-      if (err) {
-        (*err) += "'" + property + "' property is not an integer type.\n";
-      }
-    }
-    return false;
-  }
+  {
+    json_const_iterator samplerIt;
+    if (FindMember(o, "samplers", samplerIt) && IsArray(GetValue(samplerIt))) {
+      const json &sampler_array = GetValue(samplerIt);
+
+      json_const_array_iterator it = ArrayBegin(sampler_array);
+      json_const_array_iterator itEnd = ArrayEnd(sampler_array);
+
+      for (; it != itEnd; ++it) {
+        const json &s = *it;
+
+        AnimationSampler sampler;
+        int inputIndex = -1;
+        int outputIndex = -1;
+        if (!ParseIntegerProperty(&inputIndex, err, s, "input", true)) {
+          if (err) {
+            (*err) += "`input` field is missing in animation.sampler\n";
+          }
+          return false;
+        }
+        ParseStringProperty(&sampler.interpolation, err, s, "interpolation",
+                            false);
+        if (!ParseIntegerProperty(&outputIndex, err, s, "output", true)) {
+          if (err) {
+            (*err) += "`output` field is missing in animation.sampler\n";
+          }
+          return false;
+        }
+        sampler.input = inputIndex;
+        sampler.output = outputIndex;
+        ParseExtensionsProperty(&(sampler.extensions), err, o);
+        ParseExtrasProperty(&(sampler.extras), s);
+
+        if (store_original_json_for_extras_and_extensions) {
+          {
+            json_const_iterator eit;
+            if (FindMember(o, "extensions", eit)) {
+              sampler.extensions_json_string = JsonToString(GetValue(eit));
+            }
+          }
+          {
+            json_const_iterator eit;
+            if (FindMember(o, "extras", eit)) {
+              sampler.extras_json_string = JsonToString(GetValue(eit));
+            }
+          }
+        }
+
+        animation->samplers.emplace_back(std::move(sampler));
+      }
+    }
+  }
+
+  ParseStringProperty(&animation->name, err, o, "name", false);
+
+  ParseExtensionsProperty(&animation->extensions, err, o);
+  ParseExtrasProperty(&(animation->extras), o);
+
+  if (store_original_json_for_extras_and_extensions) {
+    {
+      json_const_iterator it;
+      if (FindMember(o, "extensions", it)) {
+        animation->extensions_json_string = JsonToString(GetValue(it));
+      }
+    }
+    {
+      json_const_iterator it;
+      if (FindMember(o, "extras", it)) {
+        animation->extras_json_string = JsonToString(GetValue(it));
+      }
+    }
+  }
+
+  return true;
+}
+
+static bool ParseSampler(Sampler *sampler, std::string *err, const json &o,
+                         bool store_original_json_for_extras_and_extensions) {
+  ParseStringProperty(&sampler->name, err, o, "name", false);
+
+  int minFilter = -1;
+  int magFilter = -1;
+  int wrapS = TINYGLTF_TEXTURE_WRAP_REPEAT;
+  int wrapT = TINYGLTF_TEXTURE_WRAP_REPEAT;
+  //int wrapR = TINYGLTF_TEXTURE_WRAP_REPEAT;
+  ParseIntegerProperty(&minFilter, err, o, "minFilter", false);
+  ParseIntegerProperty(&magFilter, err, o, "magFilter", false);
+  ParseIntegerProperty(&wrapS, err, o, "wrapS", false);
+  ParseIntegerProperty(&wrapT, err, o, "wrapT", false);
+  //ParseIntegerProperty(&wrapR, err, o, "wrapR", false);  // tinygltf extension
+
+  // TODO(syoyo): Check the value is alloed one.
+  // (e.g. we allow 9728(NEAREST), but don't allow 9727)
 
-  if (ret) {
-    (*ret) = intValue;
-  }
+  sampler->minFilter = minFilter;
+  sampler->magFilter = magFilter;
+  sampler->wrapS = wrapS;
+  sampler->wrapT = wrapT;
+  //sampler->wrapR = wrapR;
 
-  return true;
-}
+  ParseExtensionsProperty(&(sampler->extensions), err, o);
+  ParseExtrasProperty(&(sampler->extras), o);
 
-static bool ParseUnsignedProperty(size_t *ret, std::string *err, const json &o,
-                                  const std::string &property,
-                                  const bool required,
-                                  const std::string &parent_node = "") {
-  json_const_iterator it;
-  if (!FindMember(o, property.c_str(), it)) {
-    if (required) {
-      if (err) {
-        (*err) += "'" + property + "' property is missing";
-        if (!parent_node.empty()) {
-          (*err) += " in " + parent_node;
-        }
-        (*err) += ".\n";
+  if (store_original_json_for_extras_and_extensions) {
+    {
+      json_const_iterator it;
+      if (FindMember(o, "extensions", it)) {
+        sampler->extensions_json_string = JsonToString(GetValue(it));
       }
     }
-    return false;
-  }
-
-  auto &value = GetValue(it);
-
-  size_t uValue = 0;
-  bool isUValue;
-#ifdef TINYGLTF_USE_RAPIDJSON
-  isUValue = false;
-  if (value.IsUint()) {
-    uValue = value.GetUint();
-    isUValue = true;
-  } else if (value.IsUint64()) {
-    uValue = value.GetUint64();
-    isUValue = true;
-  }
-#else
-  isUValue = value.is_number_unsigned();
-  if (isUValue) {
-    uValue = value.get<size_t>();
-  }
-#endif
-  if (!isUValue) {
-    if (required) {
-      if (err) {
-        (*err) += "'" + property + "' property is not a positive integer.\n";
+    {
+      json_const_iterator it;
+      if (FindMember(o, "extras", it)) {
+        sampler->extras_json_string = JsonToString(GetValue(it));
       }
     }
-    return false;
-  }
-
-  if (ret) {
-    (*ret) = uValue;
   }
 
   return true;
 }
 
-static bool ParseNumberProperty(double *ret, std::string *err, const json &o,
-                                const std::string &property,
-                                const bool required,
-                                const std::string &parent_node = "") {
-  json_const_iterator it;
+static bool ParseSkin(Skin *skin, std::string *err, const json &o,
+                      bool store_original_json_for_extras_and_extensions) {
+  ParseStringProperty(&skin->name, err, o, "name", false, "Skin");
 
-  if (!FindMember(o, property.c_str(), it)) {
-    if (required) {
-      if (err) {
-        (*err) += "'" + property + "' property is missing";
-        if (!parent_node.empty()) {
-          (*err) += " in " + parent_node;
-        }
-        (*err) += ".\n";
-      }
-    }
+  std::vector<int> joints;
+  if (!ParseIntegerArrayProperty(&joints, err, o, "joints", false, "Skin")) {
     return false;
   }
+  skin->joints = std::move(joints);
 
-  double numberValue;
-  bool isNumber = GetNumber(GetValue(it), numberValue);
+  int skeleton = -1;
+  ParseIntegerProperty(&skeleton, err, o, "skeleton", false, "Skin");
+  skin->skeleton = skeleton;
 
-  if (!isNumber) {
-    if (required) {
-      if (err) {
-        (*err) += "'" + property + "' property is not a number type.\n";
+  int invBind = -1;
+  ParseIntegerProperty(&invBind, err, o, "inverseBindMatrices", true, "Skin");
+  skin->inverseBindMatrices = invBind;
+
+  ParseExtensionsProperty(&(skin->extensions), err, o);
+  ParseExtrasProperty(&(skin->extras), o);
+
+  if (store_original_json_for_extras_and_extensions) {
+    {
+      json_const_iterator it;
+      if (FindMember(o, "extensions", it)) {
+        skin->extensions_json_string = JsonToString(GetValue(it));
+      }
+    }
+    {
+      json_const_iterator it;
+      if (FindMember(o, "extras", it)) {
+        skin->extras_json_string = JsonToString(GetValue(it));
       }
     }
-    return false;
-  }
-
-  if (ret) {
-    (*ret) = numberValue;
   }
 
   return true;
 }
 
-static bool ParseNumberArrayProperty(std::vector<double> *ret, std::string *err,
-                                     const json &o, const std::string &property,
-                                     bool required,
-                                     const std::string &parent_node = "") {
-  json_const_iterator it;
-  if (!FindMember(o, property.c_str(), it)) {
-    if (required) {
-      if (err) {
-        (*err) += "'" + property + "' property is missing";
-        if (!parent_node.empty()) {
-          (*err) += " in " + parent_node;
-        }
-        (*err) += ".\n";
-      }
-    }
+static bool ParsePerspectiveCamera(
+    PerspectiveCamera *camera, std::string *err, const json &o,
+    bool store_original_json_for_extras_and_extensions) {
+  double yfov = 0.0;
+  if (!ParseNumberProperty(&yfov, err, o, "yfov", true, "OrthographicCamera")) {
     return false;
   }
 
-  if (!IsArray(GetValue(it))) {
-    if (required) {
-      if (err) {
-        (*err) += "'" + property + "' property is not an array";
-        if (!parent_node.empty()) {
-          (*err) += " in " + parent_node;
-        }
-        (*err) += ".\n";
-      }
-    }
+  double znear = 0.0;
+  if (!ParseNumberProperty(&znear, err, o, "znear", true,
+                           "PerspectiveCamera")) {
     return false;
   }
 
-  ret->clear();
-  auto end = ArrayEnd(GetValue(it));
-  for (auto i = ArrayBegin(GetValue(it)); i != end; ++i) {
-    double numberValue;
-    const bool isNumber = GetNumber(*i, numberValue);
-    if (!isNumber) {
-      if (required) {
-        if (err) {
-          (*err) += "'" + property + "' property is not a number.\n";
-          if (!parent_node.empty()) {
-            (*err) += " in " + parent_node;
-          }
-          (*err) += ".\n";
-        }
-      }
-      return false;
-    }
-    ret->push_back(numberValue);
-  }
+  double aspectRatio = 0.0;  // = invalid
+  ParseNumberProperty(&aspectRatio, err, o, "aspectRatio", false,
+                      "PerspectiveCamera");
 
-  return true;
-}
+  double zfar = 0.0;  // = invalid
+  ParseNumberProperty(&zfar, err, o, "zfar", false, "PerspectiveCamera");
 
-static bool ParseIntegerArrayProperty(std::vector<int> *ret, std::string *err,
-                                      const json &o,
-                                      const std::string &property,
-                                      bool required,
-                                      const std::string &parent_node = "") {
-  json_const_iterator it;
-  if (!FindMember(o, property.c_str(), it)) {
-    if (required) {
-      if (err) {
-        (*err) += "'" + property + "' property is missing";
-        if (!parent_node.empty()) {
-          (*err) += " in " + parent_node;
-        }
-        (*err) += ".\n";
+  camera->aspectRatio = aspectRatio;
+  camera->zfar = zfar;
+  camera->yfov = yfov;
+  camera->znear = znear;
+
+  ParseExtensionsProperty(&camera->extensions, err, o);
+  ParseExtrasProperty(&(camera->extras), o);
+
+  if (store_original_json_for_extras_and_extensions) {
+    {
+      json_const_iterator it;
+      if (FindMember(o, "extensions", it)) {
+        camera->extensions_json_string = JsonToString(GetValue(it));
       }
     }
-    return false;
-  }
-
-  if (!IsArray(GetValue(it))) {
-    if (required) {
-      if (err) {
-        (*err) += "'" + property + "' property is not an array";
-        if (!parent_node.empty()) {
-          (*err) += " in " + parent_node;
-        }
-        (*err) += ".\n";
+    {
+      json_const_iterator it;
+      if (FindMember(o, "extras", it)) {
+        camera->extras_json_string = JsonToString(GetValue(it));
       }
     }
-    return false;
   }
 
-  ret->clear();
-  auto end = ArrayEnd(GetValue(it));
-  for (auto i = ArrayBegin(GetValue(it)); i != end; ++i) {
-    int numberValue;
-    bool isNumber = GetInt(*i, numberValue);
-    if (!isNumber) {
-      if (required) {
-        if (err) {
-          (*err) += "'" + property + "' property is not an integer type.\n";
-          if (!parent_node.empty()) {
-            (*err) += " in " + parent_node;
-          }
-          (*err) += ".\n";
-        }
+  // TODO(syoyo): Validate parameter values.
+
+  return true;
+}
+
+static bool ParseSpotLight(SpotLight *light, std::string *err, const json &o,
+                           bool store_original_json_for_extras_and_extensions) {
+  ParseNumberProperty(&light->innerConeAngle, err, o, "innerConeAngle", false);
+  ParseNumberProperty(&light->outerConeAngle, err, o, "outerConeAngle", false);
+
+  ParseExtensionsProperty(&light->extensions, err, o);
+  ParseExtrasProperty(&light->extras, o);
+
+  if (store_original_json_for_extras_and_extensions) {
+    {
+      json_const_iterator it;
+      if (FindMember(o, "extensions", it)) {
+        light->extensions_json_string = JsonToString(GetValue(it));
+      }
+    }
+    {
+      json_const_iterator it;
+      if (FindMember(o, "extras", it)) {
+        light->extras_json_string = JsonToString(GetValue(it));
       }
-      return false;
     }
-    ret->push_back(numberValue);
   }
 
+  // TODO(syoyo): Validate parameter values.
+
   return true;
 }
 
-static bool ParseStringProperty(
-    std::string *ret, std::string *err, const json &o,
-    const std::string &property, bool required,
-    const std::string &parent_node = std::string()) {
-  json_const_iterator it;
-  if (!FindMember(o, property.c_str(), it)) {
-    if (required) {
-      if (err) {
-        (*err) += "'" + property + "' property is missing";
-        if (parent_node.empty()) {
-          (*err) += ".\n";
-        } else {
-          (*err) += " in `" + parent_node + "'.\n";
-        }
-      }
-    }
+static bool ParseOrthographicCamera(
+    OrthographicCamera *camera, std::string *err, const json &o,
+    bool store_original_json_for_extras_and_extensions) {
+  double xmag = 0.0;
+  if (!ParseNumberProperty(&xmag, err, o, "xmag", true, "OrthographicCamera")) {
     return false;
   }
 
-  std::string strValue;
-  if (!GetString(GetValue(it), strValue)) {
-    if (required) {
-      if (err) {
-        (*err) += "'" + property + "' property is not a string type.\n";
-      }
-    }
+  double ymag = 0.0;
+  if (!ParseNumberProperty(&ymag, err, o, "ymag", true, "OrthographicCamera")) {
     return false;
   }
 
-  if (ret) {
-    (*ret) = std::move(strValue);
+  double zfar = 0.0;
+  if (!ParseNumberProperty(&zfar, err, o, "zfar", true, "OrthographicCamera")) {
+    return false;
   }
 
-  return true;
-}
-
-static bool ParseStringIntegerProperty(std::map<std::string, int> *ret,
-                                       std::string *err, const json &o,
-                                       const std::string &property,
-                                       bool required,
-                                       const std::string &parent = "") {
-  json_const_iterator it;
-  if (!FindMember(o, property.c_str(), it)) {
-    if (required) {
-      if (err) {
-        if (!parent.empty()) {
-          (*err) +=
-              "'" + property + "' property is missing in " + parent + ".\n";
-        } else {
-          (*err) += "'" + property + "' property is missing.\n";
-        }
-      }
-    }
+  double znear = 0.0;
+  if (!ParseNumberProperty(&znear, err, o, "znear", true,
+                           "OrthographicCamera")) {
     return false;
   }
 
-  const json &dict = GetValue(it);
+  ParseExtensionsProperty(&camera->extensions, err, o);
+  ParseExtrasProperty(&(camera->extras), o);
 
-  // Make sure we are dealing with an object / dictionary.
-  if (!IsObject(dict)) {
-    if (required) {
-      if (err) {
-        (*err) += "'" + property + "' property is not an object.\n";
+  if (store_original_json_for_extras_and_extensions) {
+    {
+      json_const_iterator it;
+      if (FindMember(o, "extensions", it)) {
+        camera->extensions_json_string = JsonToString(GetValue(it));
+      }
+    }
+    {
+      json_const_iterator it;
+      if (FindMember(o, "extras", it)) {
+        camera->extras_json_string = JsonToString(GetValue(it));
       }
     }
-    return false;
   }
 
-  ret->clear();
-
-  json_const_iterator dictIt(ObjectBegin(dict));
-  json_const_iterator dictItEnd(ObjectEnd(dict));
+  camera->xmag = xmag;
+  camera->ymag = ymag;
+  camera->zfar = zfar;
+  camera->znear = znear;
 
-  for (; dictIt != dictItEnd; ++dictIt) {
-    int intVal;
-    if (!GetInt(GetValue(dictIt), intVal)) {
-      if (required) {
-        if (err) {
-          (*err) += "'" + property + "' value is not an integer type.\n";
-        }
-      }
-      return false;
-    }
+  // TODO(syoyo): Validate parameter values.
 
-    // Insert into the list.
-    (*ret)[GetKey(dictIt)] = intVal;
-  }
   return true;
 }
 
-static bool ParseJSONProperty(std::map<std::string, double> *ret,
-                              std::string *err, const json &o,
-                              const std::string &property, bool required) {
-  json_const_iterator it;
-  if (!FindMember(o, property.c_str(), it)) {
-    if (required) {
-      if (err) {
-        (*err) += "'" + property + "' property is missing. \n'";
-      }
-    }
+static bool ParseCamera(Camera *camera, std::string *err, const json &o,
+                        bool store_original_json_for_extras_and_extensions) {
+  if (!ParseStringProperty(&camera->type, err, o, "type", true, "Camera")) {
     return false;
   }
 
-  const json &obj = GetValue(it);
-
-  if (!IsObject(obj)) {
-    if (required) {
+  if (camera->type.compare("orthographic") == 0) {
+    json_const_iterator orthoIt;
+    if (!FindMember(o, "orthographic", orthoIt)) {
       if (err) {
-        (*err) += "'" + property + "' property is not a JSON object.\n";
+        std::stringstream ss;
+        ss << "Orhographic camera description not found." << std::endl;
+        (*err) += ss.str();
       }
+      return false;
     }
-    return false;
-  }
-
-  ret->clear();
 
-  json_const_iterator it2(ObjectBegin(obj));
-  json_const_iterator itEnd(ObjectEnd(obj));
-  for (; it2 != itEnd; ++it2) {
-    double numVal;
-    if (GetNumber(GetValue(it2), numVal))
-      ret->emplace(std::string(GetKey(it2)), numVal);
-  }
+    const json &v = GetValue(orthoIt);
+    if (!IsObject(v)) {
+      if (err) {
+        std::stringstream ss;
+        ss << "\"orthographic\" is not a JSON object." << std::endl;
+        (*err) += ss.str();
+      }
+      return false;
+    }
 
-  return true;
-}
+    if (!ParseOrthographicCamera(
+            &camera->orthographic, err, v,
+            store_original_json_for_extras_and_extensions)) {
+      return false;
+    }
+  } else if (camera->type.compare("perspective") == 0) {
+    json_const_iterator perspIt;
+    if (!FindMember(o, "perspective", perspIt)) {
+      if (err) {
+        std::stringstream ss;
+        ss << "Perspective camera description not found." << std::endl;
+        (*err) += ss.str();
+      }
+      return false;
+    }
 
-static bool ParseParameterProperty(Parameter *param, std::string *err,
-                                   const json &o, const std::string &prop,
-                                   bool required) {
-  // A parameter value can either be a string or an array of either a boolean or
-  // a number. Booleans of any kind aren't supported here. Granted, it
-  // complicates the Parameter structure and breaks it semantically in the sense
-  // that the client probably works off the assumption that if the string is
-  // empty the vector is used, etc. Would a tagged union work?
-  if (ParseStringProperty(&param->string_value, err, o, prop, false)) {
-    // Found string property.
-    return true;
-  } else if (ParseNumberArrayProperty(&param->number_array, err, o, prop,
-                                      false)) {
-    // Found a number array.
-    return true;
-  } else if (ParseNumberProperty(&param->number_value, err, o, prop, false)) {
-    return param->has_number_value = true;
-  } else if (ParseJSONProperty(&param->json_double_value, err, o, prop,
-                               false)) {
-    return true;
-  } else if (ParseBooleanProperty(&param->bool_value, err, o, prop, false)) {
-    return true;
-  } else {
-    if (required) {
+    const json &v = GetValue(perspIt);
+    if (!IsObject(v)) {
       if (err) {
-        (*err) += "parameter must be a string or number / number array.\n";
+        std::stringstream ss;
+        ss << "\"perspective\" is not a JSON object." << std::endl;
+        (*err) += ss.str();
       }
+      return false;
+    }
+
+    if (!ParsePerspectiveCamera(
+            &camera->perspective, err, v,
+            store_original_json_for_extras_and_extensions)) {
+      return false;
+    }
+  } else {
+    if (err) {
+      std::stringstream ss;
+      ss << "Invalid camera type: \"" << camera->type
+         << "\". Must be \"perspective\" or \"orthographic\"" << std::endl;
+      (*err) += ss.str();
     }
     return false;
   }
-}
 
-static bool ParseExtensionsProperty(ExtensionMap *ret, std::string *err,
-                                    const json &o) {
-  (void)err;
+  ParseStringProperty(&camera->name, err, o, "name", false);
 
-  json_const_iterator it;
-  if (!FindMember(o, "extensions", it)) {
-    return false;
-  }
+  ParseExtensionsProperty(&camera->extensions, err, o);
+  ParseExtrasProperty(&(camera->extras), o);
 
-  auto &obj = GetValue(it);
-  if (!IsObject(obj)) {
-    return false;
-  }
-  ExtensionMap extensions;
-  json_const_iterator extIt = ObjectBegin(obj);  // it.value().begin();
-  json_const_iterator extEnd = ObjectEnd(obj);
-  for (; extIt != extEnd; ++extIt) {
-    auto &itObj = GetValue(extIt);
-    if (!IsObject(itObj)) continue;
-    std::string key(GetKey(extIt));
-    if (!ParseJsonAsValue(&extensions[key], itObj)) {
-      if (!key.empty()) {
-        // create empty object so that an extension object is still of type
-        // object
-        extensions[key] = Value{Value::Object{}};
+  if (store_original_json_for_extras_and_extensions) {
+    {
+      json_const_iterator it;
+      if (FindMember(o, "extensions", it)) {
+        camera->extensions_json_string = JsonToString(GetValue(it));
+      }
+    }
+    {
+      json_const_iterator it;
+      if (FindMember(o, "extras", it)) {
+        camera->extras_json_string = JsonToString(GetValue(it));
       }
     }
   }
-  if (ret) {
-    (*ret) = std::move(extensions);
-  }
+
   return true;
 }
 
-static bool ParseAsset(Asset *asset, std::string *err, const json &o,
+static bool ParseLight(Light *light, std::string *err, const json &o,
                        bool store_original_json_for_extras_and_extensions) {
-  ParseStringProperty(&asset->version, err, o, "version", true, "Asset");
-  ParseStringProperty(&asset->generator, err, o, "generator", false, "Asset");
-  ParseStringProperty(&asset->minVersion, err, o, "minVersion", false, "Asset");
-  ParseStringProperty(&asset->copyright, err, o, "copyright", false, "Asset");
+  if (!ParseStringProperty(&light->type, err, o, "type", true)) {
+    return false;
+  }
 
-  ParseExtensionsProperty(&asset->extensions, err, o);
+  if (light->type == "spot") {
+    json_const_iterator spotIt;
+    if (!FindMember(o, "spot", spotIt)) {
+      if (err) {
+        std::stringstream ss;
+        ss << "Spot light description not found." << std::endl;
+        (*err) += ss.str();
+      }
+      return false;
+    }
 
-  // Unity exporter version is added as extra here
-  ParseExtrasProperty(&(asset->extras), o);
+    const json &v = GetValue(spotIt);
+    if (!IsObject(v)) {
+      if (err) {
+        std::stringstream ss;
+        ss << "\"spot\" is not a JSON object." << std::endl;
+        (*err) += ss.str();
+      }
+      return false;
+    }
+
+    if (!ParseSpotLight(&light->spot, err, v,
+                        store_original_json_for_extras_and_extensions)) {
+      return false;
+    }
+  }
+
+  ParseStringProperty(&light->name, err, o, "name", false);
+  ParseNumberArrayProperty(&light->color, err, o, "color", false);
+  ParseNumberProperty(&light->range, err, o, "range", false);
+  ParseNumberProperty(&light->intensity, err, o, "intensity", false);
+  ParseExtensionsProperty(&light->extensions, err, o);
+  ParseExtrasProperty(&(light->extras), o);
 
   if (store_original_json_for_extras_and_extensions) {
     {
       json_const_iterator it;
       if (FindMember(o, "extensions", it)) {
-        asset->extensions_json_string = JsonToString(GetValue(it));
+        light->extensions_json_string = JsonToString(GetValue(it));
       }
     }
     {
       json_const_iterator it;
       if (FindMember(o, "extras", it)) {
-        asset->extras_json_string = JsonToString(GetValue(it));
+        light->extras_json_string = JsonToString(GetValue(it));
       }
     }
   }
@@ -3725,1074 +7566,1819 @@ static bool ParseAsset(Asset *asset, std::string *err, const json &o,
   return true;
 }
 
-static bool ParseImage(Image *image, const int image_idx, std::string *err,
-                       std::string *warn, const json &o,
-                       bool store_original_json_for_extras_and_extensions,
-                       const std::string &basedir, FsCallbacks *fs,
-                       LoadImageDataFunction *LoadImageData = nullptr,
-                       void *load_image_user_data = nullptr) {
-  // A glTF image must either reference a bufferView or an image uri
+///////////////////////
+// Streaming parser
+///////////////////////
+//
+// Used instead of the JSON DOM when TinyGLTF::SetStreamingParser(true) is
+// set. The document is validated in one pass and then read straight into
+// Model. Members of every glTF object are resolved to fixed slots with a
+// perfect hash of the key (the member switch would not compile if two keys of
+// one object collided), so no DOM is built and no member is looked up by
+// string compare. Only the types a large document has many of (buffers,
+// buffer views, accessors, meshes, nodes and images) have Stream* parsers,
+// which mirror the Parse* functions above, error messages included. Every
+// other object is parsed into a small DOM and read by its Parse* function.
 
-  // schema says oneOf [`bufferView`, `uri`]
-  // TODO(syoyo): Check the type of each parameters.
-  json_const_iterator it;
-  bool hasBufferView = FindMember(o, "bufferView", it);
-  bool hasURI = FindMember(o, "uri", it);
+namespace {
 
-  ParseStringProperty(&image->name, err, o, "name", false);
+// FNV-1a
+constexpr uint32_t StreamKeyHash(const char *s, uint32_t h = 2166136261u) {
+  return (*s == '\0')
+             ? h
+             : StreamKeyHash(s + 1, (h ^ static_cast<uint32_t>(
+                                             static_cast<unsigned char>(*s))) *
+                                        16777619u);
+}
 
-  if (hasBufferView && hasURI) {
-    // Should not both defined.
-    if (err) {
-      (*err) +=
-          "Only one of `bufferView` or `uri` should be defined, but both are "
-          "defined for image[" +
-          std::to_string(image_idx) + "] name = \"" + image->name + "\"\n";
+struct StreamKey {
+  const char *data;
+  size_t size;
+  uint32_t hash;
+
+  bool operator==(const char *s) const {
+    return (strlen(s) == size) && (memcmp(data, s, size) == 0);
+  }
+};
+
+// Source text of one JSON value. Empty when a member is not present.
+struct JsonSpan {
+  const char *begin;
+  const char *end;
+
+  JsonSpan() : begin(nullptr), end(nullptr) {}
+  JsonSpan(const char *b, const char *e) : begin(b), end(e) {}
+
+  bool empty() const { return begin == nullptr; }
+};
+
+// Number classified like the JSON DOM does: integers without a sign are
+// unsigned, negative integers are signed and everything else (fractions,
+// exponents, out of range integers) is a double.
+struct JsonNumber {
+  enum Kind { kUnsigned, kInteger, kFloat };
+
+  Kind kind;
+  uint64_t u;
+  int64_t i;
+  double d;
+
+  bool IsInteger() const { return kind != kFloat; }
+};
+
+class JsonReader {
+ public:
+  enum Type { kEnd, kNull, kBool, kNumber, kString, kArray, kObject };
+
+  JsonReader(const char *begin, const char *end)
+      : begin_(begin), cur_(begin), end_(end) {}
+  explicit JsonReader(const JsonSpan &span)
+      : begin_(span.begin), cur_(span.begin), end_(span.end) {}
+
+
+  Type Peek() {
+    SkipWhitespace();
+    if (cur_ == end_) return kEnd;
+    switch (*cur_) {
+      case '{':
+        return kObject;
+      case '[':
+        return kArray;
+      case '"':
+        return kString;
+      case 't':
+      case 'f':
+        return kBool;
+      case 'n':
+        return kNull;
+      default:
+        return kNumber;
+    }
+  }
+
+  // Checks the syntax of the next value and moves past it. The other
+  // functions assume validated input.
+  bool Validate(std::string *err);
+
+  // Fails unless only whitespace is left.
+  bool ValidateEnd(std::string *err) {
+    SkipWhitespace();
+    return (cur_ == end_) || Fail(err, "unexpected content after the value");
+  }
+
+  JsonSpan Skip();
+
+  bool EnterObject() {
+    if (Peek() != kObject) return false;
+    ++cur_;
+    first_ = true;
+    return true;
+  }
+
+  bool EnterArray() {
+    if (Peek() != kArray) return false;
+    ++cur_;
+    first_ = true;
+    return true;
+  }
+
+  // The key is valid until the next call.
+  bool NextMember(StreamKey *key);
+  bool NextElement();
+
+  bool ReadBool(bool *value) {
+    if (Peek() != kBool) return false;
+    (*value) = (*cur_ == 't');
+    cur_ += (*value) ? 4 : 5;
+    return true;
+  }
+
+  bool ReadNumber(JsonNumber *number);
+  bool ReadString(std::string *value);
+
+ private:
+  static bool IsDigit(char c) { return (c >= '0') && (c <= '9'); }
+
+  void SkipWhitespace() {
+    while ((cur_ != end_) && ((*cur_ == ' ') || (*cur_ == '\n') ||
+                              (*cur_ == '\r') || (*cur_ == '\t'))) {
+      ++cur_;
     }
-    return false;
   }
 
-  if (!hasBufferView && !hasURI) {
-    if (err) {
-      (*err) += "Neither required `bufferView` nor `uri` defined for image[" +
-                std::to_string(image_idx) + "] name = \"" + image->name +
-                "\"\n";
+  void SkipString();
+  void Unescape(const char *p, std::string *out);
+
+  bool Fail(std::string *err, const char *message);
+  bool ValidateKey(std::string *err);
+  bool ValidateScalar(std::string *err);
+  bool ValidateString(std::string *err);
+  bool ValidateNumber(std::string *err);
+  bool ValidateLiteral(std::string *err, const char *literal);
+
+  const char *begin_;
+  const char *cur_;
+  const char *end_;
+  bool first_ = false;
+  std::string key_;
+};
+
+bool JsonReader::Fail(std::string *err, const char *message) {
+  if (err) {
+    int line = 1;
+    int column = 1;
+    for (const char *p = begin_; p != cur_; ++p) {
+      if (*p == '\n') {
+        ++line;
+        column = 1;
+      } else {
+        ++column;
+      }
     }
-    return false;
+    (*err) = "JSON parse error at line " + std::to_string(line) +
+             ", column " + std::to_string(column) + ": " + message + "\n";
   }
+  return false;
+}
 
-  ParseExtensionsProperty(&image->extensions, err, o);
-  ParseExtrasProperty(&image->extras, o);
+bool JsonReader::Validate(std::string *err) {
+  std::vector<char> stack;
 
-  if (store_original_json_for_extras_and_extensions) {
-    {
-      json_const_iterator eit;
-      if (FindMember(o, "extensions", eit)) {
-        image->extensions_json_string = JsonToString(GetValue(eit));
+  for (;;) {
+    SkipWhitespace();
+    if (cur_ == end_) return Fail(err, "unexpected end of input");
+
+    char c = *cur_;
+    if ((c == '{') || (c == '[')) {
+      ++cur_;
+      SkipWhitespace();
+      if ((cur_ == end_) || (*cur_ != ((c == '{') ? '}' : ']'))) {
+        stack.push_back(c);
+        if ((c == '{') && !ValidateKey(err)) return false;
+        continue;
       }
+      ++cur_;
+    } else if (!ValidateScalar(err)) {
+      return false;
     }
-    {
-      json_const_iterator eit;
-      if (FindMember(o, "extras", eit)) {
-        image->extras_json_string = JsonToString(GetValue(eit));
+
+    // A value is complete, close every container it completes.
+    for (;;) {
+      if (stack.empty()) return true;
+
+      SkipWhitespace();
+      if (cur_ == end_) return Fail(err, "unexpected end of input");
+
+      char open = stack.back();
+      if (*cur_ == ',') {
+        ++cur_;
+        if ((open == '{') && !ValidateKey(err)) return false;
+        break;
       }
+      if (*cur_ != ((open == '{') ? '}' : ']')) {
+        return Fail(err, (open == '{') ? "expected ',' or '}'"
+                                       : "expected ',' or ']'");
+      }
+      ++cur_;
+      stack.pop_back();
     }
   }
+}
 
-  if (hasBufferView) {
-    int bufferView = -1;
-    if (!ParseIntegerProperty(&bufferView, err, o, "bufferView", true)) {
-      if (err) {
-        (*err) += "Failed to parse `bufferView` for image[" +
-                  std::to_string(image_idx) + "] name = \"" + image->name +
-                  "\"\n";
-      }
+bool JsonReader::ValidateKey(std::string *err) {
+  SkipWhitespace();
+  if ((cur_ == end_) || (*cur_ != '"')) {
+    return Fail(err, "expected an object key");
+  }
+  if (!ValidateString(err)) return false;
+  SkipWhitespace();
+  if ((cur_ == end_) || (*cur_ != ':')) return Fail(err, "expected ':'");
+  ++cur_;
+  return true;
+}
+
+bool JsonReader::ValidateScalar(std::string *err) {
+  switch (*cur_) {
+    case '"':
+      return ValidateString(err);
+    case 't':
+      return ValidateLiteral(err, "true");
+    case 'f':
+      return ValidateLiteral(err, "false");
+    case 'n':
+      return ValidateLiteral(err, "null");
+    default:
+      if ((*cur_ == '-') || IsDigit(*cur_)) return ValidateNumber(err);
+      return Fail(err, "unexpected character");
+  }
+}
+
+bool JsonReader::ValidateLiteral(std::string *err, const char *literal) {
+  size_t length = strlen(literal);
+  if ((size_t(end_ - cur_) < length) || (memcmp(cur_, literal, length) != 0)) {
+    return Fail(err, "invalid literal");
+  }
+  cur_ += length;
+  return true;
+}
+
+static bool ReadHex4(const char *p, const char *end, unsigned int *value) {
+  if (end - p < 4) return false;
+  unsigned int v = 0;
+  for (int i = 0; i < 4; i++) {
+    char c = p[i];
+    v <<= 4;
+    if ((c >= '0') && (c <= '9')) {
+      v |= unsigned(c - '0');
+    } else if ((c >= 'a') && (c <= 'f')) {
+      v |= unsigned(c - 'a' + 10);
+    } else if ((c >= 'A') && (c <= 'F')) {
+      v |= unsigned(c - 'A' + 10);
+    } else {
       return false;
     }
+  }
+  (*value) = v;
+  return true;
+}
 
-    std::string mime_type;
-    ParseStringProperty(&mime_type, err, o, "mimeType", false);
+// strtod() in the C locale whatever the process locale is, without
+// localeconv(), which is not thread safe. Numbers get their terminating nul
+// in a stack buffer, only absurdly long ones are copied to the heap.
+static double StringToDouble(const char *begin, const char *end) {
+  char buffer[128];
+  std::string long_token;
+  char *token = buffer;
+  size_t length = size_t(end - begin);
+  if (length < sizeof(buffer)) {
+    memcpy(buffer, begin, length);
+    buffer[length] = '\0';
+  } else {
+    long_token.assign(begin, end);
+    token = &long_token[0];
+  }
 
-    int width = 0;
-    ParseIntegerProperty(&width, err, o, "width", false);
+#if defined(TINYGLTF_INTERNAL_HAS_STRTOD_L)
+  static const locale_t c_locale = newlocale(LC_ALL_MASK, "C", locale_t(0));
+  if (c_locale != locale_t(0)) {
+    return strtod_l(token, nullptr, c_locale);
+  }
+#elif defined(_MSC_VER)
+  static const _locale_t c_locale = _create_locale(LC_ALL, "C");
+  if (c_locale != nullptr) {
+    return _strtod_l(token, nullptr, c_locale);
+  }
+#endif
 
-    int height = 0;
-    ParseIntegerProperty(&height, err, o, "height", false);
+  // No C locale object on this platform, swap in the decimal point strtod()
+  // expects like the DOM parser does.
+  const struct lconv *conv = localeconv();
+  if (conv && conv->decimal_point && conv->decimal_point[0] &&
+      (conv->decimal_point[0] != '.')) {
+    std::replace(token, token + length, '.', conv->decimal_point[0]);
+  }
+  return std::strtod(token, nullptr);
+}
+
+// Length of the well-formed UTF-8 sequence at `p` (RFC 3629), 0 if it is not.
+static size_t Utf8SequenceLength(const char *p, const char *end) {
+  const unsigned char *s = reinterpret_cast<const unsigned char *>(p);
+  size_t avail = size_t(end - p);
+  unsigned char c = s[0];
+
+  size_t length;
+  unsigned char lo = 0x80;
+  unsigned char hi = 0xBF;
+  if ((c >= 0xC2) && (c <= 0xDF)) {
+    length = 2;
+  } else if ((c >= 0xE0) && (c <= 0xEF)) {
+    length = 3;
+    if (c == 0xE0) lo = 0xA0;
+    if (c == 0xED) hi = 0x9F;
+  } else if ((c >= 0xF0) && (c <= 0xF4)) {
+    length = 4;
+    if (c == 0xF0) lo = 0x90;
+    if (c == 0xF4) hi = 0x8F;
+  } else {
+    return 0;
+  }
 
-    // Just only save some information here. Loading actual image data from
-    // bufferView is done after this `ParseImage` function.
-    image->bufferView = bufferView;
-    image->mimeType = mime_type;
-    image->width = width;
-    image->height = height;
+  if (avail < length) return 0;
+  if ((s[1] < lo) || (s[1] > hi)) return 0;
+  for (size_t i = 2; i < length; i++) {
+    if ((s[i] < 0x80) || (s[i] > 0xBF)) return 0;
+  }
+  return length;
+}
 
-    return true;
+bool JsonReader::ValidateString(std::string *err) {
+  ++cur_;
+  while (cur_ != end_) {
+    unsigned char c = static_cast<unsigned char>(*cur_);
+    if (c == '"') {
+      ++cur_;
+      return true;
+    }
+    if (c < 0x20) return Fail(err, "control character in string");
+    if (c == '\\') {
+      if (end_ - cur_ < 2) break;
+      char e = cur_[1];
+      if (e == 'u') {
+        unsigned int cp;
+        if (!ReadHex4(cur_ + 2, end_, &cp)) {
+          return Fail(err, "invalid \\u escape");
+        }
+        cur_ += 6;
+        if ((cp >= 0xDC00) && (cp <= 0xDFFF)) {
+          return Fail(err, "unpaired UTF-16 surrogate");
+        }
+        if ((cp >= 0xD800) && (cp <= 0xDBFF)) {
+          unsigned int low;
+          if ((end_ - cur_ < 6) || (cur_[0] != '\\') || (cur_[1] != 'u') ||
+              !ReadHex4(cur_ + 2, end_, &low) || (low < 0xDC00) ||
+              (low > 0xDFFF)) {
+            return Fail(err, "unpaired UTF-16 surrogate");
+          }
+          cur_ += 6;
+        }
+        continue;
+      }
+      if ((e != '"') && (e != '\\') && (e != '/') && (e != 'b') &&
+          (e != 'f') && (e != 'n') && (e != 'r') && (e != 't')) {
+        return Fail(err, "invalid escape");
+      }
+      cur_ += 2;
+      continue;
+    }
+    if (c < 0x80) {
+      ++cur_;
+      continue;
+    }
+    size_t length = Utf8SequenceLength(cur_, end_);
+    if (length == 0) return Fail(err, "invalid UTF-8 in string");
+    cur_ += length;
   }
+  return Fail(err, "unterminated string");
+}
 
-  // Parse URI & Load image data.
+bool JsonReader::ValidateNumber(std::string *err) {
+  const char *p = cur_;
+  if (*p == '-') ++p;
 
-  std::string uri;
-  std::string tmp_err;
-  if (!ParseStringProperty(&uri, &tmp_err, o, "uri", true)) {
-    if (err) {
-      (*err) += "Failed to parse `uri` for image[" + std::to_string(image_idx) +
-                "] name = \"" + image->name + "\".\n";
+  if ((p != end_) && (*p == '0')) {
+    ++p;
+  } else if ((p != end_) && IsDigit(*p)) {
+    while ((p != end_) && IsDigit(*p)) ++p;
+  } else {
+    cur_ = p;
+    return Fail(err, "invalid number");
+  }
+  long magnitude = long(p - cur_);
+
+  if ((p != end_) && (*p == '.')) {
+    ++p;
+    if ((p == end_) || !IsDigit(*p)) {
+      cur_ = p;
+      return Fail(err, "invalid number");
     }
-    return false;
+    while ((p != end_) && IsDigit(*p)) ++p;
   }
 
-  std::vector<unsigned char> img;
+  if ((p != end_) && ((*p == 'e') || (*p == 'E'))) {
+    ++p;
+    bool negative = false;
+    if ((p != end_) && ((*p == '+') || (*p == '-'))) {
+      negative = (*p == '-');
+      ++p;
+    }
+    if ((p == end_) || !IsDigit(*p)) {
+      cur_ = p;
+      return Fail(err, "invalid number");
+    }
+    long exponent = 0;
+    for (; (p != end_) && IsDigit(*p); ++p) {
+      if (exponent < 100000) exponent = exponent * 10 + (*p - '0');
+    }
+    magnitude += negative ? -exponent : exponent;
+  }
 
-  if (IsDataURI(uri)) {
-    if (!DecodeDataURI(&img, image->mimeType, uri, 0, false)) {
-      if (err) {
-        (*err) += "Failed to decode 'uri' for image[" +
-                  std::to_string(image_idx) + "] name = [" + image->name +
-                  "]\n";
+  // The DOM rejects numbers that overflow a double. Only numbers that may be
+  // that large are converted here.
+  if ((magnitude > 300) && std::isinf(StringToDouble(cur_, p))) {
+    return Fail(err, "number overflow");
+  }
+
+  cur_ = p;
+  return true;
+}
+
+void JsonReader::SkipString() {
+  ++cur_;
+  while (cur_ != end_) {
+    char c = *cur_++;
+    if (c == '"') return;
+    if ((c == '\\') && (cur_ != end_)) ++cur_;
+  }
+}
+
+JsonSpan JsonReader::Skip() {
+  SkipWhitespace();
+  const char *begin = cur_;
+  if (cur_ == end_) return JsonSpan(begin, cur_);
+
+  char c = *cur_;
+  if (c == '"') {
+    SkipString();
+  } else if ((c == '{') || (c == '[')) {
+    size_t depth = 0;
+    while (cur_ != end_) {
+      c = *cur_;
+      if (c == '"') {
+        SkipString();
+        continue;
+      }
+      ++cur_;
+      if ((c == '{') || (c == '[')) {
+        ++depth;
+      } else if (((c == '}') || (c == ']')) && (--depth == 0)) {
+        break;
       }
-      return false;
     }
   } else {
-    // Assume external file
-    // Keep texture path (for textures that cannot be decoded)
-    image->uri = uri;
-#ifdef TINYGLTF_NO_EXTERNAL_IMAGE
-    return true;
-#endif
-    std::string decoded_uri = dlib::urldecode(uri);
-    if (!LoadExternalFile(&img, err, warn, decoded_uri, basedir,
-                          /* required */ false, /* required bytes */ 0,
-                          /* checksize */ false, fs)) {
-      if (warn) {
-        (*warn) += "Failed to load external 'uri' for image[" +
-                   std::to_string(image_idx) + "] name = [" + image->name +
-                   "]\n";
-      }
-      // If the image cannot be loaded, keep uri as image->uri.
-      return true;
+    while ((cur_ != end_) && (*cur_ != ',') && (*cur_ != '}') &&
+           (*cur_ != ']') && (*cur_ != ' ') && (*cur_ != '\n') &&
+           (*cur_ != '\r') && (*cur_ != '\t')) {
+      ++cur_;
     }
+  }
+  return JsonSpan(begin, cur_);
+}
+
+bool JsonReader::NextMember(StreamKey *key) {
+  SkipWhitespace();
+  if (first_) {
+    first_ = false;
+  } else if ((cur_ != end_) && (*cur_ == ',')) {
+    ++cur_;
+    SkipWhitespace();
+  } else {
+    if (cur_ != end_) ++cur_;  // '}'
+    return false;
+  }
+  if ((cur_ == end_) || (*cur_ != '"')) {
+    if (cur_ != end_) ++cur_;  // '}' of an empty object
+    return false;
+  }
 
-    if (img.empty()) {
-      if (warn) {
-        (*warn) += "Image data is empty for image[" +
-                   std::to_string(image_idx) + "] name = [" + image->name +
-                   "] \n";
-      }
-      return false;
+  const char *begin = ++cur_;
+  uint32_t hash = 2166136261u;
+  while ((cur_ != end_) && (*cur_ != '"') && (*cur_ != '\\')) {
+    hash = (hash ^ static_cast<uint32_t>(static_cast<unsigned char>(*cur_))) *
+           16777619u;
+    ++cur_;
+  }
+
+  if ((cur_ != end_) && (*cur_ == '\\')) {
+    cur_ = begin - 1;
+    hash = 2166136261u;
+    key_.clear();
+    ReadString(&key_);
+    key->data = key_.data();
+    key->size = key_.size();
+    for (size_t i = 0; i < key_.size(); i++) {
+      hash = (hash ^ static_cast<uint32_t>(
+                         static_cast<unsigned char>(key_[i]))) *
+             16777619u;
     }
+    key->hash = hash;
+  } else {
+    key->data = begin;
+    key->size = size_t(cur_ - begin);
+    key->hash = hash;
+    if (cur_ != end_) ++cur_;
   }
 
-  if (*LoadImageData == nullptr) {
-    if (err) {
-      (*err) += "No LoadImageData callback specified.\n";
+  SkipWhitespace();
+  if ((cur_ != end_) && (*cur_ == ':')) ++cur_;
+  return true;
+}
+
+bool JsonReader::NextElement() {
+  SkipWhitespace();
+  if (first_) {
+    first_ = false;
+    if ((cur_ != end_) && (*cur_ == ']')) {
+      ++cur_;
+      return false;
     }
-    return false;
+    return cur_ != end_;
   }
-  return (*LoadImageData)(image, image_idx, err, warn, 0, 0, &img.at(0),
-                          static_cast<int>(img.size()), load_image_user_data);
+  if ((cur_ != end_) && (*cur_ == ',')) {
+    ++cur_;
+    return true;
+  }
+  if (cur_ != end_) ++cur_;  // ']'
+  return false;
 }
 
-static bool ParseTexture(Texture *texture, std::string *err, const json &o,
-                         bool store_original_json_for_extras_and_extensions,
-                         const std::string &basedir) {
-  (void)basedir;
-  int sampler = -1;
-  int source = -1;
-  ParseIntegerProperty(&sampler, err, o, "sampler", false);
+bool JsonReader::ReadNumber(JsonNumber *number) {
+  if (Peek() != kNumber) return false;
 
-  ParseIntegerProperty(&source, err, o, "source", false);
+  const char *begin = cur_;
+  const char *p = cur_;
+  bool negative = (*p == '-');
+  if (negative) ++p;
 
-  texture->sampler = sampler;
-  texture->source = source;
+  uint64_t value = 0;
+  bool overflow = false;
+  for (; (p != end_) && IsDigit(*p); ++p) {
+    uint64_t digit = uint64_t(*p - '0');
+    if (value > (std::numeric_limits<uint64_t>::max() - digit) / 10) {
+      overflow = true;
+    } else {
+      value = value * 10 + digit;
+    }
+  }
 
-  ParseExtensionsProperty(&texture->extensions, err, o);
-  ParseExtrasProperty(&texture->extras, o);
+  bool fraction = false;
+  if ((p != end_) && (*p == '.')) {
+    fraction = true;
+    for (++p; (p != end_) && IsDigit(*p); ++p) {
+    }
+  }
+  if ((p != end_) && ((*p == 'e') || (*p == 'E'))) {
+    fraction = true;
+    ++p;
+    if ((p != end_) && ((*p == '+') || (*p == '-'))) ++p;
+    for (; (p != end_) && IsDigit(*p); ++p) {
+    }
+  }
+  cur_ = p;
 
-  if (store_original_json_for_extras_and_extensions) {
-    {
-      json_const_iterator it;
-      if (FindMember(o, "extensions", it)) {
-        texture->extensions_json_string = JsonToString(GetValue(it));
-      }
+  const uint64_t min_integer =
+      uint64_t(std::numeric_limits<int64_t>::max()) + 1;
+  if (!fraction && !overflow && (!negative || (value <= min_integer))) {
+    if (negative) {
+      number->kind = JsonNumber::kInteger;
+      number->i = (value == min_integer) ? std::numeric_limits<int64_t>::min()
+                                         : -static_cast<int64_t>(value);
+      number->u = static_cast<uint64_t>(number->i);
+      number->d = static_cast<double>(number->i);
+    } else {
+      number->kind = JsonNumber::kUnsigned;
+      number->u = value;
+      number->i = static_cast<int64_t>(value);
+      number->d = static_cast<double>(value);
     }
-    {
-      json_const_iterator it;
-      if (FindMember(o, "extras", it)) {
-        texture->extras_json_string = JsonToString(GetValue(it));
-      }
+    return true;
+  }
+
+  number->kind = JsonNumber::kFloat;
+  number->d = StringToDouble(begin, p);
+  number->i = static_cast<int64_t>(number->d);
+  number->u = static_cast<uint64_t>(number->i);
+  return true;
+}
+
+void JsonReader::Unescape(const char *p, std::string *out) {
+  // `p` is just past the opening quote of a validated string.
+  for (;;) {
+    const char *run = p;
+    while ((*p != '"') && (*p != '\\')) ++p;
+    out->append(run, p);
+    if (*p == '"') {
+      cur_ = p + 1;
+      return;
+    }
+
+    char e = p[1];
+    p += 2;
+    switch (e) {
+      case 'b':
+        out->push_back('\b');
+        break;
+      case 'f':
+        out->push_back('\f');
+        break;
+      case 'n':
+        out->push_back('\n');
+        break;
+      case 'r':
+        out->push_back('\r');
+        break;
+      case 't':
+        out->push_back('\t');
+        break;
+      case 'u': {
+        unsigned int cp = 0;
+        ReadHex4(p, end_, &cp);
+        p += 4;
+        if ((cp >= 0xD800) && (cp <= 0xDBFF)) {
+          unsigned int low = 0;
+          ReadHex4(p + 2, end_, &low);
+          p += 6;
+          cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+        }
+        if (cp < 0x80) {
+          out->push_back(static_cast<char>(cp));
+        } else if (cp < 0x800) {
+          out->push_back(static_cast<char>(0xC0 | (cp >> 6)));
+          out->push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+        } else if (cp < 0x10000) {
+          out->push_back(static_cast<char>(0xE0 | (cp >> 12)));
+          out->push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+          out->push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+        } else {
+          out->push_back(static_cast<char>(0xF0 | (cp >> 18)));
+          out->push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+          out->push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+          out->push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+        }
+      } break;
+      default:  // '"', '\\' and '/'
+        out->push_back(e);
+        break;
     }
   }
+}
 
-  ParseStringProperty(&texture->name, err, o, "name", false);
+bool JsonReader::ReadString(std::string *value) {
+  if (Peek() != kString) return false;
 
+  const char *begin = cur_ + 1;
+  const char *p = begin;
+  while ((*p != '"') && (*p != '\\')) ++p;
+  if (*p == '"') {
+    value->assign(begin, p);
+    cur_ = p + 1;
+    return true;
+  }
+
+  value->clear();
+  Unescape(begin, value);
   return true;
 }
 
-static bool ParseTextureInfo(
-    TextureInfo *texinfo, std::string *err, const json &o,
-    bool store_original_json_for_extras_and_extensions) {
-  if (texinfo == nullptr) {
+bool StreamIsObject(const JsonSpan &value) {
+  return !value.empty() && (JsonReader(value).Peek() == JsonReader::kObject);
+}
+
+bool StreamIsArray(const JsonSpan &value) {
+  return !value.empty() && (JsonReader(value).Peek() == JsonReader::kArray);
+}
+
+bool StreamGetInt(const JsonSpan &value, int *out) {
+  JsonNumber number;
+  if (value.empty() || !JsonReader(value).ReadNumber(&number) ||
+      !number.IsInteger()) {
     return false;
   }
+  (*out) = static_cast<int>(number.i);
+  return true;
+}
 
-  if (!ParseIntegerProperty(&texinfo->index, err, o, "index",
-                            /* required */ true, "TextureInfo")) {
-    return false;
+bool StreamGetString(const JsonSpan &value, std::string *out) {
+  return !value.empty() && JsonReader(value).ReadString(out);
+}
+
+// Records the value of every member `members` has a slot for. Later
+// duplicates replace earlier ones, as in the DOM. A value that is not an
+// object leaves every slot empty, like looking members up on it would.
+template <typename Members>
+bool StreamIndexMembers(const JsonSpan &o, Members *members) {
+  JsonReader r(o);
+  if (o.empty() || !r.EnterObject()) return false;
+
+  StreamKey key;
+  while (r.NextMember(&key)) {
+    JsonSpan *slot = members->Find(key);
+    JsonSpan value = r.Skip();
+    if (slot) (*slot) = value;
   }
+  return true;
+}
 
-  ParseIntegerProperty(&texinfo->texCoord, err, o, "texCoord", false);
+template <typename Callback>
+bool StreamForEachInArray(const JsonSpan &value, const Callback &cb) {
+  JsonReader r(value);
+  if (value.empty() || !r.EnterArray()) return true;
 
-  ParseExtensionsProperty(&texinfo->extensions, err, o);
-  ParseExtrasProperty(&texinfo->extras, o);
+  while (r.NextElement()) {
+    if (!cb(r.Skip())) return false;
+  }
+  return true;
+}
 
-  if (store_original_json_for_extras_and_extensions) {
-    {
-      json_const_iterator it;
-      if (FindMember(o, "extensions", it)) {
-        texinfo->extensions_json_string = JsonToString(GetValue(it));
-      }
+#define TINYGLTF_STREAM_MEMBER(member) \
+  case StreamKeyHash(#member):         \
+    return (key == #member) ? &member : nullptr;
+
+static void StreamMissingPropertyError(std::string *err,
+                                       const std::string &property,
+                                       const std::string &parent_node) {
+  if (err) {
+    (*err) += "'" + property + "' property is missing";
+    if (!parent_node.empty()) {
+      (*err) += " in " + parent_node;
     }
-    {
-      json_const_iterator it;
-      if (FindMember(o, "extras", it)) {
-        texinfo->extras_json_string = JsonToString(GetValue(it));
+    (*err) += ".\n";
+  }
+}
+
+static bool StreamParseJsonAsValue(Value *ret, JsonReader &r) {
+  Value val{};
+  switch (r.Peek()) {
+    case JsonReader::kObject: {
+      std::vector<Value::Object::value_type> members;
+      StreamKey key;
+      r.EnterObject();
+      while (r.NextMember(&key)) {
+        members.emplace_back(std::string(key.data, key.size), Value());
+        StreamParseJsonAsValue(&members.back().second, r);
+      }
+
+      // Sorted once, the last of duplicate keys wins and null drops the key
+      // like in the DOM.
+      Value::Object value_object(std::move(members));
+      for (Value::Object::iterator it = value_object.begin();
+           it != value_object.end();) {
+        if (it->second.Type() == NULL_TYPE) {
+          it = value_object.erase(it);
+        } else {
+          ++it;
+        }
       }
-    }
+      if (value_object.size() > 0) val = Value(std::move(value_object));
+    } break;
+    case JsonReader::kArray: {
+      Value::Array value_array;
+      r.EnterArray();
+      while (r.NextElement()) {
+        Value entry;
+        if (StreamParseJsonAsValue(&entry, r))
+          value_array.emplace_back(std::move(entry));
+      }
+      if (value_array.size() > 0) val = Value(std::move(value_array));
+    } break;
+    case JsonReader::kString: {
+      std::string str;
+      r.ReadString(&str);
+      val = Value(std::move(str));
+    } break;
+    case JsonReader::kBool: {
+      bool b = false;
+      r.ReadBool(&b);
+      val = Value(b);
+    } break;
+    case JsonReader::kNumber: {
+      JsonNumber number;
+      r.ReadNumber(&number);
+      if (number.IsInteger()) {
+        val = Value(static_cast<int>(number.i));
+      } else {
+        val = Value(number.d);
+      }
+    } break;
+    case JsonReader::kNull:
+    case JsonReader::kEnd:
+      r.Skip();
+      break;
   }
+  if (ret) *ret = std::move(val);
 
-  return true;
+  return val.Type() != NULL_TYPE;
 }
 
-static bool ParseNormalTextureInfo(
-    NormalTextureInfo *texinfo, std::string *err, const json &o,
-    bool store_original_json_for_extras_and_extensions) {
-  if (texinfo == nullptr) {
+static bool StreamParseExtrasProperty(Value *ret, const JsonSpan &value) {
+  if (value.empty()) {
     return false;
   }
 
-  if (!ParseIntegerProperty(&texinfo->index, err, o, "index",
-                            /* required */ true, "NormalTextureInfo")) {
+  JsonReader r(value);
+  return StreamParseJsonAsValue(ret, r);
+}
+
+static bool StreamParseBooleanProperty(bool *ret, std::string *err,
+                                       const JsonSpan &value,
+                                       const std::string &property,
+                                       const bool required,
+                                       const std::string &parent_node = "") {
+  if (value.empty()) {
+    if (required) {
+      StreamMissingPropertyError(err, property, parent_node);
+    }
     return false;
   }
 
-  ParseIntegerProperty(&texinfo->texCoord, err, o, "texCoord", false);
-  ParseNumberProperty(&texinfo->scale, err, o, "scale", false);
+  bool boolValue = false;
+  if (!JsonReader(value).ReadBool(&boolValue)) {
+    if (required) {
+      if (err) {
+        (*err) += "'" + property + "' property is not a bool type.\n";
+      }
+    }
+    return false;
+  }
 
-  ParseExtensionsProperty(&texinfo->extensions, err, o);
-  ParseExtrasProperty(&texinfo->extras, o);
+  if (ret) {
+    (*ret) = boolValue;
+  }
 
-  if (store_original_json_for_extras_and_extensions) {
-    {
-      json_const_iterator it;
-      if (FindMember(o, "extensions", it)) {
-        texinfo->extensions_json_string = JsonToString(GetValue(it));
-      }
+  return true;
+}
+
+static bool StreamParseIntegerProperty(int *ret, std::string *err,
+                                       const JsonSpan &value,
+                                       const std::string &property,
+                                       const bool required,
+                                       const std::string &parent_node = "") {
+  if (value.empty()) {
+    if (required) {
+      StreamMissingPropertyError(err, property, parent_node);
     }
-    {
-      json_const_iterator it;
-      if (FindMember(o, "extras", it)) {
-        texinfo->extras_json_string = JsonToString(GetValue(it));
+    return false;
+  }
+
+  int intValue;
+  if (!StreamGetInt(value, &intValue)) {
+    if (required) {
+      if (err) {
+        (*err) += "'" + property + "' property is not an integer type.\n";
       }
     }
+    return false;
+  }
+
+  if (ret) {
+    (*ret) = intValue;
   }
 
   return true;
 }
 
-static bool ParseOcclusionTextureInfo(
-    OcclusionTextureInfo *texinfo, std::string *err, const json &o,
-    bool store_original_json_for_extras_and_extensions) {
-  if (texinfo == nullptr) {
+static bool StreamParseUnsignedProperty(size_t *ret, std::string *err,
+                                        const JsonSpan &value,
+                                        const std::string &property,
+                                        const bool required,
+                                        const std::string &parent_node = "") {
+  if (value.empty()) {
+    if (required) {
+      StreamMissingPropertyError(err, property, parent_node);
+    }
     return false;
   }
 
-  if (!ParseIntegerProperty(&texinfo->index, err, o, "index",
-                            /* required */ true, "NormalTextureInfo")) {
+  JsonNumber number;
+  if (!JsonReader(value).ReadNumber(&number) ||
+      (number.kind != JsonNumber::kUnsigned)) {
+    if (required) {
+      if (err) {
+        (*err) += "'" + property + "' property is not a positive integer.\n";
+      }
+    }
     return false;
   }
 
-  ParseIntegerProperty(&texinfo->texCoord, err, o, "texCoord", false);
-  ParseNumberProperty(&texinfo->strength, err, o, "strength", false);
+  if (ret) {
+    (*ret) = static_cast<size_t>(number.u);
+  }
 
-  ParseExtensionsProperty(&texinfo->extensions, err, o);
-  ParseExtrasProperty(&texinfo->extras, o);
+  return true;
+}
 
-  if (store_original_json_for_extras_and_extensions) {
-    {
-      json_const_iterator it;
-      if (FindMember(o, "extensions", it)) {
-        texinfo->extensions_json_string = JsonToString(GetValue(it));
-      }
-    }
-    {
-      json_const_iterator it;
-      if (FindMember(o, "extras", it)) {
-        texinfo->extras_json_string = JsonToString(GetValue(it));
-      }
+// Only optional number arrays exist in glTF, so unlike
+// ParseNumberArrayProperty there are no error messages.
+static bool StreamParseNumberArrayProperty(std::vector<double> *ret,
+                                           const JsonSpan &value) {
+  JsonReader r(value);
+  if (value.empty() || !r.EnterArray()) {
+    return false;
+  }
+
+  ret->clear();
+  while (r.NextElement()) {
+    JsonNumber number;
+    if (!r.ReadNumber(&number)) {
+      return false;
     }
+    ret->push_back(number.d);
   }
 
   return true;
 }
 
-static bool ParseBuffer(Buffer *buffer, std::string *err, const json &o,
-                        bool store_original_json_for_extras_and_extensions,
-                        FsCallbacks *fs, const std::string &basedir,
-                        bool is_binary = false,
-                        const unsigned char *bin_data = nullptr,
-                        size_t bin_size = 0) {
-  size_t byteLength;
-  if (!ParseUnsignedProperty(&byteLength, err, o, "byteLength", true,
-                             "Buffer")) {
+static bool StreamParseIntegerArrayProperty(std::vector<int> *ret,
+                                            const JsonSpan &value) {
+  JsonReader r(value);
+  if (value.empty() || !r.EnterArray()) {
     return false;
   }
 
-  // In glTF 2.0, uri is not mandatory anymore
-  buffer->uri.clear();
-  ParseStringProperty(&buffer->uri, err, o, "uri", false, "Buffer");
+  ret->clear();
+  while (r.NextElement()) {
+    JsonNumber number;
+    if (!r.ReadNumber(&number) || !number.IsInteger()) {
+      return false;
+    }
+    ret->push_back(static_cast<int>(number.i));
+  }
 
-  // having an empty uri for a non embedded image should not be valid
-  if (!is_binary && buffer->uri.empty()) {
-    if (err) {
-      (*err) += "'uri' is missing from non binary glTF file buffer.\n";
+  return true;
+}
+
+static bool StreamParseStringProperty(
+    std::string *ret, std::string *err, const JsonSpan &value,
+    const std::string &property, bool required,
+    const std::string &parent_node = std::string()) {
+  if (value.empty()) {
+    if (required) {
+      if (err) {
+        (*err) += "'" + property + "' property is missing";
+        if (parent_node.empty()) {
+          (*err) += ".\n";
+        } else {
+          (*err) += " in `" + parent_node + "'.\n";
+        }
+      }
     }
+    return false;
   }
 
-  json_const_iterator type;
-  if (FindMember(o, "type", type)) {
-    std::string typeStr;
-    if (GetString(GetValue(type), typeStr)) {
-      if (typeStr.compare("arraybuffer") == 0) {
-        // buffer.type = "arraybuffer";
+  std::string strValue;
+  if (!StreamGetString(value, &strValue)) {
+    if (required) {
+      if (err) {
+        (*err) += "'" + property + "' property is not a string type.\n";
       }
     }
+    return false;
   }
 
-  if (is_binary) {
-    // Still binary glTF accepts external dataURI.
-    if (!buffer->uri.empty()) {
-      // First try embedded data URI.
-      if (IsDataURI(buffer->uri)) {
-        std::string mime_type;
-        if (!DecodeDataURI(&buffer->data, mime_type, buffer->uri, byteLength,
-                           true)) {
-          if (err) {
-            (*err) +=
-                "Failed to decode 'uri' : " + buffer->uri + " in Buffer\n";
-          }
-          return false;
-        }
-      } else {
-        // External .bin file.
-        std::string decoded_uri = dlib::urldecode(buffer->uri);
-        if (!LoadExternalFile(&buffer->data, err, /* warn */ nullptr,
-                              decoded_uri, basedir, /* required */ true,
-                              byteLength, /* checkSize */ true, fs)) {
-          return false;
-        }
-      }
-    } else {
-      // load data from (embedded) binary data
+  if (ret) {
+    (*ret) = std::move(strValue);
+  }
 
-      if ((bin_size == 0) || (bin_data == nullptr)) {
-        if (err) {
-          (*err) += "Invalid binary data in `Buffer'.\n";
-        }
-        return false;
-      }
+  return true;
+}
 
-      if (byteLength > bin_size) {
-        if (err) {
-          std::stringstream ss;
-          ss << "Invalid `byteLength'. Must be equal or less than binary size: "
-                "`byteLength' = "
-             << byteLength << ", binary size = " << bin_size << std::endl;
-          (*err) += ss.str();
+static bool StreamParseStringIntegerProperty(std::map<std::string, int> *ret,
+                                             std::string *err,
+                                             const JsonSpan &value,
+                                             const std::string &property,
+                                             bool required,
+                                             const std::string &parent = "") {
+  if (value.empty()) {
+    if (required) {
+      if (err) {
+        if (!parent.empty()) {
+          (*err) +=
+              "'" + property + "' property is missing in " + parent + ".\n";
+        } else {
+          (*err) += "'" + property + "' property is missing.\n";
         }
-        return false;
       }
-
-      // Read buffer data
-      buffer->data.resize(static_cast<size_t>(byteLength));
-      memcpy(&(buffer->data.at(0)), bin_data, static_cast<size_t>(byteLength));
     }
+    return false;
+  }
 
-  } else {
-    if (IsDataURI(buffer->uri)) {
-      std::string mime_type;
-      if (!DecodeDataURI(&buffer->data, mime_type, buffer->uri, byteLength,
-                         true)) {
-        if (err) {
-          (*err) += "Failed to decode 'uri' : " + buffer->uri + " in Buffer\n";
-        }
-        return false;
-      }
-    } else {
-      // Assume external .bin file.
-      std::string decoded_uri = dlib::urldecode(buffer->uri);
-      if (!LoadExternalFile(&buffer->data, err, /* warn */ nullptr, decoded_uri,
-                            basedir, /* required */ true, byteLength,
-                            /* checkSize */ true, fs)) {
-        return false;
+  JsonReader r(value);
+  if (!r.EnterObject()) {
+    if (required) {
+      if (err) {
+        (*err) += "'" + property + "' property is not an object.\n";
       }
     }
+    return false;
   }
 
-  ParseStringProperty(&buffer->name, err, o, "name", false);
-
-  ParseExtensionsProperty(&buffer->extensions, err, o);
-  ParseExtrasProperty(&buffer->extras, o);
+  ret->clear();
 
-  if (store_original_json_for_extras_and_extensions) {
-    {
-      json_const_iterator it;
-      if (FindMember(o, "extensions", it)) {
-        buffer->extensions_json_string = JsonToString(GetValue(it));
-      }
+  // A later duplicate key decides whether the value is valid.
+  std::vector<std::string> invalid;
+  StreamKey key;
+  while (r.NextMember(&key)) {
+    std::string name(key.data, key.size);
+    JsonNumber number;
+    bool isNumber = r.ReadNumber(&number);
+    if (isNumber && number.IsInteger()) {
+      (*ret)[name] = static_cast<int>(number.i);
+      invalid.erase(std::remove(invalid.begin(), invalid.end(), name),
+                    invalid.end());
+    } else {
+      if (!isNumber) r.Skip();
+      ret->erase(name);
+      invalid.push_back(std::move(name));
     }
-    {
-      json_const_iterator it;
-      if (FindMember(o, "extras", it)) {
-        buffer->extras_json_string = JsonToString(GetValue(it));
+  }
+
+  if (!invalid.empty()) {
+    if (required) {
+      if (err) {
+        (*err) += "'" + property + "' value is not an integer type.\n";
       }
     }
+    return false;
   }
-
   return true;
 }
 
-static bool ParseBufferView(
-    BufferView *bufferView, std::string *err, const json &o,
-    bool store_original_json_for_extras_and_extensions) {
-  int buffer = -1;
-  if (!ParseIntegerProperty(&buffer, err, o, "buffer", true, "BufferView")) {
+static bool StreamParseExtensionsProperty(ExtensionMap *ret,
+                                          const JsonSpan &value) {
+  JsonReader r(value);
+  if (value.empty() || !r.EnterObject()) {
     return false;
   }
 
-  size_t byteOffset = 0;
-  ParseUnsignedProperty(&byteOffset, err, o, "byteOffset", false);
+  ExtensionMap extensions;
+  StreamKey key;
+  while (r.NextMember(&key)) {
+    std::string name(key.data, key.size);
+    if (r.Peek() != JsonReader::kObject) {
+      r.Skip();
+      extensions.erase(name);
+      continue;
+    }
+    if (!StreamParseJsonAsValue(&extensions[name], r)) {
+      if (!name.empty()) {
+        // create empty object so that an extension object is still of type
+        // object
+        extensions[name] = Value{Value::Object{}};
+      }
+    }
+  }
+  if (ret) {
+    (*ret) = std::move(extensions);
+  }
+  return true;
+}
 
-  size_t byteLength = 1;
-  if (!ParseUnsignedProperty(&byteLength, err, o, "byteLength", true,
-                             "BufferView")) {
-    return false;
+// Parses the text of one object into a DOM and hands it to `parse`, for the
+// types without a Stream* parser. The document is validated already.
+template <typename Parse>
+static bool StreamParseWithDom(const JsonSpan &o, const Parse &parse) {
+  JsonDocument doc;
+  JsonParse(doc, o.begin, size_t(o.end - o.begin));
+  return parse(static_cast<const json &>(doc));
+}
+
+struct StreamAssetMembers {
+  JsonSpan version, generator, minVersion, copyright, extensions, extras;
+
+  JsonSpan *Find(const StreamKey &key) {
+    switch (key.hash) {
+      TINYGLTF_STREAM_MEMBER(version)
+      TINYGLTF_STREAM_MEMBER(generator)
+      TINYGLTF_STREAM_MEMBER(minVersion)
+      TINYGLTF_STREAM_MEMBER(copyright)
+      TINYGLTF_STREAM_MEMBER(extensions)
+      TINYGLTF_STREAM_MEMBER(extras)
+    }
+    return nullptr;
   }
+};
 
-  size_t byteStride = 0;
-  if (!ParseUnsignedProperty(&byteStride, err, o, "byteStride", false)) {
-    // Spec says: When byteStride of referenced bufferView is not defined, it
-    // means that accessor elements are tightly packed, i.e., effective stride
-    // equals the size of the element.
-    // We cannot determine the actual byteStride until Accessor are parsed, thus
-    // set 0(= tightly packed) here(as done in OpenGL's VertexAttribPoiner)
-    byteStride = 0;
+struct StreamImageMembers {
+  JsonSpan name, bufferView, uri, mimeType, width, height, extensions, extras;
+
+  JsonSpan *Find(const StreamKey &key) {
+    switch (key.hash) {
+      TINYGLTF_STREAM_MEMBER(name)
+      TINYGLTF_STREAM_MEMBER(bufferView)
+      TINYGLTF_STREAM_MEMBER(uri)
+      TINYGLTF_STREAM_MEMBER(mimeType)
+      TINYGLTF_STREAM_MEMBER(width)
+      TINYGLTF_STREAM_MEMBER(height)
+      TINYGLTF_STREAM_MEMBER(extensions)
+      TINYGLTF_STREAM_MEMBER(extras)
+    }
+    return nullptr;
   }
+};
 
-  if ((byteStride > 252) || ((byteStride % 4) != 0)) {
-    if (err) {
-      std::stringstream ss;
-      ss << "Invalid `byteStride' value. `byteStride' must be the multiple of "
-            "4 : "
-         << byteStride << std::endl;
+static bool StreamParseImage(Image *image, const int image_idx,
+                             std::string *err, std::string *warn,
+                             const JsonSpan &o, const std::string &basedir,
+                             FsCallbacks *fs,
+                             LoadImageDataFunction *LoadImageData,
+                             void *load_image_user_data) {
+  StreamImageMembers m;
+  StreamIndexMembers(o, &m);
 
-      (*err) += ss.str();
+  bool hasBufferView = !m.bufferView.empty();
+  bool hasURI = !m.uri.empty();
+
+  StreamParseStringProperty(&image->name, err, m.name, "name", false);
+
+  if (hasBufferView && hasURI) {
+    // Should not both defined.
+    if (err) {
+      (*err) +=
+          "Only one of `bufferView` or `uri` should be defined, but both are "
+          "defined for image[" +
+          std::to_string(image_idx) + "] name = \"" + image->name + "\"\n";
     }
     return false;
   }
 
-  int target = 0;
-  ParseIntegerProperty(&target, err, o, "target", false);
-  if ((target == TINYGLTF_TARGET_ARRAY_BUFFER) ||
-      (target == TINYGLTF_TARGET_ELEMENT_ARRAY_BUFFER)) {
-    // OK
-  } else {
-    target = 0;
+  if (!hasBufferView && !hasURI) {
+    if (err) {
+      (*err) += "Neither required `bufferView` nor `uri` defined for image[" +
+                std::to_string(image_idx) + "] name = \"" + image->name +
+                "\"\n";
+    }
+    return false;
   }
-  bufferView->target = target;
-
-  ParseStringProperty(&bufferView->name, err, o, "name", false);
 
-  ParseExtensionsProperty(&bufferView->extensions, err, o);
-  ParseExtrasProperty(&bufferView->extras, o);
+  StreamParseExtensionsProperty(&image->extensions, m.extensions);
+  StreamParseExtrasProperty(&image->extras, m.extras);
 
-  if (store_original_json_for_extras_and_extensions) {
-    {
-      json_const_iterator it;
-      if (FindMember(o, "extensions", it)) {
-        bufferView->extensions_json_string = JsonToString(GetValue(it));
-      }
-    }
-    {
-      json_const_iterator it;
-      if (FindMember(o, "extras", it)) {
-        bufferView->extras_json_string = JsonToString(GetValue(it));
+  if (hasBufferView) {
+    int bufferView = -1;
+    if (!StreamParseIntegerProperty(&bufferView, err, m.bufferView,
+                                    "bufferView", true)) {
+      if (err) {
+        (*err) += "Failed to parse `bufferView` for image[" +
+                  std::to_string(image_idx) + "] name = \"" + image->name +
+                  "\"\n";
       }
+      return false;
     }
-  }
 
-  bufferView->buffer = buffer;
-  bufferView->byteOffset = byteOffset;
-  bufferView->byteLength = byteLength;
-  bufferView->byteStride = byteStride;
-  return true;
-}
+    std::string mime_type;
+    StreamParseStringProperty(&mime_type, err, m.mimeType, "mimeType", false);
 
-static bool ParseSparseAccessor(Accessor *accessor, std::string *err,
-                                const json &o) {
-  accessor->sparse.isSparse = true;
+    int width = 0;
+    StreamParseIntegerProperty(&width, err, m.width, "width", false);
 
-  int count = 0;
-  if (!ParseIntegerProperty(&count, err, o, "count", true, "SparseAccessor")) {
-    return false;
-  }
+    int height = 0;
+    StreamParseIntegerProperty(&height, err, m.height, "height", false);
 
-  json_const_iterator indices_iterator;
-  json_const_iterator values_iterator;
-  if (!FindMember(o, "indices", indices_iterator)) {
-    (*err) = "the sparse object of this accessor doesn't have indices";
-    return false;
+    // Just only save some information here. Loading actual image data from
+    // bufferView is done after this `StreamParseImage` function.
+    image->bufferView = bufferView;
+    image->mimeType = mime_type;
+    image->width = width;
+    image->height = height;
+
+    return true;
   }
 
-  if (!FindMember(o, "values", values_iterator)) {
-    (*err) = "the sparse object ob ths accessor doesn't have values";
+  // Parse URI & Load image data.
+
+  std::string uri;
+  std::string tmp_err;
+  if (!StreamParseStringProperty(&uri, &tmp_err, m.uri, "uri", true)) {
+    if (err) {
+      (*err) += "Failed to parse `uri` for image[" + std::to_string(image_idx) +
+                "] name = \"" + image->name + "\".\n";
+    }
     return false;
   }
 
-  const json &indices_obj = GetValue(indices_iterator);
-  const json &values_obj = GetValue(values_iterator);
+  return LoadImageFromURI(image, image_idx, err, warn, uri, basedir, fs,
+                          LoadImageData, load_image_user_data);
+}
 
-  int indices_buffer_view = 0, indices_byte_offset = 0, component_type = 0;
-  if (!ParseIntegerProperty(&indices_buffer_view, err, indices_obj, "bufferView",
-                       true, "SparseAccessor")) {
-    return false;
+struct StreamBufferMembers {
+  JsonSpan byteLength, uri, name, extensions, extras;
+
+  JsonSpan *Find(const StreamKey &key) {
+    switch (key.hash) {
+      TINYGLTF_STREAM_MEMBER(byteLength)
+      TINYGLTF_STREAM_MEMBER(uri)
+      TINYGLTF_STREAM_MEMBER(name)
+      TINYGLTF_STREAM_MEMBER(extensions)
+      TINYGLTF_STREAM_MEMBER(extras)
+    }
+    return nullptr;
   }
-  ParseIntegerProperty(&indices_byte_offset, err, indices_obj, "byteOffset",
-                       false);
-  if (!ParseIntegerProperty(&component_type, err, indices_obj, "componentType",
-                       true, "SparseAccessor")) {
+};
+
+static bool StreamParseBuffer(Buffer *buffer, std::string *err,
+                              const JsonSpan &o, FsCallbacks *fs,
+                              const std::string &basedir, bool is_binary,
+                              const unsigned char *bin_data,
+                              size_t bin_size) {
+  StreamBufferMembers m;
+  StreamIndexMembers(o, &m);
+
+  size_t byteLength;
+  if (!StreamParseUnsignedProperty(&byteLength, err, m.byteLength,
+                                   "byteLength", true, "Buffer")) {
     return false;
   }
 
-  int values_buffer_view = 0, values_byte_offset = 0;
-  if (!ParseIntegerProperty(&values_buffer_view, err, values_obj, "bufferView",
-                       true, "SparseAccessor")) {
+  // In glTF 2.0, uri is not mandatory anymore
+  buffer->uri.clear();
+  StreamParseStringProperty(&buffer->uri, err, m.uri, "uri", false, "Buffer");
+
+  if (!LoadBufferData(buffer, err, byteLength, fs, basedir, is_binary,
+                      bin_data, bin_size)) {
     return false;
   }
-  ParseIntegerProperty(&values_byte_offset, err, values_obj, "byteOffset",
-                       false);
 
-  accessor->sparse.count = count;
-  accessor->sparse.indices.bufferView = indices_buffer_view;
-  accessor->sparse.indices.byteOffset = indices_byte_offset;
-  accessor->sparse.indices.componentType = component_type;
-  accessor->sparse.values.bufferView = values_buffer_view;
-  accessor->sparse.values.byteOffset = values_byte_offset;
+  StreamParseStringProperty(&buffer->name, err, m.name, "name", false);
+
+  StreamParseExtensionsProperty(&buffer->extensions, m.extensions);
+  StreamParseExtrasProperty(&buffer->extras, m.extras);
 
   return true;
 }
 
-static bool ParseAccessor(Accessor *accessor, std::string *err, const json &o,
-                          bool store_original_json_for_extras_and_extensions) {
-  int bufferView = -1;
-  ParseIntegerProperty(&bufferView, err, o, "bufferView", false, "Accessor");
+struct StreamBufferViewMembers {
+  JsonSpan buffer, byteOffset, byteLength, byteStride, target, name,
+      extensions, extras;
 
-  size_t byteOffset = 0;
-  ParseUnsignedProperty(&byteOffset, err, o, "byteOffset", false, "Accessor");
+  JsonSpan *Find(const StreamKey &key) {
+    switch (key.hash) {
+      TINYGLTF_STREAM_MEMBER(buffer)
+      TINYGLTF_STREAM_MEMBER(byteOffset)
+      TINYGLTF_STREAM_MEMBER(byteLength)
+      TINYGLTF_STREAM_MEMBER(byteStride)
+      TINYGLTF_STREAM_MEMBER(target)
+      TINYGLTF_STREAM_MEMBER(name)
+      TINYGLTF_STREAM_MEMBER(extensions)
+      TINYGLTF_STREAM_MEMBER(extras)
+    }
+    return nullptr;
+  }
+};
 
-  bool normalized = false;
-  ParseBooleanProperty(&normalized, err, o, "normalized", false, "Accessor");
+static bool StreamParseBufferView(BufferView *bufferView, std::string *err,
+                                  const JsonSpan &o) {
+  StreamBufferViewMembers m;
+  StreamIndexMembers(o, &m);
 
-  size_t componentType = 0;
-  if (!ParseUnsignedProperty(&componentType, err, o, "componentType", true,
-                             "Accessor")) {
+  int buffer = -1;
+  if (!StreamParseIntegerProperty(&buffer, err, m.buffer, "buffer", true,
+                                  "BufferView")) {
     return false;
   }
 
-  size_t count = 0;
-  if (!ParseUnsignedProperty(&count, err, o, "count", true, "Accessor")) {
+  size_t byteOffset = 0;
+  StreamParseUnsignedProperty(&byteOffset, err, m.byteOffset, "byteOffset",
+                              false);
+
+  size_t byteLength = 1;
+  if (!StreamParseUnsignedProperty(&byteLength, err, m.byteLength,
+                                   "byteLength", true, "BufferView")) {
     return false;
   }
 
-  std::string type;
-  if (!ParseStringProperty(&type, err, o, "type", true, "Accessor")) {
-    return false;
+  size_t byteStride = 0;
+  if (!StreamParseUnsignedProperty(&byteStride, err, m.byteStride,
+                                   "byteStride", false)) {
+    // See ParseBufferView(), 0 means tightly packed.
+    byteStride = 0;
   }
 
-  if (type.compare("SCALAR") == 0) {
-    accessor->type = TINYGLTF_TYPE_SCALAR;
-  } else if (type.compare("VEC2") == 0) {
-    accessor->type = TINYGLTF_TYPE_VEC2;
-  } else if (type.compare("VEC3") == 0) {
-    accessor->type = TINYGLTF_TYPE_VEC3;
-  } else if (type.compare("VEC4") == 0) {
-    accessor->type = TINYGLTF_TYPE_VEC4;
-  } else if (type.compare("MAT2") == 0) {
-    accessor->type = TINYGLTF_TYPE_MAT2;
-  } else if (type.compare("MAT3") == 0) {
-    accessor->type = TINYGLTF_TYPE_MAT3;
-  } else if (type.compare("MAT4") == 0) {
-    accessor->type = TINYGLTF_TYPE_MAT4;
-  } else {
-    std::stringstream ss;
-    ss << "Unsupported `type` for accessor object. Got \"" << type << "\"\n";
+  if ((byteStride > 252) || ((byteStride % 4) != 0)) {
     if (err) {
+      std::stringstream ss;
+      ss << "Invalid `byteStride' value. `byteStride' must be the multiple of "
+            "4 : "
+         << byteStride << std::endl;
+
       (*err) += ss.str();
     }
     return false;
   }
 
-  ParseStringProperty(&accessor->name, err, o, "name", false);
+  int target = 0;
+  StreamParseIntegerProperty(&target, err, m.target, "target", false);
+  if ((target == TINYGLTF_TARGET_ARRAY_BUFFER) ||
+      (target == TINYGLTF_TARGET_ELEMENT_ARRAY_BUFFER)) {
+    // OK
+  } else {
+    target = 0;
+  }
+  bufferView->target = target;
 
-  accessor->minValues.clear();
-  accessor->maxValues.clear();
-  ParseNumberArrayProperty(&accessor->minValues, err, o, "min", false,
-                           "Accessor");
+  StreamParseStringProperty(&bufferView->name, err, m.name, "name", false);
 
-  ParseNumberArrayProperty(&accessor->maxValues, err, o, "max", false,
-                           "Accessor");
+  StreamParseExtensionsProperty(&bufferView->extensions, m.extensions);
+  StreamParseExtrasProperty(&bufferView->extras, m.extras);
 
-  accessor->count = count;
-  accessor->bufferView = bufferView;
-  accessor->byteOffset = byteOffset;
-  accessor->normalized = normalized;
-  {
-    if (componentType >= TINYGLTF_COMPONENT_TYPE_BYTE &&
-        componentType <= TINYGLTF_COMPONENT_TYPE_DOUBLE) {
-      // OK
-      accessor->componentType = int(componentType);
-    } else {
-      std::stringstream ss;
-      ss << "Invalid `componentType` in accessor. Got " << componentType
-         << "\n";
-      if (err) {
-        (*err) += ss.str();
-      }
-      return false;
+  bufferView->buffer = buffer;
+  bufferView->byteOffset = byteOffset;
+  bufferView->byteLength = byteLength;
+  bufferView->byteStride = byteStride;
+  return true;
+}
+
+struct StreamSparseMembers {
+  JsonSpan count, indices, values;
+
+  JsonSpan *Find(const StreamKey &key) {
+    switch (key.hash) {
+      TINYGLTF_STREAM_MEMBER(count)
+      TINYGLTF_STREAM_MEMBER(indices)
+      TINYGLTF_STREAM_MEMBER(values)
     }
+    return nullptr;
   }
+};
 
-  ParseExtensionsProperty(&(accessor->extensions), err, o);
-  ParseExtrasProperty(&(accessor->extras), o);
+// Members of accessor.sparse.indices and accessor.sparse.values.
+struct StreamSparseViewMembers {
+  JsonSpan bufferView, byteOffset, componentType;
 
-  if (store_original_json_for_extras_and_extensions) {
-    {
-      json_const_iterator it;
-      if (FindMember(o, "extensions", it)) {
-        accessor->extensions_json_string = JsonToString(GetValue(it));
-      }
-    }
-    {
-      json_const_iterator it;
-      if (FindMember(o, "extras", it)) {
-        accessor->extras_json_string = JsonToString(GetValue(it));
-      }
+  JsonSpan *Find(const StreamKey &key) {
+    switch (key.hash) {
+      TINYGLTF_STREAM_MEMBER(bufferView)
+      TINYGLTF_STREAM_MEMBER(byteOffset)
+      TINYGLTF_STREAM_MEMBER(componentType)
     }
+    return nullptr;
   }
+};
 
-  // check if accessor has a "sparse" object:
-  json_const_iterator iterator;
-  if (FindMember(o, "sparse", iterator)) {
-    // here this accessor has a "sparse" subobject
-    return ParseSparseAccessor(accessor, err, GetValue(iterator));
-  }
+static bool StreamParseSparseAccessor(Accessor *accessor, std::string *err,
+                                      const JsonSpan &o) {
+  accessor->sparse.isSparse = true;
 
-  return true;
-}
+  StreamSparseMembers m;
+  StreamIndexMembers(o, &m);
 
-#ifdef TINYGLTF_ENABLE_DRACO
+  int count = 0;
+  if (!StreamParseIntegerProperty(&count, err, m.count, "count", true,
+                                  "SparseAccessor")) {
+    return false;
+  }
 
-static void DecodeIndexBuffer(draco::Mesh *mesh, size_t componentSize,
-                              std::vector<uint8_t> &outBuffer) {
-  if (componentSize == 4) {
-    assert(sizeof(mesh->face(draco::FaceIndex(0))[0]) == componentSize);
-    memcpy(outBuffer.data(), &mesh->face(draco::FaceIndex(0))[0],
-           outBuffer.size());
-  } else {
-    size_t faceStride = componentSize * 3;
-    for (draco::FaceIndex f(0); f < mesh->num_faces(); ++f) {
-      const draco::Mesh::Face &face = mesh->face(f);
-      if (componentSize == 2) {
-        uint16_t indices[3] = {(uint16_t)face[0].value(),
-                               (uint16_t)face[1].value(),
-                               (uint16_t)face[2].value()};
-        memcpy(outBuffer.data() + f.value() * faceStride, &indices[0],
-               faceStride);
-      } else {
-        uint8_t indices[3] = {(uint8_t)face[0].value(),
-                              (uint8_t)face[1].value(),
-                              (uint8_t)face[2].value()};
-        memcpy(outBuffer.data() + f.value() * faceStride, &indices[0],
-               faceStride);
-      }
+  if (m.indices.empty()) {
+    if (err) {
+      (*err) = "the sparse object of this accessor doesn't have indices";
     }
+    return false;
   }
-}
 
-template <typename T>
-static bool GetAttributeForAllPoints(draco::Mesh *mesh,
-                                     const draco::PointAttribute *pAttribute,
-                                     std::vector<uint8_t> &outBuffer) {
-  size_t byteOffset = 0;
-  T values[4] = {0, 0, 0, 0};
-  for (draco::PointIndex i(0); i < mesh->num_points(); ++i) {
-    const draco::AttributeValueIndex val_index = pAttribute->mapped_index(i);
-    if (!pAttribute->ConvertValue<T>(val_index, pAttribute->num_components(),
-                                     values))
-      return false;
+  if (m.values.empty()) {
+    if (err) {
+      (*err) = "the sparse object ob ths accessor doesn't have values";
+    }
+    return false;
+  }
 
-    memcpy(outBuffer.data() + byteOffset, &values[0],
-           sizeof(T) * pAttribute->num_components());
-    byteOffset += sizeof(T) * pAttribute->num_components();
+  StreamSparseViewMembers indices;
+  StreamSparseViewMembers values;
+  StreamIndexMembers(m.indices, &indices);
+  StreamIndexMembers(m.values, &values);
+
+  int indices_buffer_view = 0, indices_byte_offset = 0, component_type = 0;
+  if (!StreamParseIntegerProperty(&indices_buffer_view, err,
+                                  indices.bufferView, "bufferView", true,
+                                  "SparseAccessor")) {
+    return false;
+  }
+  StreamParseIntegerProperty(&indices_byte_offset, err, indices.byteOffset,
+                             "byteOffset", false);
+  if (!StreamParseIntegerProperty(&component_type, err, indices.componentType,
+                                  "componentType", true, "SparseAccessor")) {
+    return false;
+  }
+
+  int values_buffer_view = 0, values_byte_offset = 0;
+  if (!StreamParseIntegerProperty(&values_buffer_view, err, values.bufferView,
+                                  "bufferView", true, "SparseAccessor")) {
+    return false;
   }
+  StreamParseIntegerProperty(&values_byte_offset, err, values.byteOffset,
+                             "byteOffset", false);
+
+  accessor->sparse.count = count;
+  accessor->sparse.indices.bufferView = indices_buffer_view;
+  accessor->sparse.indices.byteOffset = indices_byte_offset;
+  accessor->sparse.indices.componentType = component_type;
+  accessor->sparse.values.bufferView = values_buffer_view;
+  accessor->sparse.values.byteOffset = values_byte_offset;
 
   return true;
 }
 
-static bool GetAttributeForAllPoints(uint32_t componentType, draco::Mesh *mesh,
-                                     const draco::PointAttribute *pAttribute,
-                                     std::vector<uint8_t> &outBuffer) {
-  bool decodeResult = false;
-  switch (componentType) {
-    case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
-      decodeResult =
-          GetAttributeForAllPoints<uint8_t>(mesh, pAttribute, outBuffer);
-      break;
-    case TINYGLTF_COMPONENT_TYPE_BYTE:
-      decodeResult =
-          GetAttributeForAllPoints<int8_t>(mesh, pAttribute, outBuffer);
-      break;
-    case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
-      decodeResult =
-          GetAttributeForAllPoints<uint16_t>(mesh, pAttribute, outBuffer);
-      break;
-    case TINYGLTF_COMPONENT_TYPE_SHORT:
-      decodeResult =
-          GetAttributeForAllPoints<int16_t>(mesh, pAttribute, outBuffer);
-      break;
-    case TINYGLTF_COMPONENT_TYPE_INT:
-      decodeResult =
-          GetAttributeForAllPoints<int32_t>(mesh, pAttribute, outBuffer);
-      break;
-    case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:
-      decodeResult =
-          GetAttributeForAllPoints<uint32_t>(mesh, pAttribute, outBuffer);
-      break;
-    case TINYGLTF_COMPONENT_TYPE_FLOAT:
-      decodeResult =
-          GetAttributeForAllPoints<float>(mesh, pAttribute, outBuffer);
-      break;
-    case TINYGLTF_COMPONENT_TYPE_DOUBLE:
-      decodeResult =
-          GetAttributeForAllPoints<double>(mesh, pAttribute, outBuffer);
-      break;
-    default:
-      return false;
-  }
+struct StreamAccessorMembers {
+  JsonSpan bufferView, byteOffset, normalized, componentType, count, type,
+      name, min, max, sparse, extensions, extras;
 
-  return decodeResult;
-}
+  JsonSpan *Find(const StreamKey &key) {
+    switch (key.hash) {
+      TINYGLTF_STREAM_MEMBER(bufferView)
+      TINYGLTF_STREAM_MEMBER(byteOffset)
+      TINYGLTF_STREAM_MEMBER(normalized)
+      TINYGLTF_STREAM_MEMBER(componentType)
+      TINYGLTF_STREAM_MEMBER(count)
+      TINYGLTF_STREAM_MEMBER(type)
+      TINYGLTF_STREAM_MEMBER(name)
+      TINYGLTF_STREAM_MEMBER(min)
+      TINYGLTF_STREAM_MEMBER(max)
+      TINYGLTF_STREAM_MEMBER(sparse)
+      TINYGLTF_STREAM_MEMBER(extensions)
+      TINYGLTF_STREAM_MEMBER(extras)
+    }
+    return nullptr;
+  }
+};
 
-static bool ParseDracoExtension(Primitive *primitive, Model *model,
-                                std::string *err,
-                                const Value &dracoExtensionValue) {
-  (void)err;
-  auto bufferViewValue = dracoExtensionValue.Get("bufferView");
-  if (!bufferViewValue.IsInt()) return false;
-  auto attributesValue = dracoExtensionValue.Get("attributes");
-  if (!attributesValue.IsObject()) return false;
+static bool StreamParseAccessor(Accessor *accessor, std::string *err,
+                                const JsonSpan &o) {
+  StreamAccessorMembers m;
+  StreamIndexMembers(o, &m);
 
-  auto attributesObject = attributesValue.Get<Value::Object>();
-  int bufferView = bufferViewValue.Get<int>();
+  int bufferView = -1;
+  StreamParseIntegerProperty(&bufferView, err, m.bufferView, "bufferView",
+                             false, "Accessor");
 
-  BufferView &view = model->bufferViews[bufferView];
-  Buffer &buffer = model->buffers[view.buffer];
-  // BufferView has already been decoded
-  if (view.dracoDecoded) return true;
-  view.dracoDecoded = true;
+  size_t byteOffset = 0;
+  StreamParseUnsignedProperty(&byteOffset, err, m.byteOffset, "byteOffset",
+                              false, "Accessor");
 
-  const char *bufferViewData =
-      reinterpret_cast<const char *>(buffer.data.data() + view.byteOffset);
-  size_t bufferViewSize = view.byteLength;
+  bool normalized = false;
+  StreamParseBooleanProperty(&normalized, err, m.normalized, "normalized",
+                             false, "Accessor");
 
-  // decode draco
-  draco::DecoderBuffer decoderBuffer;
-  decoderBuffer.Init(bufferViewData, bufferViewSize);
-  draco::Decoder decoder;
-  auto decodeResult = decoder.DecodeMeshFromBuffer(&decoderBuffer);
-  if (!decodeResult.ok()) {
+  size_t componentType = 0;
+  if (!StreamParseUnsignedProperty(&componentType, err, m.componentType,
+                                   "componentType", true, "Accessor")) {
     return false;
   }
-  const std::unique_ptr<draco::Mesh> &mesh = decodeResult.value();
-
-  // create new bufferView for indices
-  if (primitive->indices >= 0) {
-    int32_t componentSize = GetComponentSizeInBytes(
-        model->accessors[primitive->indices].componentType);
-    Buffer decodedIndexBuffer;
-    decodedIndexBuffer.data.resize(mesh->num_faces() * 3 * componentSize);
 
-    DecodeIndexBuffer(mesh.get(), componentSize, decodedIndexBuffer.data);
-
-    model->buffers.emplace_back(std::move(decodedIndexBuffer));
+  size_t count = 0;
+  if (!StreamParseUnsignedProperty(&count, err, m.count, "count", true,
+                                   "Accessor")) {
+    return false;
+  }
 
-    BufferView decodedIndexBufferView;
-    decodedIndexBufferView.buffer = int(model->buffers.size() - 1);
-    decodedIndexBufferView.byteLength =
-        int(mesh->num_faces() * 3 * componentSize);
-    decodedIndexBufferView.byteOffset = 0;
-    decodedIndexBufferView.byteStride = 0;
-    decodedIndexBufferView.target = TINYGLTF_TARGET_ARRAY_BUFFER;
-    model->bufferViews.emplace_back(std::move(decodedIndexBufferView));
+  std::string type;
+  if (!StreamParseStringProperty(&type, err, m.type, "type", true,
+                                 "Accessor")) {
+    return false;
+  }
 
-    model->accessors[primitive->indices].bufferView =
-        int(model->bufferViews.size() - 1);
-    model->accessors[primitive->indices].count = int(mesh->num_faces() * 3);
+  if (type.compare("SCALAR") == 0) {
+    accessor->type = TINYGLTF_TYPE_SCALAR;
+  } else if (type.compare("VEC2") == 0) {
+    accessor->type = TINYGLTF_TYPE_VEC2;
+  } else if (type.compare("VEC3") == 0) {
+    accessor->type = TINYGLTF_TYPE_VEC3;
+  } else if (type.compare("VEC4") == 0) {
+    accessor->type = TINYGLTF_TYPE_VEC4;
+  } else if (type.compare("MAT2") == 0) {
+    accessor->type = TINYGLTF_TYPE_MAT2;
+  } else if (type.compare("MAT3") == 0) {
+    accessor->type = TINYGLTF_TYPE_MAT3;
+  } else if (type.compare("MAT4") == 0) {
+    accessor->type = TINYGLTF_TYPE_MAT4;
+  } else {
+    std::stringstream ss;
+    ss << "Unsupported `type` for accessor object. Got \"" << type << "\"\n";
+    if (err) {
+      (*err) += ss.str();
+    }
+    return false;
   }
 
-  for (const auto &attribute : attributesObject) {
-    if (!attribute.second.IsInt()) return false;
-    auto primitiveAttribute = primitive->attributes.find(attribute.first);
-    if (primitiveAttribute == primitive->attributes.end()) return false;
+  StreamParseStringProperty(&accessor->name, err, m.name, "name", false);
 
-    int dracoAttributeIndex = attribute.second.Get<int>();
-    const auto pAttribute = mesh->GetAttributeByUniqueId(dracoAttributeIndex);
-    const auto componentType =
-        model->accessors[primitiveAttribute->second].componentType;
+  accessor->minValues.clear();
+  accessor->maxValues.clear();
+  StreamParseNumberArrayProperty(&accessor->minValues, m.min);
 
-    // Create a new buffer for this decoded buffer
-    Buffer decodedBuffer;
-    size_t bufferSize = mesh->num_points() * pAttribute->num_components() *
-                        GetComponentSizeInBytes(componentType);
-    decodedBuffer.data.resize(bufferSize);
+  StreamParseNumberArrayProperty(&accessor->maxValues, m.max);
 
-    if (!GetAttributeForAllPoints(componentType, mesh.get(), pAttribute,
-                                  decodedBuffer.data))
+  accessor->count = count;
+  accessor->bufferView = bufferView;
+  accessor->byteOffset = byteOffset;
+  accessor->normalized = normalized;
+  {
+    if (componentType >= TINYGLTF_COMPONENT_TYPE_BYTE &&
+        componentType <= TINYGLTF_COMPONENT_TYPE_DOUBLE) {
+      // OK
+      accessor->componentType = int(componentType);
+    } else {
+      std::stringstream ss;
+      ss << "Invalid `componentType` in accessor. Got " << componentType
+         << "\n";
+      if (err) {
+        (*err) += ss.str();
+      }
       return false;
+    }
+  }
 
-    model->buffers.emplace_back(std::move(decodedBuffer));
-
-    BufferView decodedBufferView;
-    decodedBufferView.buffer = int(model->buffers.size() - 1);
-    decodedBufferView.byteLength = bufferSize;
-    decodedBufferView.byteOffset = pAttribute->byte_offset();
-    decodedBufferView.byteStride = pAttribute->byte_stride();
-    decodedBufferView.target = primitive->indices >= 0
-                                   ? TINYGLTF_TARGET_ELEMENT_ARRAY_BUFFER
-                                   : TINYGLTF_TARGET_ARRAY_BUFFER;
-    model->bufferViews.emplace_back(std::move(decodedBufferView));
+  StreamParseExtensionsProperty(&(accessor->extensions), m.extensions);
+  StreamParseExtrasProperty(&(accessor->extras), m.extras);
 
-    model->accessors[primitiveAttribute->second].bufferView =
-        int(model->bufferViews.size() - 1);
-    model->accessors[primitiveAttribute->second].count =
-        int(mesh->num_points());
+  // check if accessor has a "sparse" object:
+  if (!m.sparse.empty()) {
+    // here this accessor has a "sparse" subobject
+    return StreamParseSparseAccessor(accessor, err, m.sparse);
   }
 
   return true;
 }
-#endif
 
-static bool ParsePrimitive(Primitive *primitive, Model *model, std::string *err,
-                           const json &o,
-                           bool store_original_json_for_extras_and_extensions) {
+struct StreamPrimitiveMembers {
+  JsonSpan material, mode, indices, attributes, targets, extensions, extras;
+
+  JsonSpan *Find(const StreamKey &key) {
+    switch (key.hash) {
+      TINYGLTF_STREAM_MEMBER(material)
+      TINYGLTF_STREAM_MEMBER(mode)
+      TINYGLTF_STREAM_MEMBER(indices)
+      TINYGLTF_STREAM_MEMBER(attributes)
+      TINYGLTF_STREAM_MEMBER(targets)
+      TINYGLTF_STREAM_MEMBER(extensions)
+      TINYGLTF_STREAM_MEMBER(extras)
+    }
+    return nullptr;
+  }
+};
+
+static bool StreamParsePrimitive(Primitive *primitive, std::string *err,
+                                 const JsonSpan &o) {
+  StreamPrimitiveMembers m;
+  StreamIndexMembers(o, &m);
+
   int material = -1;
-  ParseIntegerProperty(&material, err, o, "material", false);
+  StreamParseIntegerProperty(&material, err, m.material, "material", false);
   primitive->material = material;
 
   int mode = TINYGLTF_MODE_TRIANGLES;
-  ParseIntegerProperty(&mode, err, o, "mode", false);
+  StreamParseIntegerProperty(&mode, err, m.mode, "mode", false);
   primitive->mode = mode;  // Why only triangled were supported ?
 
   int indices = -1;
-  ParseIntegerProperty(&indices, err, o, "indices", false);
+  StreamParseIntegerProperty(&indices, err, m.indices, "indices", false);
   primitive->indices = indices;
-  if (!ParseStringIntegerProperty(&primitive->attributes, err, o, "attributes",
-                                  true, "Primitive")) {
+  if (!StreamParseStringIntegerProperty(&primitive->attributes, err,
+                                        m.attributes, "attributes", true,
+                                        "Primitive")) {
     return false;
   }
 
   // Look for morph targets
-  json_const_iterator targetsObject;
-  if (FindMember(o, "targets", targetsObject) &&
-      IsArray(GetValue(targetsObject))) {
-    auto targetsObjectEnd = ArrayEnd(GetValue(targetsObject));
-    for (json_const_array_iterator i = ArrayBegin(GetValue(targetsObject));
-         i != targetsObjectEnd; ++i) {
+  StreamForEachInArray(m.targets, [&](const JsonSpan &dict) {
+    JsonReader r(dict);
+    if (r.EnterObject()) {
       std::map<std::string, int> targetAttribues;
-
-      const json &dict = *i;
-      if (IsObject(dict)) {
-        json_const_iterator dictIt(ObjectBegin(dict));
-        json_const_iterator dictItEnd(ObjectEnd(dict));
-
-        for (; dictIt != dictItEnd; ++dictIt) {
-          int iVal;
-          if (GetInt(GetValue(dictIt), iVal))
-            targetAttribues[GetKey(dictIt)] = iVal;
+      StreamKey key;
+      while (r.NextMember(&key)) {
+        std::string name(key.data, key.size);
+        JsonNumber number;
+        bool isNumber = r.ReadNumber(&number);
+        if (isNumber && number.IsInteger()) {
+          targetAttribues[name] = static_cast<int>(number.i);
+        } else {
+          if (!isNumber) r.Skip();
+          targetAttribues.erase(name);
         }
-        primitive->targets.emplace_back(std::move(targetAttribues));
-      }
-    }
-  }
-
-  ParseExtrasProperty(&(primitive->extras), o);
-  ParseExtensionsProperty(&primitive->extensions, err, o);
-
-  if (store_original_json_for_extras_and_extensions) {
-    {
-      json_const_iterator it;
-      if (FindMember(o, "extensions", it)) {
-        primitive->extensions_json_string = JsonToString(GetValue(it));
-      }
-    }
-    {
-      json_const_iterator it;
-      if (FindMember(o, "extras", it)) {
-        primitive->extras_json_string = JsonToString(GetValue(it));
       }
+      primitive->targets.emplace_back(std::move(targetAttribues));
     }
-  }
+    return true;
+  });
 
-#ifdef TINYGLTF_ENABLE_DRACO
-  auto dracoExtension =
-      primitive->extensions.find("KHR_draco_mesh_compression");
-  if (dracoExtension != primitive->extensions.end()) {
-    ParseDracoExtension(primitive, model, err, dracoExtension->second);
-  }
-#else
-  (void)model;
-#endif
+  StreamParseExtrasProperty(&(primitive->extras), m.extras);
+  StreamParseExtensionsProperty(&primitive->extensions, m.extensions);
 
   return true;
 }
 
-static bool ParseMesh(Mesh *mesh, Model *model, std::string *err, const json &o,
-                      bool store_original_json_for_extras_and_extensions) {
-  ParseStringProperty(&mesh->name, err, o, "name", false);
+struct StreamMeshMembers {
+  JsonSpan name, primitives, weights, extensions, extras;
 
-  mesh->primitives.clear();
-  json_const_iterator primObject;
-  if (FindMember(o, "primitives", primObject) &&
-      IsArray(GetValue(primObject))) {
-    json_const_array_iterator primEnd = ArrayEnd(GetValue(primObject));
-    for (json_const_array_iterator i = ArrayBegin(GetValue(primObject));
-         i != primEnd; ++i) {
-      Primitive primitive;
-      if (ParsePrimitive(&primitive, model, err, *i,
-                         store_original_json_for_extras_and_extensions)) {
-        // Only add the primitive if the parsing succeeds.
-        mesh->primitives.emplace_back(std::move(primitive));
-      }
+  JsonSpan *Find(const StreamKey &key) {
+    switch (key.hash) {
+      TINYGLTF_STREAM_MEMBER(name)
+      TINYGLTF_STREAM_MEMBER(primitives)
+      TINYGLTF_STREAM_MEMBER(weights)
+      TINYGLTF_STREAM_MEMBER(extensions)
+      TINYGLTF_STREAM_MEMBER(extras)
     }
+    return nullptr;
   }
+};
 
-  // Should probably check if has targets and if dimensions fit
-  ParseNumberArrayProperty(&mesh->weights, err, o, "weights", false);
+static bool StreamParseMesh(Mesh *mesh, std::string *err, const JsonSpan &o) {
+  StreamMeshMembers m;
+  StreamIndexMembers(o, &m);
 
-  ParseExtensionsProperty(&mesh->extensions, err, o);
-  ParseExtrasProperty(&(mesh->extras), o);
+  StreamParseStringProperty(&mesh->name, err, m.name, "name", false);
 
-  if (store_original_json_for_extras_and_extensions) {
-    {
-      json_const_iterator it;
-      if (FindMember(o, "extensions", it)) {
-        mesh->extensions_json_string = JsonToString(GetValue(it));
-      }
-    }
-    {
-      json_const_iterator it;
-      if (FindMember(o, "extras", it)) {
-        mesh->extras_json_string = JsonToString(GetValue(it));
-      }
+  mesh->primitives.clear();
+  StreamForEachInArray(m.primitives, [&](const JsonSpan &p) {
+    Primitive primitive;
+    if (StreamParsePrimitive(&primitive, err, p)) {
+      // Only add the primitive if the parsing succeeds.
+      mesh->primitives.emplace_back(std::move(primitive));
     }
-  }
+    return true;
+  });
+
+  // Should probably check if has targets and if dimensions fit
+  StreamParseNumberArrayProperty(&mesh->weights, m.weights);
+
+  StreamParseExtensionsProperty(&mesh->extensions, m.extensions);
+  StreamParseExtrasProperty(&(mesh->extras), m.extras);
 
   return true;
 }
 
-static bool ParseNode(Node *node, std::string *err, const json &o,
-                      bool store_original_json_for_extras_and_extensions) {
-  ParseStringProperty(&node->name, err, o, "name", false);
-
-  int skin = -1;
-  ParseIntegerProperty(&skin, err, o, "skin", false);
-  node->skin = skin;
+struct StreamNodeMembers {
+  JsonSpan name, skin, matrix, rotation, scale, translation, camera, mesh,
+      children, weights, extensions, extras;
 
-  // Matrix and T/R/S are exclusive
-  if (!ParseNumberArrayProperty(&node->matrix, err, o, "matrix", false)) {
-    ParseNumberArrayProperty(&node->rotation, err, o, "rotation", false);
-    ParseNumberArrayProperty(&node->scale, err, o, "scale", false);
-    ParseNumberArrayProperty(&node->translation, err, o, "translation", false);
+  JsonSpan *Find(const StreamKey &key) {
+    switch (key.hash) {
+      TINYGLTF_STREAM_MEMBER(name)
+      TINYGLTF_STREAM_MEMBER(skin)
+      TINYGLTF_STREAM_MEMBER(matrix)
+      TINYGLTF_STREAM_MEMBER(rotation)
+      TINYGLTF_STREAM_MEMBER(scale)
+      TINYGLTF_STREAM_MEMBER(translation)
+      TINYGLTF_STREAM_MEMBER(camera)
+      TINYGLTF_STREAM_MEMBER(mesh)
+      TINYGLTF_STREAM_MEMBER(children)
+      TINYGLTF_STREAM_MEMBER(weights)
+      TINYGLTF_STREAM_MEMBER(extensions)
+      TINYGLTF_STREAM_MEMBER(extras)
+    }
+    return nullptr;
   }
+};
 
-  int camera = -1;
-  ParseIntegerProperty(&camera, err, o, "camera", false);
-  node->camera = camera;
-
-  int mesh = -1;
-  ParseIntegerProperty(&mesh, err, o, "mesh", false);
-  node->mesh = mesh;
-
-  node->children.clear();
-  ParseIntegerArrayProperty(&node->children, err, o, "children", false);
-
-  ParseNumberArrayProperty(&node->weights, err, o, "weights", false);
-
-  ParseExtensionsProperty(&node->extensions, err, o);
-  ParseExtrasProperty(&(node->extras), o);
+static bool StreamParseNode(Node *node, std::string *err, const JsonSpan &o) {
+  StreamNodeMembers m;
+  StreamIndexMembers(o, &m);
 
-  if (store_original_json_for_extras_and_extensions) {
-    {
-      json_const_iterator it;
-      if (FindMember(o, "extensions", it)) {
-        node->extensions_json_string = JsonToString(GetValue(it));
-      }
-    }
-    {
-      json_const_iterator it;
-      if (FindMember(o, "extras", it)) {
-        node->extras_json_string = JsonToString(GetValue(it));
-      }
-    }
+  StreamParseStringProperty(&node->name, err, m.name, "name", false);
+
+  int skin = -1;
+  StreamParseIntegerProperty(&skin, err, m.skin, "skin", false);
+  node->skin = skin;
+
+  // Matrix and T/R/S are exclusive
+  if (!StreamParseNumberArrayProperty(&node->matrix, m.matrix)) {
+    StreamParseNumberArrayProperty(&node->rotation, m.rotation);
+    StreamParseNumberArrayProperty(&node->scale, m.scale);
+    StreamParseNumberArrayProperty(&node->translation, m.translation);
   }
 
+  int camera = -1;
+  StreamParseIntegerProperty(&camera, err, m.camera, "camera", false);
+  node->camera = camera;
+
+  int mesh = -1;
+  StreamParseIntegerProperty(&mesh, err, m.mesh, "mesh", false);
+  node->mesh = mesh;
+
+  node->children.clear();
+  StreamParseIntegerArrayProperty(&node->children, m.children);
+
+  StreamParseNumberArrayProperty(&node->weights, m.weights);
+
+  StreamParseExtensionsProperty(&node->extensions, m.extensions);
+  StreamParseExtrasProperty(&(node->extras), m.extras);
+
   return true;
 }
 
-static bool ParsePbrMetallicRoughness(
-    PbrMetallicRoughness *pbr, std::string *err, const json &o,
-    bool store_original_json_for_extras_and_extensions) {
-  if (pbr == nullptr) {
-    return false;
+struct StreamRootMembers {
+  JsonSpan asset, extensionsUsed, extensionsRequired, buffers, bufferViews,
+      accessors, meshes, nodes, scenes, scene, materials, images, textures,
+      animations, skins, samplers, cameras, extensions, extras;
+
+  JsonSpan *Find(const StreamKey &key) {
+    switch (key.hash) {
+      TINYGLTF_STREAM_MEMBER(asset)
+      TINYGLTF_STREAM_MEMBER(extensionsUsed)
+      TINYGLTF_STREAM_MEMBER(extensionsRequired)
+      TINYGLTF_STREAM_MEMBER(buffers)
+      TINYGLTF_STREAM_MEMBER(bufferViews)
+      TINYGLTF_STREAM_MEMBER(accessors)
+      TINYGLTF_STREAM_MEMBER(meshes)
+      TINYGLTF_STREAM_MEMBER(nodes)
+      TINYGLTF_STREAM_MEMBER(scenes)
+      TINYGLTF_STREAM_MEMBER(scene)
+      TINYGLTF_STREAM_MEMBER(materials)
+      TINYGLTF_STREAM_MEMBER(images)
+      TINYGLTF_STREAM_MEMBER(textures)
+      TINYGLTF_STREAM_MEMBER(animations)
+      TINYGLTF_STREAM_MEMBER(skins)
+      TINYGLTF_STREAM_MEMBER(samplers)
+      TINYGLTF_STREAM_MEMBER(cameras)
+      TINYGLTF_STREAM_MEMBER(extensions)
+      TINYGLTF_STREAM_MEMBER(extras)
+    }
+    return nullptr;
   }
+};
 
-  std::vector<double> baseColorFactor;
-  if (ParseNumberArrayProperty(&baseColorFactor, err, o, "baseColorFactor",
-                               /* required */ false)) {
-    if (baseColorFactor.size() != 4) {
-      if (err) {
-        (*err) +=
-            "Array length of `baseColorFactor` parameter in "
-            "pbrMetallicRoughness must be 4, but got " +
-            std::to_string(baseColorFactor.size()) + "\n";
-      }
-      return false;
-    }
-    pbr->baseColorFactor = baseColorFactor;
-  }
+struct StreamLightsPunctualMembers {
+  JsonSpan KHR_lights_punctual, lights;
 
-  {
-    json_const_iterator it;
-    if (FindMember(o, "baseColorTexture", it)) {
-      ParseTextureInfo(&pbr->baseColorTexture, err, GetValue(it),
-                       store_original_json_for_extras_and_extensions);
+  JsonSpan *Find(const StreamKey &key) {
+    switch (key.hash) {
+      TINYGLTF_STREAM_MEMBER(KHR_lights_punctual)
+      TINYGLTF_STREAM_MEMBER(lights)
     }
+    return nullptr;
   }
+};
 
-  {
-    json_const_iterator it;
-    if (FindMember(o, "metallicRoughnessTexture", it)) {
-      ParseTextureInfo(&pbr->metallicRoughnessTexture, err, GetValue(it),
-                       store_original_json_for_extras_and_extensions);
-    }
-  }
+}  // namespace
 
-  ParseNumberProperty(&pbr->metallicFactor, err, o, "metallicFactor", false);
-  ParseNumberProperty(&pbr->roughnessFactor, err, o, "roughnessFactor", false);
+#undef TINYGLTF_STREAM_MEMBER
 
-  ParseExtensionsProperty(&pbr->extensions, err, o);
-  ParseExtrasProperty(&pbr->extras, o);
+// Assign missing bufferView target types
+// - Look for missing Mesh indices
+// - Look for missing Mesh attributes
+static bool AssignBufferViewTargets(Model *model, std::string *err) {
+  for (auto &mesh : model->meshes) {
+    for (auto &primitive : mesh.primitives) {
+      if (primitive.indices >
+          -1)  // has indices from parsing step, must be Element Array Buffer
+      {
+        if (size_t(primitive.indices) >= model->accessors.size()) {
+          if (err) {
+            (*err) += "primitive indices accessor out of bounds";
+          }
+          return false;
+        }
 
-  if (store_original_json_for_extras_and_extensions) {
-    {
-      json_const_iterator it;
-      if (FindMember(o, "extensions", it)) {
-        pbr->extensions_json_string = JsonToString(GetValue(it));
+        auto bufferView =
+            model->accessors[size_t(primitive.indices)].bufferView;
+        if (bufferView < 0 || size_t(bufferView) >= model->bufferViews.size()) {
+          if (err) {
+            (*err) += "accessor[" + std::to_string(primitive.indices) +
+                      "] invalid bufferView";
+          }
+          return false;
+        }
+
+        model->bufferViews[size_t(bufferView)].target =
+            TINYGLTF_TARGET_ELEMENT_ARRAY_BUFFER;
+        // we could optionally check if acessors' bufferView type is Scalar, as
+        // it should be
       }
-    }
-    {
-      json_const_iterator it;
-      if (FindMember(o, "extras", it)) {
-        pbr->extras_json_string = JsonToString(GetValue(it));
+
+      for (auto &attribute : primitive.attributes) {
+        model
+            ->bufferViews[size_t(
+                model->accessors[size_t(attribute.second)].bufferView)]
+            .target = TINYGLTF_TARGET_ARRAY_BUFFER;
+      }
+
+      for (auto &target : primitive.targets) {
+        for (auto &attribute : target) {
+          auto bufferView =
+              model->accessors[size_t(attribute.second)].bufferView;
+          // bufferView could be null(-1) for sparse morph target
+          if (bufferView >= 0) {
+            model->bufferViews[size_t(bufferView)].target =
+                TINYGLTF_TARGET_ARRAY_BUFFER;
+          }
+        }
       }
     }
   }
@@ -4800,695 +9386,688 @@ static bool ParsePbrMetallicRoughness(
   return true;
 }
 
-static bool ParseMaterial(Material *material, std::string *err, const json &o,
-                          bool store_original_json_for_extras_and_extensions) {
-  ParseStringProperty(&material->name, err, o, "name", /* required */ false);
-
-  if (ParseNumberArrayProperty(&material->emissiveFactor, err, o,
-                               "emissiveFactor",
-                               /* required */ false)) {
-    if (material->emissiveFactor.size() != 3) {
-      if (err) {
-        (*err) +=
-            "Array length of `emissiveFactor` parameter in "
-            "material must be 3, but got " +
-            std::to_string(material->emissiveFactor.size()) + "\n";
-      }
-      return false;
+static bool LoadImageFromBufferView(Image *image, int idx, const Model &model,
+                                    LoadImageDataFunction LoadImageData,
+                                    void *load_image_user_data,
+                                    std::string *err, std::string *warn) {
+  if (size_t(image->bufferView) >= model.bufferViews.size()) {
+    if (err) {
+      std::stringstream ss;
+      ss << "image[" << idx << "] bufferView \"" << image->bufferView
+         << "\" not found in the scene." << std::endl;
+      (*err) += ss.str();
     }
-  } else {
-    // fill with default values
-    material->emissiveFactor = {0.0, 0.0, 0.0};
+    return false;
   }
 
-  ParseStringProperty(&material->alphaMode, err, o, "alphaMode",
-                      /* required */ false);
-  ParseNumberProperty(&material->alphaCutoff, err, o, "alphaCutoff",
-                      /* required */ false);
-  ParseBooleanProperty(&material->doubleSided, err, o, "doubleSided",
-                       /* required */ false);
-
-  {
-    json_const_iterator it;
-    if (FindMember(o, "pbrMetallicRoughness", it)) {
-      ParsePbrMetallicRoughness(&material->pbrMetallicRoughness, err,
-                                GetValue(it),
-                                store_original_json_for_extras_and_extensions);
+  const BufferView &bufferView = model.bufferViews[size_t(image->bufferView)];
+  if (size_t(bufferView.buffer) >= model.buffers.size()) {
+    if (err) {
+      std::stringstream ss;
+      ss << "image[" << idx << "] buffer \"" << bufferView.buffer
+         << "\" not found in the scene." << std::endl;
+      (*err) += ss.str();
     }
+    return false;
   }
+  const Buffer &buffer = model.buffers[size_t(bufferView.buffer)];
 
-  {
-    json_const_iterator it;
-    if (FindMember(o, "normalTexture", it)) {
-      ParseNormalTextureInfo(&material->normalTexture, err, GetValue(it),
-                             store_original_json_for_extras_and_extensions);
+  if (LoadImageData == nullptr) {
+    if (err) {
+      (*err) += "No LoadImageData callback specified.\n";
     }
+    return false;
   }
+  return LoadImageData(image, idx, err, warn, image->width, image->height,
+                       &buffer.data[bufferView.byteOffset],
+                       static_cast<int>(bufferView.byteLength),
+                       load_image_user_data);
+}
 
-  {
-    json_const_iterator it;
-    if (FindMember(o, "occlusionTexture", it)) {
-      ParseOcclusionTextureInfo(&material->occlusionTexture, err, GetValue(it),
-                                store_original_json_for_extras_and_extensions);
+bool TinyGLTF::LoadFromString(Model *model, std::string *err, std::string *warn,
+                              const char *json_str,
+                              unsigned int json_str_length,
+                              const std::string &base_dir,
+                              unsigned int check_sections) {
+  if (json_str_length < 4) {
+    if (err) {
+      (*err) = "JSON string too short.\n";
     }
+    return false;
   }
 
-  {
-    json_const_iterator it;
-    if (FindMember(o, "emissiveTexture", it)) {
-      ParseTextureInfo(&material->emissiveTexture, err, GetValue(it),
-                       store_original_json_for_extras_and_extensions);
-    }
+#ifndef TINYGLTF_ENABLE_DRACO
+  if (streaming_parser_ && !store_original_json_for_extras_and_extensions_) {
+    return LoadFromStringStreaming(model, err, warn, json_str, json_str_length,
+                                   base_dir, check_sections);
   }
+#endif
 
-  // Old code path. For backward compatibility, we still store material values
-  // as Parameter. This will create duplicated information for
-  // example(pbrMetallicRoughness), but should be neglible in terms of memory
-  // consumption.
-  // TODO(syoyo): Remove in the next major release.
-  material->values.clear();
-  material->additionalValues.clear();
-
-  json_const_iterator it(ObjectBegin(o));
-  json_const_iterator itEnd(ObjectEnd(o));
-
-  for (; it != itEnd; ++it) {
-    std::string key(GetKey(it));
-    if (key == "pbrMetallicRoughness") {
-      if (IsObject(GetValue(it))) {
-        const json &values_object = GetValue(it);
+  JsonDocument v;
 
-        json_const_iterator itVal(ObjectBegin(values_object));
-        json_const_iterator itValEnd(ObjectEnd(values_object));
+#if (defined(__cpp_exceptions) || defined(__EXCEPTIONS) || \
+     defined(_CPPUNWIND)) &&                               \
+    !defined(TINYGLTF_NOEXCEPTION)
+  try {
+    JsonParse(v, json_str, json_str_length, true);
 
-        for (; itVal != itValEnd; ++itVal) {
-          Parameter param;
-          if (ParseParameterProperty(&param, err, values_object, GetKey(itVal),
-                                     false)) {
-            material->values.emplace(GetKey(itVal), std::move(param));
-          }
-        }
-      }
-    } else if (key == "extensions" || key == "extras") {
-      // done later, skip, otherwise poorly parsed contents will be saved in the
-      // parametermap and serialized again later
-    } else {
-      Parameter param;
-      if (ParseParameterProperty(&param, err, o, key, false)) {
-        // names of materials have already been parsed. Putting it in this map
-        // doesn't correctly reflext the glTF specification
-        if (key != "name")
-          material->additionalValues.emplace(std::move(key), std::move(param));
-      }
+  } catch (const std::exception &e) {
+    if (err) {
+      (*err) = e.what();
     }
+    return false;
   }
+#else
+  {
+    JsonParse(v, json_str, json_str_length);
 
-  material->extensions.clear();
-  ParseExtensionsProperty(&material->extensions, err, o);
-  ParseExtrasProperty(&(material->extras), o);
-
-  if (store_original_json_for_extras_and_extensions) {
-    {
-      json_const_iterator eit;
-      if (FindMember(o, "extensions", eit)) {
-        material->extensions_json_string = JsonToString(GetValue(eit));
-      }
-    }
-    {
-      json_const_iterator eit;
-      if (FindMember(o, "extras", eit)) {
-        material->extras_json_string = JsonToString(GetValue(eit));
+    if (!IsObject(v)) {
+      // Assume parsing was failed.
+      if (err) {
+        (*err) = "Failed to parse JSON object\n";
       }
+      return false;
     }
   }
-
-  return true;
-}
-
-static bool ParseAnimationChannel(
-    AnimationChannel *channel, std::string *err, const json &o,
-    bool store_original_json_for_extras_and_extensions) {
-  int samplerIndex = -1;
-  int targetIndex = -1;
-  if (!ParseIntegerProperty(&samplerIndex, err, o, "sampler", true,
-                            "AnimationChannel")) {
+#endif
+
+  if (!IsObject(v)) {
+    // root is not an object.
     if (err) {
-      (*err) += "`sampler` field is missing in animation channels\n";
+      (*err) = "Root element is not a JSON object\n";
     }
     return false;
   }
 
-  json_const_iterator targetIt;
-  if (FindMember(o, "target", targetIt) && IsObject(GetValue(targetIt))) {
-    const json &target_object = GetValue(targetIt);
-
-    if (!ParseIntegerProperty(&targetIndex, err, target_object, "node", true)) {
-      if (err) {
-        (*err) += "`node` field is missing in animation.channels.target\n";
+  {
+    bool version_found = false;
+    json_const_iterator it;
+    if (FindMember(v, "asset", it) && IsObject(GetValue(it))) {
+      auto &itObj = GetValue(it);
+      json_const_iterator version_it;
+      std::string versionStr;
+      if (FindMember(itObj, "version", version_it) &&
+          GetString(GetValue(version_it), versionStr)) {
+        version_found = true;
       }
-      return false;
     }
-
-    if (!ParseStringProperty(&channel->target_path, err, target_object, "path",
-                             true)) {
+    if (version_found) {
+      // OK
+    } else if (check_sections & REQUIRE_VERSION) {
       if (err) {
-        (*err) += "`path` field is missing in animation.channels.target\n";
+        (*err) += "\"asset\" object not found in .gltf or not an object type\n";
       }
       return false;
     }
-    ParseExtensionsProperty(&channel->target_extensions, err, target_object);
-    if (store_original_json_for_extras_and_extensions) {
-      json_const_iterator it;
-      if (FindMember(target_object, "extensions", it)) {
-        channel->target_extensions_json_string = JsonToString(GetValue(it));
-      }
-    }
   }
 
-  channel->sampler = samplerIndex;
-  channel->target_node = targetIndex;
+  // scene is not mandatory.
+  // FIXME Maybe a better way to handle it than removing the code
 
-  ParseExtensionsProperty(&channel->extensions, err, o);
-  ParseExtrasProperty(&(channel->extras), o);
+  auto IsArrayMemberPresent = [](const json &_v, const char *name) -> bool {
+    json_const_iterator it;
+    return FindMember(_v, name, it) && IsArray(GetValue(it));
+  };
 
-  if (store_original_json_for_extras_and_extensions) {
-    {
-      json_const_iterator it;
-      if (FindMember(o, "extensions", it)) {
-        channel->extensions_json_string = JsonToString(GetValue(it));
-      }
-    }
-    {
-      json_const_iterator it;
-      if (FindMember(o, "extras", it)) {
-        channel->extras_json_string = JsonToString(GetValue(it));
+  {
+    if ((check_sections & REQUIRE_SCENES) &&
+        !IsArrayMemberPresent(v, "scenes")) {
+      if (err) {
+        (*err) += "\"scenes\" object not found in .gltf or not an array type\n";
       }
+      return false;
     }
   }
 
-  return true;
-}
-
-static bool ParseAnimation(Animation *animation, std::string *err,
-                           const json &o,
-                           bool store_original_json_for_extras_and_extensions) {
   {
-    json_const_iterator channelsIt;
-    if (FindMember(o, "channels", channelsIt) &&
-        IsArray(GetValue(channelsIt))) {
-      json_const_array_iterator channelEnd = ArrayEnd(GetValue(channelsIt));
-      for (json_const_array_iterator i = ArrayBegin(GetValue(channelsIt));
-           i != channelEnd; ++i) {
-        AnimationChannel channel;
-        if (ParseAnimationChannel(
-                &channel, err, *i,
-                store_original_json_for_extras_and_extensions)) {
-          // Only add the channel if the parsing succeeds.
-          animation->channels.emplace_back(std::move(channel));
-        }
+    if ((check_sections & REQUIRE_NODES) && !IsArrayMemberPresent(v, "nodes")) {
+      if (err) {
+        (*err) += "\"nodes\" object not found in .gltf\n";
       }
+      return false;
     }
   }
 
   {
-    json_const_iterator samplerIt;
-    if (FindMember(o, "samplers", samplerIt) && IsArray(GetValue(samplerIt))) {
-      const json &sampler_array = GetValue(samplerIt);
-
-      json_const_array_iterator it = ArrayBegin(sampler_array);
-      json_const_array_iterator itEnd = ArrayEnd(sampler_array);
-
-      for (; it != itEnd; ++it) {
-        const json &s = *it;
-
-        AnimationSampler sampler;
-        int inputIndex = -1;
-        int outputIndex = -1;
-        if (!ParseIntegerProperty(&inputIndex, err, s, "input", true)) {
-          if (err) {
-            (*err) += "`input` field is missing in animation.sampler\n";
-          }
-          return false;
-        }
-        ParseStringProperty(&sampler.interpolation, err, s, "interpolation",
-                            false);
-        if (!ParseIntegerProperty(&outputIndex, err, s, "output", true)) {
-          if (err) {
-            (*err) += "`output` field is missing in animation.sampler\n";
-          }
-          return false;
-        }
-        sampler.input = inputIndex;
-        sampler.output = outputIndex;
-        ParseExtensionsProperty(&(sampler.extensions), err, o);
-        ParseExtrasProperty(&(sampler.extras), s);
-
-        if (store_original_json_for_extras_and_extensions) {
-          {
-            json_const_iterator eit;
-            if (FindMember(o, "extensions", eit)) {
-              sampler.extensions_json_string = JsonToString(GetValue(eit));
-            }
-          }
-          {
-            json_const_iterator eit;
-            if (FindMember(o, "extras", eit)) {
-              sampler.extras_json_string = JsonToString(GetValue(eit));
-            }
-          }
-        }
-
-        animation->samplers.emplace_back(std::move(sampler));
+    if ((check_sections & REQUIRE_ACCESSORS) &&
+        !IsArrayMemberPresent(v, "accessors")) {
+      if (err) {
+        (*err) += "\"accessors\" object not found in .gltf\n";
       }
+      return false;
     }
   }
 
-  ParseStringProperty(&animation->name, err, o, "name", false);
-
-  ParseExtensionsProperty(&animation->extensions, err, o);
-  ParseExtrasProperty(&(animation->extras), o);
-
-  if (store_original_json_for_extras_and_extensions) {
-    {
-      json_const_iterator it;
-      if (FindMember(o, "extensions", it)) {
-        animation->extensions_json_string = JsonToString(GetValue(it));
+  {
+    if ((check_sections & REQUIRE_BUFFERS) &&
+        !IsArrayMemberPresent(v, "buffers")) {
+      if (err) {
+        (*err) += "\"buffers\" object not found in .gltf\n";
       }
+      return false;
     }
-    {
-      json_const_iterator it;
-      if (FindMember(o, "extras", it)) {
-        animation->extras_json_string = JsonToString(GetValue(it));
+  }
+
+  {
+    if ((check_sections & REQUIRE_BUFFER_VIEWS) &&
+        !IsArrayMemberPresent(v, "bufferViews")) {
+      if (err) {
+        (*err) += "\"bufferViews\" object not found in .gltf\n";
       }
+      return false;
     }
   }
 
-  return true;
-}
-
-static bool ParseSampler(Sampler *sampler, std::string *err, const json &o,
-                         bool store_original_json_for_extras_and_extensions) {
-  ParseStringProperty(&sampler->name, err, o, "name", false);
-
-  int minFilter = -1;
-  int magFilter = -1;
-  int wrapS = TINYGLTF_TEXTURE_WRAP_REPEAT;
-  int wrapT = TINYGLTF_TEXTURE_WRAP_REPEAT;
-  //int wrapR = TINYGLTF_TEXTURE_WRAP_REPEAT;
-  ParseIntegerProperty(&minFilter, err, o, "minFilter", false);
-  ParseIntegerProperty(&magFilter, err, o, "magFilter", false);
-  ParseIntegerProperty(&wrapS, err, o, "wrapS", false);
-  ParseIntegerProperty(&wrapT, err, o, "wrapT", false);
-  //ParseIntegerProperty(&wrapR, err, o, "wrapR", false);  // tinygltf extension
-
-  // TODO(syoyo): Check the value is alloed one.
-  // (e.g. we allow 9728(NEAREST), but don't allow 9727)
+  model->buffers.clear();
+  model->bufferViews.clear();
+  model->accessors.clear();
+  model->meshes.clear();
+  model->cameras.clear();
+  model->nodes.clear();
+  model->extensionsUsed.clear();
+  model->extensionsRequired.clear();
+  model->extensions.clear();
+  model->defaultScene = -1;
 
-  sampler->minFilter = minFilter;
-  sampler->magFilter = magFilter;
-  sampler->wrapS = wrapS;
-  sampler->wrapT = wrapT;
-  //sampler->wrapR = wrapR;
+  // 1. Parse Asset
+  {
+    json_const_iterator it;
+    if (FindMember(v, "asset", it) && IsObject(GetValue(it))) {
+      const json &root = GetValue(it);
 
-  ParseExtensionsProperty(&(sampler->extensions), err, o);
-  ParseExtrasProperty(&(sampler->extras), o);
+      ParseAsset(&model->asset, err, root,
+                 store_original_json_for_extras_and_extensions_);
+    }
+  }
 
-  if (store_original_json_for_extras_and_extensions) {
-    {
-      json_const_iterator it;
-      if (FindMember(o, "extensions", it)) {
-        sampler->extensions_json_string = JsonToString(GetValue(it));
+#ifdef TINYGLTF_USE_CPP14
+  auto ForEachInArray = [](const json &_v, const char *member,
+                           const auto &cb) -> bool
+#else
+  // The std::function<> implementation can be less efficient because it will
+  // allocate heap when the size of the captured lambda is above 16 bytes with
+  // clang and gcc, but it does not require C++14.
+  auto ForEachInArray = [](const json &_v, const char *member,
+                           const std::function<bool(const json &)> &cb) -> bool
+#endif
+  {
+    json_const_iterator itm;
+    if (FindMember(_v, member, itm) && IsArray(GetValue(itm))) {
+      const json &root = GetValue(itm);
+      auto it = ArrayBegin(root);
+      auto end = ArrayEnd(root);
+      for (; it != end; ++it) {
+        if (!cb(*it)) return false;
       }
     }
-    {
+    return true;
+  };
+
+  // 2. Parse extensionUsed
+  {
+    ForEachInArray(v, "extensionsUsed", [&](const json &o) {
+      std::string str;
+      GetString(o, str);
+      model->extensionsUsed.emplace_back(std::move(str));
+      return true;
+    });
+  }
+
+  {
+    ForEachInArray(v, "extensionsRequired", [&](const json &o) {
+      std::string str;
+      GetString(o, str);
+      model->extensionsRequired.emplace_back(std::move(str));
+      return true;
+    });
+  }
+
+  // External buffers and images are read while the document is parsed.
+  FsCallbacks *load_fs = &fs;
+#ifndef TINYGLTF_NO_THREADS
+  ExternalFilePrefetch prefetch(fs, async_fs_);
+  if ((external_file_threads_ > 0 || async_fs_.SubmitRead) && fs.FileExists &&
+      fs.ExpandFilePath && fs.ReadWholeFile) {
+    auto AddExternalFile = [&](const json &o) {
       json_const_iterator it;
-      if (FindMember(o, "extras", it)) {
-        sampler->extras_json_string = JsonToString(GetValue(it));
+      std::string uri;
+      if (IsObject(o) && FindMember(o, "uri", it) &&
+          GetString(GetValue(it), uri)) {
+        prefetch.Add(uri, base_dir);
       }
-    }
+      return true;
+    };
+    ForEachInArray(v, "buffers", AddExternalFile);
+#ifndef TINYGLTF_NO_EXTERNAL_IMAGE
+    ForEachInArray(v, "images", AddExternalFile);
+#endif
+    prefetch.Start(external_file_threads_, external_file_read_ahead_);
+    load_fs = prefetch.GetCallbacks();
   }
+#endif
 
-  return true;
-}
+  // 3. Parse Buffer
+  {
+    bool success = ForEachInArray(v, "buffers", [&](const json &o) {
+      if (!IsObject(o)) {
+        if (err) {
+          (*err) += "`buffers' does not contain an JSON object.";
+        }
+        return false;
+      }
+      Buffer buffer;
+      if (!ParseBuffer(&buffer, err, o,
+                       store_original_json_for_extras_and_extensions_, load_fs,
+                       base_dir, is_binary_, bin_data_, bin_size_)) {
+        return false;
+      }
 
-static bool ParseSkin(Skin *skin, std::string *err, const json &o,
-                      bool store_original_json_for_extras_and_extensions) {
-  ParseStringProperty(&skin->name, err, o, "name", false, "Skin");
+      model->buffers.emplace_back(std::move(buffer));
+      return true;
+    });
 
-  std::vector<int> joints;
-  if (!ParseIntegerArrayProperty(&joints, err, o, "joints", false, "Skin")) {
-    return false;
+    if (!success) {
+      return false;
+    }
   }
-  skin->joints = std::move(joints);
-
-  int skeleton = -1;
-  ParseIntegerProperty(&skeleton, err, o, "skeleton", false, "Skin");
-  skin->skeleton = skeleton;
+  // 4. Parse BufferView
+  {
+    bool success = ForEachInArray(v, "bufferViews", [&](const json &o) {
+      if (!IsObject(o)) {
+        if (err) {
+          (*err) += "`bufferViews' does not contain an JSON object.";
+        }
+        return false;
+      }
+      BufferView bufferView;
+      if (!ParseBufferView(&bufferView, err, o,
+                           store_original_json_for_extras_and_extensions_)) {
+        return false;
+      }
 
-  int invBind = -1;
-  ParseIntegerProperty(&invBind, err, o, "inverseBindMatrices", true, "Skin");
-  skin->inverseBindMatrices = invBind;
+      model->bufferViews.emplace_back(std::move(bufferView));
+      return true;
+    });
 
-  ParseExtensionsProperty(&(skin->extensions), err, o);
-  ParseExtrasProperty(&(skin->extras), o);
+    if (!success) {
+      return false;
+    }
+  }
 
-  if (store_original_json_for_extras_and_extensions) {
-    {
-      json_const_iterator it;
-      if (FindMember(o, "extensions", it)) {
-        skin->extensions_json_string = JsonToString(GetValue(it));
+  // 5. Parse Accessor
+  {
+    bool success = ForEachInArray(v, "accessors", [&](const json &o) {
+      if (!IsObject(o)) {
+        if (err) {
+          (*err) += "`accessors' does not contain an JSON object.";
+        }
+        return false;
       }
-    }
-    {
-      json_const_iterator it;
-      if (FindMember(o, "extras", it)) {
-        skin->extras_json_string = JsonToString(GetValue(it));
+      Accessor accessor;
+      if (!ParseAccessor(&accessor, err, o,
+                         store_original_json_for_extras_and_extensions_)) {
+        return false;
       }
+
+      model->accessors.emplace_back(std::move(accessor));
+      return true;
+    });
+
+    if (!success) {
+      return false;
     }
   }
 
-  return true;
-}
+  // 6. Parse Mesh
+  {
+    bool success = ForEachInArray(v, "meshes", [&](const json &o) {
+      if (!IsObject(o)) {
+        if (err) {
+          (*err) += "`meshes' does not contain an JSON object.";
+        }
+        return false;
+      }
+      Mesh mesh;
+      if (!ParseMesh(&mesh, model, err, o,
+                     store_original_json_for_extras_and_extensions_)) {
+        return false;
+      }
 
-static bool ParsePerspectiveCamera(
-    PerspectiveCamera *camera, std::string *err, const json &o,
-    bool store_original_json_for_extras_and_extensions) {
-  double yfov = 0.0;
-  if (!ParseNumberProperty(&yfov, err, o, "yfov", true, "OrthographicCamera")) {
-    return false;
+      model->meshes.emplace_back(std::move(mesh));
+      return true;
+    });
+
+    if (!success) {
+      return false;
+    }
   }
 
-  double znear = 0.0;
-  if (!ParseNumberProperty(&znear, err, o, "znear", true,
-                           "PerspectiveCamera")) {
+  // Assign missing bufferView target types
+  if (!AssignBufferViewTargets(model, err)) {
     return false;
   }
 
-  double aspectRatio = 0.0;  // = invalid
-  ParseNumberProperty(&aspectRatio, err, o, "aspectRatio", false,
-                      "PerspectiveCamera");
-
-  double zfar = 0.0;  // = invalid
-  ParseNumberProperty(&zfar, err, o, "zfar", false, "PerspectiveCamera");
-
-  camera->aspectRatio = aspectRatio;
-  camera->zfar = zfar;
-  camera->yfov = yfov;
-  camera->znear = znear;
-
-  ParseExtensionsProperty(&camera->extensions, err, o);
-  ParseExtrasProperty(&(camera->extras), o);
-
-  if (store_original_json_for_extras_and_extensions) {
-    {
-      json_const_iterator it;
-      if (FindMember(o, "extensions", it)) {
-        camera->extensions_json_string = JsonToString(GetValue(it));
+  // 7. Parse Node
+  {
+    bool success = ForEachInArray(v, "nodes", [&](const json &o) {
+      if (!IsObject(o)) {
+        if (err) {
+          (*err) += "`nodes' does not contain an JSON object.";
+        }
+        return false;
       }
-    }
-    {
-      json_const_iterator it;
-      if (FindMember(o, "extras", it)) {
-        camera->extras_json_string = JsonToString(GetValue(it));
+      Node node;
+      if (!ParseNode(&node, err, o,
+                     store_original_json_for_extras_and_extensions_)) {
+        return false;
       }
-    }
-  }
 
-  // TODO(syoyo): Validate parameter values.
+      model->nodes.emplace_back(std::move(node));
+      return true;
+    });
 
-  return true;
-}
+    if (!success) {
+      return false;
+    }
+  }
 
-static bool ParseSpotLight(SpotLight *light, std::string *err, const json &o,
-                           bool store_original_json_for_extras_and_extensions) {
-  ParseNumberProperty(&light->innerConeAngle, err, o, "innerConeAngle", false);
-  ParseNumberProperty(&light->outerConeAngle, err, o, "outerConeAngle", false);
+  // 8. Parse scenes.
+  {
+    bool success = ForEachInArray(v, "scenes", [&](const json &o) {
+      if (!IsObject(o)) {
+        if (err) {
+          (*err) += "`scenes' does not contain an JSON object.";
+        }
+        return false;
+      }
+      Scene scene;
+      ParseScene(&scene, err, o,
+                 store_original_json_for_extras_and_extensions_);
 
-  ParseExtensionsProperty(&light->extensions, err, o);
-  ParseExtrasProperty(&light->extras, o);
+      model->scenes.emplace_back(std::move(scene));
+      return true;
+    });
 
-  if (store_original_json_for_extras_and_extensions) {
-    {
-      json_const_iterator it;
-      if (FindMember(o, "extensions", it)) {
-        light->extensions_json_string = JsonToString(GetValue(it));
-      }
+    if (!success) {
+      return false;
     }
-    {
-      json_const_iterator it;
-      if (FindMember(o, "extras", it)) {
-        light->extras_json_string = JsonToString(GetValue(it));
-      }
+  }
+
+  // 9. Parse default scenes.
+  {
+    json_const_iterator rootIt;
+    int iVal;
+    if (FindMember(v, "scene", rootIt) && GetInt(GetValue(rootIt), iVal)) {
+      model->defaultScene = iVal;
     }
   }
 
-  // TODO(syoyo): Validate parameter values.
+  // 10. Parse Material
+  {
+    bool success = ForEachInArray(v, "materials", [&](const json &o) {
+      if (!IsObject(o)) {
+        if (err) {
+          (*err) += "`materials' does not contain an JSON object.";
+        }
+        return false;
+      }
+      Material material;
+      ParseStringProperty(&material.name, err, o, "name", false);
 
-  return true;
-}
+      if (!ParseMaterial(&material, err, o,
+                         store_original_json_for_extras_and_extensions_)) {
+        return false;
+      }
 
-static bool ParseOrthographicCamera(
-    OrthographicCamera *camera, std::string *err, const json &o,
-    bool store_original_json_for_extras_and_extensions) {
-  double xmag = 0.0;
-  if (!ParseNumberProperty(&xmag, err, o, "xmag", true, "OrthographicCamera")) {
-    return false;
-  }
+      model->materials.emplace_back(std::move(material));
+      return true;
+    });
 
-  double ymag = 0.0;
-  if (!ParseNumberProperty(&ymag, err, o, "ymag", true, "OrthographicCamera")) {
-    return false;
+    if (!success) {
+      return false;
+    }
   }
 
-  double zfar = 0.0;
-  if (!ParseNumberProperty(&zfar, err, o, "zfar", true, "OrthographicCamera")) {
-    return false;
-  }
+  // 11. Parse Image
+  void *load_image_user_data{nullptr};
 
-  double znear = 0.0;
-  if (!ParseNumberProperty(&znear, err, o, "znear", true,
-                           "OrthographicCamera")) {
-    return false;
-  }
+  LoadImageDataOption load_image_option;
 
-  ParseExtensionsProperty(&camera->extensions, err, o);
-  ParseExtrasProperty(&(camera->extras), o);
+  if (user_image_loader_) {
+    // Use user supplied pointer
+    load_image_user_data = load_image_user_data_;
+  } else {
+    load_image_option.preserve_channels = preserve_image_channels_;
+    load_image_user_data = reinterpret_cast<void *>(&load_image_option);
+  }
 
-  if (store_original_json_for_extras_and_extensions) {
-    {
-      json_const_iterator it;
-      if (FindMember(o, "extensions", it)) {
-        camera->extensions_json_string = JsonToString(GetValue(it));
+  {
+    int idx = 0;
+    bool success = ForEachInArray(v, "images", [&](const json &o) {
+      if (!IsObject(o)) {
+        if (err) {
+          (*err) += "image[" + std::to_string(idx) + "] is not a JSON object.";
+        }
+        return false;
       }
-    }
-    {
-      json_const_iterator it;
-      if (FindMember(o, "extras", it)) {
-        camera->extras_json_string = JsonToString(GetValue(it));
+      Image image;
+      if (!ParseImage(&image, idx, err, warn, o,
+                      store_original_json_for_extras_and_extensions_, base_dir,
+                      load_fs, &this->LoadImageData, load_image_user_data)) {
+        return false;
       }
-    }
-  }
-
-  camera->xmag = xmag;
-  camera->ymag = ymag;
-  camera->zfar = zfar;
-  camera->znear = znear;
 
-  // TODO(syoyo): Validate parameter values.
+      if (image.bufferView != -1) {
+        // Load image from the buffer view.
+        if (!LoadImageFromBufferView(&image, idx, *model, LoadImageData,
+                                     load_image_user_data, err, warn)) {
+          return false;
+        }
+      }
 
-  return true;
-}
+      model->images.emplace_back(std::move(image));
+      ++idx;
+      return true;
+    });
 
-static bool ParseCamera(Camera *camera, std::string *err, const json &o,
-                        bool store_original_json_for_extras_and_extensions) {
-  if (!ParseStringProperty(&camera->type, err, o, "type", true, "Camera")) {
-    return false;
+    if (!success) {
+      return false;
+    }
   }
 
-  if (camera->type.compare("orthographic") == 0) {
-    json_const_iterator orthoIt;
-    if (!FindMember(o, "orthographic", orthoIt)) {
-      if (err) {
-        std::stringstream ss;
-        ss << "Orhographic camera description not found." << std::endl;
-        (*err) += ss.str();
+  // 12. Parse Texture
+  {
+    bool success = ForEachInArray(v, "textures", [&](const json &o) {
+      if (!IsObject(o)) {
+        if (err) {
+          (*err) += "`textures' does not contain an JSON object.";
+        }
+        return false;
+      }
+      Texture texture;
+      if (!ParseTexture(&texture, err, o,
+                        store_original_json_for_extras_and_extensions_,
+                        base_dir)) {
+        return false;
       }
+
+      model->textures.emplace_back(std::move(texture));
+      return true;
+    });
+
+    if (!success) {
       return false;
     }
+  }
 
-    const json &v = GetValue(orthoIt);
-    if (!IsObject(v)) {
-      if (err) {
-        std::stringstream ss;
-        ss << "\"orthographic\" is not a JSON object." << std::endl;
-        (*err) += ss.str();
+  // 13. Parse Animation
+  {
+    bool success = ForEachInArray(v, "animations", [&](const json &o) {
+      if (!IsObject(o)) {
+        if (err) {
+          (*err) += "`animations' does not contain an JSON object.";
+        }
+        return false;
+      }
+      Animation animation;
+      if (!ParseAnimation(&animation, err, o,
+                          store_original_json_for_extras_and_extensions_)) {
+        return false;
       }
-      return false;
-    }
 
-    if (!ParseOrthographicCamera(
-            &camera->orthographic, err, v,
-            store_original_json_for_extras_and_extensions)) {
+      model->animations.emplace_back(std::move(animation));
+      return true;
+    });
+
+    if (!success) {
       return false;
     }
-  } else if (camera->type.compare("perspective") == 0) {
-    json_const_iterator perspIt;
-    if (!FindMember(o, "perspective", perspIt)) {
-      if (err) {
-        std::stringstream ss;
-        ss << "Perspective camera description not found." << std::endl;
-        (*err) += ss.str();
+  }
+
+  // 14. Parse Skin
+  {
+    bool success = ForEachInArray(v, "skins", [&](const json &o) {
+      if (!IsObject(o)) {
+        if (err) {
+          (*err) += "`skins' does not contain an JSON object.";
+        }
+        return false;
       }
+      Skin skin;
+      if (!ParseSkin(&skin, err, o,
+                     store_original_json_for_extras_and_extensions_)) {
+        return false;
+      }
+
+      model->skins.emplace_back(std::move(skin));
+      return true;
+    });
+
+    if (!success) {
       return false;
     }
+  }
 
-    const json &v = GetValue(perspIt);
-    if (!IsObject(v)) {
-      if (err) {
-        std::stringstream ss;
-        ss << "\"perspective\" is not a JSON object." << std::endl;
-        (*err) += ss.str();
+  // 15. Parse Sampler
+  {
+    bool success = ForEachInArray(v, "samplers", [&](const json &o) {
+      if (!IsObject(o)) {
+        if (err) {
+          (*err) += "`samplers' does not contain an JSON object.";
+        }
+        return false;
+      }
+      Sampler sampler;
+      if (!ParseSampler(&sampler, err, o,
+                        store_original_json_for_extras_and_extensions_)) {
+        return false;
       }
-      return false;
-    }
 
-    if (!ParsePerspectiveCamera(
-            &camera->perspective, err, v,
-            store_original_json_for_extras_and_extensions)) {
+      model->samplers.emplace_back(std::move(sampler));
+      return true;
+    });
+
+    if (!success) {
       return false;
     }
-  } else {
-    if (err) {
-      std::stringstream ss;
-      ss << "Invalid camera type: \"" << camera->type
-         << "\". Must be \"perspective\" or \"orthographic\"" << std::endl;
-      (*err) += ss.str();
-    }
-    return false;
   }
 
-  ParseStringProperty(&camera->name, err, o, "name", false);
-
-  ParseExtensionsProperty(&camera->extensions, err, o);
-  ParseExtrasProperty(&(camera->extras), o);
-
-  if (store_original_json_for_extras_and_extensions) {
-    {
-      json_const_iterator it;
-      if (FindMember(o, "extensions", it)) {
-        camera->extensions_json_string = JsonToString(GetValue(it));
+  // 16. Parse Camera
+  {
+    bool success = ForEachInArray(v, "cameras", [&](const json &o) {
+      if (!IsObject(o)) {
+        if (err) {
+          (*err) += "`cameras' does not contain an JSON object.";
+        }
+        return false;
       }
-    }
-    {
-      json_const_iterator it;
-      if (FindMember(o, "extras", it)) {
-        camera->extras_json_string = JsonToString(GetValue(it));
+      Camera camera;
+      if (!ParseCamera(&camera, err, o,
+                       store_original_json_for_extras_and_extensions_)) {
+        return false;
       }
+
+      model->cameras.emplace_back(std::move(camera));
+      return true;
+    });
+
+    if (!success) {
+      return false;
     }
   }
 
-  return true;
-}
+  // 17. Parse Extensions
+  ParseExtensionsProperty(&model->extensions, err, v);
 
-static bool ParseLight(Light *light, std::string *err, const json &o,
-                       bool store_original_json_for_extras_and_extensions) {
-  if (!ParseStringProperty(&light->type, err, o, "type", true)) {
-    return false;
-  }
+  // 18. Specific extension implementations
+  {
+    json_const_iterator rootIt;
+    if (FindMember(v, "extensions", rootIt) && IsObject(GetValue(rootIt))) {
+      const json &root = GetValue(rootIt);
 
-  if (light->type == "spot") {
-    json_const_iterator spotIt;
-    if (!FindMember(o, "spot", spotIt)) {
-      if (err) {
-        std::stringstream ss;
-        ss << "Spot light description not found." << std::endl;
-        (*err) += ss.str();
-      }
-      return false;
-    }
+      json_const_iterator it(ObjectBegin(root));
+      json_const_iterator itEnd(ObjectEnd(root));
+      for (; it != itEnd; ++it) {
+        // parse KHR_lights_punctual extension
+        std::string key(GetKey(it));
+        if ((key == "KHR_lights_punctual") && IsObject(GetValue(it))) {
+          const json &object = GetValue(it);
+          json_const_iterator itLight;
+          if (FindMember(object, "lights", itLight)) {
+            const json &lights = GetValue(itLight);
+            if (!IsArray(lights)) {
+              continue;
+            }
 
-    const json &v = GetValue(spotIt);
-    if (!IsObject(v)) {
-      if (err) {
-        std::stringstream ss;
-        ss << "\"spot\" is not a JSON object." << std::endl;
-        (*err) += ss.str();
+            auto arrayIt(ArrayBegin(lights));
+            auto arrayItEnd(ArrayEnd(lights));
+            for (; arrayIt != arrayItEnd; ++arrayIt) {
+              Light light;
+              if (!ParseLight(&light, err, *arrayIt,
+                              store_original_json_for_extras_and_extensions_)) {
+                return false;
+              }
+              model->lights.emplace_back(std::move(light));
+            }
+          }
+        }
       }
-      return false;
-    }
-
-    if (!ParseSpotLight(&light->spot, err, v,
-                        store_original_json_for_extras_and_extensions)) {
-      return false;
     }
   }
 
-  ParseStringProperty(&light->name, err, o, "name", false);
-  ParseNumberArrayProperty(&light->color, err, o, "color", false);
-  ParseNumberProperty(&light->range, err, o, "range", false);
-  ParseNumberProperty(&light->intensity, err, o, "intensity", false);
-  ParseExtensionsProperty(&light->extensions, err, o);
-  ParseExtrasProperty(&(light->extras), o);
+  // 19. Parse Extras
+  ParseExtrasProperty(&model->extras, v);
 
-  if (store_original_json_for_extras_and_extensions) {
-    {
-      json_const_iterator it;
-      if (FindMember(o, "extensions", it)) {
-        light->extensions_json_string = JsonToString(GetValue(it));
-      }
-    }
-    {
-      json_const_iterator it;
-      if (FindMember(o, "extras", it)) {
-        light->extras_json_string = JsonToString(GetValue(it));
-      }
-    }
+  if (store_original_json_for_extras_and_extensions_) {
+    model->extras_json_string = JsonToString(v["extras"]);
+    model->extensions_json_string = JsonToString(v["extensions"]);
   }
 
   return true;
 }
 
-bool TinyGLTF::LoadFromString(Model *model, std::string *err, std::string *warn,
-                              const char *json_str,
-                              unsigned int json_str_length,
-                              const std::string &base_dir,
-                              unsigned int check_sections) {
-  if (json_str_length < 4) {
-    if (err) {
-      (*err) = "JSON string too short.\n";
-    }
-    return false;
+bool TinyGLTF::LoadFromStringStreaming(Model *model, std::string *err,
+                                       std::string *warn,
+                                       const char *json_str,
+                                       unsigned int json_str_length,
+                                       const std::string &base_dir,
+                                       unsigned int check_sections) {
+  // The document is validated in one pass up front so that the Stream*
+  // functions only ever see well-formed JSON, then read again member by
+  // member without building a DOM.
+  JsonSpan v(json_str, json_str + json_str_length);
+  if ((json_str_length >= 3) && (memcmp(json_str, "\xEF\xBB\xBF", 3) == 0)) {
+    // Skip the UTF-8 BOM like the DOM parser does.
+    v.begin += 3;
   }
 
-  JsonDocument v;
-
-#if (defined(__cpp_exceptions) || defined(__EXCEPTIONS) || \
-     defined(_CPPUNWIND)) &&                               \
-    !defined(TINYGLTF_NOEXCEPTION)
-  try {
-    JsonParse(v, json_str, json_str_length, true);
-
-  } catch (const std::exception &e) {
-    if (err) {
-      (*err) = e.what();
-    }
+  JsonReader reader(v);
+  if (!reader.Validate(err) || !reader.ValidateEnd(err)) {
     return false;
   }
-#else
-  {
-    JsonParse(v, json_str, json_str_length);
-
-    if (!IsObject(v)) {
-      // Assume parsing was failed.
-      if (err) {
-        (*err) = "Failed to parse JSON object\n";
-      }
-      return false;
-    }
-  }
-#endif
 
-  if (!IsObject(v)) {
+  StreamRootMembers root;
+  if (!StreamIndexMembers(v, &root)) {
     // root is not an object.
     if (err) {
       (*err) = "Root element is not a JSON object\n";
@@ -5498,15 +10077,11 @@ bool TinyGLTF::LoadFromString(Model *model, std::string *err, std::string *warn,
 
   {
     bool version_found = false;
-    json_const_iterator it;
-    if (FindMember(v, "asset", it) && IsObject(GetValue(it))) {
-      auto &itObj = GetValue(it);
-      json_const_iterator version_it;
-      std::string versionStr;
-      if (FindMember(itObj, "version", version_it) &&
-          GetString(GetValue(version_it), versionStr)) {
-        version_found = true;
-      }
+    StreamAssetMembers asset;
+    std::string versionStr;
+    if (StreamIndexMembers(root.asset, &asset) &&
+        StreamGetString(asset.version, &versionStr)) {
+      version_found = true;
     }
     if (version_found) {
       // OK
@@ -5519,16 +10094,9 @@ bool TinyGLTF::LoadFromString(Model *model, std::string *err, std::string *warn,
   }
 
   // scene is not mandatory.
-  // FIXME Maybe a better way to handle it than removing the code
-
-  auto IsArrayMemberPresent = [](const json &_v, const char *name) -> bool {
-    json_const_iterator it;
-    return FindMember(_v, name, it) && IsArray(GetValue(it));
-  };
 
   {
-    if ((check_sections & REQUIRE_SCENES) &&
-        !IsArrayMemberPresent(v, "scenes")) {
+    if ((check_sections & REQUIRE_SCENES) && !StreamIsArray(root.scenes)) {
       if (err) {
         (*err) += "\"scenes\" object not found in .gltf or not an array type\n";
       }
@@ -5537,7 +10105,7 @@ bool TinyGLTF::LoadFromString(Model *model, std::string *err, std::string *warn,
   }
 
   {
-    if ((check_sections & REQUIRE_NODES) && !IsArrayMemberPresent(v, "nodes")) {
+    if ((check_sections & REQUIRE_NODES) && !StreamIsArray(root.nodes)) {
       if (err) {
         (*err) += "\"nodes\" object not found in .gltf\n";
       }
@@ -5547,7 +10115,7 @@ bool TinyGLTF::LoadFromString(Model *model, std::string *err, std::string *warn,
 
   {
     if ((check_sections & REQUIRE_ACCESSORS) &&
-        !IsArrayMemberPresent(v, "accessors")) {
+        !StreamIsArray(root.accessors)) {
       if (err) {
         (*err) += "\"accessors\" object not found in .gltf\n";
       }
@@ -5556,8 +10124,7 @@ bool TinyGLTF::LoadFromString(Model *model, std::string *err, std::string *warn,
   }
 
   {
-    if ((check_sections & REQUIRE_BUFFERS) &&
-        !IsArrayMemberPresent(v, "buffers")) {
+    if ((check_sections & REQUIRE_BUFFERS) && !StreamIsArray(root.buffers)) {
       if (err) {
         (*err) += "\"buffers\" object not found in .gltf\n";
       }
@@ -5567,7 +10134,7 @@ bool TinyGLTF::LoadFromString(Model *model, std::string *err, std::string *warn,
 
   {
     if ((check_sections & REQUIRE_BUFFER_VIEWS) &&
-        !IsArrayMemberPresent(v, "bufferViews")) {
+        !StreamIsArray(root.bufferViews)) {
       if (err) {
         (*err) += "\"bufferViews\" object not found in .gltf\n";
       }
@@ -5587,71 +10154,68 @@ bool TinyGLTF::LoadFromString(Model *model, std::string *err, std::string *warn,
   model->defaultScene = -1;
 
   // 1. Parse Asset
-  {
-    json_const_iterator it;
-    if (FindMember(v, "asset", it) && IsObject(GetValue(it))) {
-      const json &root = GetValue(it);
-
-      ParseAsset(&model->asset, err, root,
-                 store_original_json_for_extras_and_extensions_);
-    }
+  if (StreamIsObject(root.asset)) {
+    StreamParseWithDom(root.asset, [&](const json &o) {
+      return ParseAsset(&model->asset, err, o, false);
+    });
   }
 
-#ifdef TINYGLTF_USE_CPP14
-  auto ForEachInArray = [](const json &_v, const char *member,
-                           const auto &cb) -> bool
-#else
-  // The std::function<> implementation can be less efficient because it will
-  // allocate heap when the size of the captured lambda is above 16 bytes with
-  // clang and gcc, but it does not require C++14.
-  auto ForEachInArray = [](const json &_v, const char *member,
-                           const std::function<bool(const json &)> &cb) -> bool
-#endif
-  {
-    json_const_iterator itm;
-    if (FindMember(_v, member, itm) && IsArray(GetValue(itm))) {
-      const json &root = GetValue(itm);
-      auto it = ArrayBegin(root);
-      auto end = ArrayEnd(root);
-      for (; it != end; ++it) {
-        if (!cb(*it)) return false;
-      }
-    }
+  // 2. Parse extensionUsed
+  StreamForEachInArray(root.extensionsUsed, [&](const JsonSpan &o) {
+    std::string str;
+    StreamGetString(o, &str);
+    model->extensionsUsed.emplace_back(std::move(str));
     return true;
-  };
+  });
 
-  // 2. Parse extensionUsed
-  {
-    ForEachInArray(v, "extensionsUsed", [&](const json &o) {
-      std::string str;
-      GetString(o, str);
-      model->extensionsUsed.emplace_back(std::move(str));
+  StreamForEachInArray(root.extensionsRequired, [&](const JsonSpan &o) {
+    std::string str;
+    StreamGetString(o, &str);
+    model->extensionsRequired.emplace_back(std::move(str));
+    return true;
+  });
+
+  // External buffers and images are read while the document is parsed.
+  FsCallbacks *load_fs = &fs;
+#ifndef TINYGLTF_NO_THREADS
+  ExternalFilePrefetch prefetch(fs, async_fs_);
+  if ((external_file_threads_ > 0 || async_fs_.SubmitRead) && fs.FileExists &&
+      fs.ExpandFilePath && fs.ReadWholeFile) {
+    StreamForEachInArray(root.buffers, [&](const JsonSpan &o) {
+      StreamBufferMembers m;
+      std::string uri;
+      if (StreamIndexMembers(o, &m) && StreamGetString(m.uri, &uri)) {
+        prefetch.Add(uri, base_dir);
+      }
       return true;
     });
-  }
-
-  {
-    ForEachInArray(v, "extensionsRequired", [&](const json &o) {
-      std::string str;
-      GetString(o, str);
-      model->extensionsRequired.emplace_back(std::move(str));
+#ifndef TINYGLTF_NO_EXTERNAL_IMAGE
+    StreamForEachInArray(root.images, [&](const JsonSpan &o) {
+      StreamImageMembers m;
+      std::string uri;
+      if (StreamIndexMembers(o, &m) && StreamGetString(m.uri, &uri)) {
+        prefetch.Add(uri, base_dir);
+      }
       return true;
     });
+#endif
+    prefetch.Start(external_file_threads_, external_file_read_ahead_);
+    load_fs = prefetch.GetCallbacks();
   }
+#endif
 
   // 3. Parse Buffer
   {
-    bool success = ForEachInArray(v, "buffers", [&](const json &o) {
-      if (!IsObject(o)) {
+    bool success = StreamForEachInArray(root.buffers, [&](const JsonSpan &o) {
+      if (!StreamIsObject(o)) {
         if (err) {
           (*err) += "`buffers' does not contain an JSON object.";
         }
         return false;
       }
       Buffer buffer;
-      if (!ParseBuffer(&buffer, err, o,
-                       store_original_json_for_extras_and_extensions_, &fs,
-                       base_dir, is_binary_, bin_data_, bin_size_)) {
+      if (!StreamParseBuffer(&buffer, err, o, load_fs, base_dir, is_binary_,
+                             bin_data_, bin_size_)) {
         return false;
       }
 
@@ -5663,24 +10227,25 @@ bool TinyGLTF::LoadFromString(Model *model, std::string *err, std::string *warn,
       return false;
     }
   }
+
   // 4. Parse BufferView
   {
-    bool success = ForEachInArray(v, "bufferViews", [&](const json &o) {
-      if (!IsObject(o)) {
-        if (err) {
-          (*err) += "`bufferViews' does not contain an JSON object.";
-        }
-        return false;
-      }
-      BufferView bufferView;
-      if (!ParseBufferView(&bufferView, err, o,
-                           store_original_json_for_extras_and_extensions_)) {
-        return false;
-      }
+    bool success =
+        StreamForEachInArray(root.bufferViews, [&](const JsonSpan &o) {
+          if (!StreamIsObject(o)) {
+            if (err) {
+              (*err) += "`bufferViews' does not contain an JSON object.";
+            }
+            return false;
+          }
+          BufferView bufferView;
+          if (!StreamParseBufferView(&bufferView, err, o)) {
+            return false;
+          }
 
-      model->bufferViews.emplace_back(std::move(bufferView));
-      return true;
-    });
+          model->bufferViews.emplace_back(std::move(bufferView));
+          return true;
+        });
 
     if (!success) {
       return false;
@@ -5689,116 +10254,66 @@ bool TinyGLTF::LoadFromString(Model *model, std::string *err, std::string *warn,
 
   // 5. Parse Accessor
   {
-    bool success = ForEachInArray(v, "accessors", [&](const json &o) {
-      if (!IsObject(o)) {
+    bool success = StreamForEachInArray(root.accessors, [&](const JsonSpan &o) {
+      if (!StreamIsObject(o)) {
         if (err) {
           (*err) += "`accessors' does not contain an JSON object.";
         }
-        return false;
-      }
-      Accessor accessor;
-      if (!ParseAccessor(&accessor, err, o,
-                         store_original_json_for_extras_and_extensions_)) {
-        return false;
-      }
-
-      model->accessors.emplace_back(std::move(accessor));
-      return true;
-    });
-
-    if (!success) {
-      return false;
-    }
-  }
-
-  // 6. Parse Mesh
-  {
-    bool success = ForEachInArray(v, "meshes", [&](const json &o) {
-      if (!IsObject(o)) {
-        if (err) {
-          (*err) += "`meshes' does not contain an JSON object.";
-        }
-        return false;
-      }
-      Mesh mesh;
-      if (!ParseMesh(&mesh, model, err, o,
-                     store_original_json_for_extras_and_extensions_)) {
-        return false;
-      }
-
-      model->meshes.emplace_back(std::move(mesh));
-      return true;
-    });
-
-    if (!success) {
-      return false;
-    }
-  }
-
-  // Assign missing bufferView target types
-  // - Look for missing Mesh indices
-  // - Look for missing Mesh attributes
-  for (auto &mesh : model->meshes) {
-    for (auto &primitive : mesh.primitives) {
-      if (primitive.indices >
-          -1)  // has indices from parsing step, must be Element Array Buffer
-      {
-        if (size_t(primitive.indices) >= model->accessors.size()) {
-          if (err) {
-            (*err) += "primitive indices accessor out of bounds";
-          }
-          return false;
-        }
-
-        auto bufferView =
-            model->accessors[size_t(primitive.indices)].bufferView;
-        if (bufferView < 0 || size_t(bufferView) >= model->bufferViews.size()) {
-          if (err) {
-            (*err) += "accessor[" + std::to_string(primitive.indices) +
-                      "] invalid bufferView";
-          }
-          return false;
-        }
-
-        model->bufferViews[size_t(bufferView)].target =
-            TINYGLTF_TARGET_ELEMENT_ARRAY_BUFFER;
-        // we could optionally check if acessors' bufferView type is Scalar, as
-        // it should be
+        return false;
       }
-
-      for (auto &attribute : primitive.attributes) {
-        model
-            ->bufferViews[size_t(
-                model->accessors[size_t(attribute.second)].bufferView)]
-            .target = TINYGLTF_TARGET_ARRAY_BUFFER;
+      Accessor accessor;
+      if (!StreamParseAccessor(&accessor, err, o)) {
+        return false;
       }
 
-      for (auto &target : primitive.targets) {
-        for (auto &attribute : target) {
-          auto bufferView =
-              model->accessors[size_t(attribute.second)].bufferView;
-          // bufferView could be null(-1) for sparse morph target
-          if (bufferView >= 0) {
-            model->bufferViews[size_t(bufferView)].target =
-                TINYGLTF_TARGET_ARRAY_BUFFER;
-          }
+      model->accessors.emplace_back(std::move(accessor));
+      return true;
+    });
+
+    if (!success) {
+      return false;
+    }
+  }
+
+  // 6. Parse Mesh
+  {
+    bool success = StreamForEachInArray(root.meshes, [&](const JsonSpan &o) {
+      if (!StreamIsObject(o)) {
+        if (err) {
+          (*err) += "`meshes' does not contain an JSON object.";
         }
+        return false;
       }
+      Mesh mesh;
+      if (!StreamParseMesh(&mesh, err, o)) {
+        return false;
+      }
+
+      model->meshes.emplace_back(std::move(mesh));
+      return true;
+    });
+
+    if (!success) {
+      return false;
     }
   }
 
+  // Assign missing bufferView target types
+  if (!AssignBufferViewTargets(model, err)) {
+    return false;
+  }
+
   // 7. Parse Node
   {
-    bool success = ForEachInArray(v, "nodes", [&](const json &o) {
-      if (!IsObject(o)) {
+    bool success = StreamForEachInArray(root.nodes, [&](const JsonSpan &o) {
+      if (!StreamIsObject(o)) {
         if (err) {
           (*err) += "`nodes' does not contain an JSON object.";
         }
         return false;
       }
       Node node;
-      if (!ParseNode(&node, err, o,
-                     store_original_json_for_extras_and_extensions_)) {
+      if (!StreamParseNode(&node, err, o)) {
         return false;
       }
 
@@ -5813,38 +10328,17 @@ bool TinyGLTF::LoadFromString(Model *model, std::string *err, std::string *warn,
 
   // 8. Parse scenes.
   {
-    bool success = ForEachInArray(v, "scenes", [&](const json &o) {
-      if (!IsObject(o)) {
+    bool success = StreamForEachInArray(root.scenes, [&](const JsonSpan &o) {
+      if (!StreamIsObject(o)) {
         if (err) {
           (*err) += "`scenes' does not contain an JSON object.";
         }
         return false;
       }
-      std::vector<int> nodes;
-      ParseIntegerArrayProperty(&nodes, err, o, "nodes", false);
-
       Scene scene;
-      scene.nodes = std::move(nodes);
-
-      ParseStringProperty(&scene.name, err, o, "name", false);
-
-      ParseExtensionsProperty(&scene.extensions, err, o);
-      ParseExtrasProperty(&scene.extras, o);
-
-      if (store_original_json_for_extras_and_extensions_) {
-        {
-          json_const_iterator it;
-          if (FindMember(o, "extensions", it)) {
-            scene.extensions_json_string = JsonToString(GetValue(it));
-          }
-        }
-        {
-          json_const_iterator it;
-          if (FindMember(o, "extras", it)) {
-            scene.extras_json_string = JsonToString(GetValue(it));
-          }
-        }
-      }
+      StreamParseWithDom(o, [&](const json &j) {
+        return ParseScene(&scene, err, j, false);
+      });
 
       model->scenes.emplace_back(std::move(scene));
       return true;
@@ -5857,27 +10351,25 @@ bool TinyGLTF::LoadFromString(Model *model, std::string *err, std::string *warn,
 
   // 9. Parse default scenes.
   {
-    json_const_iterator rootIt;
     int iVal;
-    if (FindMember(v, "scene", rootIt) && GetInt(GetValue(rootIt), iVal)) {
+    if (StreamGetInt(root.scene, &iVal)) {
       model->defaultScene = iVal;
     }
   }
 
   // 10. Parse Material
   {
-    bool success = ForEachInArray(v, "materials", [&](const json &o) {
-      if (!IsObject(o)) {
+    bool success = StreamForEachInArray(root.materials, [&](const JsonSpan &o) {
+      if (!StreamIsObject(o)) {
         if (err) {
           (*err) += "`materials' does not contain an JSON object.";
         }
         return false;
       }
       Material material;
-      ParseStringProperty(&material.name, err, o, "name", false);
-
-      if (!ParseMaterial(&material, err, o,
-                         store_original_json_for_extras_and_extensions_)) {
+      if (!StreamParseWithDom(o, [&](const json &j) {
+            return ParseMaterial(&material, err, j, false);
+          })) {
         return false;
       }
 
@@ -5905,56 +10397,23 @@ bool TinyGLTF::LoadFromString(Model *model, std::string *err, std::string *warn,
 
   {
     int idx = 0;
-    bool success = ForEachInArray(v, "images", [&](const json &o) {
-      if (!IsObject(o)) {
+    bool success = StreamForEachInArray(root.images, [&](const JsonSpan &o) {
+      if (!StreamIsObject(o)) {
         if (err) {
           (*err) += "image[" + std::to_string(idx) + "] is not a JSON object.";
         }
         return false;
       }
       Image image;
-      if (!ParseImage(&image, idx, err, warn, o,
-                      store_original_json_for_extras_and_extensions_, base_dir,
-                      &fs, &this->LoadImageData, load_image_user_data)) {
+      if (!StreamParseImage(&image, idx, err, warn, o, base_dir, load_fs,
+                            &this->LoadImageData, load_image_user_data)) {
         return false;
       }
 
       if (image.bufferView != -1) {
         // Load image from the buffer view.
-        if (size_t(image.bufferView) >= model->bufferViews.size()) {
-          if (err) {
-            std::stringstream ss;
-            ss << "image[" << idx << "] bufferView \"" << image.bufferView
-               << "\" not found in the scene." << std::endl;
-            (*err) += ss.str();
-          }
-          return false;
-        }
-
-        const BufferView &bufferView =
-            model->bufferViews[size_t(image.bufferView)];
-        if (size_t(bufferView.buffer) >= model->buffers.size()) {
-          if (err) {
-            std::stringstream ss;
-            ss << "image[" << idx << "] buffer \"" << bufferView.buffer
-               << "\" not found in the scene." << std::endl;
-            (*err) += ss.str();
-          }
-          return false;
-        }
-        const Buffer &buffer = model->buffers[size_t(bufferView.buffer)];
-
-        if (*LoadImageData == nullptr) {
-          if (err) {
-            (*err) += "No LoadImageData callback specified.\n";
-          }
-          return false;
-        }
-        bool ret = LoadImageData(
-            &image, idx, err, warn, image.width, image.height,
-            &buffer.data[bufferView.byteOffset],
-            static_cast<int>(bufferView.byteLength), load_image_user_data);
-        if (!ret) {
+        if (!LoadImageFromBufferView(&image, idx, *model, LoadImageData,
+                                     load_image_user_data, err, warn)) {
           return false;
         }
       }
@@ -5971,17 +10430,17 @@ bool TinyGLTF::LoadFromString(Model *model, std::string *err, std::string *warn,
 
   // 12. Parse Texture
   {
-    bool success = ForEachInArray(v, "textures", [&](const json &o) {
-      if (!IsObject(o)) {
+    bool success = StreamForEachInArray(root.textures, [&](const JsonSpan &o) {
+      if (!StreamIsObject(o)) {
         if (err) {
           (*err) += "`textures' does not contain an JSON object.";
         }
         return false;
       }
       Texture texture;
-      if (!ParseTexture(&texture, err, o,
-                        store_original_json_for_extras_and_extensions_,
-                        base_dir)) {
+      if (!StreamParseWithDom(o, [&](const json &j) {
+            return ParseTexture(&texture, err, j, false, base_dir);
+          })) {
         return false;
       }
 
@@ -5996,22 +10455,24 @@ bool TinyGLTF::LoadFromString(Model *model, std::string *err, std::string *warn,
 
   // 13. Parse Animation
   {
-    bool success = ForEachInArray(v, "animations", [&](const json &o) {
-      if (!IsObject(o)) {
-        if (err) {
-          (*err) += "`animations' does not contain an JSON object.";
-        }
-        return false;
-      }
-      Animation animation;
-      if (!ParseAnimation(&animation, err, o,
-                          store_original_json_for_extras_and_extensions_)) {
-        return false;
-      }
+    bool success =
+        StreamForEachInArray(root.animations, [&](const JsonSpan &o) {
+          if (!StreamIsObject(o)) {
+            if (err) {
+              (*err) += "`animations' does not contain an JSON object.";
+            }
+            return false;
+          }
+          Animation animation;
+          if (!StreamParseWithDom(o, [&](const json &j) {
+                return ParseAnimation(&animation, err, j, false);
+              })) {
+            return false;
+          }
 
-      model->animations.emplace_back(std::move(animation));
-      return true;
-    });
+          model->animations.emplace_back(std::move(animation));
+          return true;
+        });
 
     if (!success) {
       return false;
@@ -6020,16 +10481,17 @@ bool TinyGLTF::LoadFromString(Model *model, std::string *err, std::string *warn,
 
   // 14. Parse Skin
   {
-    bool success = ForEachInArray(v, "skins", [&](const json &o) {
-      if (!IsObject(o)) {
+    bool success = StreamForEachInArray(root.skins, [&](const JsonSpan &o) {
+      if (!StreamIsObject(o)) {
         if (err) {
           (*err) += "`skins' does not contain an JSON object.";
         }
         return false;
       }
       Skin skin;
-      if (!ParseSkin(&skin, err, o,
-                     store_original_json_for_extras_and_extensions_)) {
+      if (!StreamParseWithDom(o, [&](const json &j) {
+            return ParseSkin(&skin, err, j, false);
+          })) {
         return false;
       }
 
@@ -6044,16 +10506,17 @@ bool TinyGLTF::LoadFromString(Model *model, std::string *err, std::string *warn,
 
   // 15. Parse Sampler
   {
-    bool success = ForEachInArray(v, "samplers", [&](const json &o) {
-      if (!IsObject(o)) {
+    bool success = StreamForEachInArray(root.samplers, [&](const JsonSpan &o) {
+      if (!StreamIsObject(o)) {
         if (err) {
           (*err) += "`samplers' does not contain an JSON object.";
         }
         return false;
       }
       Sampler sampler;
-      if (!ParseSampler(&sampler, err, o,
-                        store_original_json_for_extras_and_extensions_)) {
+      if (!StreamParseWithDom(o, [&](const json &j) {
+            return ParseSampler(&sampler, err, j, false);
+          })) {
         return false;
       }
 
@@ -6068,16 +10531,17 @@ bool TinyGLTF::LoadFromString(Model *model, std::string *err, std::string *warn,
 
   // 16. Parse Camera
   {
-    bool success = ForEachInArray(v, "cameras", [&](const json &o) {
-      if (!IsObject(o)) {
+    bool success = StreamForEachInArray(root.cameras, [&](const JsonSpan &o) {
+      if (!StreamIsObject(o)) {
         if (err) {
           (*err) += "`cameras' does not contain an JSON object.";
         }
         return false;
       }
       Camera camera;
-      if (!ParseCamera(&camera, err, o,
-                       store_original_json_for_extras_and_extensions_)) {
+      if (!StreamParseWithDom(o, [&](const json &j) {
+            return ParseCamera(&camera, err, j, false);
+          })) {
         return false;
       }
 
@@ -6091,51 +10555,34 @@ bool TinyGLTF::LoadFromString(Model *model, std::string *err, std::string *warn,
   }
 
   // 17. Parse Extensions
-  ParseExtensionsProperty(&model->extensions, err, v);
+  StreamParseExtensionsProperty(&model->extensions, root.extensions);
 
   // 18. Specific extension implementations
   {
-    json_const_iterator rootIt;
-    if (FindMember(v, "extensions", rootIt) && IsObject(GetValue(rootIt))) {
-      const json &root = GetValue(rootIt);
-
-      json_const_iterator it(ObjectBegin(root));
-      json_const_iterator itEnd(ObjectEnd(root));
-      for (; it != itEnd; ++it) {
-        // parse KHR_lights_punctual extension
-        std::string key(GetKey(it));
-        if ((key == "KHR_lights_punctual") && IsObject(GetValue(it))) {
-          const json &object = GetValue(it);
-          json_const_iterator itLight;
-          if (FindMember(object, "lights", itLight)) {
-            const json &lights = GetValue(itLight);
-            if (!IsArray(lights)) {
-              continue;
+    StreamLightsPunctualMembers extensions;
+    StreamLightsPunctualMembers lights_punctual;
+    if (StreamIndexMembers(root.extensions, &extensions) &&
+        StreamIndexMembers(extensions.KHR_lights_punctual, &lights_punctual)) {
+      bool success =
+          StreamForEachInArray(lights_punctual.lights, [&](const JsonSpan &o) {
+            Light light;
+            if (!StreamParseWithDom(o, [&](const json &j) {
+                  return ParseLight(&light, err, j, false);
+                })) {
+              return false;
             }
+            model->lights.emplace_back(std::move(light));
+            return true;
+          });
 
-            auto arrayIt(ArrayBegin(lights));
-            auto arrayItEnd(ArrayEnd(lights));
-            for (; arrayIt != arrayItEnd; ++arrayIt) {
-              Light light;
-              if (!ParseLight(&light, err, *arrayIt,
-                              store_original_json_for_extras_and_extensions_)) {
-                return false;
-              }
-              model->lights.emplace_back(std::move(light));
-            }
-          }
-        }
+      if (!success) {
+        return false;
       }
     }
   }
 
   // 19. Parse Extras
-  ParseExtrasProperty(&model->extras, v);
-
-  if (store_original_json_for_extras_and_extensions_) {
-    model->extras_json_string = JsonToString(v["extras"]);
-    model->extensions_json_string = JsonToString(v["extensions"]);
-  }
+  StreamParseExtrasProperty(&model->extras, root.extras);
 
   return true;
 }
@@ -6450,7 +10897,7 @@ static bool ValueToJson(const Value &value, json *ret) {
       break;
     case OBJECT_TYPE: {
       obj.SetObject();
-      Value::Object objMap = value.Get<Value::Object>();
+      const Value::Object &objMap = value.Get<Value::Object>();
       for (auto &it : objMap) {
         json elementJson;
         if (ValueToJson(it.second, &elementJson)) {
@@ -6493,7 +10940,7 @@ static bool ValueToJson(const Value &value, json *ret) {
       return false;
       break;
     case OBJECT_TYPE: {
-      Value::Object objMap = value.Get<Value::Object>();
+      const Value::Object &objMap = value.Get<Value::Object>();
       for (auto &it : objMap) {
         json elementJson;
         if (ValueToJson(it.second, &elementJson)) obj[it.first] = elementJson;
@@ -6521,9 +10968,8 @@ static void SerializeGltfBufferData(const std::vector<unsigned char> &data,
                                     json &o) {
   std::string header = "data:application/octet-stream;base64,";
   if (data.size() > 0) {
-    std::string encodedData =
-        base64_encode(&data[0], static_cast<unsigned int>(data.size()));
-    SerializeStringProperty("uri", header + encodedData, o);
+    SerializeStringProperty("uri", EncodeDataURI(header, &data[0], data.size()),
+                            o);
   } else {
     // Issue #229
     // size 0 is allowd. Just emit mime header.
@@ -6781,10 +11227,8 @@ static void SerializeGltfAsset(Asset &asset, json &o) {
   SerializeExtensionMap(asset.extensions, o);
 }
 
-static void SerializeGltfBufferBin(Buffer &buffer, json &o,
-                                   std::vector<unsigned char> &binBuffer) {
+static void SerializeGltfBufferBin(Buffer &buffer, json &o) {
   SerializeNumberProperty("byteLength", buffer.data.size(), o);
-  binBuffer = buffer.data;
 
   if (buffer.name.size()) SerializeStringProperty("name", buffer.name, o);
 
@@ -7278,64 +11722,163 @@ static void SerializeGltfTexture(Texture &texture, json &o) {
   SerializeExtensionMap(texture.extensions, o);
 }
 
+namespace {
+
+// Builds the top level members into a json document.
+class JsonDocumentWriter {
+ public:
+  explicit JsonDocumentWriter(json &o) : o_(o) {}
+
+  void AddMember(const char *key, json &&value) {
+    JsonAddMember(o_, key, std::move(value));
+  }
+
+  // Adds every member of `members`, which may be null when it has none.
+  void AddMembers(json &members) {
+    if (!IsObject(members)) return;
+    json_const_iterator it(ObjectBegin(members));
+    json_const_iterator itEnd(ObjectEnd(members));
+    for (; it != itEnd; ++it) {
+      json value;
+      JsonAssign(value, GetValue(it));
+      JsonAddMember(o_, GetKey(it).c_str(), std::move(value));
+    }
+  }
+
+  void BeginArray(const char *key, size_t size) {
+    array_key_ = key;
+    JsonReserveArray(array_, size);
+  }
+
+  void PushBack(json &&value) { JsonPushBack(array_, std::move(value)); }
+
+  void EndArray() { JsonAddMember(o_, array_key_, std::move(array_)); }
+
+ private:
+  json &o_;
+  json array_;
+  const char *array_key_ = nullptr;
+};
+
+// Writes the top level members to a stream as soon as each one, or each
+// element of an array, is serialized. Without a stream it only counts the
+// bytes it would write.
+class JsonStreamWriter {
+ public:
+  explicit JsonStreamWriter(std::ostream *stream) : stream_(stream) {}
+
+  void BeginObject() { Write("{"); }
+  void EndObject() { Write("}"); }
+
+  void AddMember(const char *key, const json &value) {
+    WriteKey(key);
+    Write(JsonToString(value));
+  }
+
+  void AddMembers(json &members) {
+    if (!IsObject(members)) return;
+    json_const_iterator it(ObjectBegin(members));
+    json_const_iterator itEnd(ObjectEnd(members));
+    for (; it != itEnd; ++it) {
+      WriteKey(GetKey(it));
+      Write(JsonToString(GetValue(it)));
+    }
+  }
+
+  void BeginArray(const char *key, size_t size) {
+    (void)size;
+    WriteKey(key);
+    Write("[");
+    first_element_ = true;
+  }
+
+  void PushBack(json &&value) {
+    if (!first_element_) Write(",");
+    first_element_ = false;
+    Write(JsonToString(value));
+  }
+
+  void EndArray() { Write("]"); }
+
+  uint64_t Size() const { return size_; }
+
+ private:
+  void WriteKey(const std::string &key) {
+    if (!first_member_) Write(",");
+    first_member_ = false;
+    Write(JsonToString(JsonFromString(key.c_str())));
+    Write(":");
+  }
+
+  void Write(const std::string &s) {
+    size_ += s.size();
+    if (stream_) stream_->write(s.data(), std::streamsize(s.size()));
+  }
+
+  std::ostream *stream_;
+  uint64_t size_ = 0;
+  bool first_member_ = true;
+  bool first_element_ = true;
+};
+
+}  // namespace
+
 ///
 /// Serialize all properties except buffers and images.
 ///
-static void SerializeGltfModel(Model *model, json &o) {
+template <typename Writer>
+static void SerializeGltfModel(Model *model, Writer &writer) {
   // ACCESSORS
   if (model->accessors.size()) {
-    json accessors;
-    JsonReserveArray(accessors, model->accessors.size());
+    writer.BeginArray("accessors", model->accessors.size());
     for (unsigned int i = 0; i < model->accessors.size(); ++i) {
       json accessor;
       SerializeGltfAccessor(model->accessors[i], accessor);
-      JsonPushBack(accessors, std::move(accessor));
+      writer.PushBack(std::move(accessor));
     }
-    JsonAddMember(o, "accessors", std::move(accessors));
+    writer.EndArray();
   }
 
   // ANIMATIONS
   if (model->animations.size()) {
-    json animations;
-    JsonReserveArray(animations, model->animations.size());
+    writer.BeginArray("animations", model->animations.size());
     for (unsigned int i = 0; i < model->animations.size(); ++i) {
       if (model->animations[i].channels.size()) {
         json animation;
         SerializeGltfAnimation(model->animations[i], animation);
-        JsonPushBack(animations, std::move(animation));
+        writer.PushBack(std::move(animation));
       }
     }
-
-    JsonAddMember(o, "animations", std::move(animations));
+    writer.EndArray();
   }
 
   // ASSET
   json asset;
   SerializeGltfAsset(model->asset, asset);
-  JsonAddMember(o, "asset", std::move(asset));
+  writer.AddMember("asset", std::move(asset));
 
   // BUFFERVIEWS
   if (model->bufferViews.size()) {
-    json bufferViews;
-    JsonReserveArray(bufferViews, model->bufferViews.size());
+    writer.BeginArray("bufferViews", model->bufferViews.size());
     for (unsigned int i = 0; i < model->bufferViews.size(); ++i) {
       json bufferView;
       SerializeGltfBufferView(model->bufferViews[i], bufferView);
-      JsonPushBack(bufferViews, std::move(bufferView));
+      writer.PushBack(std::move(bufferView));
     }
-    JsonAddMember(o, "bufferViews", std::move(bufferViews));
+    writer.EndArray();
   }
 
   // Extensions required
   if (model->extensionsRequired.size()) {
+    json extensionsRequired;
     SerializeStringArrayProperty("extensionsRequired",
-                                 model->extensionsRequired, o);
+                                 model->extensionsRequired, extensionsRequired);
+    writer.AddMembers(extensionsRequired);
   }
 
   // MATERIALS
   if (model->materials.size()) {
-    json materials;
-    JsonReserveArray(materials, model->materials.size());
+    writer.BeginArray("materials", model->materials.size());
     for (unsigned int i = 0; i < model->materials.size(); ++i) {
       json material;
       SerializeGltfMaterial(model->materials[i], material);
@@ -7349,100 +11892,99 @@ static void SerializeGltfModel(Model *model, json &o) {
         // null is not allowed thus we create an empty JSON object.
         JsonSetObject(material);
       }
-      JsonPushBack(materials, std::move(material));
+      writer.PushBack(std::move(material));
     }
-    JsonAddMember(o, "materials", std::move(materials));
+    writer.EndArray();
   }
 
   // MESHES
   if (model->meshes.size()) {
-    json meshes;
-    JsonReserveArray(meshes, model->meshes.size());
+    writer.BeginArray("meshes", model->meshes.size());
     for (unsigned int i = 0; i < model->meshes.size(); ++i) {
       json mesh;
       SerializeGltfMesh(model->meshes[i], mesh);
-      JsonPushBack(meshes, std::move(mesh));
+      writer.PushBack(std::move(mesh));
     }
-    JsonAddMember(o, "meshes", std::move(meshes));
+    writer.EndArray();
   }
 
   // NODES
   if (model->nodes.size()) {
-    json nodes;
-    JsonReserveArray(nodes, model->nodes.size());
+    writer.BeginArray("nodes", model->nodes.size());
     for (unsigned int i = 0; i < model->nodes.size(); ++i) {
       json node;
       SerializeGltfNode(model->nodes[i], node);
-      JsonPushBack(nodes, std::move(node));
+      writer.PushBack(std::move(node));
     }
-    JsonAddMember(o, "nodes", std::move(nodes));
+    writer.EndArray();
   }
 
   // SCENE
   if (model->defaultScene > -1) {
-    SerializeNumberProperty<int>("scene", model->defaultScene, o);
+    json scene;
+    SerializeNumberProperty<int>("scene", model->defaultScene, scene);
+    writer.AddMembers(scene);
   }
 
   // SCENES
   if (model->scenes.size()) {
-    json scenes;
-    JsonReserveArray(scenes, model->scenes.size());
+    writer.BeginArray("scenes", model->scenes.size());
     for (unsigned int i = 0; i < model->scenes.size(); ++i) {
       json currentScene;
       SerializeGltfScene(model->scenes[i], currentScene);
-      JsonPushBack(scenes, std::move(currentScene));
+      writer.PushBack(std::move(currentScene));
     }
-    JsonAddMember(o, "scenes", std::move(scenes));
+    writer.EndArray();
   }
 
   // SKINS
   if (model->skins.size()) {
-    json skins;
-    JsonReserveArray(skins, model->skins.size());
+    writer.BeginArray("skins", model->skins.size());
     for (unsigned int i = 0; i < model->skins.size(); ++i) {
       json skin;
       SerializeGltfSkin(model->skins[i], skin);
-      JsonPushBack(skins, std::move(skin));
+      writer.PushBack(std::move(skin));
     }
-    JsonAddMember(o, "skins", std::move(skins));
+    writer.EndArray();
   }
 
   // TEXTURES
   if (model->textures.size()) {
-    json textures;
-    JsonReserveArray(textures, model->textures.size());
+    writer.BeginArray("textures", model->textures.size());
     for (unsigned int i = 0; i < model->textures.size(); ++i) {
       json texture;
       SerializeGltfTexture(model->textures[i], texture);
-      JsonPushBack(textures, std::move(texture));
+      writer.PushBack(std::move(texture));
     }
-    JsonAddMember(o, "textures", std::move(textures));
+    writer.EndArray();
   }
 
   // SAMPLERS
   if (model->samplers.size()) {
-    json samplers;
-    JsonReserveArray(samplers, model->samplers.size());
+    writer.BeginArray("samplers", model->samplers.size());
     for (unsigned int i = 0; i < model->samplers.size(); ++i) {
       json sampler;
       SerializeGltfSampler(model->samplers[i], sampler);
-      JsonPushBack(samplers, std::move(sampler));
+      writer.PushBack(std::move(sampler));
     }
-    JsonAddMember(o, "samplers", std::move(samplers));
+    writer.EndArray();
   }
 
   // CAMERAS
   if (model->cameras.size()) {
-    json cameras;
-    JsonReserveArray(cameras, model->cameras.size());
+    writer.BeginArray("cameras", model->cameras.size());
     for (unsigned int i = 0; i < model->cameras.size(); ++i) {
       json camera;
       SerializeGltfCamera(model->cameras[i], camera);
-      JsonPushBack(cameras, std::move(camera));
+      writer.PushBack(std::move(camera));
     }
-    JsonAddMember(o, "cameras", std::move(cameras));
+    writer.EndArray();
   }
 
+  // The remaining members are small, they are collected in `o` first, since
+  // the lights are merged into the extensions.
+  json o;
+
   // EXTENSIONS
   SerializeExtensionMap(model->extensions, o);
 
@@ -7495,6 +12037,13 @@ static void SerializeGltfModel(Model *model, json &o) {
   if (model->extras.Type() != NULL_TYPE) {
     SerializeValue("extras", model->extras, o);
   }
+
+  writer.AddMembers(o);
+}
+
+static void SerializeGltfModel(Model *model, json &o) {
+  JsonDocumentWriter writer(o);
+  SerializeGltfModel(model, writer);
 }
 
 static bool WriteGltfStream(std::ostream &stream, const std::string &content) {
@@ -7525,65 +12074,87 @@ static bool WriteGltfFile(const std::string &output,
   return WriteGltfStream(gltfFile, content);
 }
 
-static void WriteBinaryGltfStream(std::ostream &stream,
-                                  const std::string &content,
-                                  const std::vector<unsigned char> &binBuffer) {
-  const std::string header = "glTF";
-  const int version = 2;
+// The JSON chunk is serialized twice, first only to measure it for the
+// headers, so no more than one element of it is held in memory at a time.
+// The BIN chunk is written straight from `binBuffer`, which is the first
+// buffer of the model, or null when there is none.
+static bool WriteBinaryGltfStream(std::ostream &stream, Model *model,
+                                  const json &buffers, const json &images,
+                                  const std::vector<unsigned char> *binBuffer) {
+  auto serialize = [&](JsonStreamWriter &writer) {
+    writer.BeginObject();
+    SerializeGltfModel(model, writer);
+    if (!JsonIsNull(buffers)) writer.AddMember("buffers", buffers);
+    if (!JsonIsNull(images)) writer.AddMember("images", images);
+    writer.EndObject();
+  };
+
+  JsonStreamWriter counter(nullptr);
+  serialize(counter);
+
+  const char header[] = "glTF";
+  const uint32_t version = 2;
 
-  const uint32_t content_size = uint32_t(content.size());
-  const uint32_t binBuffer_size = uint32_t(binBuffer.size());
+  const uint64_t content_size = counter.Size();
+  const uint64_t binBuffer_size = binBuffer ? binBuffer->size() : 0;
   // determine number of padding bytes required to ensure 4 byte alignment
-  const uint32_t content_padding_size = content_size % 4 == 0 ? 0 : 4 - content_size % 4;
-  const uint32_t bin_padding_size = binBuffer_size % 4 == 0 ? 0 : 4 - binBuffer_size % 4;
+  const uint32_t content_padding_size = (4 - content_size % 4) % 4;
+  const uint32_t bin_padding_size = (4 - binBuffer_size % 4) % 4;
 
   // 12 bytes for header, JSON content length, 8 bytes for JSON chunk info.
   // Chunk data must be located at 4-byte boundary, which may require padding
-  const uint32_t length =
+  const uint64_t length =
       12 + 8 + content_size + content_padding_size +
       (binBuffer_size ? (8 + binBuffer_size + bin_padding_size) : 0);
 
-  stream.write(header.c_str(), std::streamsize(header.size()));
+  // GLB sizes are 32 bit
+  if (length > 0xffffffffu) {
+    return false;
+  }
+
+  const uint32_t length32 = uint32_t(length);
+  stream.write(header, 4);
   stream.write(reinterpret_cast<const char *>(&version), sizeof(version));
-  stream.write(reinterpret_cast<const char *>(&length), sizeof(length));
+  stream.write(reinterpret_cast<const char *>(&length32), sizeof(length32));
 
   // JSON chunk info, then JSON data
-  const uint32_t model_length = uint32_t(content.size()) + content_padding_size;
+  const uint32_t model_length = uint32_t(content_size) + content_padding_size;
   const uint32_t model_format = 0x4E4F534A;
   stream.write(reinterpret_cast<const char *>(&model_length),
                sizeof(model_length));
   stream.write(reinterpret_cast<const char *>(&model_format),
                sizeof(model_format));
-  stream.write(content.c_str(), std::streamsize(content.size()));
 
-  // Chunk must be multiplies of 4, so pad with spaces
-  if (content_padding_size > 0) {
-    const std::string padding = std::string(size_t(content_padding_size), ' ');
-    stream.write(padding.c_str(), std::streamsize(padding.size()));
+  JsonStreamWriter writer(&stream);
+  serialize(writer);
+  if (writer.Size() != content_size) {
+    return false;
   }
-  if (binBuffer.size() > 0) {
+
+  // Chunk must be multiplies of 4, so pad with spaces
+  stream.write("   ", content_padding_size);
+
+  if (binBuffer_size > 0) {
     // BIN chunk info, then BIN data
-    const uint32_t bin_length = uint32_t(binBuffer.size()) + bin_padding_size;
+    const uint32_t bin_length = uint32_t(binBuffer_size) + bin_padding_size;
     const uint32_t bin_format = 0x004e4942;
     stream.write(reinterpret_cast<const char *>(&bin_length),
                  sizeof(bin_length));
     stream.write(reinterpret_cast<const char *>(&bin_format),
                  sizeof(bin_format));
-    stream.write(reinterpret_cast<const char *>(binBuffer.data()),
-                 std::streamsize(binBuffer.size()));
+    stream.write(reinterpret_cast<const char *>(binBuffer->data()),
+                 std::streamsize(binBuffer_size));
     // Chunksize must be multiplies of 4, so pad with zeroes
-    if (bin_padding_size > 0) {
-      const std::vector<unsigned char> padding =
-          std::vector<unsigned char>(size_t(bin_padding_size), 0);
-      stream.write(reinterpret_cast<const char *>(padding.data()),
-                   std::streamsize(padding.size()));
-    }
+    const char padding[3] = {0, 0, 0};
+    stream.write(padding, bin_padding_size);
   }
+
+  return !stream.fail();
 }
 
-static void WriteBinaryGltfFile(const std::string &output,
-                                const std::string &content,
-                                const std::vector<unsigned char> &binBuffer) {
+static bool WriteBinaryGltfFile(const std::string &output, Model *model,
+                                const json &buffers, const json &images,
+                                const std::vector<unsigned char> *binBuffer) {
 #ifdef _WIN32
 #if defined(_MSC_VER)
   std::ofstream gltfFile(UTF8ToWchar(output).c_str(), std::ios::binary);
@@ -7599,37 +12170,32 @@ static void WriteBinaryGltfFile(const std::string &output,
 #else
   std::ofstream gltfFile(output.c_str(), std::ios::binary);
 #endif
-  WriteBinaryGltfStream(gltfFile, content, binBuffer);
+  return WriteBinaryGltfStream(gltfFile, model, buffers, images, binBuffer);
 }
 
 bool TinyGLTF::WriteGltfSceneToStream(Model *model, std::ostream &stream,
                                       bool prettyPrint = true,
                                       bool writeBinary = false) {
-  JsonDocument output;
-
-  /// Serialize all properties except buffers and images.
-  SerializeGltfModel(model, output);
-
   // BUFFERS
-  std::vector<unsigned char> binBuffer;
+  const std::vector<unsigned char> *binBuffer = nullptr;
+  json buffers;
   if (model->buffers.size()) {
-    json buffers;
     JsonReserveArray(buffers, model->buffers.size());
     for (unsigned int i = 0; i < model->buffers.size(); ++i) {
       json buffer;
       if (writeBinary && i == 0 && model->buffers[i].uri.empty()) {
-        SerializeGltfBufferBin(model->buffers[i], buffer, binBuffer);
+        SerializeGltfBufferBin(model->buffers[i], buffer);
+        binBuffer = &model->buffers[i].data;
       } else {
         SerializeGltfBuffer(model->buffers[i], buffer);
       }
       JsonPushBack(buffers, std::move(buffer));
     }
-    JsonAddMember(output, "buffers", std::move(buffers));
   }
 
   // IMAGES
+  json images;
   if (model->images.size()) {
-    json images;
     JsonReserveArray(images, model->images.size());
     for (unsigned int i = 0; i < model->images.size(); ++i) {
       json image;
@@ -7643,15 +12209,25 @@ bool TinyGLTF::WriteGltfSceneToStream(Model *model, std::ostream &stream,
       SerializeGltfImage(model->images[i], image);
       JsonPushBack(images, std::move(image));
     }
-    JsonAddMember(output, "images", std::move(images));
   }
 
   if (writeBinary) {
-    WriteBinaryGltfStream(stream, JsonToString(output), binBuffer);
-  } else {
-    WriteGltfStream(stream, JsonToString(output, prettyPrint ? 2 : -1));
+    return WriteBinaryGltfStream(stream, model, buffers, images, binBuffer);
+  }
+
+  JsonDocument output;
+
+  /// Serialize all properties except buffers and images.
+  SerializeGltfModel(model, output);
+  if (!JsonIsNull(buffers)) {
+    JsonAddMember(output, "buffers", std::move(buffers));
+  }
+  if (!JsonIsNull(images)) {
+    JsonAddMember(output, "images", std::move(images));
   }
 
+  WriteGltfStream(stream, JsonToString(output, prettyPrint ? 2 : -1));
+
   return true;
 }
 
@@ -7660,7 +12236,6 @@ bool TinyGLTF::WriteGltfSceneToFile(Model *model, const std::string &filename,
                                     bool embedBuffers = false,
                                     bool prettyPrint = true,
                                     bool writeBinary = false) {
-  JsonDocument output;
   std::string defaultBinFilename = GetBaseFilename(filename);
   std::string defaultBinFileExt = ".bin";
   std::string::size_type pos =
@@ -7673,19 +12248,18 @@ bool TinyGLTF::WriteGltfSceneToFile(Model *model, const std::string &filename,
   if (baseDir.empty()) {
     baseDir = "./";
   }
-  /// Serialize all properties except buffers and images.
-  SerializeGltfModel(model, output);
 
   // BUFFERS
   std::vector<std::string> usedUris;
-  std::vector<unsigned char> binBuffer;
+  const std::vector<unsigned char> *binBuffer = nullptr;
+  json buffers;
   if (model->buffers.size()) {
-    json buffers;
     JsonReserveArray(buffers, model->buffers.size());
     for (unsigned int i = 0; i < model->buffers.size(); ++i) {
       json buffer;
       if (writeBinary && i == 0 && model->buffers[i].uri.empty()) {
-        SerializeGltfBufferBin(model->buffers[i], buffer, binBuffer);
+        SerializeGltfBufferBin(model->buffers[i], buffer);
+        binBuffer = &model->buffers[i].data;
       } else if (embedBuffers) {
         SerializeGltfBuffer(model->buffers[i], buffer);
       } else {
@@ -7718,12 +12292,11 @@ bool TinyGLTF::WriteGltfSceneToFile(Model *model, const std::string &filename,
       }
       JsonPushBack(buffers, std::move(buffer));
     }
-    JsonAddMember(output, "buffers", std::move(buffers));
   }
 
   // IMAGES
+  json images;
   if (model->images.size()) {
-    json images;
     JsonReserveArray(images, model->images.size());
     for (unsigned int i = 0; i < model->images.size(); ++i) {
       json image;
@@ -7733,15 +12306,25 @@ bool TinyGLTF::WriteGltfSceneToFile(Model *model, const std::string &filename,
       SerializeGltfImage(model->images[i], image);
       JsonPushBack(images, std::move(image));
     }
-    JsonAddMember(output, "images", std::move(images));
   }
 
   if (writeBinary) {
-    WriteBinaryGltfFile(filename, JsonToString(output), binBuffer);
-  } else {
-    WriteGltfFile(filename, JsonToString(output, (prettyPrint ? 2 : -1)));
+    return WriteBinaryGltfFile(filename, model, buffers, images, binBuffer);
+  }
+
+  JsonDocument output;
+
+  /// Serialize all properties except buffers and images.
+  SerializeGltfModel(model, output);
+  if (!JsonIsNull(buffers)) {
+    JsonAddMember(output, "buffers", std::move(buffers));
+  }
+  if (!JsonIsNull(images)) {
+    JsonAddMember(output, "images", std::move(images));
   }
 
+  WriteGltfFile(filename, JsonToString(output, (prettyPrint ? 2 : -1)));
+
   return true;
 }
 
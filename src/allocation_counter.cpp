@@ -0,0 +1,427 @@
+#include "allocation_counter.h"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+
+struct AllocationHeader
+{
+	uint64_t size;
+	uint32_t offset; // from the start of the underlying block to the user pointer
+	MemoryCategory category;
+	bool aligned;
+	bool arena;
+};
+
+constexpr size_t AllocationHeaderSize = 16;
+static_assert(sizeof(AllocationHeader) <= AllocationHeaderSize);
+
+struct CategoryCounters
+{
+	std::atomic<int64_t> live_bytes = 0;
+	std::atomic<int64_t> peak_bytes = 0;
+	std::atomic<int64_t> live_allocations = 0;
+	std::atomic<uint64_t> allocations = 0;
+};
+
+static std::atomic<uint64_t> gAllocationCount = 0;
+static std::atomic<uint64_t> gAllocatedBytes = 0;
+static CategoryCounters gCategories[(size_t)MemoryCategory::Count];
+
+static thread_local MemoryCategory tMemoryCategory = MemoryCategory::Other;
+static thread_local HeapArena* tHeapArena = nullptr;
+
+MemoryScope::MemoryScope(MemoryCategory category) : mPrevCategory(tMemoryCategory)
+{
+	tMemoryCategory = category;
+}
+
+MemoryScope::~MemoryScope()
+{
+	tMemoryCategory = mPrevCategory;
+}
+
+HeapArenaScope::HeapArenaScope(HeapArena* arena) : mPrevArena(tHeapArena)
+{
+	tHeapArena = arena;
+}
+
+HeapArenaScope::~HeapArenaScope()
+{
+	tHeapArena = mPrevArena;
+}
+
+uint64_t GetAllocationCount()
+{
+	return gAllocationCount.load(std::memory_order_relaxed);
+}
+
+uint64_t GetAllocatedBytes()
+{
+	return gAllocatedBytes.load(std::memory_order_relaxed);
+}
+
+const char* GetMemoryCategoryName(MemoryCategory category)
+{
+	switch (category)
+	{
+	case MemoryCategory::Other: return "other";
+	case MemoryCategory::GltfJson: return "gltf json";
+	case MemoryCategory::GltfBuffers: return "gltf buffers";
+	case MemoryCategory::DecodedImages: return "decoded images";
+	case MemoryCategory::RenderBuffer: return "render buffer";
+	case MemoryCategory::GpuUploads: return "gpu uploads";
+	case MemoryCategory::Frame: return "frame";
+	case MemoryCategory::Gui: return "gui";
+	default: return "unknown";
+	}
+}
+
+MemoryCategoryStats GetMemoryStats(MemoryCategory category)
+{
+	const auto& counters = gCategories[(size_t)category];
+
+	return {
+		.live_bytes = counters.live_bytes.load(std::memory_order_relaxed),
+		.peak_bytes = counters.peak_bytes.load(std::memory_order_relaxed),
+		.live_allocations = counters.live_allocations.load(std::memory_order_relaxed),
+		.allocations = counters.allocations.load(std::memory_order_relaxed)
+	};
+}
+
+static void AddLiveBytes(MemoryCategory category, int64_t bytes, int64_t allocations)
+{
+	auto& counters = gCategories[(size_t)category];
+	auto live_bytes = counters.live_bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+	counters.live_allocations.fetch_add(allocations, std::memory_order_relaxed);
+
+	auto peak_bytes = counters.peak_bytes.load(std::memory_order_relaxed);
+
+	while (live_bytes > peak_bytes && !counters.peak_bytes.compare_exchange_weak(peak_bytes, live_bytes,
+		std::memory_order_relaxed))
+	{
+	}
+}
+
+static AllocationHeader* GetHeader(const void* ptr)
+{
+	return reinterpret_cast<AllocationHeader*>((std::byte*)ptr - AllocationHeaderSize);
+}
+
+void SetAllocationCategory(const void* ptr, MemoryCategory category)
+{
+	if (ptr == nullptr)
+		return;
+
+	auto header = GetHeader(ptr);
+
+	if (header->category == category)
+		return;
+
+	AddLiveBytes(header->category, -(int64_t)header->size, -1);
+	AddLiveBytes(category, (int64_t)header->size, 1);
+	header->category = category;
+}
+
+bool DumpMemoryStats(const std::string& path)
+{
+	std::ofstream file(path);
+
+	if (!file)
+		return false;
+
+	file << "{\n";
+
+	for (size_t i = 0; i < (size_t)MemoryCategory::Count; i++)
+	{
+		auto category = (MemoryCategory)i;
+		auto stats = GetMemoryStats(category);
+
+		file << "\t\"" << GetMemoryCategoryName(category) << "\": { \"live_bytes\": " << stats.live_bytes
+			<< ", \"peak_bytes\": " << stats.peak_bytes << ", \"live_allocations\": " << stats.live_allocations
+			<< ", \"allocations\": " << stats.allocations << " },\n";
+	}
+
+	file << "\t\"total_allocations\": " << GetAllocationCount() << ",\n";
+	file << "\t\"total_allocated_bytes\": " << GetAllocatedBytes() << "\n";
+	file << "}\n";
+
+	return (bool)file;
+}
+
+static std::atomic<size_t> gArenaChunkCount = 0;
+
+HeapArena::HeapArena()
+{
+	// malloc, not new, operator new may be routed into an arena itself
+	mState = (State*)std::malloc(sizeof(State));
+
+	if (mState == nullptr)
+		throw std::bad_alloc();
+
+	new (mState) State{ .references = 1, .chunks = nullptr };
+}
+
+HeapArena::~HeapArena()
+{
+	if (mState->references.fetch_sub(1, std::memory_order_acq_rel) != 1)
+		return; // the last block frees the chunks
+
+	FreeChunks(*mState);
+	mState->~State();
+	std::free(mState);
+}
+
+int64_t HeapArena::getLiveAllocations() const
+{
+	return mState->references.load(std::memory_order_relaxed) - 1;
+}
+
+size_t HeapArena::GetLiveChunkCount()
+{
+	return gArenaChunkCount.load(std::memory_order_relaxed);
+}
+
+void HeapArena::FreeChunks(State& state)
+{
+	while (state.chunks != nullptr)
+	{
+		auto next = state.chunks->next;
+#ifdef _MSC_VER
+		_aligned_free(state.chunks);
+#else
+		std::free(state.chunks);
+#endif
+		state.chunks = next;
+		gArenaChunkCount.fetch_sub(1, std::memory_order_relaxed);
+	}
+}
+
+void* HeapArena::allocate(size_t size)
+{
+	if (size > MaxBlockSize)
+		return nullptr;
+
+	size = (size + 15) & ~(size_t)15;
+
+	if (mOffset + size > ChunkSize)
+	{
+		// chunks are aligned to their size, so a block finds its chunk and
+		// arena state by masking its address
+
+#ifdef _MSC_VER
+		auto chunk = (Chunk*)_aligned_malloc(ChunkSize, ChunkSize);
+#else
+		auto chunk = (Chunk*)std::aligned_alloc(ChunkSize, ChunkSize);
+#endif
+		if (chunk == nullptr)
+			return nullptr;
+
+		gAllocationCount.fetch_add(1, std::memory_order_relaxed);
+		gAllocatedBytes.fetch_add(ChunkSize, std::memory_order_relaxed);
+		gArenaChunkCount.fetch_add(1, std::memory_order_relaxed);
+
+		chunk->state = mState;
+		chunk->next = mState->chunks;
+		mState->chunks = chunk;
+		mChunkCount += 1;
+		mOffset = ChunkHeaderSize;
+	}
+
+	auto ptr = (std::byte*)mState->chunks + mOffset;
+	mOffset += size;
+	mState->references.fetch_add(1, std::memory_order_relaxed);
+
+	return ptr;
+}
+
+void HeapArena::deallocate(void* ptr)
+{
+	auto chunk = (Chunk*)((uintptr_t)ptr & ~(uintptr_t)(ChunkSize - 1));
+	auto state = chunk->state;
+
+	if (state->references.fetch_sub(1, std::memory_order_acq_rel) != 1)
+		return;
+
+	// the arena is gone and this was its last block
+	FreeChunks(*state);
+	state->~State();
+	std::free(state);
+}
+
+int64_t HeapArena::reset()
+{
+	auto live_blocks = mState->references.load(std::memory_order_acquire) - 1;
+
+	if (live_blocks != 0)
+		return live_blocks;
+
+	FreeChunks(*mState);
+	mChunkCount = 0;
+	mOffset = ChunkSize;
+	return 0;
+}
+
+static void* AllocateFromArena(HeapArena& arena, size_t size)
+{
+	auto category = tMemoryCategory;
+
+	auto block = arena.allocate(size + AllocationHeaderSize);
+
+	if (block == nullptr)
+		return nullptr;
+
+	gCategories[(size_t)category].allocations.fetch_add(1, std::memory_order_relaxed);
+
+	auto ptr = (std::byte*)block + AllocationHeaderSize;
+	auto header = GetHeader(ptr);
+	header->size = size;
+	header->offset = (uint32_t)AllocationHeaderSize;
+	header->category = category;
+	header->aligned = false;
+	header->arena = true;
+
+	AddLiveBytes(category, (int64_t)size, 1);
+
+	return ptr;
+}
+
+static void* Allocate(size_t size, size_t alignment)
+{
+	if (tHeapArena != nullptr && alignment <= __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+	{
+		if (auto ptr = AllocateFromArena(*tHeapArena, size))
+			return ptr;
+	}
+
+	auto category = tMemoryCategory;
+
+	gAllocationCount.fetch_add(1, std::memory_order_relaxed);
+	gAllocatedBytes.fetch_add(size, std::memory_order_relaxed);
+	gCategories[(size_t)category].allocations.fetch_add(1, std::memory_order_relaxed);
+
+	// the header sits right before the user pointer, the offset keeps the
+	// requested alignment
+
+	auto offset = std::max(AllocationHeaderSize, alignment);
+	auto aligned = alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+	void* block = nullptr;
+
+	if (!aligned)
+	{
+		block = std::malloc(size + offset);
+	}
+	else
+	{
+#ifdef _MSC_VER
+		block = _aligned_malloc(size + offset, alignment);
+#else
+		block = std::aligned_alloc(alignment, (size + offset + alignment - 1) & ~(alignment - 1));
+#endif
+	}
+
+	if (block == nullptr)
+		return nullptr;
+
+	auto ptr = (std::byte*)block + offset;
+	auto header = GetHeader(ptr);
+	header->size = size;
+	header->offset = (uint32_t)offset;
+	header->category = category;
+	header->aligned = aligned;
+	header->arena = false;
+
+	AddLiveBytes(category, (int64_t)size, 1);
+
+	return ptr;
+}
+
+static void Free(void* ptr)
+{
+	if (ptr == nullptr)
+		return;
+
+	auto header = GetHeader(ptr);
+	auto block = (std::byte*)ptr - header->offset;
+
+	AddLiveBytes(header->category, -(int64_t)header->size, -1);
+
+	if (header->arena)
+	{
+		HeapArena::deallocate(block);
+		return;
+	}
+
+	if (!header->aligned)
+	{
+		std::free(block);
+		return;
+	}
+
+#ifdef _MSC_VER
+	_aligned_free(block);
+#else
+	std::free(block);
+#endif
+}
+
+void* operator new(size_t size)
+{
+	if (auto ptr = Allocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__))
+		return ptr;
+
+	throw std::bad_alloc();
+}
+
+void* operator new[](size_t size)
+{
+	return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+	return Allocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+	return Allocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void* operator new(size_t size, std::align_val_t alignment)
+{
+	if (auto ptr = Allocate(size, (size_t)alignment))
+		return ptr;
+
+	throw std::bad_alloc();
+}
+
+void* operator new[](size_t size, std::align_val_t alignment)
+{
+	return operator new(size, alignment);
+}
+
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+	return Allocate(size, (size_t)alignment);
+}
+
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+	return Allocate(size, (size_t)alignment);
+}
+
+void operator delete(void* ptr) noexcept { Free(ptr); }
+void operator delete[](void* ptr) noexcept { Free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { Free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { Free(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { Free(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { Free(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { Free(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { Free(ptr); }
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept { Free(ptr); }
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept { Free(ptr); }
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { Free(ptr); }
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { Free(ptr); }
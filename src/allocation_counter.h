@@ -0,0 +1,145 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Global operator new/delete are replaced to count heap allocations made by
+// the whole process, used to check that steady-state frames don't allocate.
+// Every allocation carries a small header with its size and the memory
+// category that was active on the allocating thread, so live bytes can be
+// broken down per subsystem. Small allocations can be redirected into a
+// HeapArena for the lifetime of a scope.
+
+enum class MemoryCategory : uint8_t
+{
+	Other,
+	GltfJson, // parsed document and model structures
+	GltfBuffers,
+	DecodedImages,
+	RenderBuffer,
+	GpuUploads,
+	Frame,
+	Gui,
+	Count
+};
+
+struct MemoryCategoryStats
+{
+	int64_t live_bytes = 0;
+	int64_t peak_bytes = 0;
+	int64_t live_allocations = 0;
+	uint64_t allocations = 0;
+};
+
+// sets the category of the calling thread until destroyed
+class MemoryScope
+{
+public:
+	MemoryScope(MemoryCategory category);
+	~MemoryScope();
+
+	MemoryScope(const MemoryScope&) = delete;
+	MemoryScope& operator=(const MemoryScope&) = delete;
+
+private:
+	MemoryCategory mPrevCategory;
+};
+
+uint64_t GetAllocationCount();
+uint64_t GetAllocatedBytes();
+
+const char* GetMemoryCategoryName(MemoryCategory category);
+MemoryCategoryStats GetMemoryStats(MemoryCategory category);
+
+// moves a block that is already allocated, e.g. a buffer filled by a library, to another category
+void SetAllocationCategory(const void* ptr, MemoryCategory category);
+
+bool DumpMemoryStats(const std::string& path);
+
+// Bump allocator behind the global operator new. While a HeapArenaScope is
+// active, small allocations of that thread come out of 1 MB chunks, so
+// something built from many small objects, like a tinygltf::Model with its
+// names, extras and extension maps, costs a few chunk allocations. Only the
+// chunks count as heap allocations, the blocks still count per memory
+// category.
+//
+// This is not an allocator handed to the parser: it catches whatever the
+// scoped thread allocates through operator new, and nothing from other
+// threads. Teardown is not free either, every block is still deleted one by
+// one, each delete is an atomic decrement instead of a heap call.
+//
+// The chunks are freed by reset() or the destructor once every block is
+// deleted. reset() refuses while some are alive and returns how many. A
+// block that outlives the arena frees the chunks with its delete, so escaped
+// blocks stay valid and nothing is written into the destroyed arena.
+
+class HeapArena
+{
+public:
+	static constexpr size_t ChunkSize = 1024 * 1024;
+	static constexpr size_t MaxBlockSize = 64 * 1024; // bigger blocks, like buffer data, go to the heap
+
+public:
+	HeapArena();
+	~HeapArena();
+
+	HeapArena(const HeapArena&) = delete;
+	HeapArena& operator=(const HeapArena&) = delete;
+
+	// called by operator new on the thread that owns the scope, nullptr when
+	// the block is too big
+	void* allocate(size_t size);
+
+	// called by operator delete from any thread
+	static void deallocate(void* ptr);
+
+	// frees the chunks, or keeps them and returns the live block count
+	int64_t reset();
+
+	size_t getChunkCount() const { return mChunkCount; }
+	int64_t getLiveAllocations() const;
+
+	// chunks of every arena not freed yet, including destroyed arenas with live blocks
+	static size_t GetLiveChunkCount();
+
+private:
+	struct Chunk;
+
+	// shared by the arena and its blocks, freed by whichever lets go last
+	struct State
+	{
+		std::atomic<int64_t> references; // live blocks, plus one while the arena exists
+		Chunk* chunks;
+	};
+
+	struct Chunk
+	{
+		State* state;
+		Chunk* next;
+	};
+
+	static constexpr size_t ChunkHeaderSize = 16;
+	static_assert(sizeof(Chunk) <= ChunkHeaderSize);
+
+	static void FreeChunks(State& state);
+
+	State* mState;
+	size_t mChunkCount = 0;
+	size_t mOffset = ChunkSize;
+};
+
+// sets the arena of the calling thread until destroyed, nullptr goes back to the heap
+class HeapArenaScope
+{
+public:
+	HeapArenaScope(HeapArena* arena);
+	~HeapArenaScope();
+
+	HeapArenaScope(const HeapArenaScope&) = delete;
+	HeapArenaScope& operator=(const HeapArenaScope&) = delete;
+
+private:
+	HeapArena* mPrevArena;
+};
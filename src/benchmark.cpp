@@ -0,0 +1,827 @@
+#include "benchmark.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <sstream>
+#include <thread>
+#include <map>
+#include <optional>
+#include "allocation_counter.h"
+#include "camera_path.h"
+#include "frame.h"
+#include "image_decoder.h"
+#include "profiler.h"
+#include "render_buffer.h"
+#include <stb_image.h>
+#include <stb_image_write.h>
+
+static std::vector<uint32_t> GetThreadCounts()
+{
+	auto max_threads = std::max(1u, std::thread::hardware_concurrency());
+
+	std::vector<uint32_t> result;
+
+	for (uint32_t threads = 1; threads < max_threads; threads *= 2)
+	{
+		result.push_back(threads);
+	}
+
+	result.push_back(max_threads);
+
+	return result;
+}
+
+int RunLightClustersBenchmark(uint32_t frames)
+{
+	auto stress_lights = CreateStressLights(StressLightCount);
+
+	auto camera = skygfx::utils::PerspectiveCamera();
+	camera.position = { -1100.0f, 300.0f, 0.0f };
+
+	auto matrices = MakeCameraMatrices(camera, 1920, 1080);
+	std::vector<LightSphere> spheres;
+	LightClusters clusters;
+
+	std::cout << "light clusters: " << stress_lights.size() << " lights, " << LightClusters::ClusterCount
+		<< " clusters, " << frames << " frames" << std::endl;
+
+	for (auto threads : GetThreadCounts())
+	{
+		JobSystem jobs(threads);
+
+		double total_ms = 0.0;
+		size_t references = 0;
+
+		for (uint32_t frame = 0; frame < frames; frame++)
+		{
+			spheres.clear();
+
+			for (auto& light : stress_lights)
+			{
+				AnimateStressLight(light, (float)frame / 60.0f);
+				spheres.push_back({ light.light.position, GetLightRadius(light.light, DefaultLightCutoff) });
+			}
+
+			auto begin = std::chrono::high_resolution_clock::now();
+			AssignLightsToClusters(clusters, matrices, spheres, jobs);
+			auto end = std::chrono::high_resolution_clock::now();
+
+			total_ms += std::chrono::duration<double, std::milli>(end - begin).count();
+			references += clusters.light_indices.size();
+		}
+
+		std::cout << "  threads: " << threads << ", assign: " << (total_ms / frames) << " ms, visible lights: "
+			<< clusters.visible_lights.size() << ", references: " << (references / frames)
+			<< ", max per cluster: " << clusters.max_lights_per_cluster << std::endl;
+	}
+
+	return 0;
+}
+
+static SceneDraws CreateSyntheticDraws()
+{
+	SceneDraws result;
+
+	for (int x = 0; x < 24; x++)
+	{
+		for (int y = 0; y < 6; y++)
+		{
+			for (int z = 0; z < 8; z++)
+			{
+				auto min = glm::vec3{ -1300.0f + x * 110.0f, y * 200.0f, -600.0f + z * 150.0f };
+
+				result.models.push_back(skygfx::utils::Model());
+				result.bounds.push_back({ .min = min, .max = min + glm::vec3{ 100.0f, 180.0f, 140.0f } });
+			}
+		}
+	}
+
+	return result;
+}
+
+int RunJobSystemBenchmark(uint32_t frames)
+{
+	FrameScene scene;
+	SetupSceneLights(scene);
+	scene.draws = CreateSyntheticDraws();
+
+	FrameSettings settings;
+	settings.stress_lights = true;
+	settings.forward_shading = true;
+
+	auto camera = skygfx::utils::PerspectiveCamera();
+	camera.position = { -1100.0f, 300.0f, 0.0f };
+
+	auto matrices = MakeCameraMatrices(camera, 1920, 1080);
+
+	// encoded images are read once, only decoding is timed
+
+	tinygltf::Model model;
+	DeferredImages images;
+
+	for (const auto& entry : std::filesystem::directory_iterator("assets/sponza"))
+	{
+		if (entry.path().extension() != ".png")
+			continue;
+
+		std::ifstream file(entry.path(), std::ios::binary);
+		auto index = (int)model.images.size();
+		model.images.emplace_back();
+		images.entries.push_back({
+			.index = index,
+			.req_width = 0,
+			.req_height = 0,
+			.bytes = std::vector<unsigned char>(std::istreambuf_iterator<char>(file), {})
+		});
+	}
+
+	std::cout << "job system: " << frames << " stress frames, " << images.entries.size() << " images" << std::endl;
+
+	double frame_ms_single = 0.0;
+	double decode_ms_single = 0.0;
+
+	for (auto threads : GetThreadCounts())
+	{
+		JobSystem jobs(threads);
+		FrameState frame;
+
+		auto frames_begin = std::chrono::high_resolution_clock::now();
+
+		for (uint32_t i = 0; i < frames; i++)
+		{
+			UpdateFrame(frame, scene, matrices, (float)i / 60.0f, settings, jobs);
+		}
+
+		auto frames_end = std::chrono::high_resolution_clock::now();
+
+		auto decode_images = images;
+		std::string err;
+
+		auto decode_begin = std::chrono::high_resolution_clock::now();
+		DecodeDeferredImages(model, decode_images, jobs, &err);
+		auto decode_end = std::chrono::high_resolution_clock::now();
+
+		auto frame_ms = std::chrono::duration<double, std::milli>(frames_end - frames_begin).count() / frames;
+		auto decode_ms = std::chrono::duration<double, std::milli>(decode_end - decode_begin).count();
+
+		if (threads == 1)
+		{
+			frame_ms_single = frame_ms;
+			decode_ms_single = decode_ms;
+		}
+
+		std::cout << "  threads: " << threads << ", frame: " << frame_ms << " ms (x" << (frame_ms_single / frame_ms)
+			<< "), decode: " << decode_ms << " ms (x" << (decode_ms_single / decode_ms) << ")" << std::endl;
+	}
+
+	return 0;
+}
+
+int RunFrameAllocationCheck(uint32_t frames)
+{
+	const uint32_t WarmupFrames = 120;
+
+	FrameScene scene;
+	SetupSceneLights(scene);
+	scene.draws = CreateSyntheticDraws();
+
+	FrameState frame;
+	JobSystem jobs;
+
+	FrameSettings settings;
+	settings.stress_lights = true;
+	settings.forward_shading = true;
+
+	auto camera = skygfx::utils::PerspectiveCamera();
+	camera.position = { -1100.0f, 300.0f, 0.0f };
+
+	uint64_t allocations_before = 0;
+
+	for (uint32_t i = 0; i < WarmupFrames + frames; i++)
+	{
+		if (i == WarmupFrames)
+			allocations_before = GetAllocationCount();
+
+		// one full turn per warmup, so later frames revisit the same views
+		camera.yaw = glm::two_pi<float>() * (float)(i % WarmupFrames) / (float)WarmupFrames;
+
+		auto matrices = MakeCameraMatrices(camera, 1920, 1080);
+		UpdateFrame(frame, scene, matrices, (float)(i % WarmupFrames) / 60.0f, settings, jobs);
+	}
+
+	auto allocations = GetAllocationCount() - allocations_before;
+
+	std::cout << "frame allocations: " << allocations << " over " << frames << " frames, arena peak: "
+		<< frame.arena.getPeakBytes() << " bytes" << std::endl;
+
+	return allocations == 0 ? 0 : 1;
+}
+
+int RunHeapArenaCheck()
+{
+	using Block = std::array<char, 64>;
+
+	auto chunks_before = HeapArena::GetLiveChunkCount();
+	std::vector<Block*> escaped;
+	escaped.reserve(4); // outside the arena, only the blocks escape
+	bool failed = false;
+
+	{
+		HeapArena arena;
+
+		{
+			HeapArenaScope arena_scope(&arena);
+
+			for (int i = 0; i < 4; i++)
+			{
+				escaped.push_back(new Block);
+				escaped.back()->fill((char)i);
+			}
+		}
+
+		// live blocks keep the chunks through a reset
+		failed |= arena.reset() != 4 || arena.getChunkCount() != 1;
+	}
+
+	failed |= HeapArena::GetLiveChunkCount() != chunks_before + 1;
+
+	for (size_t i = 0; i < escaped.size(); i++)
+	{
+		failed |= std::count(escaped[i]->begin(), escaped[i]->end(), (char)i) != (ptrdiff_t)escaped[i]->size();
+		delete escaped[i];
+	}
+
+	failed |= HeapArena::GetLiveChunkCount() != chunks_before;
+
+	std::cout << "heap arena: blocks freed after their arena " << (failed ? "leaked or broke" : "are fine") << std::endl;
+
+	return failed ? 1 : 0;
+}
+
+static std::string CreateSyntheticGltf(uint32_t nodes)
+{
+	// every node has its own mesh and position accessor, all of them point
+	// at one 12 byte buffer, so the document is almost all json. Nodes carry
+	// extras and an extension object like exporters with custom data write
+
+	std::ostringstream stream;
+
+	stream << "{\"asset\":{\"version\":\"2.0\",\"generator\":\"sponza-demo\"},\"scene\":0,"
+		<< "\"buffers\":[{\"byteLength\":12,\"uri\":\"data:application/octet-stream;base64,AAAAAAAAAAAAAAAA\"}],"
+		<< "\"bufferViews\":[{\"buffer\":0,\"byteLength\":12,\"target\":34962}],\"accessors\":[";
+
+	for (uint32_t i = 0; i < nodes; i++)
+	{
+		stream << (i > 0 ? "," : "") << "{\"bufferView\":0,\"componentType\":5126,\"count\":1,\"type\":\"VEC3\","
+			<< "\"min\":[" << -(float)i << ",0.0,-1.5],\"max\":[" << (float)i << ",1.0,1.5]}";
+	}
+
+	stream << "],\"meshes\":[";
+
+	for (uint32_t i = 0; i < nodes; i++)
+	{
+		stream << (i > 0 ? "," : "") << "{\"name\":\"mesh_" << i << "\",\"primitives\":[{\"attributes\":{\"POSITION\":"
+			<< i << "},\"material\":0,\"mode\":4}]}";
+	}
+
+	stream << "],\"nodes\":[";
+
+	for (uint32_t i = 0; i < nodes; i++)
+	{
+		stream << (i > 0 ? "," : "") << "{\"name\":\"node_" << i << "\",\"mesh\":" << i << ",\"translation\":["
+			<< (float)(i % 97) * 0.5f << "," << (float)(i % 13) << ",-2.25],\"rotation\":[0,0,0,1],"
+			<< "\"extras\":{\"id\":" << i << ",\"tag\":\"n\\u00e9\"},\"extensions\":{\"EXT_demo_lod\":{\"ids\":["
+			<< i << "," << (i + 1) << "],\"coverage\":[0.5,0.25],\"source\":\"lod\",\"visible\":true}}}";
+	}
+
+	stream << "],\"scenes\":[{\"nodes\":[";
+
+	for (uint32_t i = 0; i < nodes; i++)
+	{
+		stream << (i > 0 ? "," : "") << i;
+	}
+
+	stream << "]}],\"materials\":[{\"name\":\"default\",\"pbrMetallicRoughness\":{\"baseColorFactor\":[1,1,1,1],"
+		<< "\"metallicFactor\":0.0}}]}";
+
+	return stream.str();
+}
+
+int RunGltfParseBenchmark(uint32_t nodes)
+{
+	const uint32_t Runs = 5;
+
+	auto json = CreateSyntheticGltf(nodes);
+
+	std::cout << "gltf parse: " << nodes << " nodes and accessors, " << (json.size() / 1024) << " KB json, " << Runs
+		<< " runs" << std::endl;
+
+	struct Mode
+	{
+		const char* name;
+		bool streaming;
+		bool arena;
+	};
+
+	const Mode modes[] = {
+		{ "dom", false, false },
+		{ "streaming", true, false },
+		{ "streaming + arena", true, true }
+	};
+
+	tinygltf::Model first_model;
+	bool models_differ = false;
+
+	for (const auto& mode : modes)
+	{
+		tinygltf::TinyGLTF loader;
+		loader.SetStreamingParser(mode.streaming);
+
+		double best_ms = std::numeric_limits<double>::max();
+		double best_free_ms = std::numeric_limits<double>::max();
+		uint64_t allocations = 0;
+		int64_t model_bytes = 0;
+
+		for (uint32_t run = 0; run < Runs; run++)
+		{
+			HeapArena arena;
+			std::optional<tinygltf::Model> model;
+			std::string err;
+			std::string warn;
+			bool ok;
+
+			auto allocations_before = GetAllocationCount();
+			auto bytes_before = GetMemoryStats(MemoryCategory::GltfJson).live_bytes;
+			auto begin = std::chrono::high_resolution_clock::now();
+
+			{
+				MemoryScope memory_scope(MemoryCategory::GltfJson);
+				HeapArenaScope arena_scope(mode.arena ? &arena : nullptr);
+				model.emplace();
+				ok = loader.LoadASCIIFromString(&model.value(), &err, &warn, json.c_str(), (unsigned int)json.size(), "");
+			}
+
+			auto end = std::chrono::high_resolution_clock::now();
+			allocations = GetAllocationCount() - allocations_before;
+			model_bytes = GetMemoryStats(MemoryCategory::GltfJson).live_bytes - bytes_before;
+
+			if (!ok)
+			{
+				std::cout << "failed to parse: " << err << std::endl;
+				return 1;
+			}
+
+			if (run == 0 && mode.streaming)
+				models_differ |= !(model.value() == first_model);
+			else if (run == 0)
+				first_model = model.value();
+
+			err = {};
+			warn = {};
+
+			auto free_begin = std::chrono::high_resolution_clock::now();
+			model.reset();
+			auto kept_blocks = arena.reset();
+			auto free_end = std::chrono::high_resolution_clock::now();
+
+			if (kept_blocks != 0)
+			{
+				std::cout << "  " << mode.name << ": " << kept_blocks << " blocks outlived the model" << std::endl;
+				return 1;
+			}
+
+			best_ms = std::min(best_ms, std::chrono::duration<double, std::milli>(end - begin).count());
+			best_free_ms = std::min(best_free_ms, std::chrono::duration<double, std::milli>(free_end - free_begin).count());
+		}
+
+		std::cout << "  " << mode.name << ": " << best_ms << " ms, "
+			<< ((double)json.size() / (1024.0 * 1024.0) / (best_ms / 1000.0)) << " MB/s, " << allocations
+			<< " heap allocations, model: " << (model_bytes / 1024) << " KB, free: " << best_free_ms << " ms" << std::endl;
+	}
+
+	if (models_differ)
+	{
+		std::cout << "  models differ" << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
+
+// decodes every file to rgba with stb_image and with tinygltf, false when the pixels differ
+static bool RunImageDecodePasses(const std::vector<std::vector<unsigned char>>& files, uint32_t runs)
+{
+	size_t encoded_bytes = 0;
+
+	for (const auto& bytes : files)
+	{
+		encoded_bytes += bytes.size();
+	}
+
+	std::vector<std::vector<unsigned char>> expected(files.size());
+	size_t pixels = 0;
+
+	for (const auto& decoder : { "stb_image", "tinygltf" })
+	{
+		auto stb_image = std::string(decoder) == "stb_image";
+		double best_ms = std::numeric_limits<double>::max();
+		bool images_differ = false;
+
+		for (uint32_t run = 0; run < runs; run++)
+		{
+			std::vector<tinygltf::Image> images(files.size());
+			pixels = 0;
+
+			auto begin = std::chrono::high_resolution_clock::now();
+
+			for (size_t i = 0; i < files.size(); i++)
+			{
+				const auto& bytes = files[i];
+				auto& image = images[i];
+
+				if (stb_image)
+				{
+					auto data = stbi_load_from_memory(bytes.data(), (int)bytes.size(), &image.width, &image.height,
+						&image.component, 4);
+
+					if (data)
+						image.image.assign(data, data + (size_t)image.width * image.height * 4);
+
+					stbi_image_free(data);
+				}
+				else
+				{
+					std::string err;
+					std::string warn;
+					tinygltf::LoadImageData(&image, (int)i, &err, &warn, 0, 0, bytes.data(), (int)bytes.size(), nullptr);
+				}
+
+				pixels += (size_t)image.width * image.height;
+			}
+
+			auto end = std::chrono::high_resolution_clock::now();
+			best_ms = std::min(best_ms, std::chrono::duration<double, std::milli>(end - begin).count());
+
+			for (size_t i = 0; i < files.size(); i++)
+			{
+				if (stb_image && run == 0)
+					expected[i] = std::move(images[i].image);
+				else if (!stb_image)
+					images_differ |= images[i].image.empty() || images[i].image != expected[i];
+			}
+		}
+
+		std::cout << "  " << decoder << ": " << best_ms << " ms, " << ((double)pixels / 1000.0 / best_ms)
+			<< " Mpix/s, " << ((double)encoded_bytes / (1024.0 * 1024.0) / (best_ms / 1000.0)) << " MB/s" << std::endl;
+
+		if (images_differ)
+		{
+			std::cout << "  images differ" << std::endl;
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// chroma subsampling from the luma sampling factors in the baseline frame header
+static const char* GetJpegChromaSampling(const std::vector<unsigned char>& bytes)
+{
+	for (size_t i = 2; i + 11 < bytes.size(); i++)
+	{
+		if (bytes[i] != 0xFF || bytes[i + 1] != 0xC0)
+			continue;
+
+		// stb_image_write never subsamples the chroma components themselves
+
+		switch (bytes[i + 11])
+		{
+		case 0x11: return "4:4:4";
+		case 0x21: return "4:2:2";
+		case 0x22: return "4:2:0";
+		default: return "other sampling";
+		}
+	}
+
+	return "no baseline frame";
+}
+
+int RunImageDecodeBenchmark(uint32_t runs)
+{
+	const int TextureSize = 4096;
+	const int TileSize = 1024;
+
+	// encoded images are read once, decoding runs on this thread only
+
+	std::vector<std::vector<unsigned char>> png_files;
+	size_t encoded_bytes = 0;
+
+	for (const auto& entry : std::filesystem::directory_iterator("assets/sponza"))
+	{
+		if (entry.path().extension() != ".png")
+			continue;
+
+		std::ifstream file(entry.path(), std::ios::binary);
+		png_files.emplace_back(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+		encoded_bytes += png_files.back().size();
+	}
+
+	std::cout << "image decode: " << png_files.size() << " png images, " << (encoded_bytes / (1024 * 1024)) << " MB, "
+		<< runs << " runs" << std::endl;
+
+	if (!RunImageDecodePasses(png_files, runs))
+		return 1;
+
+	// opaque 4k textures tiled from the sponza images as baseline jpegs. The
+	// stb_image_write bundled with tinygltf (v1.11) keeps full chroma at every
+	// quality, newer versions subsample to 4:2:0 at quality 90 and below, so
+	// the sampling is read back from the file
+
+	std::vector<unsigned char> texture((size_t)TextureSize * TextureSize * 3);
+	auto tiles_per_row = TextureSize / TileSize;
+
+	for (int tile = 0; tile < tiles_per_row * tiles_per_row; tile++)
+	{
+		const auto& bytes = png_files.at(tile % png_files.size());
+		int width = 0;
+		int height = 0;
+		int comp = 0;
+		auto data = stbi_load_from_memory(bytes.data(), (int)bytes.size(), &width, &height, &comp, 3);
+
+		for (int y = 0; y < TileSize; y++)
+		{
+			for (int x = 0; x < TileSize; x++)
+			{
+				auto src = data + (((size_t)(y % height) * width) + (x % width)) * 3;
+				auto dst = texture.data() + (((size_t)(tile / tiles_per_row * TileSize + y) * TextureSize) +
+					(tile % tiles_per_row * TileSize + x)) * 3;
+				std::copy(src, src + 3, dst);
+			}
+		}
+
+		stbi_image_free(data);
+	}
+
+	std::vector<std::vector<unsigned char>> jpeg_files;
+
+	for (auto quality : { 85, 95 })
+	{
+		auto& bytes = jpeg_files.emplace_back();
+		stbi_write_jpg_to_func([](void* context, void* data, int size) {
+			auto bytes = static_cast<std::vector<unsigned char>*>(context);
+			bytes->insert(bytes->end(), (unsigned char*)data, (unsigned char*)data + size);
+		}, &bytes, TextureSize, TextureSize, 3, texture.data(), quality);
+
+		std::cout << "image decode: " << TextureSize << "x" << TextureSize << " jpeg, quality " << quality << ", "
+			<< GetJpegChromaSampling(bytes) << ", " << (bytes.size() / 1024) << " KB, " << runs << " runs" << std::endl;
+
+		if (!RunImageDecodePasses({ bytes }, runs))
+			return 1;
+	}
+
+	return 0;
+}
+
+SceneBenchmarkOptions ParseSceneBenchmarkOptions(int argc, char* argv[])
+{
+	SceneBenchmarkOptions result;
+
+	for (int i = 1; i < argc; i++)
+	{
+		auto arg = std::string(argv[i]);
+		auto has_value = i + 1 < argc;
+
+		if (arg == "--frames" && has_value)
+			result.frames = (uint32_t)std::stoul(argv[++i]);
+		else if (arg == "--warmup" && has_value)
+			result.warmup_frames = (uint32_t)std::stoul(argv[++i]);
+		else if (arg == "--timestep" && has_value)
+			result.timestep = std::stof(argv[++i]);
+		else if (arg == "--threads" && has_value)
+			result.threads = (uint32_t)std::stoul(argv[++i]);
+		else if (arg == "--scene" && has_value)
+			result.scene_path = argv[++i];
+		else if (arg == "--out" && has_value)
+			result.output_path = argv[++i];
+		else if (arg == "--camera-path" && has_value)
+			result.camera_path = argv[++i];
+		else if (arg == "--stress-lights")
+			result.stress_lights = true;
+		else if (arg == "--forward")
+			result.forward_shading = true;
+	}
+
+	return result;
+}
+
+static std::optional<SceneDraws> LoadSceneDraws(const std::string& path, JobSystem& jobs)
+{
+	auto primitive_datas = LoadScenePrimitives(path, jobs);
+
+	if (!primitive_datas.has_value())
+		return std::nullopt;
+
+	SceneDraws result;
+
+	for (const auto& primitive_data : primitive_datas.value())
+	{
+		if (!primitive_data.valid)
+			continue;
+
+		result.models.push_back(skygfx::utils::Model());
+		result.bounds.push_back(primitive_data.bounds);
+	}
+
+	return result;
+}
+
+static std::string EscapeJson(const std::string& value)
+{
+	std::string result;
+
+	for (auto c : value)
+	{
+		if ((unsigned char)c < 0x20)
+		{
+			char escaped[8];
+			std::snprintf(escaped, sizeof(escaped), "\\u%04x", (unsigned char)c);
+			result += escaped;
+			continue;
+		}
+
+		if (c == '"' || c == '\\')
+			result += '\\';
+
+		result += c;
+	}
+
+	return result;
+}
+
+static void WriteStats(std::ostream& stream, std::vector<double> values)
+{
+	std::sort(values.begin(), values.end());
+
+	auto percentile = [&](double p) {
+		return values.at(std::min((size_t)(p * values.size()), values.size() - 1));
+	};
+
+	auto mean = std::accumulate(values.begin(), values.end(), 0.0) / values.size();
+
+	stream << "{ \"mean\": " << mean << ", \"p50\": " << percentile(0.5) << ", \"p95\": " << percentile(0.95)
+		<< ", \"p99\": " << percentile(0.99) << ", \"max\": " << values.back() << " }";
+}
+
+int RunSceneBenchmark(const SceneBenchmarkOptions& options)
+{
+	if (options.frames == 0)
+		return 1;
+
+	JobSystem jobs(options.threads == 0 ? std::thread::hardware_concurrency() : options.threads);
+
+	FrameScene scene;
+	SetupSceneLights(scene);
+
+	auto scene_name = options.scene_path;
+
+	if (auto draws = LoadSceneDraws(options.scene_path, jobs); draws.has_value())
+	{
+		scene.draws = std::move(draws.value());
+	}
+	else
+	{
+		std::cout << "failed to load " << options.scene_path << ", using synthetic draws" << std::endl;
+		scene.draws = CreateSyntheticDraws();
+		scene_name = "synthetic";
+	}
+
+	FrameSettings settings;
+	settings.stress_lights = options.stress_lights;
+	settings.forward_shading = options.forward_shading;
+
+	auto camera_path = CreateDefaultCameraPath();
+
+	if (!options.camera_path.empty())
+	{
+		auto loaded_path = LoadCameraPath(options.camera_path);
+
+		if (!loaded_path.has_value() || loaded_path.value().keys.empty())
+		{
+			std::cout << "failed to load camera path " << options.camera_path << std::endl;
+			return 1;
+		}
+
+		camera_path = std::move(loaded_path.value());
+	}
+
+	FrameState frame;
+
+	std::vector<double> frame_times;
+	std::map<std::string, std::vector<double>> stage_times;
+	std::map<std::string, std::vector<double>> counters;
+
+	// a camera path switches these per key, only measured frames are counted
+	uint32_t stress_lights_frames = 0;
+	uint32_t forward_shading_frames = 0;
+
+	for (uint32_t i = 0; i < options.warmup_frames + options.frames; i++)
+	{
+		// light time and camera only depend on the frame index
+
+		auto time = (float)i * options.timestep;
+		auto path_time = camera_path.getDuration() > 0.0f ? std::fmod(time, camera_path.getDuration()) : 0.0f;
+		auto camera = SampleCameraPath(camera_path, path_time);
+		auto matrices = MakeCameraMatrices(camera, 1920, 1080);
+
+		if (!options.camera_path.empty())
+		{
+			auto flags = SampleCameraPathFlags(camera_path, path_time);
+			settings.stress_lights = flags & CameraFlagStressLights;
+			settings.forward_shading = flags & CameraFlagForwardShading;
+			settings.frustum_culling = flags & CameraFlagFrustumCulling;
+		}
+
+		auto begin = std::chrono::high_resolution_clock::now();
+		UpdateFrame(frame, scene, matrices, time, settings, jobs);
+		auto end = std::chrono::high_resolution_clock::now();
+
+		CollectProfilerFrame();
+
+		if (i < options.warmup_frames)
+			continue;
+
+		frame_times.push_back(std::chrono::duration<double, std::milli>(end - begin).count());
+
+		stress_lights_frames += settings.stress_lights ? 1 : 0;
+		forward_shading_frames += settings.forward_shading ? 1 : 0;
+
+		for (const auto& zone : GetProfilerZones())
+		{
+			if (zone.calls > 0)
+				stage_times[zone.name].push_back(zone.ms);
+		}
+
+		const auto& stats = frame.stats;
+		counters["draws"].push_back(stats.draws);
+		counters["visible_draws"].push_back(stats.visible_draws);
+		counters["lights"].push_back(stats.lights);
+		counters["visible_lights"].push_back(stats.visible_lights);
+		counters["max_lights_per_cluster"].push_back(stats.max_lights_per_cluster);
+		counters["draw_light_references"].push_back(stats.draw_light_references);
+		counters["scene_lights"].push_back(stats.scene_lights);
+	}
+
+	std::ofstream file(options.output_path);
+
+	if (!file)
+	{
+		std::cout << "failed to write " << options.output_path << std::endl;
+		return 1;
+	}
+
+	file << "{\n";
+	file << "\t\"scene\": \"" << EscapeJson(scene_name) << "\",\n";
+	file << "\t\"camera_path\": \"" << EscapeJson(options.camera_path.empty() ? "default" : options.camera_path) << "\",\n";
+	file << "\t\"frames\": " << options.frames << ",\n";
+	file << "\t\"warmup_frames\": " << options.warmup_frames << ",\n";
+	file << "\t\"timestep\": " << options.timestep << ",\n";
+	file << "\t\"threads\": " << jobs.getThreadCount() << ",\n";
+	file << "\t\"stress_lights_share\": " << (double)stress_lights_frames / options.frames << ",\n";
+	file << "\t\"forward_shading_share\": " << (double)forward_shading_frames / options.frames << ",\n";
+	file << "\t\"frame_ms\": ";
+	WriteStats(file, frame_times);
+	file << ",\n\t\"stages_ms\": {";
+
+	bool first = true;
+
+	for (const auto& [name, times] : stage_times)
+	{
+		file << (first ? "\n" : ",\n") << "\t\t\"" << name << "\": ";
+		WriteStats(file, times);
+		first = false;
+	}
+
+	file << "\n\t},\n\t\"counts\": {";
+
+	first = true;
+
+	for (const auto& [name, values] : counters)
+	{
+		file << (first ? "\n" : ",\n") << "\t\t\"" << name << "\": ";
+		WriteStats(file, values);
+		first = false;
+	}
+
+	file << "\n\t}\n}\n";
+
+	std::cout << "scene benchmark: " << options.frames << " frames, frame mean: "
+		<< std::accumulate(frame_times.begin(), frame_times.end(), 0.0) / frame_times.size()
+		<< " ms, written to " << options.output_path << std::endl;
+
+	return 0;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// Headless benchmarks, no window or graphics backend is created
+
+int RunLightClustersBenchmark(uint32_t frames);
+
+// frame work and image decoding timed from 1 to N workers
+int RunJobSystemBenchmark(uint32_t frames);
+
+// fails when frames after warmup touch the heap
+int RunFrameAllocationCheck(uint32_t frames);
+
+// fails when blocks that outlive their heap arena are not freed with their
+// chunks, run it under a sanitizer to catch writes into the destroyed arena
+int RunHeapArenaCheck();
+
+// parses a generated gltf with the given number of nodes and accessors through
+// the json dom, the streaming parser and the streaming parser into a heap
+// arena, fails when the models differ
+int RunGltfParseBenchmark(uint32_t nodes);
+
+// decodes the sponza pngs and 4k jpegs made from them with stb_image and with
+// tinygltf on one thread, fails when the pixels differ
+int RunImageDecodeBenchmark(uint32_t runs);
+
+struct SceneBenchmarkOptions
+{
+	uint32_t frames = 1320; // one pass over the default camera path at 60 fps
+	uint32_t warmup_frames = 60;
+	float timestep = 1.0f / 60.0f;
+	uint32_t threads = 0; // 0 means every hardware thread
+	bool stress_lights = false;
+	bool forward_shading = false;
+	std::string scene_path = "assets/sponza/sponza.glb";
+	std::string output_path = "benchmark.json";
+	std::string camera_path; // recorded track, its toggles override the light and culling options
+};
+
+// --frames N --warmup N --timestep S --threads N --stress-lights --forward --scene PATH --out PATH
+// --camera-path PATH
+SceneBenchmarkOptions ParseSceneBenchmarkOptions(int argc, char* argv[]);
+
+// replays the camera path at a fixed timestep with light time derived from
+// the frame index, writes per-stage timings and cull counts as json
+int RunSceneBenchmark(const SceneBenchmarkOptions& options);
@@ -0,0 +1,29 @@
+#include "camera.h"
+
+glm::vec3 GetCameraFront(const skygfx::utils::PerspectiveCamera& camera)
+{
+	auto sin_yaw = glm::sin(camera.yaw);
+	auto sin_pitch = glm::sin(camera.pitch);
+
+	auto cos_yaw = glm::cos(camera.yaw);
+	auto cos_pitch = glm::cos(camera.pitch);
+
+	return glm::normalize(glm::vec3(cos_yaw * cos_pitch, sin_pitch, sin_yaw * cos_pitch));
+}
+
+CameraMatrices MakeCameraMatrices(const skygfx::utils::PerspectiveCamera& camera, uint32_t width, uint32_t height)
+{
+	auto front = GetCameraFront(camera);
+
+	return {
+		.view = glm::lookAtRH(camera.position, camera.position + front, CameraWorldUp),
+		.projection = glm::perspectiveFov(glm::radians(CameraFov), (float)width, (float)height,
+			CameraNearPlane, CameraFarPlane),
+		.position = camera.position,
+		.front = front,
+		.near_plane = CameraNearPlane,
+		.far_plane = CameraFarPlane,
+		.width = width,
+		.height = height
+	};
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <skygfx/utils.h>
+
+constexpr float CameraFov = 70.0f;
+constexpr float CameraNearPlane = 1.0f;
+constexpr float CameraFarPlane = 8192.0f;
+const glm::vec3 CameraWorldUp = { 0.0f, 1.0f, 0.0f };
+
+struct CameraMatrices
+{
+	glm::mat4 view;
+	glm::mat4 projection;
+	glm::vec3 position;
+	glm::vec3 front;
+	float near_plane;
+	float far_plane;
+	uint32_t width;
+	uint32_t height;
+};
+
+glm::vec3 GetCameraFront(const skygfx::utils::PerspectiveCamera& camera);
+CameraMatrices MakeCameraMatrices(const skygfx::utils::PerspectiveCamera& camera, uint32_t width, uint32_t height);
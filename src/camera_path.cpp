@@ -0,0 +1,234 @@
+#include "camera_path.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+constexpr char CameraPathMagic[4] = { 'C', 'P', 'T', 'H' };
+constexpr uint32_t CameraPathVersion = 1;
+
+float CameraPath::getDuration() const
+{
+	return keys.empty() ? 0.0f : keys.back().time;
+}
+
+CameraPath CreateDefaultCameraPath()
+{
+	CameraPath result;
+	result.keys = {
+		{ .time = 0.0f, .position = { -1100.0f, 200.0f, 0.0f }, .yaw = 0.0f, .pitch = 0.0f },
+		{ .time = 6.0f, .position = { 1000.0f, 200.0f, 0.0f }, .yaw = 0.0f, .pitch = 0.1f },
+		{ .time = 9.0f, .position = { 1000.0f, 250.0f, 0.0f }, .yaw = glm::pi<float>(), .pitch = 0.1f },
+		{ .time = 13.0f, .position = { 0.0f, 600.0f, 380.0f }, .yaw = glm::pi<float>() * 1.5f, .pitch = -0.2f },
+		{ .time = 18.0f, .position = { -1100.0f, 600.0f, 380.0f }, .yaw = glm::pi<float>() * 1.5f, .pitch = -0.3f },
+		{ .time = 22.0f, .position = { -1100.0f, 200.0f, 0.0f }, .yaw = glm::two_pi<float>(), .pitch = 0.0f },
+	};
+	return result;
+}
+
+// index of the last key at or before time, clamped to the track
+static size_t FindCameraKey(const CameraPath& path, float time)
+{
+	auto next = std::upper_bound(path.keys.begin(), path.keys.end(), time, [](float time, const CameraKey& key) {
+		return time < key.time;
+	});
+
+	if (next == path.keys.begin())
+		return 0;
+
+	return (size_t)std::distance(path.keys.begin(), next) - 1;
+}
+
+static glm::vec3 CatmullRom(const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2, const glm::vec3& p3, float t)
+{
+	auto t2 = t * t;
+	auto t3 = t2 * t;
+
+	return 0.5f * ((2.0f * p1) + (p2 - p0) * t + (2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3) * t2 +
+		(3.0f * p1 - p0 - 3.0f * p2 + p3) * t3);
+}
+
+// yaw turns around the world up axis, pitch raises the front vector, no roll
+static glm::quat GetCameraOrientation(float yaw, float pitch)
+{
+	return glm::angleAxis(-yaw, CameraWorldUp) * glm::angleAxis(pitch, glm::vec3{ 0.0f, 0.0f, 1.0f });
+}
+
+skygfx::utils::PerspectiveCamera SampleCameraPath(const CameraPath& path, float time)
+{
+	auto result = skygfx::utils::PerspectiveCamera();
+
+	if (path.keys.empty())
+		return result;
+
+	auto index = FindCameraKey(path, time);
+	auto last = path.keys.size() - 1;
+
+	if (index == last || time <= path.keys.front().time)
+	{
+		const auto& key = path.keys.at(index);
+		result.position = key.position;
+		result.yaw = key.yaw;
+		result.pitch = key.pitch;
+		return result;
+	}
+
+	const auto& p0 = path.keys.at(index > 0 ? index - 1 : index);
+	const auto& p1 = path.keys.at(index);
+	const auto& p2 = path.keys.at(index + 1);
+	const auto& p3 = path.keys.at(std::min(index + 2, last));
+
+	auto t = (p2.time > p1.time) ? (time - p1.time) / (p2.time - p1.time) : 0.0f;
+
+	result.position = CatmullRom(p0.position, p1.position, p2.position, p3.position, t);
+
+	auto orientation = glm::slerp(GetCameraOrientation(p1.yaw, p1.pitch), GetCameraOrientation(p2.yaw, p2.pitch), t);
+	auto front = orientation * glm::vec3{ 1.0f, 0.0f, 0.0f };
+
+	result.yaw = glm::atan(front.z, front.x);
+	result.pitch = glm::asin(glm::clamp(front.y, -1.0f, 1.0f));
+	return result;
+}
+
+uint32_t SampleCameraPathFlags(const CameraPath& path, float time)
+{
+	if (path.keys.empty())
+		return 0;
+
+	return path.keys.at(FindCameraKey(path, time)).flags;
+}
+
+void RecordCameraKey(CameraPath& path, float time, const skygfx::utils::PerspectiveCamera& camera, uint32_t flags)
+{
+	path.keys.push_back({
+		.time = time,
+		.position = camera.position,
+		.yaw = camera.yaw,
+		.pitch = camera.pitch,
+		.flags = flags
+	});
+}
+
+// every field is 4 bytes, written byte by byte so files move between hosts
+
+static void WriteCameraPathValue(std::ofstream& file, uint32_t value)
+{
+	char bytes[4];
+
+	for (int i = 0; i < 4; i++)
+		bytes[i] = (char)((value >> (i * 8)) & 0xFF);
+
+	file.write(bytes, sizeof(bytes));
+}
+
+static void WriteCameraPathValue(std::ofstream& file, float value)
+{
+	WriteCameraPathValue(file, std::bit_cast<uint32_t>(value));
+}
+
+static bool ReadCameraPathValue(std::ifstream& file, uint32_t& value)
+{
+	unsigned char bytes[4];
+
+	if (!file.read(reinterpret_cast<char*>(bytes), sizeof(bytes)))
+		return false;
+
+	value = 0;
+
+	for (int i = 0; i < 4; i++)
+		value |= (uint32_t)bytes[i] << (i * 8);
+
+	return true;
+}
+
+static bool ReadCameraPathValue(std::ifstream& file, float& value)
+{
+	uint32_t bits = 0;
+
+	if (!ReadCameraPathValue(file, bits))
+		return false;
+
+	value = std::bit_cast<float>(bits);
+	return true;
+}
+
+constexpr std::streamoff CameraKeySize = 7 * 4;
+
+bool SaveCameraPath(const CameraPath& path, const std::string& file_path)
+{
+	std::ofstream file(file_path, std::ios::binary);
+
+	if (!file)
+		return false;
+
+	auto write = [&](auto value) {
+		WriteCameraPathValue(file, value);
+	};
+
+	file.write(CameraPathMagic, sizeof(CameraPathMagic));
+	write(CameraPathVersion);
+	write((uint32_t)path.keys.size());
+
+	for (const auto& key : path.keys)
+	{
+		write(key.time);
+		write(key.position.x);
+		write(key.position.y);
+		write(key.position.z);
+		write(key.yaw);
+		write(key.pitch);
+		write(key.flags);
+	}
+
+	return (bool)file;
+}
+
+std::optional<CameraPath> LoadCameraPath(const std::string& file_path)
+{
+	std::ifstream file(file_path, std::ios::binary | std::ios::ate);
+
+	if (!file)
+		return std::nullopt;
+
+	auto file_size = (std::streamoff)file.tellg();
+	file.seekg(0);
+
+	auto read = [&](auto& value) {
+		return ReadCameraPathValue(file, value);
+	};
+
+	char magic[4];
+	uint32_t version = 0;
+	uint32_t count = 0;
+
+	if (!file.read(magic, sizeof(magic)) || std::memcmp(magic, CameraPathMagic, sizeof(magic)) != 0)
+		return std::nullopt;
+
+	if (!read(version) || version != CameraPathVersion || !read(count))
+		return std::nullopt;
+
+	// a broken count must not allocate more keys than the file can hold
+	if ((std::streamoff)count > (file_size - (std::streamoff)file.tellg()) / CameraKeySize)
+		return std::nullopt;
+
+	CameraPath result;
+	result.keys.resize(count);
+
+	for (size_t i = 0; i < result.keys.size(); i++)
+	{
+		auto& key = result.keys[i];
+
+		if (!read(key.time) || !read(key.position.x) || !read(key.position.y) || !read(key.position.z) ||
+			!read(key.yaw) || !read(key.pitch) || !read(key.flags))
+			return std::nullopt;
+
+		// sampling binary searches the keys by time
+		if (std::isnan(key.time) || (i > 0 && key.time < result.keys[i - 1].time))
+			return std::nullopt;
+	}
+
+	return result;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <optional>
+#include <string>
+#include <vector>
+#include "camera.h"
+
+// Keyframed camera track, sampled by time so replays do not depend on input
+// or frame rate. Positions follow a Catmull-Rom spline through the keys,
+// orientation is slerped between them. Every key also stores the toggles
+// that were active when it was recorded.
+
+constexpr uint32_t CameraFlagStressLights = 1 << 0;
+constexpr uint32_t CameraFlagForwardShading = 1 << 1;
+constexpr uint32_t CameraFlagFrustumCulling = 1 << 2;
+constexpr uint32_t CameraFlagNormalMapping = 1 << 3;
+
+struct CameraKey
+{
+	float time;
+	glm::vec3 position;
+	float yaw;
+	float pitch;
+	uint32_t flags = CameraFlagFrustumCulling | CameraFlagNormalMapping;
+};
+
+struct CameraPath
+{
+	std::vector<CameraKey> keys; // sorted by time
+
+	float getDuration() const;
+};
+
+// walk along the atrium floor, turn, then pass the upper gallery
+CameraPath CreateDefaultCameraPath();
+
+skygfx::utils::PerspectiveCamera SampleCameraPath(const CameraPath& path, float time);
+uint32_t SampleCameraPathFlags(const CameraPath& path, float time);
+
+// appends a key, time must not go backwards
+void RecordCameraKey(CameraPath& path, float time, const skygfx::utils::PerspectiveCamera& camera, uint32_t flags);
+
+// little-endian binary track: "CPTH", version, key count, then packed keys
+bool SaveCameraPath(const CameraPath& path, const std::string& file_path);
+std::optional<CameraPath> LoadCameraPath(const std::string& file_path);
@@ -0,0 +1,184 @@
+#include "debug_lines.h"
+#include "profiler.h"
+#include <bit>
+#include <chrono>
+
+static uint32_t GetDensityStride(const DrawBounds& bounds, uint32_t vertex_count, const CameraMatrices& camera,
+	float pixels_per_line)
+{
+	auto center = (bounds.min + bounds.max) * 0.5f;
+	auto radius = glm::length(bounds.max - bounds.min) * 0.5f;
+	auto distance = glm::distance(center, camera.position);
+
+	if (distance <= radius)
+		return 1;
+
+	// projection[1][1] is 1 / tan(fov / 2), so this is the bounding sphere radius in pixels
+
+	auto screen_radius = radius / distance * camera.projection[1][1] * (float)camera.height * 0.5f;
+	auto max_lines = glm::pi<float>() * screen_radius * screen_radius / (pixels_per_line * pixels_per_line);
+
+	return std::max((uint32_t)std::ceil((float)vertex_count / std::max(max_lines, 1.0f)), 1u);
+}
+
+void DebugLines::invalidate()
+{
+	mBuilt = false;
+}
+
+void DebugLines::release()
+{
+	mLoadFailed = false;
+
+	if (!mPrimitives.has_value() && !mBuilt)
+		return;
+
+	mPrimitives.reset();
+	mVertices = {};
+	mMesh = {};
+	mBuilt = false;
+	mStats = {};
+}
+
+void DebugLines::update(const RenderBuffer& render_buffer, const std::string& scene_path, const CameraMatrices& camera,
+	const DebugLineSettings& settings, JobSystem& jobs)
+{
+	if (settings != mSettings)
+	{
+		mSettings = settings;
+		mBuilt = false;
+	}
+
+	if (mSettings.screen_density && glm::distance(camera.position, mCameraPosition) > RebuildDistance)
+		mBuilt = false;
+
+	if (mBuilt)
+		return;
+
+	if (mLoadFailed)
+	{
+		mStats = { .failed = true };
+		return;
+	}
+
+	if (!mPrimitives.has_value())
+	{
+		// parsing the scene again takes far longer than a frame, so it runs
+		// on its own thread, the primitives are still converted by the jobs
+
+		if (!mLoading.valid())
+		{
+			mLoading = std::async(std::launch::async, [scene_path, &jobs] {
+				return LoadScenePrimitives(scene_path, jobs);
+			});
+		}
+
+		if (mLoading.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+		{
+			mStats = { .loading = true };
+			return;
+		}
+
+		mPrimitives = mLoading.get();
+
+		if (!mPrimitives.has_value())
+		{
+			mLoadFailed = true;
+			mStats = { .failed = true };
+			return;
+		}
+	}
+
+	build(render_buffer, camera, jobs);
+}
+
+const skygfx::utils::Mesh* DebugLines::getMesh() const
+{
+	return mBuilt && mStats.lines > 0 ? &mMesh : nullptr;
+}
+
+void DebugLines::build(const RenderBuffer& render_buffer, const CameraMatrices& camera, JobSystem& jobs)
+{
+	PROFILE_ZONE("build debug lines");
+
+	auto begin = std::chrono::high_resolution_clock::now();
+
+	struct DrawRange
+	{
+		const PrimitiveData* primitive;
+		uint32_t stride;
+		uint32_t first_vertex;
+		uint32_t vertices;
+	};
+
+	// every draw draws its whole vertex buffer, so lines are made per vertex,
+	// not per index, which would repeat shared vertices
+
+	std::vector<DrawRange> ranges;
+	auto lines_per_vertex = (uint32_t)std::popcount(mSettings.flags & (DebugLineNormals | DebugLineTangents | DebugLineBitangents));
+	uint32_t total_vertices = 0;
+	uint32_t source_vertices = 0;
+
+	for (const auto& [material, draw_datas] : render_buffer.meshes)
+	{
+		for (const auto& draw_data : draw_datas)
+		{
+			if (draw_data.primitive >= mPrimitives->size())
+				continue;
+
+			const auto& primitive = mPrimitives->at(draw_data.primitive);
+			auto vertex_count = (uint32_t)primitive.vertices.size();
+			auto stride = mSettings.screen_density ?
+				GetDensityStride(draw_data.bounds, vertex_count, camera, mSettings.pixels_per_line) : 1;
+			auto sources = (vertex_count + stride - 1) / stride;
+
+			ranges.push_back({ &primitive, stride, total_vertices, sources * lines_per_vertex * 2 });
+			total_vertices += sources * lines_per_vertex * 2;
+			source_vertices += sources;
+		}
+	}
+
+	mVertices.resize(total_vertices);
+
+	jobs.parallelFor((uint32_t)ranges.size(), 1, [&](uint32_t i) {
+		const auto& range = ranges[i];
+		const auto& vertices = range.primitive->vertices;
+		auto dst = mVertices.data() + range.first_vertex;
+
+		auto write_line = [&](const glm::vec3& pos, const glm::vec3& dir, const glm::vec4& color) {
+			dst[0] = { .pos = pos, .color = color };
+			dst[1] = { .pos = pos + (dir * mSettings.length), .color = color };
+			dst += 2;
+		};
+
+		for (size_t j = 0; j < vertices.size(); j += range.stride)
+		{
+			const auto& vertex = vertices[j];
+
+			if (mSettings.flags & DebugLineNormals)
+				write_line(vertex.pos, vertex.normal, { 0.0f, 1.0f, 0.0f, 1.0f });
+
+			if (mSettings.flags & DebugLineTangents)
+				write_line(vertex.pos, vertex.tangent, { 1.0f, 0.0f, 0.0f, 1.0f });
+
+			if (mSettings.flags & DebugLineBitangents)
+				write_line(vertex.pos, glm::cross(vertex.normal, vertex.tangent), { 0.0f, 0.0f, 1.0f, 1.0f });
+		}
+	});
+
+	if (total_vertices > 0)
+	{
+		mMesh.setTopology(skygfx::Topology::LineList);
+		mMesh.setVertices(mVertices);
+	}
+
+	auto end = std::chrono::high_resolution_clock::now();
+
+	mBuilt = true;
+	mCameraPosition = camera.position;
+	mStats = {
+		.lines = total_vertices / 2,
+		.vertices = source_vertices,
+		.build_ms = std::chrono::duration<double, std::milli>(end - begin).count()
+	};
+}
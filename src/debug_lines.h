@@ -0,0 +1,78 @@
+#pragma once
+
+#include <future>
+#include <optional>
+#include <string>
+#include <vector>
+#include <skygfx/utils.h>
+#include "camera.h"
+#include "job_system.h"
+#include "render_buffer.h"
+
+// Normal, tangent and bitangent lines for the whole scene. Every draw gets a
+// precomputed range of one preallocated vertex buffer and jobs fill the
+// ranges in parallel. The cpu geometry is read from the scene file on a
+// background thread when the lines are first shown, they appear once it is
+// loaded, and it is kept only while the lines are in use.
+
+enum DebugLineFlags : uint32_t
+{
+	DebugLineNormals = 1 << 0,
+	DebugLineTangents = 1 << 1,
+	DebugLineBitangents = 1 << 2
+};
+
+struct DebugLineSettings
+{
+	uint32_t flags = DebugLineNormals;
+	float length = 25.0f;
+	bool screen_density = true; // subsample vertices of draws that are small on screen
+	float pixels_per_line = 6.0f; // average screen spacing of line origins when subsampling
+
+	bool operator==(const DebugLineSettings&) const = default;
+};
+
+struct DebugLineStats
+{
+	uint32_t lines = 0;
+	uint32_t vertices = 0; // scene vertices the lines were taken from
+	double build_ms = 0.0;
+	bool loading = false; // the scene geometry is still being read
+	bool failed = false; // the scene geometry could not be read, retried after release()
+};
+
+class DebugLines
+{
+public:
+	// camera distance after which screen density subsampling is redone
+	static constexpr float RebuildDistance = 100.0f;
+
+public:
+	// the lines are rebuilt on the next update, call when the render buffer changes
+	void invalidate();
+
+	// drops the lines and the cached geometry, a load in flight is kept, a
+	// failed one is tried again on the next update
+	void release();
+
+	void update(const RenderBuffer& render_buffer, const std::string& scene_path, const CameraMatrices& camera,
+		const DebugLineSettings& settings, JobSystem& jobs);
+
+	// nullptr when there is nothing to draw or the geometry is still loading
+	const skygfx::utils::Mesh* getMesh() const;
+	const DebugLineStats& getStats() const { return mStats; }
+
+private:
+	void build(const RenderBuffer& render_buffer, const CameraMatrices& camera, JobSystem& jobs);
+
+private:
+	std::future<std::optional<std::vector<PrimitiveData>>> mLoading;
+	std::optional<std::vector<PrimitiveData>> mPrimitives;
+	bool mLoadFailed = false;
+	skygfx::utils::Mesh::Vertices mVertices;
+	skygfx::utils::Mesh mMesh;
+	bool mBuilt = false;
+	DebugLineSettings mSettings;
+	glm::vec3 mCameraPosition = { 0.0f, 0.0f, 0.0f };
+	DebugLineStats mStats;
+};
@@ -0,0 +1,159 @@
+#include "frame.h"
+#include "allocation_counter.h"
+#include "profiler.h"
+#include <chrono>
+#include <numeric>
+
+void SetupSceneLights(FrameScene& scene)
+{
+	auto directional_light = skygfx::utils::DirectionalLight();
+	directional_light.ambient = { 0.125f, 0.125f, 0.125f };
+	directional_light.diffuse = { 0.125f, 0.125f, 0.125f };
+	directional_light.specular = { 1.0f, 1.0f, 1.0f };
+	directional_light.shininess = 16.0f;
+	directional_light.direction = { 0.5f, -1.0f, 0.5f };
+
+	auto base_light = skygfx::utils::PointLight();
+	base_light.shininess = 32.0f;
+	base_light.constant_attenuation = 0.0f;
+	base_light.linear_attenuation = 0.00128f;
+	base_light.quadratic_attenuation = 0.0f;
+
+	auto red_light = base_light;
+	red_light.ambient = { 0.0625f, 0.0f, 0.0f };
+	red_light.diffuse = { 0.5f, 0.0f, 0.0f };
+	red_light.specular = { 1.0f, 0.0f, 0.0f };
+
+	auto green_light = base_light;
+	green_light.ambient = { 0.0f, 0.0625f, 0.0f };
+	green_light.diffuse = { 0.0f, 0.5f, 0.0f };
+	green_light.specular = { 0.0f, 1.0f, 0.0f };
+
+	auto blue_light = base_light;
+	blue_light.ambient = { 0.0f, 0.0f, 0.0625f };
+	blue_light.diffuse = { 0.0f, 0.0f, 0.5f };
+	blue_light.specular = { 0.0f, 0.0f, 1.0f };
+
+	auto lightblue_light = base_light;
+	lightblue_light.ambient = { 0.0f, 0.0625f, 0.0625f };
+	lightblue_light.diffuse = { 0.0f, 0.5f, 0.5f };
+	lightblue_light.specular = { 0.0f, 1.0f, 1.0f };
+
+	scene.directional_light = directional_light;
+	scene.moving_lights = {
+		// first floor
+		{ red_light, { 1200.0f, 256.0f, -36.0f }, { -1200.0f, 256.0f, -36.0f }, 4.0f },
+		{ green_light, { 1200.0f, 256.0f, -36.0f }, { -1200.0f, 256.0f, -36.0f }, 3.0f },
+		{ blue_light, { 1200.0f, 256.0f, -36.0f }, { -1200.0f, 256.0f, -36.0f }, 2.0f },
+
+		// second floor
+		{ green_light, { 1100.0f, 550.0f, 400.0f }, { 1100.0f, 550.0f, -400.0f }, 1.0f },
+		{ red_light, { -1200.0f, 550.0f, -400.0f }, { -1200.0f, 550.0f, 400.0f }, 2.0f },
+		{ blue_light, { 1100.0f, 550.0f, 400.0f }, { -1200.0f, 550.0f, 400.0f }, 3.0f },
+		{ lightblue_light, { 1100.0f, 550.0f, -400.0f }, { -1200.0f, 550.0f, -400.0f }, 4.0f }
+	};
+
+	scene.stress_lights = CreateStressLights(StressLightCount);
+}
+
+void UpdateFrame(FrameState& state, FrameScene& scene, const CameraMatrices& camera, float time,
+	const FrameSettings& settings, JobSystem& jobs)
+{
+	PROFILE_ZONE("update frame");
+	MemoryScope memory_scope(MemoryCategory::Frame);
+
+	state.arena.reset();
+
+	auto light_count = settings.stress_lights ? scene.stress_lights.size() : scene.moving_lights.size();
+
+	FrameVector<skygfx::utils::PointLight> point_lights(state.arena);
+	FrameVector<LightSphere> light_spheres(state.arena);
+	FrameVector<uint32_t> visible_draws(scene.draws.models.size(), state.arena);
+
+	point_lights.resize(light_count);
+	light_spheres.resize(light_count);
+
+	if (settings.stress_lights)
+	{
+		PROFILE_ZONE("animate stress lights");
+
+		jobs.parallelFor((uint32_t)light_count, 256, [&](uint32_t i) {
+			auto& stress_light = scene.stress_lights[i];
+			AnimateStressLight(stress_light, time);
+			point_lights[i] = stress_light.light;
+			light_spheres[i] = { stress_light.light.position, GetLightRadius(stress_light.light, settings.light_cutoff) };
+		});
+	}
+	else
+	{
+		PROFILE_ZONE("animate lights");
+
+		for (size_t i = 0; i < light_count; i++)
+		{
+			auto& moving_light = scene.moving_lights[i];
+			moving_light.light.position = glm::lerp(moving_light.begin, moving_light.end, (glm::sin(time / moving_light.multiplier) + 1.0f) * 0.5f);
+			point_lights[i] = moving_light.light;
+
+			auto radius = GetLightRadius(moving_light.light, settings.light_cutoff);
+
+			if (settings.moving_light_range > 0.0f)
+				radius = glm::min(radius, settings.moving_light_range);
+
+			light_spheres[i] = { moving_light.light.position, radius };
+		}
+	}
+
+	auto assign_begin = std::chrono::high_resolution_clock::now();
+	AssignLightsToClusters(state.light_clusters, camera, light_spheres, jobs);
+	auto assign_end = std::chrono::high_resolution_clock::now();
+
+	if (settings.frustum_culling)
+	{
+		visible_draws.resize(CullDraws(MakeFrustum(camera), scene.draws.bounds, visible_draws, jobs));
+	}
+	else
+	{
+		std::iota(visible_draws.begin(), visible_draws.end(), 0);
+	}
+
+	state.visible_models.clear();
+
+	for (auto index : visible_draws)
+	{
+		state.visible_models.push_back(scene.draws.models.at(index));
+	}
+
+	BuildDrawLights(state.draw_lights, visible_draws, scene.draws.bounds, point_lights, light_spheres,
+		state.light_clusters.visible_lights, (uint32_t)settings.max_lights_per_draw);
+
+	// forward shading only needs lights that made it into some draw list, in
+	// rank order so max_scene_lights keeps every draw's strongest lights,
+	// deferred shading needs every light touching a visible cluster
+
+	const auto& scene_lights = settings.forward_shading ? state.draw_lights.scene_lights :
+		state.light_clusters.visible_lights;
+
+	state.lights.clear();
+	state.lights.push_back(scene.directional_light);
+
+	for (auto index : scene_lights)
+	{
+		if (state.lights.size() > (size_t)settings.max_scene_lights)
+			break;
+
+		state.lights.push_back(point_lights[index]);
+	}
+
+	state.stats = {
+		.lights = (uint32_t)point_lights.size(),
+		.visible_lights = (uint32_t)state.light_clusters.visible_lights.size(),
+		.max_lights_per_cluster = state.light_clusters.max_lights_per_cluster,
+		.assign_ms = std::chrono::duration<double, std::milli>(assign_end - assign_begin).count(),
+		.draws = (uint32_t)scene.draws.models.size(),
+		.visible_draws = (uint32_t)visible_draws.size(),
+		.draw_light_references = (uint32_t)state.draw_lights.light_indices.size(),
+		.max_lights_per_draw = state.draw_lights.max_lights_per_draw,
+		.scene_lights = (uint32_t)scene_lights.size(),
+		.arena_bytes = state.arena.getPeakBytes()
+	};
+}
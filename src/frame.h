@@ -0,0 +1,80 @@
+#pragma once
+
+#include <vector>
+#include <skygfx/utils.h>
+#include "frame_arena.h"
+#include "light_clusters.h"
+#include "light_culling.h"
+#include "stress_lights.h"
+#include "visibility.h"
+
+// Per-frame CPU work between input and DrawScene: light animation, light
+// clustering, draw culling and per-draw light lists. Kept free of window and
+// backend calls so it can also run headless.
+
+struct MovingLight
+{
+	skygfx::utils::PointLight light;
+	glm::vec3 begin;
+	glm::vec3 end;
+	float multiplier = 1.0f;
+};
+
+struct SceneDraws
+{
+	std::vector<skygfx::utils::Model> models;
+	std::vector<DrawBounds> bounds;
+};
+
+struct FrameScene
+{
+	skygfx::utils::DirectionalLight directional_light;
+	std::vector<MovingLight> moving_lights;
+	std::vector<StressLight> stress_lights;
+	SceneDraws draws;
+};
+
+struct FrameSettings
+{
+	bool stress_lights = false;
+	bool frustum_culling = true;
+	bool forward_shading = false;
+	float light_cutoff = DefaultLightCutoff;
+	// caps the culling radius of the moving lights, 0 keeps the radius from
+	// attenuation. Their linear falloff reaches the cutoff only far outside
+	// the atrium, so any cap also cuts off some of their light
+	float moving_light_range = 0.0f;
+	int max_lights_per_draw = 8;
+	int max_scene_lights = 64;
+};
+
+struct FrameStats
+{
+	uint32_t lights = 0;
+	uint32_t visible_lights = 0;
+	uint32_t max_lights_per_cluster = 0;
+	double assign_ms = 0.0;
+	uint32_t draws = 0;
+	uint32_t visible_draws = 0;
+	uint32_t draw_light_references = 0;
+	uint32_t max_lights_per_draw = 0;
+	uint32_t scene_lights = 0;
+	size_t arena_bytes = 0;
+};
+
+struct FrameState
+{
+	FrameArena arena;
+	LightClusters light_clusters;
+	DrawLights draw_lights;
+
+	// results, DrawScene takes std::vector so these are reused instead of arena backed
+	std::vector<skygfx::utils::Light> lights;
+	std::vector<skygfx::utils::Model> visible_models;
+
+	FrameStats stats;
+};
+
+void SetupSceneLights(FrameScene& scene);
+void UpdateFrame(FrameState& state, FrameScene& scene, const CameraMatrices& camera, float time,
+	const FrameSettings& settings, JobSystem& jobs);
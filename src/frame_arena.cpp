@@ -0,0 +1,63 @@
+#include "frame_arena.h"
+#include <algorithm>
+
+FrameArena::FrameArena(size_t block_size) : mBlockSize(block_size)
+{
+}
+
+void* FrameArena::allocate(size_t size, size_t alignment)
+{
+	while (true)
+	{
+		if (mBlockIndex < mBlocks.size())
+		{
+			auto& block = mBlocks.at(mBlockIndex);
+			auto base = (size_t)block.memory.get();
+			auto offset = ((base + mBlockOffset + alignment - 1) & ~(alignment - 1)) - base;
+
+			if (offset + size <= block.size)
+			{
+				mBlockOffset = offset + size;
+				mUsedBytes += size;
+				mPeakBytes = std::max(mPeakBytes, mUsedBytes);
+				return block.memory.get() + offset;
+			}
+
+			if (mBlockOffset > 0)
+			{
+				mBlockIndex += 1;
+				mBlockOffset = 0;
+				continue;
+			}
+		}
+
+		// no block left, or the next one is too small for this request
+
+		auto block_size = std::max(mBlockSize, size + alignment);
+
+		mBlocks.insert(mBlocks.begin() + mBlockIndex, Block{
+			.memory = std::make_unique<std::byte[]>(block_size),
+			.size = block_size
+		});
+		mBlockOffset = 0;
+	}
+}
+
+void FrameArena::reset()
+{
+	mBlockIndex = 0;
+	mBlockOffset = 0;
+	mUsedBytes = 0;
+}
+
+size_t FrameArena::getCapacity() const
+{
+	size_t result = 0;
+
+	for (const auto& block : mBlocks)
+	{
+		result += block.size;
+	}
+
+	return result;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Bump allocator rewound once per frame. Blocks are kept between frames,
+// so once the arena has seen a frame's worth of allocations it stops
+// touching the heap.
+
+class FrameArena
+{
+public:
+	static constexpr size_t DefaultBlockSize = 1024 * 1024;
+
+	FrameArena(size_t block_size = DefaultBlockSize);
+
+	void* allocate(size_t size, size_t alignment);
+	void reset();
+
+	size_t getUsedBytes() const { return mUsedBytes; }
+	size_t getPeakBytes() const { return mPeakBytes; }
+	size_t getCapacity() const;
+
+private:
+	struct Block
+	{
+		std::unique_ptr<std::byte[]> memory;
+		size_t size;
+	};
+
+	std::vector<Block> mBlocks;
+	size_t mBlockSize;
+	size_t mBlockIndex = 0;
+	size_t mBlockOffset = 0;
+	size_t mUsedBytes = 0;
+	size_t mPeakBytes = 0;
+};
+
+template <typename T>
+struct FrameAllocator
+{
+	using value_type = T;
+
+	FrameArena* arena;
+
+	FrameAllocator(FrameArena& _arena) : arena(&_arena) {}
+
+	template <typename U>
+	FrameAllocator(const FrameAllocator<U>& other) : arena(other.arena) {}
+
+	T* allocate(size_t count)
+	{
+		return static_cast<T*>(arena->allocate(count * sizeof(T), alignof(T)));
+	}
+
+	void deallocate(T*, size_t)
+	{
+	}
+
+	template <typename U>
+	bool operator==(const FrameAllocator<U>& other) const { return arena == other.arena; }
+};
+
+template <typename T>
+using FrameVector = std::vector<T, FrameAllocator<T>>;
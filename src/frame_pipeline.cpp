@@ -0,0 +1,147 @@
+#include "frame_pipeline.h"
+#include "profiler.h"
+
+using Clock = std::chrono::steady_clock;
+
+static double GetMilliseconds(Clock::time_point begin, Clock::time_point end)
+{
+	return std::chrono::duration<double, std::milli>(end - begin).count();
+}
+
+FramePipeline::FramePipeline()
+{
+	mThread = std::thread([this] {
+		threadLoop();
+	});
+}
+
+FramePipeline::~FramePipeline()
+{
+	{
+		std::lock_guard lock(mMutex);
+		mRunning = false;
+	}
+
+	mCondition.notify_all();
+	mThread.join();
+}
+
+FramePacket& FramePipeline::beginFrame(FrameScene& scene, const skygfx::utils::PerspectiveCamera& camera,
+	const CameraMatrices& matrices, float time, const FrameSettings& settings, JobSystem& jobs)
+{
+	auto now = Clock::now();
+
+	mStats.frame_ms = GetMilliseconds(mFrameBegin, now);
+	mFrameBegin = now;
+
+	auto& packet = (mReady == &mPackets[0]) ? mPackets[1] : mPackets[0];
+	packet.camera = camera;
+	packet.input_time = now;
+
+	mScene = &scene;
+	mMatrices = matrices;
+	mTime = time;
+	mSettings = settings;
+	mJobs = &jobs;
+
+	if (!mEnabled || mReady == nullptr)
+	{
+		// nothing prepared, this frame is simulated here and submitted right away,
+		// with pipelining on it stays ready so the next frame has something to submit
+
+		simulate(packet);
+		mSubmitted = &packet;
+		mReady = mEnabled ? &packet : nullptr;
+		mStats.frames_in_flight = 1;
+		mStats.wait_ms = 0.0;
+	}
+	else
+	{
+		mSubmitted = mReady;
+
+		{
+			std::lock_guard lock(mMutex);
+			mPending = &packet;
+			mWorkPending = true;
+		}
+
+		mCondition.notify_all();
+		mStats.frames_in_flight = 2;
+	}
+
+	mSubmitBegin = Clock::now();
+	return *mSubmitted;
+}
+
+void FramePipeline::endFrame()
+{
+	auto submit_end = Clock::now();
+	mStats.submit_ms = GetMilliseconds(mSubmitBegin, submit_end);
+	mStats.latency_ms = GetMilliseconds(mSubmitted->input_time, submit_end);
+
+	if (mPending == nullptr)
+		return;
+
+	{
+		std::unique_lock lock(mMutex);
+		mCondition.wait(lock, [this] {
+			return !mWorkPending;
+		});
+	}
+
+	mStats.wait_ms = GetMilliseconds(submit_end, Clock::now());
+	mReady = mPending;
+	mPending = nullptr;
+}
+
+void FramePipeline::invalidate()
+{
+	mReady = nullptr;
+}
+
+void FramePipeline::setEnabled(bool value)
+{
+	if (mEnabled == value)
+		return;
+
+	mEnabled = value;
+	mReady = nullptr;
+}
+
+void FramePipeline::simulate(FramePacket& packet)
+{
+	auto begin = Clock::now();
+	UpdateFrame(packet.state, *mScene, mMatrices, mTime, mSettings, *mJobs);
+	mStats.sim_ms = GetMilliseconds(begin, Clock::now());
+}
+
+void FramePipeline::threadLoop()
+{
+	SetProfilerThreadName("sim");
+
+	while (true)
+	{
+		FramePacket* packet = nullptr;
+
+		{
+			std::unique_lock lock(mMutex);
+			mCondition.wait(lock, [this] {
+				return !mRunning || mWorkPending;
+			});
+
+			if (!mRunning)
+				return;
+
+			packet = mPending;
+		}
+
+		simulate(*packet);
+
+		{
+			std::lock_guard lock(mMutex);
+			mWorkPending = false;
+		}
+
+		mCondition.notify_all();
+	}
+}
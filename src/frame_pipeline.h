@@ -0,0 +1,85 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "frame.h"
+
+// Optional two-stage frame pipeline. A simulation thread runs UpdateFrame for
+// frame N+1 while the main thread submits frame N, results are handed over
+// in two frame packets. Submission stays on the main thread because the
+// window, the imgui backend and the graphics context are bound to it.
+
+struct FramePacket
+{
+	FrameState state;
+	skygfx::utils::PerspectiveCamera camera;
+	std::chrono::steady_clock::time_point input_time;
+};
+
+struct FramePipelineStats
+{
+	double sim_ms = 0.0;
+	double submit_ms = 0.0;
+	double wait_ms = 0.0;
+	double frame_ms = 0.0;
+	double latency_ms = 0.0; // from camera input to present
+	uint32_t frames_in_flight = 0;
+};
+
+class FramePipeline
+{
+public:
+	FramePipeline();
+	~FramePipeline();
+
+	FramePipeline(const FramePipeline&) = delete;
+	FramePipeline& operator=(const FramePipeline&) = delete;
+
+	// Starts frame work for the given inputs and returns the packet to submit:
+	// the same frame when pipelining is off, the previous frame when it is on.
+	FramePacket& beginFrame(FrameScene& scene, const skygfx::utils::PerspectiveCamera& camera,
+		const CameraMatrices& matrices, float time, const FrameSettings& settings, JobSystem& jobs);
+
+	// call after Present, waits for the frame that was started in beginFrame
+	void endFrame();
+
+	// drops the prepared frame, call before scene draws are rebuilt since the
+	// packet points into them, never between beginFrame and endFrame
+	void invalidate();
+
+	void setEnabled(bool value);
+	bool isEnabled() const { return mEnabled; }
+
+	const FramePipelineStats& getStats() const { return mStats; }
+
+private:
+	void simulate(FramePacket& packet);
+	void threadLoop();
+
+private:
+	std::array<FramePacket, 2> mPackets;
+	FramePacket* mPending = nullptr; // being simulated
+	FramePacket* mReady = nullptr; // simulated, submitted by the next frame
+	FramePacket* mSubmitted = nullptr;
+	bool mEnabled = false;
+
+	// inputs of the pending frame
+	FrameScene* mScene = nullptr;
+	CameraMatrices mMatrices;
+	float mTime = 0.0f;
+	FrameSettings mSettings;
+	JobSystem* mJobs = nullptr;
+
+	std::thread mThread;
+	std::mutex mMutex;
+	std::condition_variable mCondition;
+	bool mWorkPending = false;
+	bool mRunning = true;
+
+	std::chrono::steady_clock::time_point mSubmitBegin;
+	std::chrono::steady_clock::time_point mFrameBegin;
+	FramePipelineStats mStats;
+};
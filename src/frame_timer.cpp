@@ -0,0 +1,107 @@
+#include "frame_timer.h"
+#include <algorithm>
+#include <fstream>
+
+void FrameTimer::beginFrame()
+{
+	mFrameBegin = Clock::now();
+}
+
+void FrameTimer::beginPresent()
+{
+	mPresentBegin = Clock::now();
+}
+
+void FrameTimer::endFrame()
+{
+	auto now = Clock::now();
+
+	// the first frame has nothing to measure presents against
+	if (!mHasPrevFrame)
+	{
+		mHasPrevFrame = true;
+		mPrevFrameEnd = now;
+		return;
+	}
+
+	auto cpu_ms = std::chrono::duration<float, std::milli>(mPresentBegin - mFrameBegin).count();
+	auto present_ms = std::chrono::duration<float, std::milli>(now - mPrevFrameEnd).count();
+	mPrevFrameEnd = now;
+
+	auto index = (uint32_t)(mCount % Capacity);
+	auto hitch = present_ms > mHitchThresholdMs;
+
+	if (mCount >= Capacity && mHitches[index])
+		mRecentHitchCount -= 1;
+
+	mCpuMs[index] = cpu_ms;
+	mPresentMs[index] = present_ms;
+	mHitches[index] = hitch;
+	mCount += 1;
+
+	if (hitch)
+	{
+		mHitchCount += 1;
+		mRecentHitchCount += 1;
+		mLastHitchMs = present_ms;
+	}
+
+	computePercentiles(mCpuMs, mCpuPercentiles);
+	computePercentiles(mPresentMs, mPresentPercentiles);
+
+	mHistogram.fill(0.0f);
+
+	for (uint32_t i = 0; i < getSampleCount(); i++)
+	{
+		auto bin = (uint32_t)(mPresentMs[i] / HistogramMaxMs * HistogramBins);
+		mHistogram[std::min(bin, HistogramBins - 1)] += 1.0f;
+	}
+}
+
+void FrameTimer::computePercentiles(const std::array<float, Capacity>& samples, Percentiles& percentiles)
+{
+	auto count = getSampleCount();
+	auto begin = mScratch.begin();
+	auto end = begin + count;
+
+	std::copy(samples.begin(), samples.begin() + count, begin);
+
+	// nth_element leaves everything above the pivot unsorted, so percentiles
+	// are taken from the lowest one up, each pass narrowing the range
+
+	auto select = [&](auto from, float percentile) {
+		auto nth = begin + std::min((size_t)(percentile * count), (size_t)count - 1);
+		std::nth_element(from, nth, end);
+		return nth;
+	};
+
+	auto p50 = select(begin, 0.50f);
+	auto p95 = select(p50, 0.95f);
+	auto p99 = select(p95, 0.99f);
+
+	percentiles.p50 = *p50;
+	percentiles.p95 = *p95;
+	percentiles.p99 = *p99;
+	percentiles.max = *std::max_element(p99, end);
+}
+
+bool FrameTimer::exportCsv(const std::string& path) const
+{
+	std::ofstream file(path);
+
+	if (!file)
+		return false;
+
+	file << "frame,cpu_ms,present_ms,hitch\n";
+
+	auto count = getSampleCount();
+	auto first = mCount - count;
+
+	for (uint64_t frame = first; frame < mCount; frame++)
+	{
+		auto index = frame % Capacity;
+		file << frame << "," << mCpuMs[index] << "," << mPresentMs[index] << "," << (int)mHitches[index] << "\n";
+	}
+
+	return (bool)file;
+}
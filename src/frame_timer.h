@@ -0,0 +1,76 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// Per-frame CPU time (frame begin to Present) and present-to-present time
+// over the last Capacity frames. Percentiles and the histogram are rebuilt
+// every frame from the ring, so they always describe the recent tail.
+
+class FrameTimer
+{
+public:
+	static constexpr uint32_t Capacity = 1024;
+	static constexpr uint32_t HistogramBins = 50;
+	static constexpr float HistogramMaxMs = 50.0f; // last bin collects everything above
+
+	struct Percentiles
+	{
+		float p50 = 0.0f;
+		float p95 = 0.0f;
+		float p99 = 0.0f;
+		float max = 0.0f;
+	};
+
+public:
+	void beginFrame();
+	void beginPresent();
+	void endFrame();
+
+	void setHitchThreshold(float ms) { mHitchThresholdMs = ms; }
+	float getHitchThreshold() const { return mHitchThresholdMs; }
+
+	const Percentiles& getCpuPercentiles() const { return mCpuPercentiles; }
+	const Percentiles& getPresentPercentiles() const { return mPresentPercentiles; }
+	uint32_t getHitchCount() const { return mHitchCount; }
+	uint32_t getRecentHitchCount() const { return mRecentHitchCount; } // inside the ring
+	float getLastHitchMs() const { return mLastHitchMs; }
+
+	// oldest first when read from getRingOffset() with wrap-around, for PlotLines
+	const std::array<float, Capacity>& getPresentTimes() const { return mPresentMs; }
+	uint32_t getRingOffset() const { return mCount < Capacity ? 0 : (uint32_t)(mCount % Capacity); }
+	uint32_t getSampleCount() const { return (uint32_t)std::min<uint64_t>(mCount, Capacity); }
+	const std::array<float, HistogramBins>& getHistogram() const { return mHistogram; }
+
+	bool exportCsv(const std::string& path) const;
+
+private:
+	using Clock = std::chrono::steady_clock;
+
+	void computePercentiles(const std::array<float, Capacity>& samples, Percentiles& percentiles);
+
+private:
+	Clock::time_point mFrameBegin;
+	Clock::time_point mPresentBegin;
+	Clock::time_point mPrevFrameEnd;
+	bool mHasPrevFrame = false;
+
+	std::array<float, Capacity> mCpuMs = {};
+	std::array<float, Capacity> mPresentMs = {};
+	std::array<uint8_t, Capacity> mHitches = {};
+	uint64_t mCount = 0;
+
+	float mHitchThresholdMs = 33.3f;
+	uint32_t mHitchCount = 0;
+	uint32_t mRecentHitchCount = 0;
+	float mLastHitchMs = 0.0f;
+
+	// rebuilt every frame
+	std::array<float, Capacity> mScratch;
+	Percentiles mCpuPercentiles;
+	Percentiles mPresentPercentiles;
+	std::array<float, HistogramBins> mHistogram = {};
+};
@@ -0,0 +1,34 @@
+#include "image_decoder.h"
+
+bool DecodeDeferredImages(tinygltf::Model& model, DeferredImages& images, JobSystem& jobs, std::string* err)
+{
+	std::vector<std::string> errors(images.entries.size());
+	std::vector<uint8_t> results(images.entries.size(), 0);
+
+	jobs.parallelFor((uint32_t)images.entries.size(), 1, [&](uint32_t i) {
+		auto& entry = images.entries.at(i);
+		std::string warn;
+
+		results[i] = tinygltf::LoadImageData(&model.images.at(entry.index), entry.index, &errors[i], &warn,
+			entry.req_width, entry.req_height, entry.bytes.data(), (int)entry.bytes.size(), nullptr);
+
+		entry.bytes = {};
+	});
+
+	images.entries.clear();
+
+	bool result = true;
+
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		if (results[i])
+			continue;
+
+		result = false;
+
+		if (err)
+			(*err) += errors[i];
+	}
+
+	return result;
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <tiny_gltf.h>
+#include "job_system.h"
+
+// Encoded images waiting to be decoded with one job per image.
+
+struct DeferredImages
+{
+	struct Entry
+	{
+		int index;
+		int req_width;
+		int req_height;
+		std::vector<unsigned char> bytes;
+	};
+
+	std::vector<Entry> entries;
+};
+
+bool DecodeDeferredImages(tinygltf::Model& model, DeferredImages& images, JobSystem& jobs, std::string* err);
@@ -0,0 +1,192 @@
+#include "job_system.h"
+#include "profiler.h"
+
+static thread_local const JobSystem* tJobSystem = nullptr;
+static thread_local uint32_t tWorkerIndex = 0;
+
+JobSystem::JobSystem(uint32_t threads)
+{
+	threads = std::max(threads, 1u);
+	mWorkerCount = threads;
+
+	for (uint32_t i = 0; i <= threads; i++)
+	{
+		mQueues.push_back(std::make_unique<Queue>());
+	}
+
+	for (uint32_t i = 1; i < threads; i++)
+	{
+		mThreads.emplace_back([this, i] {
+			workerLoop(i);
+		});
+	}
+}
+
+JobSystem::~JobSystem()
+{
+	mRunning = false;
+
+	{
+		std::lock_guard lock(mSleepMutex);
+	}
+
+	mSleepCondition.notify_all();
+
+	for (auto& thread : mThreads)
+	{
+		thread.join();
+	}
+}
+
+void JobSystem::wait(Counter& counter)
+{
+	auto index = getWorkerIndex();
+
+	while (counter.value.load(std::memory_order_acquire) > 0)
+	{
+		if (!runOne(index))
+			std::this_thread::yield();
+	}
+
+	// the last job releases the counter under its mutex, don't let the caller
+	// destroy the counter before that job is out
+
+	std::lock_guard lock(counter.mutex);
+}
+
+void JobSystem::push(const Job& job)
+{
+	auto& queue = *mQueues.at(getWorkerIndex());
+
+	{
+		std::unique_lock lock(queue.mutex);
+
+		if (queue.tail - queue.head >= QueueCapacity)
+		{
+			lock.unlock();
+			execute(job);
+			return;
+		}
+
+		queue.jobs[queue.tail % QueueCapacity] = job;
+		queue.tail += 1;
+	}
+
+	mQueuedJobs.fetch_add(1);
+
+	{
+		std::lock_guard lock(mSleepMutex);
+	}
+
+	mSleepCondition.notify_one();
+}
+
+void JobSystem::park(Counter& dependency, const Job& job)
+{
+	{
+		std::lock_guard lock(dependency.mutex);
+
+		if (dependency.value.load() > 0)
+		{
+			dependency.continuations.push_back(job);
+			return;
+		}
+	}
+
+	push(job);
+}
+
+bool JobSystem::popLocal(uint32_t index, Job& job)
+{
+	auto& queue = *mQueues.at(index);
+	std::lock_guard lock(queue.mutex);
+
+	if (queue.head == queue.tail)
+		return false;
+
+	queue.tail -= 1;
+	job = queue.jobs[queue.tail % QueueCapacity];
+	mQueuedJobs.fetch_sub(1);
+	return true;
+}
+
+bool JobSystem::steal(uint32_t index, Job& job)
+{
+	auto count = (uint32_t)mQueues.size();
+
+	for (uint32_t i = 1; i < count; i++)
+	{
+		auto& queue = *mQueues.at((index + i) % count);
+		std::lock_guard lock(queue.mutex);
+
+		if (queue.head == queue.tail)
+			continue;
+
+		job = queue.jobs[queue.head % QueueCapacity];
+		queue.head += 1;
+		mQueuedJobs.fetch_sub(1);
+		return true;
+	}
+
+	return false;
+}
+
+bool JobSystem::runOne(uint32_t index)
+{
+	Job job;
+
+	if (!popLocal(index, job) && !steal(index, job))
+		return false;
+
+	execute(job);
+	return true;
+}
+
+void JobSystem::execute(const Job& job)
+{
+	job.function(job.storage);
+
+	if (job.counter == nullptr)
+		return;
+
+	std::vector<Job> continuations;
+
+	{
+		std::lock_guard lock(job.counter->mutex);
+
+		if (job.counter->value.fetch_sub(1, std::memory_order_acq_rel) == 1)
+			std::swap(continuations, job.counter->continuations);
+	}
+
+	for (const auto& continuation : continuations)
+	{
+		push(continuation);
+	}
+}
+
+void JobSystem::workerLoop(uint32_t index)
+{
+	tJobSystem = this;
+	tWorkerIndex = index;
+
+	SetProfilerThreadName("worker " + std::to_string(index));
+
+	while (mRunning)
+	{
+		if (runOne(index))
+			continue;
+
+		std::unique_lock lock(mSleepMutex);
+		mSleepCondition.wait(lock, [this] {
+			return !mRunning || mQueuedJobs.load() > 0;
+		});
+	}
+}
+
+uint32_t JobSystem::getWorkerIndex() const
+{
+	if (tJobSystem == this)
+		return tWorkerIndex;
+
+	return std::this_thread::get_id() == mOwnerThread ? 0 : mWorkerCount;
+}
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Work-stealing job system. Every worker owns a fixed-size deque, pops its
+// own jobs from the back and steals from the front of other workers' deques.
+// The thread that waits on a counter keeps running jobs instead of blocking,
+// so the thread that creates the system is worker 0. Other threads, like the
+// sim thread or a loader, share one more queue that they push to and the
+// workers steal from. There should be one system per process, a second one
+// only adds threads that compete for the same cores. Scheduling never
+// allocates, which keeps frame work allocation-free.
+
+class JobSystem
+{
+public:
+	static constexpr size_t QueueCapacity = 4096;
+	static constexpr size_t JobStorageSize = 48;
+
+	struct Job;
+
+	// Number of unfinished jobs bound to it. Jobs scheduled after a counter
+	// are parked until it drops to zero.
+	struct Counter
+	{
+		std::atomic<uint32_t> value = 0;
+		std::mutex mutex;
+		std::vector<Job> continuations;
+	};
+
+	struct Job
+	{
+		void (*function)(const std::byte* storage) = nullptr;
+		Counter* counter = nullptr;
+		alignas(std::max_align_t) std::byte storage[JobStorageSize];
+	};
+
+public:
+	JobSystem(uint32_t threads = std::thread::hardware_concurrency());
+	~JobSystem();
+
+	JobSystem(const JobSystem&) = delete;
+	JobSystem& operator=(const JobSystem&) = delete;
+
+	template <typename Func>
+	void schedule(Func func, Counter* counter = nullptr)
+	{
+		push(makeJob(func, counter));
+	}
+
+	template <typename Func>
+	void scheduleAfter(Counter& dependency, Func func, Counter* counter = nullptr)
+	{
+		park(dependency, makeJob(func, counter));
+	}
+
+	void wait(Counter& counter);
+
+	// calls func(index) for every index in [0, count), batch_size indices per job
+	template <typename Func>
+	void parallelFor(uint32_t count, uint32_t batch_size, const Func& func)
+	{
+		if (count == 0)
+			return;
+
+		batch_size = std::max(batch_size, 1u);
+
+		if (mWorkerCount == 1 || count <= batch_size)
+		{
+			for (uint32_t i = 0; i < count; i++)
+				func(i);
+
+			return;
+		}
+
+		Counter counter;
+
+		for (uint32_t begin = 0; begin < count; begin += batch_size)
+		{
+			auto end = std::min(begin + batch_size, count);
+
+			schedule([&func, begin, end] {
+				for (uint32_t i = begin; i < end; i++)
+					func(i);
+			}, &counter);
+		}
+
+		wait(counter);
+	}
+
+	uint32_t getThreadCount() const { return mWorkerCount; }
+
+private:
+	struct Queue
+	{
+		std::mutex mutex;
+		std::array<Job, QueueCapacity> jobs;
+		size_t head = 0; // steal side
+		size_t tail = 0; // owner side
+	};
+
+	template <typename Func>
+	static Job makeJob(const Func& func, Counter* counter)
+	{
+		static_assert(sizeof(Func) <= JobStorageSize, "job captures are too big");
+		static_assert(std::is_trivially_copyable_v<Func>, "job captures must be trivially copyable");
+
+		Job job;
+		job.counter = counter;
+		job.function = [](const std::byte* storage) {
+			(*reinterpret_cast<const Func*>(storage))();
+		};
+		new (job.storage) Func(func);
+
+		if (counter != nullptr)
+			counter->value.fetch_add(1);
+
+		return job;
+	}
+
+	void push(const Job& job);
+	void park(Counter& dependency, const Job& job);
+	bool popLocal(uint32_t index, Job& job);
+	bool steal(uint32_t index, Job& job);
+	bool runOne(uint32_t index);
+	void execute(const Job& job);
+	void workerLoop(uint32_t index);
+	uint32_t getWorkerIndex() const;
+
+private:
+	std::vector<std::unique_ptr<Queue>> mQueues; // one per worker, the last one for other threads
+	uint32_t mWorkerCount = 0;
+	std::thread::id mOwnerThread = std::this_thread::get_id();
+	std::vector<std::thread> mThreads;
+	std::atomic<bool> mRunning = true;
+	std::atomic<uint32_t> mQueuedJobs = 0;
+	std::mutex mSleepMutex;
+	std::condition_variable mSleepCondition;
+};
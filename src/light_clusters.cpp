@@ -0,0 +1,334 @@
+#include "light_clusters.h"
+#include "profiler.h"
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define LIGHT_CLUSTERS_SSE2
+#include <emmintrin.h>
+#endif
+
+static constexpr uint32_t LightsPerChunk = 1024;
+
+uint32_t LightClusters::GetClusterIndex(uint32_t x, uint32_t y, uint32_t z)
+{
+	return (z * GridY + y) * GridX + x;
+}
+
+struct BoundsParams
+{
+	glm::vec4 view_x; // rows of the view matrix
+	glm::vec4 view_y;
+	glm::vec4 view_z;
+	float proj_x;
+	float proj_y;
+	float near_plane;
+	float far_plane;
+};
+
+static void ComputeLightBoundsScalar(LightClusters& clusters, const BoundsParams& params,
+	const LightSphere& light, uint32_t index)
+{
+	auto pos = glm::vec4(light.position, 1.0f);
+	auto x = glm::dot(params.view_x, pos);
+	auto y = glm::dot(params.view_y, pos);
+	auto depth = -glm::dot(params.view_z, pos);
+
+	auto min_depth = std::max(depth - light.radius, params.near_plane);
+	auto max_depth = std::min(depth + light.radius, params.far_plane);
+
+	// sphere aabb projected at both ends of its depth range, conservative for x / depth
+
+	auto min_x = params.proj_x * std::min((x - light.radius) / min_depth, (x - light.radius) / max_depth);
+	auto max_x = params.proj_x * std::max((x + light.radius) / min_depth, (x + light.radius) / max_depth);
+	auto min_y = params.proj_y * std::min((y - light.radius) / min_depth, (y - light.radius) / max_depth);
+	auto max_y = params.proj_y * std::max((y + light.radius) / min_depth, (y + light.radius) / max_depth);
+
+	auto& bounds = clusters.bounds[index];
+
+	bounds.visible = depth + light.radius > params.near_plane && depth - light.radius < params.far_plane &&
+		max_x > -1.0f && min_x < 1.0f && max_y > -1.0f && min_y < 1.0f;
+
+	if (!bounds.visible)
+		return;
+
+	auto to_tile = [](float ndc, uint32_t grid) {
+		return (uint8_t)std::clamp((ndc * 0.5f + 0.5f) * (float)grid, 0.0f, (float)(grid - 1));
+	};
+
+	auto to_slice = [&](float depth) {
+		uint8_t slice = 0;
+
+		for (uint32_t i = 1; i < LightClusters::GridZ; i++)
+			slice += clusters.slice_depths[i] <= depth ? 1 : 0;
+
+		return slice;
+	};
+
+	bounds.min_x = to_tile(min_x, LightClusters::GridX);
+	bounds.max_x = to_tile(max_x, LightClusters::GridX);
+	bounds.min_y = to_tile(min_y, LightClusters::GridY);
+	bounds.max_y = to_tile(max_y, LightClusters::GridY);
+	bounds.min_z = to_slice(min_depth);
+	bounds.max_z = to_slice(max_depth);
+}
+
+#ifdef LIGHT_CLUSTERS_SSE2
+static void ComputeLightBounds4(LightClusters& clusters, const BoundsParams& params,
+	const LightSphere* lights, uint32_t index)
+{
+	auto l0 = _mm_loadu_ps((const float*)&lights[0]);
+	auto l1 = _mm_loadu_ps((const float*)&lights[1]);
+	auto l2 = _mm_loadu_ps((const float*)&lights[2]);
+	auto l3 = _mm_loadu_ps((const float*)&lights[3]);
+
+	_MM_TRANSPOSE4_PS(l0, l1, l2, l3);
+
+	const auto& px = l0;
+	const auto& py = l1;
+	const auto& pz = l2;
+	const auto& radius = l3;
+
+	auto transform = [&](const glm::vec4& row) {
+		auto result = _mm_mul_ps(px, _mm_set1_ps(row.x));
+		result = _mm_add_ps(result, _mm_mul_ps(py, _mm_set1_ps(row.y)));
+		result = _mm_add_ps(result, _mm_mul_ps(pz, _mm_set1_ps(row.z)));
+		return _mm_add_ps(result, _mm_set1_ps(row.w));
+	};
+
+	auto x = transform(params.view_x);
+	auto y = transform(params.view_y);
+	auto depth = _mm_sub_ps(_mm_setzero_ps(), transform(params.view_z));
+
+	auto near_plane = _mm_set1_ps(params.near_plane);
+	auto far_plane = _mm_set1_ps(params.far_plane);
+
+	auto front = _mm_sub_ps(depth, radius);
+	auto back = _mm_add_ps(depth, radius);
+	auto min_depth = _mm_max_ps(front, near_plane);
+	auto max_depth = _mm_min_ps(back, far_plane);
+
+	auto min_proj = [&](__m128 value, float scale) {
+		return _mm_mul_ps(_mm_set1_ps(scale), _mm_min_ps(_mm_div_ps(value, min_depth), _mm_div_ps(value, max_depth)));
+	};
+
+	auto max_proj = [&](__m128 value, float scale) {
+		return _mm_mul_ps(_mm_set1_ps(scale), _mm_max_ps(_mm_div_ps(value, min_depth), _mm_div_ps(value, max_depth)));
+	};
+
+	auto min_x = min_proj(_mm_sub_ps(x, radius), params.proj_x);
+	auto max_x = max_proj(_mm_add_ps(x, radius), params.proj_x);
+	auto min_y = min_proj(_mm_sub_ps(y, radius), params.proj_y);
+	auto max_y = max_proj(_mm_add_ps(y, radius), params.proj_y);
+
+	auto one = _mm_set1_ps(1.0f);
+	auto minus_one = _mm_set1_ps(-1.0f);
+
+	auto visible = _mm_and_ps(_mm_cmpgt_ps(back, near_plane), _mm_cmplt_ps(front, far_plane));
+	visible = _mm_and_ps(visible, _mm_and_ps(_mm_cmpgt_ps(max_x, minus_one), _mm_cmplt_ps(min_x, one)));
+	visible = _mm_and_ps(visible, _mm_and_ps(_mm_cmpgt_ps(max_y, minus_one), _mm_cmplt_ps(min_y, one)));
+
+	auto to_tile = [&](__m128 ndc, uint32_t grid) {
+		auto half_grid = _mm_set1_ps((float)grid * 0.5f);
+		auto tile = _mm_add_ps(_mm_mul_ps(ndc, half_grid), half_grid);
+		tile = _mm_min_ps(_mm_max_ps(tile, _mm_setzero_ps()), _mm_set1_ps((float)(grid - 1)));
+		return _mm_cvttps_epi32(tile);
+	};
+
+	auto to_slice = [&](__m128 depth) {
+		auto slice = _mm_setzero_si128();
+
+		for (uint32_t i = 1; i < LightClusters::GridZ; i++)
+		{
+			auto mask = _mm_cmple_ps(_mm_set1_ps(clusters.slice_depths[i]), depth);
+			slice = _mm_sub_epi32(slice, _mm_castps_si128(mask));
+		}
+
+		return slice;
+	};
+
+	alignas(16) int32_t result[6][4];
+	alignas(16) int32_t visible_mask[4];
+
+	_mm_store_si128((__m128i*)result[0], to_tile(min_x, LightClusters::GridX));
+	_mm_store_si128((__m128i*)result[1], to_tile(max_x, LightClusters::GridX));
+	_mm_store_si128((__m128i*)result[2], to_tile(min_y, LightClusters::GridY));
+	_mm_store_si128((__m128i*)result[3], to_tile(max_y, LightClusters::GridY));
+	_mm_store_si128((__m128i*)result[4], to_slice(min_depth));
+	_mm_store_si128((__m128i*)result[5], to_slice(max_depth));
+	_mm_store_si128((__m128i*)visible_mask, _mm_castps_si128(visible));
+
+	for (uint32_t i = 0; i < 4; i++)
+	{
+		auto& bounds = clusters.bounds[index + i];
+		bounds.min_x = (uint8_t)result[0][i];
+		bounds.max_x = (uint8_t)result[1][i];
+		bounds.min_y = (uint8_t)result[2][i];
+		bounds.max_y = (uint8_t)result[3][i];
+		bounds.min_z = (uint8_t)result[4][i];
+		bounds.max_z = (uint8_t)result[5][i];
+		bounds.visible = visible_mask[i] != 0;
+	}
+}
+#endif
+
+static void ComputeLightBounds(LightClusters& clusters, const BoundsParams& params,
+	std::span<const LightSphere> lights, uint32_t begin, uint32_t end)
+{
+	auto i = begin;
+
+#ifdef LIGHT_CLUSTERS_SSE2
+	for (; i + 4 <= end; i += 4)
+	{
+		ComputeLightBounds4(clusters, params, &lights[i], i);
+	}
+#endif
+
+	for (; i < end; i++)
+	{
+		ComputeLightBoundsScalar(clusters, params, lights[i], i);
+	}
+}
+
+static void AssignSlice(LightClusters& clusters, uint32_t z)
+{
+	constexpr auto SliceSize = LightClusters::GridX * LightClusters::GridY;
+
+	auto& slice_lights = clusters.slice_lights[z];
+	slice_lights.clear();
+
+	for (uint32_t i = 0; i < (uint32_t)clusters.bounds.size(); i++)
+	{
+		const auto& bounds = clusters.bounds[i];
+
+		if (bounds.visible && bounds.min_z <= z && z <= bounds.max_z)
+			slice_lights.push_back(i);
+	}
+
+	std::array<uint32_t, SliceSize> counts = {};
+
+	for (auto index : slice_lights)
+	{
+		const auto& bounds = clusters.bounds[index];
+
+		for (uint32_t y = bounds.min_y; y <= bounds.max_y; y++)
+		{
+			for (uint32_t x = bounds.min_x; x <= bounds.max_x; x++)
+			{
+				counts[y * LightClusters::GridX + x] += 1;
+			}
+		}
+	}
+
+	auto first_cluster = LightClusters::GetClusterIndex(0, 0, z);
+
+	std::array<uint32_t, SliceSize> cursors;
+	uint32_t total = 0;
+
+	for (uint32_t i = 0; i < SliceSize; i++)
+	{
+		auto& cluster = clusters.clusters[first_cluster + i];
+		cluster.offset = total; // local to this slice until merged
+		cluster.count = counts[i];
+		cursors[i] = total;
+		total += counts[i];
+	}
+
+	auto& slice_indices = clusters.slice_indices[z];
+	slice_indices.resize(total);
+
+	for (auto index : slice_lights)
+	{
+		const auto& bounds = clusters.bounds[index];
+
+		for (uint32_t y = bounds.min_y; y <= bounds.max_y; y++)
+		{
+			for (uint32_t x = bounds.min_x; x <= bounds.max_x; x++)
+			{
+				slice_indices[cursors[y * LightClusters::GridX + x]++] = index;
+			}
+		}
+	}
+}
+
+void AssignLightsToClusters(LightClusters& clusters, const CameraMatrices& camera,
+	std::span<const LightSphere> lights, JobSystem& jobs)
+{
+	PROFILE_ZONE("assign light clusters");
+
+	auto light_count = (uint32_t)lights.size();
+
+	clusters.clusters.resize(LightClusters::ClusterCount);
+	clusters.bounds.resize(light_count);
+
+	for (uint32_t i = 0; i <= LightClusters::GridZ; i++)
+	{
+		clusters.slice_depths[i] = camera.near_plane * glm::pow(camera.far_plane / camera.near_plane,
+			(float)i / (float)LightClusters::GridZ);
+	}
+
+	auto view = glm::transpose(camera.view);
+
+	auto params = BoundsParams{
+		.view_x = view[0],
+		.view_y = view[1],
+		.view_z = view[2],
+		.proj_x = camera.projection[0][0],
+		.proj_y = camera.projection[1][1],
+		.near_plane = camera.near_plane,
+		.far_plane = camera.far_plane
+	};
+
+	auto chunks = (light_count + LightsPerChunk - 1) / LightsPerChunk;
+
+	jobs.parallelFor(chunks, 1, [&](uint32_t chunk) {
+		auto begin = chunk * LightsPerChunk;
+		auto end = std::min(begin + LightsPerChunk, light_count);
+		ComputeLightBounds(clusters, params, lights, begin, end);
+	});
+
+	jobs.parallelFor(LightClusters::GridZ, 1, [&](uint32_t z) {
+		AssignSlice(clusters, z);
+	});
+
+	uint32_t total = 0;
+
+	for (uint32_t z = 0; z < LightClusters::GridZ; z++)
+	{
+		auto first_cluster = LightClusters::GetClusterIndex(0, 0, z);
+
+		for (uint32_t i = 0; i < LightClusters::GridX * LightClusters::GridY; i++)
+		{
+			clusters.clusters[first_cluster + i].offset += total;
+		}
+
+		total += (uint32_t)clusters.slice_indices[z].size();
+	}
+
+	clusters.light_indices.resize(total);
+	clusters.max_lights_per_cluster = 0;
+
+	for (uint32_t z = 0; z < LightClusters::GridZ; z++)
+	{
+		const auto& slice_indices = clusters.slice_indices[z];
+
+		if (slice_indices.empty())
+			continue;
+
+		auto first_cluster = LightClusters::GetClusterIndex(0, 0, z);
+		auto offset = clusters.clusters[first_cluster].offset;
+		std::copy(slice_indices.begin(), slice_indices.end(), clusters.light_indices.begin() + offset);
+	}
+
+	for (const auto& cluster : clusters.clusters)
+	{
+		clusters.max_lights_per_cluster = std::max(clusters.max_lights_per_cluster, cluster.count);
+	}
+
+	clusters.visible_lights.clear();
+
+	for (uint32_t i = 0; i < light_count; i++)
+	{
+		if (clusters.bounds[i].visible)
+			clusters.visible_lights.push_back(i);
+	}
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <array>
+#include <span>
+#include <vector>
+#include "camera.h"
+#include "job_system.h"
+
+// Froxel grid built from the camera projection: GridX * GridY screen tiles,
+// GridZ exponential depth slices between the near and far planes.
+// Every point light is assigned to each cluster its bounding sphere overlaps.
+
+struct LightSphere
+{
+	glm::vec3 position;
+	float radius;
+};
+
+struct LightClusters
+{
+	static constexpr uint32_t GridX = 16;
+	static constexpr uint32_t GridY = 9;
+	static constexpr uint32_t GridZ = 24;
+	static constexpr uint32_t ClusterCount = GridX * GridY * GridZ;
+
+	struct Cluster
+	{
+		uint32_t offset = 0;
+		uint32_t count = 0;
+	};
+
+	struct LightBounds
+	{
+		uint8_t min_x;
+		uint8_t max_x;
+		uint8_t min_y;
+		uint8_t max_y;
+		uint8_t min_z;
+		uint8_t max_z;
+		bool visible;
+	};
+
+	std::vector<Cluster> clusters; // x fastest, then y, then z
+	std::vector<uint32_t> light_indices; // compact per-cluster lists
+	std::vector<uint32_t> visible_lights; // lights referenced by at least one cluster
+	uint32_t max_lights_per_cluster = 0;
+
+	// scratch, kept between frames to avoid reallocations
+	std::vector<LightBounds> bounds;
+	std::array<float, GridZ + 1> slice_depths;
+	std::array<std::vector<uint32_t>, GridZ> slice_lights;
+	std::array<std::vector<uint32_t>, GridZ> slice_indices;
+
+	static uint32_t GetClusterIndex(uint32_t x, uint32_t y, uint32_t z);
+};
+
+void AssignLightsToClusters(LightClusters& clusters, const CameraMatrices& camera,
+	std::span<const LightSphere> lights, JobSystem& jobs);
@@ -0,0 +1,124 @@
+#include "light_culling.h"
+#include "profiler.h"
+#include <algorithm>
+#include <limits>
+
+float GetLightIntensity(const skygfx::utils::PointLight& light)
+{
+	auto max_component = [](const glm::vec3& value) {
+		return glm::max(value.x, glm::max(value.y, value.z));
+	};
+
+	return glm::max(max_component(light.diffuse), max_component(light.specular));
+}
+
+float GetLightRadius(const skygfx::utils::PointLight& light, float cutoff)
+{
+	// solve intensity / (c + l * d + q * d^2) = cutoff for d
+
+	auto c = light.constant_attenuation - (GetLightIntensity(light) / cutoff);
+	auto l = light.linear_attenuation;
+	auto q = light.quadratic_attenuation;
+
+	if (c >= 0.0f)
+		return 0.0f;
+
+	if (q > 0.0f)
+		return (-l + glm::sqrt((l * l) - (4.0f * q * c))) / (2.0f * q);
+
+	if (l > 0.0f)
+		return -c / l;
+
+	return std::numeric_limits<float>::max();
+}
+
+static float GetAttenuation(const skygfx::utils::PointLight& light, float distance)
+{
+	auto denominator = light.constant_attenuation + (light.linear_attenuation * distance) +
+		(light.quadratic_attenuation * distance * distance);
+
+	if (denominator <= 0.0f)
+		return 1.0f;
+
+	return glm::min(1.0f / denominator, 1.0f);
+}
+
+void BuildDrawLights(DrawLights& draw_lights, std::span<const uint32_t> draws,
+	std::span<const DrawBounds> bounds, std::span<const skygfx::utils::PointLight> lights,
+	std::span<const LightSphere> spheres, std::span<const uint32_t> candidate_lights,
+	uint32_t max_lights_per_draw)
+{
+	PROFILE_ZONE("build draw lights");
+
+	draw_lights.draws.resize(draws.size());
+	draw_lights.light_indices.clear();
+	draw_lights.scene_lights.clear();
+	draw_lights.max_lights_per_draw = 0;
+	draw_lights.light_rank.assign(lights.size(), std::numeric_limits<uint32_t>::max());
+	draw_lights.light_score.assign(lights.size(), 0.0f);
+
+	for (size_t i = 0; i < draws.size(); i++)
+	{
+		const auto& draw_bounds = bounds[draws[i]];
+
+		draw_lights.candidates.clear();
+
+		for (auto light_index : candidate_lights)
+		{
+			const auto& sphere = spheres[light_index];
+			auto closest = glm::clamp(sphere.position, draw_bounds.min, draw_bounds.max);
+			auto distance = glm::distance(sphere.position, closest);
+
+			if (distance > sphere.radius)
+				continue;
+
+			const auto& light = lights[light_index];
+			auto score = GetLightIntensity(light) * GetAttenuation(light, distance);
+			draw_lights.candidates.push_back({ score, light_index });
+		}
+
+		auto count = std::min((uint32_t)draw_lights.candidates.size(), max_lights_per_draw);
+
+		std::partial_sort(draw_lights.candidates.begin(), draw_lights.candidates.begin() + count,
+			draw_lights.candidates.end(), [](const auto& left, const auto& right) {
+				return left.first > right.first;
+			});
+
+		auto& range = draw_lights.draws[i];
+		range.offset = (uint32_t)draw_lights.light_indices.size();
+		range.count = count;
+
+		for (uint32_t j = 0; j < count; j++)
+		{
+			auto [score, light_index] = draw_lights.candidates[j];
+			draw_lights.light_indices.push_back(light_index);
+
+			auto& rank = draw_lights.light_rank[light_index];
+			rank = std::min(rank, j);
+			draw_lights.light_score[light_index] = std::max(draw_lights.light_score[light_index], score);
+		}
+
+		draw_lights.max_lights_per_draw = std::max(draw_lights.max_lights_per_draw, count);
+	}
+
+	for (uint32_t i = 0; i < (uint32_t)lights.size(); i++)
+	{
+		if (draw_lights.light_rank[i] != std::numeric_limits<uint32_t>::max())
+			draw_lights.scene_lights.push_back(i);
+	}
+
+	// every draw's strongest light before any draw's second one and so on
+
+	std::sort(draw_lights.scene_lights.begin(), draw_lights.scene_lights.end(), [&](uint32_t left, uint32_t right) {
+		const auto& rank = draw_lights.light_rank;
+		const auto& score = draw_lights.light_score;
+
+		if (rank[left] != rank[right])
+			return rank[left] < rank[right];
+
+		if (score[left] != score[right])
+			return score[left] > score[right];
+
+		return left < right;
+	});
+}
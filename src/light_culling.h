@@ -0,0 +1,45 @@
+#pragma once
+
+#include <span>
+#include <vector>
+#include "light_clusters.h"
+#include "visibility.h"
+
+// Point light ranges derived from attenuation, and per-draw lists of the
+// most relevant lights. DrawScene takes one light list for all draws, so the
+// per-draw lists are not submitted. They only rank the union handed to
+// forward shading and feed the stats. Forward shading cost still grows with
+// the union, not with the lights of each draw.
+
+constexpr float DefaultLightCutoff = 1.0f / 256.0f;
+
+float GetLightIntensity(const skygfx::utils::PointLight& light);
+
+// distance where the attenuated intensity drops below cutoff
+float GetLightRadius(const skygfx::utils::PointLight& light, float cutoff);
+
+struct DrawLights
+{
+	struct Range
+	{
+		uint32_t offset = 0;
+		uint32_t count = 0;
+	};
+
+	std::vector<Range> draws; // per entry of the draws list
+	std::vector<uint32_t> light_indices;
+	// union of all draw lists, lights that some draw ranks higher come first,
+	// so cutting it off drops the least relevant lights
+	std::vector<uint32_t> scene_lights;
+	uint32_t max_lights_per_draw = 0;
+
+	// scratch, kept between frames to avoid reallocations
+	std::vector<std::pair<float, uint32_t>> candidates;
+	std::vector<uint32_t> light_rank; // best position in any draw list
+	std::vector<float> light_score; // best score in any draw list
+};
+
+void BuildDrawLights(DrawLights& draw_lights, std::span<const uint32_t> draws,
+	std::span<const DrawBounds> bounds, std::span<const skygfx::utils::PointLight> lights,
+	std::span<const LightSphere> spheres, std::span<const uint32_t> candidate_lights,
+	uint32_t max_lights_per_draw);
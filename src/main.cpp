@@ -1,4 +1,6 @@
 #include <iostream>
+#include <chrono>
+#include <algorithm>
 #include <unordered_map>
 #include <tiny_gltf.h>
 #include <imgui.h>
@@ -6,6 +8,20 @@
 #include "../lib/skygfx/examples/utils/utils.h"
 #include "../lib/skygfx/examples/utils/imgui_helper.h"
 #include <imgui_impl_glfw.h>
+#include "texture_packer.h"
+#include "render_buffer.h"
+#include "scene_loader.h"
+#include "camera.h"
+#include "camera_path.h"
+#include "light_clusters.h"
+#include "frame.h"
+#include "frame_pipeline.h"
+#include "frame_timer.h"
+#include "profiler.h"
+#include "job_system.h"
+#include "benchmark.h"
+#include "debug_lines.h"
+#include "allocation_counter.h"
 
 static double cursor_saved_pos_x = 0.0;
 static double cursor_saved_pos_y = 0.0;
@@ -59,194 +75,105 @@ void KeyCallback(GLFWwindow* window, int key, int scancode, int action, int mods
 	}
 }
 
-struct Material
-{
-	std::shared_ptr<skygfx::Texture> color_texture;
-	std::shared_ptr<skygfx::Texture> normal_texture;
-	std::shared_ptr<skygfx::Texture> metallic_roughness_texture;
-	glm::vec4 color;
-};
+using DrawOrder = std::vector<std::pair<const Material*, const RenderBuffer::DrawData*>>;
 
-struct RenderBuffer
+DrawOrder GetDrawOrder(const RenderBuffer& render_buffer, bool sort_by_texture_pages)
 {
-	struct DrawData
-	{
-		skygfx::utils::Mesh::Vertices vertices; // for normals debug
-		skygfx::utils::Mesh::Indices indices; // for normals debug
-		skygfx::Topology topology;
-		skygfx::utils::Mesh mesh;
-		skygfx::utils::commands::DrawMesh::DrawCommand draw_command;
-	};
-
-	std::unordered_map<std::shared_ptr<Material>, std::vector<DrawData>> meshes;
-};
-
-RenderBuffer BuildRenderBuffer(const tinygltf::Model& model)
-{
-	// https://github.com/syoyo/tinygltf/blob/master/examples/glview/glview.cc
-	// https://github.com/syoyo/tinygltf/blob/master/examples/basic/main.cpp
-
-	RenderBuffer result;
+	DrawOrder result;
 
-	const auto& scene = model.scenes.at(0);
-
-	std::unordered_map<int, std::shared_ptr<skygfx::Texture>> textures_cache;
-
-	auto get_or_create_texture = [&](int index) -> std::shared_ptr<skygfx::Texture> {
-		if (index == -1)
-			return nullptr;
-
-		if (!textures_cache.contains(index))
-		{
-			const auto& texture = model.textures.at(index);
-			const auto& image = model.images.at(texture.source);
-			textures_cache[index] = std::make_shared<skygfx::Texture>((uint32_t)image.width,
-				(uint32_t)image.height, skygfx::PixelFormat::RGBA8UNorm, (void*)image.image.data(), true);
-		}
-
-		return textures_cache.at(index);
-	};
-
-	for (auto node_index : scene.nodes)
+	for (const auto& [material, draw_datas] : render_buffer.meshes)
 	{
-		const auto& node = model.nodes.at(node_index);
-
-		auto mesh_index = node.mesh;
-
-		const auto& mesh = model.meshes.at(mesh_index);
-
-		for (const auto& primitive : mesh.primitives)
+		for (const auto& draw_data : draw_datas)
 		{
-			static const std::unordered_map<int, skygfx::Topology> ModesMap = {
-				{ TINYGLTF_MODE_POINTS, skygfx::Topology::PointList },
-				{ TINYGLTF_MODE_LINE, skygfx::Topology::LineList },
-			//	{ TINYGLTF_MODE_LINE_LOOP, skygfx::Topology:: },
-				{ TINYGLTF_MODE_LINE_STRIP, skygfx::Topology::LineStrip },
-				{ TINYGLTF_MODE_TRIANGLES, skygfx::Topology::TriangleList },
-				{ TINYGLTF_MODE_TRIANGLE_STRIP, skygfx::Topology::TriangleStrip },
-			//	{ TINYGLTF_MODE_TRIANGLE_FAN, skygfx::Topology:: } 
-			};
-
-			auto topology = ModesMap.at(primitive.mode);
-
-			const static std::unordered_map<int, int> IndexStride = {
-				{ TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT, 2 },
-				{ TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT, 4 },
-			};
-
-			/* buffer_view.target is:
-				TINYGLTF_TARGET_ARRAY_BUFFER,
-				TINYGLTF_TARGET_ELEMENT_ARRAY_BUFFER
-			*/
-
-			const auto& index_buffer_accessor = model.accessors.at(primitive.indices);
-			const auto& index_buffer_view = model.bufferViews.at(index_buffer_accessor.bufferView);
-			const auto& index_buffer = model.buffers.at(index_buffer_view.buffer);
-
-			auto index_buf_size = index_buffer_view.byteLength;
-			auto index_buf_stride = IndexStride.at(index_buffer_accessor.componentType);
-			auto index_buf_data = (void*)((size_t)index_buffer.data.data() + index_buffer_view.byteOffset);
-
-			auto index_count = index_buffer_accessor.count;
-			auto index_offset = index_buffer_accessor.byteOffset / 2;
+			result.push_back({ material.get(), &draw_data });
+		}
+	}
 
-			const auto& positions_buffer_accessor = model.accessors.at(primitive.attributes.at("POSITION"));
-			const auto& positions_buffer_view = model.bufferViews.at(positions_buffer_accessor.bufferView);
-			const auto& positions_buffer = model.buffers.at(positions_buffer_view.buffer);
+	if (!sort_by_texture_pages)
+		return result;
 
-			const auto& normal_buffer_accessor = model.accessors.at(primitive.attributes.at("NORMAL"));
-			const auto& normal_buffer_view = model.bufferViews.at(normal_buffer_accessor.bufferView);
-			const auto& normal_buffer = model.buffers.at(normal_buffer_view.buffer);
+	// draws that share a page pair can share one binding set when pages are texture arrays,
+	// layers and textures keep draws of the same material together inside a page
 
-			const auto& texcoord_buffer_accessor = model.accessors.at(primitive.attributes.at("TEXCOORD_0"));
-			const auto& texcoord_buffer_view = model.bufferViews.at(texcoord_buffer_accessor.bufferView);
-			const auto& texcoord_buffer = model.buffers.at(texcoord_buffer_view.buffer);
+	auto get_key = [](const Material* material) {
+		return std::make_tuple(material->color_layer.page, material->normal_layer.page,
+			material->color_layer.layer, material->normal_layer.layer,
+			material->color_texture.get(), material->normal_texture.get());
+	};
 
-			if (!primitive.attributes.contains("TANGENT"))
-				continue;
+	std::stable_sort(result.begin(), result.end(), [&](const auto& left, const auto& right) {
+		return get_key(left.first) < get_key(right.first);
+	});
 
-			const auto& tangents_buffer_accessor = model.accessors.at(primitive.attributes.at("TANGENT"));
-			const auto& tangents_buffer_view = model.bufferViews.at(tangents_buffer_accessor.bufferView);
-			const auto& tangents_buffer = model.buffers.at(tangents_buffer_view.buffer);
+	return result;
+}
 
-			//const auto& bitangents_buffer_accessor = model.accessors.at(primitive.attributes.at("BITANGENT"));
-			//const auto& bitangents_buffer_view = model.bufferViews.at(bitangents_buffer_accessor.bufferView);
-			//const auto& bitangents_buffer = model.buffers.at(bitangents_buffer_view.buffer);
+SceneDraws BuildDraws(const RenderBuffer& render_buffer, bool sort_by_texture_pages)
+{
+	SceneDraws result;
 
-			auto positions_ptr = (glm::vec3*)(((size_t)positions_buffer.data.data()) + positions_buffer_view.byteOffset);
-			auto texcoord_ptr = (glm::vec2*)(((size_t)texcoord_buffer.data.data()) + texcoord_buffer_view.byteOffset);
-			auto normal_ptr = (glm::vec3*)(((size_t)normal_buffer.data.data()) + normal_buffer_view.byteOffset);
-			auto tangents_ptr = (glm::vec3*)(((size_t)tangents_buffer.data.data()) + tangents_buffer_view.byteOffset);
-			//auto bitangents_ptr = (glm::vec3*)(((size_t)bitangents_buffer.data.data()) + bitangents_buffer_view.byteOffset);
+	for (const auto& [material, draw_data] : GetDrawOrder(render_buffer, sort_by_texture_pages))
+	{
+		skygfx::utils::Model model;
+		model.mesh = (skygfx::utils::Mesh*)&draw_data->mesh;
+		model.draw_command = draw_data->draw_command;
+		model.color = material->color;
+		model.color_texture = material->color_texture.get();
+		model.normal_texture = material->normal_texture.get();
+		model.cull_mode = skygfx::CullMode::Front;
+		model.texture_address = skygfx::TextureAddress::Wrap;
+		model.depth_mode = skygfx::ComparisonFunc::LessEqual;
+		result.models.push_back(model);
+		result.bounds.push_back(draw_data->bounds);
+	}
 
-			auto indices = skygfx::utils::Mesh::Indices();
+	return result;
+}
 
-			for (int i = 0; i < index_buffer_accessor.count; i++)
-			{
-				uint32_t index;
+TexturePackingReport MakeTexturePackingReport(const TexturePacking& texture_packing, const RenderBuffer& render_buffer)
+{
+	TexturePackingReport result;
 
-				if (index_buf_stride == 2)
-					index = static_cast<uint32_t>(((uint16_t*)index_buf_data)[i]);
-				else
-					index = ((uint32_t*)index_buf_data)[i];
+	result.pages = (int)texture_packing.pages.size();
 
-				indices.push_back(index);
-			}
+	for (const auto& page : texture_packing.pages)
+	{
+		result.images += (int)page.images.size();
+		result.bytes += (size_t)page.width * page.height * 4 * page.images.size();
+	}
 
-			skygfx::utils::Mesh::Vertices vertices;
+	auto count_binds = [](const DrawOrder& draw_order, bool use_pages) {
+		int binds = 0;
+		const Material* prev = nullptr;
 
-			for (int i = 0; i < positions_buffer_accessor.count; i++)
-			{
-				skygfx::utils::Mesh::Vertex vertex;
+		for (const auto& [material, draw_data] : draw_order)
+		{
+			auto same_binding = [&](const auto& texture, const auto& prev_texture, const TextureLayer& layer, const TextureLayer& prev_layer) {
+				if (use_pages && layer.page != -1)
+					return layer.page == prev_layer.page;
 
-				vertex.pos = positions_ptr[i];
-				vertex.normal = normal_ptr[i];
-				vertex.texcoord = texcoord_ptr[i];
-				vertex.color = { 1.0f, 1.0f, 1.0f, 1.0f }; // TODO: colors_ptr[i]
-				vertex.tangent = tangents_ptr[i];
-				//vertex.bitangent = bitangents_ptr[i];
+				return texture == prev_texture;
+			};
 
-				vertices.push_back(vertex);
-			}
+			if (prev == nullptr || !same_binding(material->color_texture, prev->color_texture, material->color_layer, prev->color_layer))
+				binds += 1;
 
-			auto mesh = skygfx::utils::Mesh();
-			mesh.setIndices(indices);
-			mesh.setVertices(vertices);
+			if (prev == nullptr || !same_binding(material->normal_texture, prev->normal_texture, material->normal_layer, prev->normal_layer))
+				binds += 1;
 
-			auto draw_command = skygfx::utils::commands::DrawMesh::DrawIndexedVerticesCommand{
-				.index_count = (uint32_t)index_count,
-				.index_offset = (uint32_t)index_offset
-			};
+			prev = material;
+		}
 
-			const auto& material = model.materials.at(primitive.material);
-			const auto& baseColorTexture = material.pbrMetallicRoughness.baseColorTexture;
-			const auto& metallicRoughnessTexture = material.pbrMetallicRoughness.metallicRoughnessTexture;
-			const auto& baseColorFactor = material.pbrMetallicRoughness.baseColorFactor;
-			const auto& occlusionTexture = material.occlusionTexture;
-
-			auto _material = std::make_shared<Material>();
-			_material->color_texture = get_or_create_texture(baseColorTexture.index);
-			_material->normal_texture = get_or_create_texture(material.normalTexture.index);
-			_material->metallic_roughness_texture = get_or_create_texture(metallicRoughnessTexture.index);
-			_material->color = {
-				baseColorFactor.at(0),
-				baseColorFactor.at(1),
-				baseColorFactor.at(2),
-				baseColorFactor.at(3)
-			};
+		return binds;
+	};
 
-			auto draw_data = RenderBuffer::DrawData{
-				.vertices = std::move(vertices),
-				.indices = std::move(indices),
-				.topology = topology,
-				.mesh = std::move(mesh),
-				.draw_command = draw_command
-			};
+	auto unsorted = GetDrawOrder(render_buffer, false);
+	auto sorted = GetDrawOrder(render_buffer, true);
 
-			result.meshes[_material].push_back(std::move(draw_data));
-		}
-		// TODO: dont forget to draw childrens of node
-	}
+	result.draws = (int)unsorted.size();
+	result.texture_binds_unsorted = count_binds(unsorted, false);
+	result.texture_binds_sorted = count_binds(sorted, false);
+	result.page_binds_sorted = count_binds(sorted, true);
 
 	return result;
 }
@@ -334,19 +261,8 @@ void UpdateCamera(GLFWwindow* window, skygfx::utils::PerspectiveCamera& camera)
 	while (camera.yaw < -pi)
 		camera.yaw += pi * 2.0f;
 
-	auto sin_yaw = glm::sin(camera.yaw);
-	auto sin_pitch = glm::sin(camera.pitch);
-
-	auto cos_yaw = glm::cos(camera.yaw);
-	auto cos_pitch = glm::cos(camera.pitch);
-
-	const float fov = 70.0f;
-	const float near_plane = 1.0f;
-	const float far_plane = 8192.0f;
-	const glm::vec3 world_up = { 0.0f, 1.0f, 0.0f };
-
-	auto front = glm::normalize(glm::vec3(cos_yaw * cos_pitch, sin_pitch, sin_yaw * cos_pitch));
-	auto right = glm::normalize(glm::cross(front, world_up));
+	auto front = GetCameraFront(camera);
+	auto right = glm::normalize(glm::cross(front, CameraWorldUp));
 	//auto up = glm::normalize(glm::cross(right, front));
 
 	if (glm::length(direction) > 0.0f)
@@ -357,40 +273,118 @@ void UpdateCamera(GLFWwindow* window, skygfx::utils::PerspectiveCamera& camera)
 }
 
 template<typename T>
-std::string GetPosteffectName()
+const char* GetPosteffectName()
 {
 	static_assert(sizeof(T) == -1, "GetPosteffectName<T> must be specialized for T");
 	return "";
 }
 
 template<>
-std::string GetPosteffectName<skygfx::utils::DrawSceneOptions::GrayscalePosteffect>() { return "Grayscale"; }
+const char* GetPosteffectName<skygfx::utils::DrawSceneOptions::GrayscalePosteffect>() { return "Grayscale"; }
 
 template<>
-std::string GetPosteffectName<skygfx::utils::DrawSceneOptions::BloomPosteffect>() { return "Bloom"; }
+const char* GetPosteffectName<skygfx::utils::DrawSceneOptions::BloomPosteffect>() { return "Bloom"; }
 
 template<>
-std::string GetPosteffectName<skygfx::utils::DrawSceneOptions::GaussianBlurPosteffect>() { return "Gaussian Blur"; }
+const char* GetPosteffectName<skygfx::utils::DrawSceneOptions::GaussianBlurPosteffect>() { return "Gaussian Blur"; }
 
-void DrawPosteffectOptions(skygfx::utils::DrawSceneOptions::GrayscalePosteffect& effect, int index)
+void DrawPosteffectOptions(skygfx::utils::DrawSceneOptions::GrayscalePosteffect& effect)
 {
-	ImGui::SliderFloat(("Intensity##" + std::to_string(index)).c_str(), &effect.intensity, 0.0f, 1.0f);
+	ImGui::SliderFloat("Intensity", &effect.intensity, 0.0f, 1.0f);
 }
 
-void DrawPosteffectOptions(skygfx::utils::DrawSceneOptions::BloomPosteffect& effect, int index)
+void DrawPosteffectOptions(skygfx::utils::DrawSceneOptions::BloomPosteffect& effect)
 {
-	ImGui::SliderFloat(("Threshold##" + std::to_string(index)).c_str(), &effect.threshold, 0.0f, 1.0f);
-	ImGui::SliderFloat(("Intensity##" + std::to_string(index)).c_str(), &effect.intensity, 0.0f, 10.0f);
+	ImGui::SliderFloat("Threshold", &effect.threshold, 0.0f, 1.0f);
+	ImGui::SliderFloat("Intensity", &effect.intensity, 0.0f, 10.0f);
 }
 
-void DrawPosteffectOptions(skygfx::utils::DrawSceneOptions::GaussianBlurPosteffect& effect, int index)
+void DrawPosteffectOptions(skygfx::utils::DrawSceneOptions::GaussianBlurPosteffect& effect)
 {
 }
 
 static int gDrawcalls = 0;
+static TexturePackingReport gTexturePackingReport;
+static FrameSettings gFrameSettings;
+static FrameStats gFrameStats;
+static SceneLoader::Progress gSceneLoadProgress;
+static bool gSceneLoaded = false;
+static bool gSceneLoadFailed = false;
+static bool gPipelineFrames = false;
+static FramePipelineStats gPipelineStats;
+static double gProfilerZoneOverhead = 0.0;
+static FrameTimer gFrameTimer;
+static CameraPath gCameraPath;
+static bool gCameraPathRecording = false;
+static bool gCameraPathPlaying = false;
+static bool gCameraPathLoop = true;
+static float gCameraPathTime = 0.0f;
+static float gCameraPathSpeed = 1.0f;
+static DebugLineSettings gDebugLineSettings;
+static DebugLineStats gDebugLineStats;
+
+constexpr uint32_t SceneUploadsPerFrame = 8;
+
+uint32_t GetCameraFlags()
+{
+	uint32_t flags = 0;
+
+	if (gFrameSettings.stress_lights)
+		flags |= CameraFlagStressLights;
+
+	if (gTechnique == skygfx::utils::DrawSceneOptions::Technique::ForwardShading)
+		flags |= CameraFlagForwardShading;
+
+	if (gFrameSettings.frustum_culling)
+		flags |= CameraFlagFrustumCulling;
+
+	if (gNormalMapping)
+		flags |= CameraFlagNormalMapping;
+
+	return flags;
+}
+
+void ApplyCameraFlags(uint32_t flags)
+{
+	gFrameSettings.stress_lights = flags & CameraFlagStressLights;
+	gTechnique = (flags & CameraFlagForwardShading) ? skygfx::utils::DrawSceneOptions::Technique::ForwardShading :
+		skygfx::utils::DrawSceneOptions::Technique::DeferredShading;
+	gFrameSettings.frustum_culling = flags & CameraFlagFrustumCulling;
+	gNormalMapping = flags & CameraFlagNormalMapping;
+}
+
+void UpdateCameraPath(skygfx::utils::PerspectiveCamera& camera)
+{
+	static auto before = glfwGetTime();
+	auto now = glfwGetTime();
+	auto dtime = (float)(now - before);
+	before = now;
+
+	if (gCameraPathRecording)
+	{
+		RecordCameraKey(gCameraPath, gCameraPathTime, camera, GetCameraFlags());
+		gCameraPathTime += dtime;
+	}
+	else if (gCameraPathPlaying)
+	{
+		auto duration = gCameraPath.getDuration();
+
+		if (gCameraPathTime > duration)
+		{
+			if (gCameraPathLoop && duration > 0.0f)
+				gCameraPathTime = std::fmod(gCameraPathTime, duration);
+			else
+				gCameraPathPlaying = false;
+		}
+
+		camera = SampleCameraPath(gCameraPath, gCameraPathTime);
+		ApplyCameraFlags(SampleCameraPathFlags(gCameraPath, gCameraPathTime));
+		gCameraPathTime += dtime * gCameraPathSpeed;
+	}
+}
 
 void DrawGui(skygfx::utils::PerspectiveCamera& camera,
-	skygfx::utils::DrawSceneOptions& options, bool& animate_lights, bool& show_normals)
+	skygfx::utils::DrawSceneOptions& options, bool& animate_lights, bool& show_normals, bool& pack_textures)
 {
 	const int ImGuiWindowFlags_Overlay = ImGuiWindowFlags_NoTitleBar |
 		ImGuiWindowFlags_NoResize |
@@ -423,16 +417,152 @@ void DrawGui(skygfx::utils::PerspectiveCamera& camera,
 
 	ImGui::Text("FPS: %d", fps);
 	ImGui::Text("Drawcalls: %d", gDrawcalls);
+
+	const auto& present = gFrameTimer.getPresentPercentiles();
+	const auto& cpu = gFrameTimer.getCpuPercentiles();
+
+	ImGui::Text("Frame p50: %.2f, p95: %.2f, p99: %.2f, max: %.2f ms", present.p50, present.p95, present.p99, present.max);
+	ImGui::Text("CPU p50: %.2f, p95: %.2f, p99: %.2f, max: %.2f ms", cpu.p50, cpu.p95, cpu.p99, cpu.max);
+	ImGui::Text("Hitches: %d, recent: %d, last: %.2f ms", gFrameTimer.getHitchCount(),
+		gFrameTimer.getRecentHitchCount(), gFrameTimer.getLastHitchMs());
+	ImGui::PlotLines("##FrameTimes", gFrameTimer.getPresentTimes().data(), (int)gFrameTimer.getSampleCount(),
+		(int)gFrameTimer.getRingOffset(), "present to present", 0.0f, present.max, ImVec2(0.0f, 60.0f));
+	ImGui::PlotHistogram("##FrameHistogram", gFrameTimer.getHistogram().data(), FrameTimer::HistogramBins, 0,
+		"0 - 50 ms", 0.0f, 3.4e38f, ImVec2(0.0f, 60.0f));
+
+	auto hitch_threshold = gFrameTimer.getHitchThreshold();
+	if (ImGui::SliderFloat("Hitch Threshold", &hitch_threshold, 5.0f, 100.0f, "%.1f ms"))
+		gFrameTimer.setHitchThreshold(hitch_threshold);
+
+	if (ImGui::Button("Export Frame Times"))
+	{
+		auto path = "frame_times.csv";
+
+		if (gFrameTimer.exportCsv(path))
+			std::cout << "frame times saved to " << path << std::endl;
+	}
+
+
+	if (!gSceneLoaded)
+	{
+		const auto& progress = gSceneLoadProgress;
+		auto items = progress.images + progress.primitives;
+		auto total = progress.images_total + progress.primitives_total;
+
+		char label[64];
+		if (gSceneLoadFailed)
+			snprintf(label, sizeof(label), "Loading failed");
+		else
+			snprintf(label, sizeof(label), "Images %d/%d, meshes %d/%d", progress.images, progress.images_total,
+				progress.primitives, progress.primitives_total);
+
+		ImGui::ProgressBar(total > 0 ? (float)items / (float)total : 0.0f, ImVec2(-1.0f, 0.0f), label);
+	}
+
 	ImGui::Separator();
 	ImGui::SliderAngle("Pitch##1", &camera.pitch, -89.0f, 89.0f);
 	ImGui::SliderAngle("Yaw##1", &camera.yaw, -180.0f, 180.0f);
 	ImGui::DragFloat3("Position##1", (float*)&camera.position);
+	ImGui::Text("Camera path: %d keys, %.1f s", (int)gCameraPath.keys.size(), gCameraPath.getDuration());
+
+	if (ImGui::Button(gCameraPathRecording ? "Stop Recording" : "Record"))
+	{
+		gCameraPathRecording = !gCameraPathRecording;
+		gCameraPathPlaying = false;
+
+		if (gCameraPathRecording)
+		{
+			gCameraPath.keys.clear();
+			gCameraPathTime = 0.0f;
+		}
+	}
+
+	ImGui::SameLine();
+
+	if (ImGui::Button(gCameraPathPlaying ? "Stop" : "Play"))
+	{
+		gCameraPathPlaying = !gCameraPathPlaying;
+		gCameraPathRecording = false;
+		gCameraPathTime = 0.0f;
+
+		if (gCameraPath.keys.empty())
+			gCameraPath = CreateDefaultCameraPath();
+	}
+
+	ImGui::SameLine();
+
+	if (ImGui::Button("Save Path") && SaveCameraPath(gCameraPath, "camera_path.bin"))
+		std::cout << "camera path saved to camera_path.bin" << std::endl;
+
+	ImGui::SameLine();
+
+	if (ImGui::Button("Load Path"))
+	{
+		if (auto path = LoadCameraPath("camera_path.bin"); path.has_value())
+			gCameraPath = std::move(path.value());
+		else
+			std::cout << "failed to load camera_path.bin" << std::endl;
+	}
+
+	ImGui::SliderFloat("Playback Speed", &gCameraPathSpeed, 0.1f, 4.0f);
+	ImGui::Checkbox("Loop Playback", &gCameraPathLoop);
 	ImGui::Separator();
 	ImGui::Checkbox("Textures", &options.use_color_textures);
 	ImGui::Checkbox("Normal Mapping", &gNormalMapping);
 	ImGui::SliderFloat("Mipmap bias", &options.mipmap_bias, -8.0f, 8.0f);
 	ImGui::Checkbox("Animate Lights", &animate_lights);
 	ImGui::Checkbox("Show Normals", &show_normals);
+
+	if (show_normals)
+	{
+		ImGui::CheckboxFlags("Normals", &gDebugLineSettings.flags, DebugLineNormals);
+		ImGui::SameLine();
+		ImGui::CheckboxFlags("Tangents", &gDebugLineSettings.flags, DebugLineTangents);
+		ImGui::SameLine();
+		ImGui::CheckboxFlags("Bitangents", &gDebugLineSettings.flags, DebugLineBitangents);
+		ImGui::SliderFloat("Line Length", &gDebugLineSettings.length, 1.0f, 100.0f);
+		ImGui::Checkbox("Screen Density", &gDebugLineSettings.screen_density);
+		ImGui::SliderFloat("Pixels Per Line", &gDebugLineSettings.pixels_per_line, 1.0f, 32.0f);
+
+		if (gDebugLineStats.loading)
+			ImGui::Text("Lines: loading scene geometry...");
+		else if (gDebugLineStats.failed)
+			ImGui::Text("Lines: failed to load scene geometry, toggle Show Normals to retry");
+		else
+			ImGui::Text("Lines: %d from %d vertices, built in %.2f ms", gDebugLineStats.lines,
+				gDebugLineStats.vertices, gDebugLineStats.build_ms);
+	}
+
+	ImGui::Checkbox("Texture Packing", &pack_textures);
+	ImGui::Text("Texture binds: %d", pack_textures ? gTexturePackingReport.texture_binds_sorted :
+		gTexturePackingReport.texture_binds_unsorted);
+
+	// pages are not texture arrays yet, they only order the draws
+	if (pack_textures)
+		ImGui::Text("Projected with pages: %d", gTexturePackingReport.page_binds_sorted);
+
+	ImGui::Separator();
+	ImGui::Checkbox("Stress Lights", &gFrameSettings.stress_lights);
+	ImGui::SliderInt("Max Scene Lights", &gFrameSettings.max_scene_lights, 1, 256);
+	ImGui::Text("Lights: %d, visible: %d", gFrameStats.lights, gFrameStats.visible_lights);
+	ImGui::Text("Max lights per cluster: %d", gFrameStats.max_lights_per_cluster);
+	ImGui::Text("Light assignment: %.3f ms", gFrameStats.assign_ms);
+	ImGui::SliderFloat("Light Cutoff", &gFrameSettings.light_cutoff, 0.001f, 0.1f, "%.4f");
+	ImGui::SliderFloat("Moving Light Range", &gFrameSettings.moving_light_range, 0.0f, 4000.0f, "%.0f");
+	ImGui::SliderInt("Max Lights Per Draw", &gFrameSettings.max_lights_per_draw, 1, 32);
+	ImGui::Checkbox("Frustum Culling", &gFrameSettings.frustum_culling);
+	ImGui::Text("Draws: %d, visible: %d", gFrameStats.draws, gFrameStats.visible_draws);
+	// DrawScene takes one light list, the per-draw lists only rank the union
+	ImGui::Text("Lights per draw: %.2f, max: %d (not submitted)", gFrameStats.visible_draws > 0 ?
+		(float)gFrameStats.draw_light_references / (float)gFrameStats.visible_draws : 0.0f,
+		gFrameStats.max_lights_per_draw);
+	ImGui::Text("Scene lights: %d (shaded by every draw)", gFrameStats.scene_lights);
+	ImGui::Text("Frame arena: %d kb", (int)(gFrameStats.arena_bytes / 1024));
+	ImGui::Checkbox("Pipelined Frames", &gPipelineFrames);
+	ImGui::Text("Frame: %.2f ms, sim: %.2f ms, submit: %.2f ms", gPipelineStats.frame_ms,
+		gPipelineStats.sim_ms, gPipelineStats.submit_ms);
+	ImGui::Text("Sim wait: %.2f ms, latency: %.2f ms, in flight: %d", gPipelineStats.wait_ms,
+		gPipelineStats.latency_ms, gPipelineStats.frames_in_flight);
 	ImGui::Separator();
 	if (ImGui::RadioButton("Forward Shading", options.technique == skygfx::utils::DrawSceneOptions::Technique::ForwardShading))
 		gTechnique = skygfx::utils::DrawSceneOptions::Technique::ForwardShading;
@@ -442,21 +572,23 @@ void DrawGui(skygfx::utils::PerspectiveCamera& camera,
 
 	for (int i = 0; i < options.posteffects.size(); i++)
 	{
+		ImGui::PushID(i);
+
 		std::visit(cases{
 			[&](auto& posteffect) {
 				using T = std::decay_t<decltype(posteffect)>;
-				auto name = GetPosteffectName<T>();
-				ImGui::Text("%s", name.c_str());
-				DrawPosteffectOptions(posteffect, i);
+				ImGui::Text("%s", GetPosteffectName<T>());
+				DrawPosteffectOptions(posteffect);
 			}
 		}, options.posteffects.at(i));
 
 		ImGui::SameLine();
-		if (ImGui::Button(("Remove##" + std::to_string(i)).c_str()))
+		if (ImGui::Button("Remove"))
 		{
 			options.posteffects.erase(options.posteffects.begin() + i);
 		}
 
+		ImGui::PopID();
 		ImGui::Separator();
 	}
 
@@ -471,9 +603,11 @@ void DrawGui(skygfx::utils::PerspectiveCamera& camera,
 		std::visit(cases{
 			[&](auto& posteffect) {
 				using T = std::decay_t<decltype(posteffect)>;
-				auto name = GetPosteffectName<T>();
 
-				if (ImGui::Button(("Add " + name + " Posteffect").c_str()))
+				char label[64];
+				snprintf(label, sizeof(label), "Add %s Posteffect", GetPosteffectName<T>());
+
+				if (ImGui::Button(label))
 					options.posteffects.emplace_back(posteffect);
 			}
 		}, posteffect);
@@ -482,68 +616,159 @@ void DrawGui(skygfx::utils::PerspectiveCamera& camera,
 	ImGui::End();
 }
 
-skygfx::utils::Mesh CreateNormalsDebugMesh(const RenderBuffer& render_buffer)
+void DrawProfiler()
 {
-	skygfx::utils::MeshBuilder mesh_builder;
+	ImGui::Begin("Profiler", nullptr, ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoSavedSettings);
 
-	for (const auto& [material, draw_datas] : render_buffer.meshes)
+	ImGui::Text("Zone overhead: %.1f ns", gProfilerZoneOverhead);
+
+	if (IsProfilerCapturing())
 	{
-		for (const auto& draw_data : draw_datas)
+		if (ImGui::Button("Stop Capture"))
 		{
-			auto draw_vertex = [&](const skygfx::utils::Mesh::Vertex& vertex) {
-				mesh_builder.begin(skygfx::utils::MeshBuilder::Mode::Lines);
-				mesh_builder.vertex({ .pos = vertex.pos, .color = { 0.0f, 1.0f, 0.0f, 1.0f } });
-				mesh_builder.vertex({ .pos = vertex.pos + (vertex.normal * 25.0f), .color = { 0.0f, 1.0f, 0.0f, 1.0f } });
-				mesh_builder.end();
-			};
+			auto path = "trace.json";
 
-			std::visit(cases{
-				[&](const skygfx::utils::commands::DrawMesh::DrawVerticesCommand& draw) {
-					auto vertex_count = draw.vertex_count.value_or((uint32_t)draw_data.vertices.size());
-					auto vertex_offset = draw.vertex_offset;
-
-					for (uint32_t i = vertex_offset; i < vertex_count; i++)
-					{
-						const auto& vertex = draw_data.vertices.at(i);
-						draw_vertex(vertex);
-					}
-				},
-				[&](const skygfx::utils::commands::DrawMesh::DrawIndexedVerticesCommand& draw) {
-					auto index_count = draw.index_count.value_or((uint32_t)draw_data.indices.size());
-					auto index_offset = draw.index_offset;
-
-					for (uint32_t i = index_offset; i < index_count; i++)
-					{
-						auto index = draw_data.indices.at(i);
-						const auto& vertex = draw_data.vertices.at(index);
-						draw_vertex(vertex);
-					}
-				}
-			}, draw_data.draw_command);
+			if (StopProfilerCapture(path))
+				std::cout << "profiler capture saved to " << path << std::endl;
 		}
 	}
+	else if (ImGui::Button("Start Capture"))
+	{
+		StartProfilerCapture();
+	}
 
-	skygfx::utils::Mesh mesh;
-	mesh_builder.setToMesh(mesh);
+	ImGui::SameLine();
 
-	return mesh;
+	if (ImGui::Button("Reset"))
+		ResetProfilerZones();
+
+	if (ImGui::BeginTable("zones", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit))
+	{
+		ImGui::TableSetupColumn("Zone");
+		ImGui::TableSetupColumn("Calls");
+		ImGui::TableSetupColumn("ms");
+		ImGui::TableSetupColumn("Avg ms");
+		ImGui::TableSetupColumn("Max ms");
+		ImGui::TableHeadersRow();
+
+		for (const auto& zone : GetProfilerZones())
+		{
+			ImGui::TableNextRow();
+			ImGui::TableNextColumn();
+			ImGui::TextUnformatted(zone.name);
+			ImGui::TableNextColumn();
+			ImGui::Text("%d", zone.calls);
+			ImGui::TableNextColumn();
+			ImGui::Text("%.3f", zone.ms);
+			ImGui::TableNextColumn();
+			ImGui::Text("%.3f", zone.avg_ms);
+			ImGui::TableNextColumn();
+			ImGui::Text("%.3f", zone.max_ms);
+		}
+
+		ImGui::EndTable();
+	}
+
+	ImGui::End();
 }
 
-void DrawNormals(const skygfx::utils::PerspectiveCamera& camera, const RenderBuffer& render_buffer)
+void DrawMemory()
 {
-	static auto mesh = CreateNormalsDebugMesh(render_buffer);;
+	ImGui::Begin("Memory", nullptr, ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoSavedSettings);
 
-	skygfx::utils::ExecuteCommands({
-		skygfx::utils::commands::SetCamera(camera),
-		skygfx::utils::commands::SetMesh(&mesh),
-		skygfx::utils::commands::DrawMesh{}
-	});
+	if (ImGui::Button("Dump Memory Stats"))
+	{
+		auto path = "memory.json";
+
+		if (DumpMemoryStats(path))
+			std::cout << "memory stats saved to " << path << std::endl;
+	}
+
+	if (ImGui::BeginTable("categories", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit))
+	{
+		ImGui::TableSetupColumn("Category");
+		ImGui::TableSetupColumn("Live mb");
+		ImGui::TableSetupColumn("Peak mb");
+		ImGui::TableSetupColumn("Live allocs");
+		ImGui::TableSetupColumn("Total allocs");
+		ImGui::TableHeadersRow();
+
+		for (size_t i = 0; i < (size_t)MemoryCategory::Count; i++)
+		{
+			auto category = (MemoryCategory)i;
+			auto stats = GetMemoryStats(category);
+
+			ImGui::TableNextRow();
+			ImGui::TableNextColumn();
+			ImGui::TextUnformatted(GetMemoryCategoryName(category));
+			ImGui::TableNextColumn();
+			ImGui::Text("%.2f", (double)stats.live_bytes / (1024.0 * 1024.0));
+			ImGui::TableNextColumn();
+			ImGui::Text("%.2f", (double)stats.peak_bytes / (1024.0 * 1024.0));
+			ImGui::TableNextColumn();
+			ImGui::Text("%lld", (long long)stats.live_allocations);
+			ImGui::TableNextColumn();
+			ImGui::Text("%llu", (unsigned long long)stats.allocations);
+		}
+
+		ImGui::EndTable();
+	}
+
+	ImGui::End();
 }
 
-int main()
+void DrawDebugLines(const skygfx::utils::PerspectiveCamera& camera, const skygfx::utils::Mesh& mesh)
 {
+	static std::vector<skygfx::utils::commands::Command> commands;
+
+	commands.clear();
+	commands.push_back(skygfx::utils::commands::SetCamera(camera));
+	commands.push_back(skygfx::utils::commands::SetMesh(&mesh));
+	commands.push_back(skygfx::utils::commands::DrawMesh{});
+
+	skygfx::utils::ExecuteCommands(commands);
+}
+
+int main(int argc, char* argv[])
+{
+	for (int i = 1; i < argc; i++)
+	{
+		if (std::string(argv[i]) == "--benchmark-light-clusters")
+			return RunLightClustersBenchmark(240);
+
+		if (std::string(argv[i]) == "--check-frame-allocations")
+			return RunFrameAllocationCheck(600);
+
+		if (std::string(argv[i]) == "--check-heap-arena")
+			return RunHeapArenaCheck();
+
+		if (std::string(argv[i]) == "--benchmark-jobs")
+			return RunJobSystemBenchmark(120);
+
+		if (std::string(argv[i]) == "--benchmark-gltf-parse")
+			return RunGltfParseBenchmark(100000);
+
+		if (std::string(argv[i]) == "--benchmark-image-decode")
+			return RunImageDecodeBenchmark(3);
+
+		if (std::string(argv[i]) == "--benchmark-scene")
+			return RunSceneBenchmark(ParseSceneBenchmarkOptions(argc, argv));
+	}
+
 	auto backend_type = utils::ChooseBackendTypeViaConsole();
 
+	// the scene streams in while the window and the device are created,
+	// timings are taken from here
+
+	SetProfilerThreadName("main");
+	gProfilerZoneOverhead = MeasureProfilerOverhead(1000000);
+
+	JobSystem jobs;
+
+	auto load_begin = std::chrono::steady_clock::now();
+	SceneLoader scene_loader("assets/sponza/sponza.glb", jobs);
+	bool first_frame = true;
+
 	glfwInit();
 	glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
 
@@ -558,94 +783,28 @@ int main()
 	glfwSetMouseButtonCallback(window, MouseButtonCallback);
 	glfwSetKeyCallback(window, KeyCallback);
 
-	tinygltf::Model model;
-	tinygltf::TinyGLTF loader;
-	std::string err;
-	std::string warn;
-	auto path = "assets/sponza/sponza.glb";
-
-	bool ret = loader.LoadBinaryFromFile(&model, &err, &warn, path);
+	RenderBuffer render_buffer;
 
 	auto camera = skygfx::utils::PerspectiveCamera();
 
-	auto render_buffer = BuildRenderBuffer(model);
-
-	auto directional_light = skygfx::utils::DirectionalLight();
-	directional_light.ambient = { 0.125f, 0.125f, 0.125f };
-	directional_light.diffuse = { 0.125f, 0.125f, 0.125f };
-	directional_light.specular = { 1.0f, 1.0f, 1.0f };
-	directional_light.shininess = 16.0f;
-	directional_light.direction = { 0.5f, -1.0f, 0.5f };
-
-	auto base_light = skygfx::utils::PointLight();
-	base_light.shininess = 32.0f;
-	base_light.constant_attenuation = 0.0f;
-	base_light.linear_attenuation = 0.00128f;
-	base_light.quadratic_attenuation = 0.0f;
-
-	auto red_light = base_light;
-	red_light.ambient = { 0.0625f, 0.0f, 0.0f };
-	red_light.diffuse = { 0.5f, 0.0f, 0.0f };
-	red_light.specular = { 1.0f, 0.0f, 0.0f };
-
-	auto green_light = base_light;
-	green_light.ambient = { 0.0f, 0.0625f, 0.0f };
-	green_light.diffuse = { 0.0f, 0.5f, 0.0f };
-	green_light.specular = { 0.0f, 1.0f, 0.0f };
-
-	auto blue_light = base_light;
-	blue_light.ambient = { 0.0f, 0.0f, 0.0625f };
-	blue_light.diffuse = { 0.0f, 0.0f, 0.5f };
-	blue_light.specular = { 0.0f, 0.0f, 1.0f };
-
-	auto lightblue_light = base_light;
-	lightblue_light.ambient = { 0.0f, 0.0625f, 0.0625f };
-	lightblue_light.diffuse = { 0.0f, 0.5f, 0.5f };
-	lightblue_light.specular = { 0.0f, 1.0f, 1.0f };
-
-	struct MovingLight
-	{
-		skygfx::utils::PointLight light;
-		glm::vec3 begin;
-		glm::vec3 end;
-		float multiplier = 1.0f;
-	};
+	FrameScene scene;
+	SetupSceneLights(scene);
 
-	std::vector<MovingLight> moving_lights = {
-		// first floor
-		{ red_light, { 1200.0f, 256.0f, -36.0f }, { -1200.0f, 256.0f, -36.0f }, 4.0f },
-		{ green_light, { 1200.0f, 256.0f, -36.0f }, { -1200.0f, 256.0f, -36.0f }, 3.0f },
-		{ blue_light, { 1200.0f, 256.0f, -36.0f }, { -1200.0f, 256.0f, -36.0f }, 2.0f },
-
-		// second floor
-		{ green_light, { 1100.0f, 550.0f, 400.0f }, { 1100.0f, 550.0f, -400.0f }, 1.0f },
-		{ red_light, { -1200.0f, 550.0f, -400.0f }, { -1200.0f, 550.0f, 400.0f }, 2.0f },
-		{ blue_light, { 1100.0f, 550.0f, 400.0f }, { -1200.0f, 550.0f, 400.0f }, 3.0f },
-		{ lightblue_light, { 1100.0f, 550.0f, -400.0f }, { -1200.0f, 550.0f, -400.0f }, 4.0f }
-	};
+	FramePipeline pipeline;
+
+	// imgui allocates with malloc by default, going through operator new puts it into the memory stats
+	ImGui::SetAllocatorFunctions([](size_t size, void* user_data) -> void* {
+		MemoryScope memory_scope(MemoryCategory::Gui);
+		return operator new(size);
+	}, [](void* ptr, void* user_data) {
+		operator delete(ptr);
+	});
 
 	auto imgui = ImguiHelper();
 
 	ImGui_ImplGlfw_InitForOpenGL(window, true);
 
-	std::vector<skygfx::utils::Model> models;
-
-	for (const auto& [material, draw_datas] : render_buffer.meshes)
-	{
-		for (const auto& draw_data: draw_datas)
-		{
-			skygfx::utils::Model model;
-			model.mesh = (skygfx::utils::Mesh*)&draw_data.mesh;
-			model.draw_command = draw_data.draw_command;
-			model.color = material->color;
-			model.color_texture = material->color_texture.get();
-			model.normal_texture = material->normal_texture.get();
-			model.cull_mode = skygfx::CullMode::Front;
-			model.texture_address = skygfx::TextureAddress::Wrap;
-			model.depth_mode = skygfx::ComparisonFunc::LessEqual;
-			models.push_back(model);
-		}
-	}
+	bool pack_textures = true;
 
 	skygfx::utils::DrawSceneOptions options = {
 		.posteffects = {
@@ -657,43 +816,117 @@ int main()
 	bool show_normals = false;
 	float time = 0.0f;
 
+	DebugLines debug_lines;
+
 	StageViewer stage_viewer;
 	skygfx::utils::SetStageViewer(&stage_viewer);
 
 	while (!glfwWindowShouldClose(window))
 	{
+		gFrameTimer.beginFrame();
+
 		ImGui_ImplGlfw_NewFrame();
 
 		ImGui::NewFrame();
 
-		DrawGui(camera, options, animate_lights, show_normals);
+		auto scene_changed = scene_loader.update(render_buffer, SceneUploadsPerFrame);
+
+		if (scene_loader.isFailed() && !gSceneLoadFailed)
+		{
+			gSceneLoadFailed = true;
+			std::cout << "failed to load scene: " << scene_loader.getError() << std::endl;
+		}
+
+		gSceneLoadProgress = scene_loader.getProgress();
+
+		if (scene_changed && scene_loader.isFinished())
+		{
+			gSceneLoaded = true;
+			gTexturePackingReport = MakeTexturePackingReport(scene_loader.getTexturePacking(), render_buffer);
+			PrintTexturePackingReport(scene_loader.getTexturePacking(), gTexturePackingReport);
+
+			auto load_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - load_begin).count();
+			std::cout << "scene loaded in " << load_ms << " ms" << std::endl;
+		}
+
+		auto prev_pack_textures = pack_textures;
+
+		DrawGui(camera, options, animate_lights, show_normals, pack_textures);
+		DrawProfiler();
+		DrawMemory();
+
+		if (scene_changed || pack_textures != prev_pack_textures)
+		{
+			PROFILE_ZONE("build draws");
+			pipeline.invalidate();
+			scene.draws = BuildDraws(render_buffer, pack_textures);
+		}
+
+		if (scene_changed)
+			debug_lines.invalidate();
+
+		pipeline.setEnabled(gPipelineFrames);
+
+		{
+			PROFILE_ZONE("update camera");
+			UpdateCamera(window, camera);
+			UpdateCameraPath(camera);
+		}
 
 		options.technique = gTechnique;
 		options.use_normal_textures = gNormalMapping;
 
-		UpdateCamera(window, camera);
-
 		if (animate_lights)
 			time = (float)glfwGetTime();
 
-		std::vector<skygfx::utils::Light> lights = { directional_light };
+		gFrameSettings.forward_shading = options.technique == skygfx::utils::DrawSceneOptions::Technique::ForwardShading;
+
+		auto camera_matrices = MakeCameraMatrices(camera, skygfx::GetBackbufferWidth(), skygfx::GetBackbufferHeight());
+		auto& packet = pipeline.beginFrame(scene, camera, camera_matrices, time, gFrameSettings, jobs);
+		gFrameStats = packet.state.stats;
 
-		for (auto& moving_light : moving_lights)
 		{
-			moving_light.light.position = glm::lerp(moving_light.begin, moving_light.end, (glm::sin(time / moving_light.multiplier) + 1.0f) * 0.5f);
-			lights.push_back(moving_light.light);
+			PROFILE_ZONE("draw scene");
+			skygfx::utils::DrawScene(nullptr, packet.camera, packet.state.visible_models, packet.state.lights, options);
 		}
 
-		skygfx::utils::DrawScene(nullptr, camera, models, lights, options);
+		if (show_normals && gSceneLoaded)
+		{
+			debug_lines.update(render_buffer, scene_loader.getPath(), camera_matrices, gDebugLineSettings, jobs);
+			gDebugLineStats = debug_lines.getStats();
 
-		if (show_normals)
-			DrawNormals(camera, render_buffer);
+			if (auto mesh = debug_lines.getMesh(); mesh != nullptr)
+				DrawDebugLines(packet.camera, *mesh);
+		}
+		else
+		{
+			debug_lines.release();
+		}
 
 		stage_viewer.show();
 		imgui.draw();
 
-		auto present_result = skygfx::Present();
-		gDrawcalls = present_result.drawcalls;
+		gFrameTimer.beginPresent();
+
+		{
+			PROFILE_ZONE("present");
+			auto present_result = skygfx::Present();
+			gDrawcalls = present_result.drawcalls;
+		}
+
+		gFrameTimer.endFrame();
+
+		pipeline.endFrame();
+		gPipelineStats = pipeline.getStats();
+
+		CollectProfilerFrame();
+
+		if (first_frame)
+		{
+			first_frame = false;
+			auto first_frame_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - load_begin).count();
+			std::cout << "first frame in " << first_frame_ms << " ms" << std::endl;
+		}
 
 		glfwPollEvents();
 	}
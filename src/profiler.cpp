@@ -0,0 +1,272 @@
+#include "profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+struct ProfilerState
+{
+	std::mutex mutex; // guards threads, only taken when a thread registers
+	std::vector<std::unique_ptr<ProfileThread>> threads;
+	std::vector<std::string> thread_names; // by id, kept after a thread exits
+
+	std::chrono::steady_clock::time_point origin_time = std::chrono::steady_clock::now();
+	uint64_t origin_ticks = GetProfilerTicks();
+
+	std::vector<ProfileZoneStats> zones;
+	std::unordered_map<const char*, size_t> zone_indices;
+
+	struct CapturedEvent
+	{
+		const char* name;
+		uint64_t begin;
+		uint64_t end;
+		uint32_t thread;
+	};
+
+	bool capturing = false;
+	std::vector<CapturedEvent> capture;
+};
+
+static ProfilerState& GetProfilerState()
+{
+	static ProfilerState state;
+	return state;
+}
+
+static thread_local ProfileThread* tProfileThread = nullptr;
+static thread_local bool tProfileThreadExited = false;
+
+// job and loader threads come and go, their rings are handed back to
+// CollectProfilerFrame when they exit instead of living until shutdown.
+// Other thread_local destructors may still run zones after this one, so the
+// thread forgets its ring and does not register a new one
+struct ProfileThreadExit
+{
+	~ProfileThreadExit()
+	{
+		if (tProfileThread != nullptr)
+			tProfileThread->exited.store(true, std::memory_order_release);
+
+		tProfileThread = nullptr;
+		tProfileThreadExited = true;
+	}
+};
+
+static thread_local ProfileThreadExit tProfileThreadExit;
+
+ProfileThread* GetProfileThread()
+{
+	if (tProfileThread != nullptr)
+		return tProfileThread;
+
+	if (tProfileThreadExited)
+		return nullptr;
+
+	auto& state = GetProfilerState();
+	std::lock_guard lock(state.mutex);
+
+	auto thread = std::make_unique<ProfileThread>();
+	thread->id = (uint32_t)state.thread_names.size();
+	state.thread_names.push_back("thread " + std::to_string(thread->id));
+	tProfileThread = thread.get();
+	state.threads.push_back(std::move(thread));
+
+	(void)tProfileThreadExit; // constructed on first use, registers its destructor
+
+	return tProfileThread;
+}
+
+void SetProfilerThreadName(const std::string& name)
+{
+	auto thread = GetProfileThread();
+
+	if (thread == nullptr)
+		return;
+
+	auto& state = GetProfilerState();
+	std::lock_guard lock(state.mutex);
+	state.thread_names.at(thread->id) = name;
+}
+
+static double GetTicksPerMicrosecond(const ProfilerState& state)
+{
+#ifdef PROFILER_RDTSC
+	// refined every call, the longer the program runs the better the estimate
+
+	auto elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - state.origin_time).count();
+
+	if (elapsed <= 0.0)
+		return 1.0;
+
+	return (double)(GetProfilerTicks() - state.origin_ticks) / elapsed;
+#else
+	return std::chrono::steady_clock::period::den / (std::chrono::steady_clock::period::num * 1000000.0);
+#endif
+}
+
+void CollectProfilerFrame()
+{
+	auto& state = GetProfilerState();
+	auto ticks_per_ms = GetTicksPerMicrosecond(state) * 1000.0;
+
+	for (auto& zone : state.zones)
+	{
+		zone.calls = 0;
+		zone.ms = 0.0;
+	}
+
+	std::lock_guard lock(state.mutex);
+
+	for (auto& thread : state.threads)
+	{
+		// read before count, an exited thread records nothing after it
+		auto exited = thread->exited.load(std::memory_order_acquire);
+		auto count = thread->count.load(std::memory_order_acquire);
+
+		// events older than one ring were overwritten
+		auto first = std::max(thread->collected, count > ProfileThread::Capacity ? count - ProfileThread::Capacity : 0);
+
+		for (auto i = first; i < count; i++)
+		{
+			const auto& event = thread->events[i & (ProfileThread::Capacity - 1)];
+			auto name = event.name.load(std::memory_order_relaxed);
+			auto begin = event.begin.load(std::memory_order_relaxed);
+			auto end = event.end.load(std::memory_order_relaxed);
+
+			// written over while being read, only possible when a thread
+			// produced a whole ring of zones during this loop
+			if (name == nullptr || end < begin)
+				continue;
+
+			if (!state.zone_indices.contains(name))
+			{
+				state.zone_indices[name] = state.zones.size();
+				state.zones.push_back({ .name = name });
+			}
+
+			auto& zone = state.zones.at(state.zone_indices.at(name));
+			auto ms = (double)(end - begin) / ticks_per_ms;
+			zone.calls += 1;
+			zone.ms += ms;
+			zone.max_ms = std::max(zone.max_ms, ms);
+
+			if (state.capturing)
+				state.capture.push_back({ name, begin, end, thread->id });
+		}
+
+		thread->collected = count;
+
+		if (exited)
+			thread.reset();
+	}
+
+	std::erase(state.threads, nullptr);
+
+	for (auto& zone : state.zones)
+	{
+		zone.avg_ms += (zone.ms - zone.avg_ms) * 0.05;
+	}
+}
+
+const std::vector<ProfileZoneStats>& GetProfilerZones()
+{
+	return GetProfilerState().zones;
+}
+
+void ResetProfilerZones()
+{
+	for (auto& zone : GetProfilerState().zones)
+	{
+		zone.avg_ms = 0.0;
+		zone.max_ms = 0.0;
+	}
+}
+
+void StartProfilerCapture()
+{
+	auto& state = GetProfilerState();
+	state.capture.clear();
+	state.capturing = true;
+}
+
+bool IsProfilerCapturing()
+{
+	return GetProfilerState().capturing;
+}
+
+bool StopProfilerCapture(const std::string& path)
+{
+	auto& state = GetProfilerState();
+	state.capturing = false;
+
+	std::ofstream file(path);
+
+	if (!file)
+		return false;
+
+	auto ticks_per_us = GetTicksPerMicrosecond(state);
+	auto origin = state.capture.empty() ? 0 : state.capture.front().begin;
+
+	for (const auto& event : state.capture)
+	{
+		origin = std::min(origin, event.begin);
+	}
+
+	// https://docs.google.com/document/d/1CvAClvFfyA5R-PhYUmn5OOQtYMH4h6I0nSsKchNAySU
+
+	file << "{\"traceEvents\":[\n";
+
+	bool first = true;
+
+	{
+		std::lock_guard lock(state.mutex);
+
+		for (uint32_t id = 0; id < (uint32_t)state.thread_names.size(); id++)
+		{
+			file << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << id
+				<< ",\"args\":{\"name\":\"" << state.thread_names.at(id) << "\"}}";
+			first = false;
+		}
+	}
+
+	file.precision(3);
+	file << std::fixed;
+
+	for (const auto& event : state.capture)
+	{
+		file << (first ? "" : ",\n") << "{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << event.thread
+			<< ",\"ts\":" << (double)(event.begin - origin) / ticks_per_us
+			<< ",\"dur\":" << (double)(event.end - event.begin) / ticks_per_us << "}";
+		first = false;
+	}
+
+	file << "\n]}\n";
+
+	state.capture.clear();
+	state.capture.shrink_to_fit();
+
+	return (bool)file;
+}
+
+double MeasureProfilerOverhead(uint32_t zones)
+{
+	GetProfileThread();
+
+	auto begin = std::chrono::steady_clock::now();
+
+	for (uint32_t i = 0; i < zones; i++)
+	{
+		PROFILE_ZONE("profiler overhead");
+	}
+
+	auto end = std::chrono::steady_clock::now();
+
+	// the measured zones must not show up in the next frame stats
+	if (auto thread = GetProfileThread(); thread != nullptr)
+		thread->collected = thread->count.load();
+
+	return std::chrono::duration<double, std::nano>(end - begin).count() / zones;
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define PROFILER_RDTSC
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#else
+#include <chrono>
+#endif
+
+// Scoped CPU zones. Every thread writes finished zones into its own ring
+// buffer without locks, the main thread collects them once per frame into
+// per-zone stats and, while a capture runs, into a Chrome trace
+// (chrome://tracing, ui.perfetto.dev). Zone names must be string literals.
+
+#define PROFILER_CONCAT_IMPL(a, b) a##b
+#define PROFILER_CONCAT(a, b) PROFILER_CONCAT_IMPL(a, b)
+#define PROFILE_ZONE(name) ProfileZone PROFILER_CONCAT(profile_zone_, __LINE__)(name)
+
+struct ProfileEvent
+{
+	std::atomic<const char*> name;
+	std::atomic<uint64_t> begin;
+	std::atomic<uint64_t> end;
+};
+
+struct ProfileThread
+{
+	// collected every frame, so this only needs to hold one frame of zones,
+	// 384 kb per thread
+	static constexpr uint64_t Capacity = 1 << 14;
+
+	std::array<ProfileEvent, Capacity> events;
+	std::atomic<uint64_t> count = 0;
+	std::atomic<bool> exited = false; // freed by the next collect
+	uint64_t collected = 0; // main thread only
+	uint32_t id = 0;
+};
+
+struct ProfileZoneStats
+{
+	const char* name = nullptr;
+	uint32_t calls = 0; // last frame
+	double ms = 0.0; // last frame, summed over threads
+	double avg_ms = 0.0; // smoothed
+	double max_ms = 0.0; // longest single call since reset
+};
+
+inline uint64_t GetProfilerTicks()
+{
+#ifdef PROFILER_RDTSC
+	return __rdtsc();
+#else
+	return (uint64_t)std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+}
+
+// nullptr once the thread's ring was handed back, zones recorded by later
+// thread_local destructors are dropped
+ProfileThread* GetProfileThread();
+
+class ProfileZone
+{
+public:
+	ProfileZone(const char* name) : mName(name), mBegin(GetProfilerTicks()) { }
+
+	~ProfileZone()
+	{
+		auto end = GetProfilerTicks();
+		auto thread = GetProfileThread();
+
+		if (thread == nullptr)
+			return;
+
+		auto index = thread->count.load(std::memory_order_relaxed);
+		auto& event = thread->events[index & (ProfileThread::Capacity - 1)];
+		event.name.store(mName, std::memory_order_relaxed);
+		event.begin.store(mBegin, std::memory_order_relaxed);
+		event.end.store(end, std::memory_order_relaxed);
+		thread->count.store(index + 1, std::memory_order_release);
+	}
+
+	ProfileZone(const ProfileZone&) = delete;
+	ProfileZone& operator=(const ProfileZone&) = delete;
+
+private:
+	const char* mName;
+	uint64_t mBegin;
+};
+
+void SetProfilerThreadName(const std::string& name);
+
+// main thread, once per frame
+void CollectProfilerFrame();
+const std::vector<ProfileZoneStats>& GetProfilerZones();
+void ResetProfilerZones();
+
+void StartProfilerCapture();
+bool IsProfilerCapturing();
+bool StopProfilerCapture(const std::string& path);
+
+// average cost of one zone in nanoseconds, measured on the calling thread
+double MeasureProfilerOverhead(uint32_t zones);
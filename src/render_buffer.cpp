@@ -0,0 +1,195 @@
+#include "render_buffer.h"
+#include "allocation_counter.h"
+#include "profiler.h"
+
+PrimitiveData ConvertPrimitive(const tinygltf::Model& model, const tinygltf::Primitive& primitive)
+{
+	static const std::unordered_map<int, skygfx::Topology> ModesMap = {
+		{ TINYGLTF_MODE_POINTS, skygfx::Topology::PointList },
+		{ TINYGLTF_MODE_LINE, skygfx::Topology::LineList },
+	//	{ TINYGLTF_MODE_LINE_LOOP, skygfx::Topology:: },
+		{ TINYGLTF_MODE_LINE_STRIP, skygfx::Topology::LineStrip },
+		{ TINYGLTF_MODE_TRIANGLES, skygfx::Topology::TriangleList },
+		{ TINYGLTF_MODE_TRIANGLE_STRIP, skygfx::Topology::TriangleStrip },
+	//	{ TINYGLTF_MODE_TRIANGLE_FAN, skygfx::Topology:: } 
+	};
+
+	const static std::unordered_map<int, int> IndexStride = {
+		{ TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT, 2 },
+		{ TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT, 4 },
+	};
+
+	PrimitiveData result;
+
+	if (!primitive.attributes.contains("TANGENT"))
+		return result;
+
+	auto topology = ModesMap.at(primitive.mode);
+
+	/* buffer_view.target is:
+		TINYGLTF_TARGET_ARRAY_BUFFER,
+		TINYGLTF_TARGET_ELEMENT_ARRAY_BUFFER
+	*/
+
+	const auto& index_buffer_accessor = model.accessors.at(primitive.indices);
+	const auto& index_buffer_view = model.bufferViews.at(index_buffer_accessor.bufferView);
+	const auto& index_buffer = model.buffers.at(index_buffer_view.buffer);
+
+	auto index_buf_stride = IndexStride.at(index_buffer_accessor.componentType);
+	auto index_buf_data = (void*)((size_t)index_buffer.data.data() + index_buffer_view.byteOffset);
+
+	auto index_count = index_buffer_accessor.count;
+	auto index_offset = index_buffer_accessor.byteOffset / 2;
+
+	const auto& positions_buffer_accessor = model.accessors.at(primitive.attributes.at("POSITION"));
+	const auto& positions_buffer_view = model.bufferViews.at(positions_buffer_accessor.bufferView);
+	const auto& positions_buffer = model.buffers.at(positions_buffer_view.buffer);
+
+	const auto& normal_buffer_accessor = model.accessors.at(primitive.attributes.at("NORMAL"));
+	const auto& normal_buffer_view = model.bufferViews.at(normal_buffer_accessor.bufferView);
+	const auto& normal_buffer = model.buffers.at(normal_buffer_view.buffer);
+
+	const auto& texcoord_buffer_accessor = model.accessors.at(primitive.attributes.at("TEXCOORD_0"));
+	const auto& texcoord_buffer_view = model.bufferViews.at(texcoord_buffer_accessor.bufferView);
+	const auto& texcoord_buffer = model.buffers.at(texcoord_buffer_view.buffer);
+
+	const auto& tangents_buffer_accessor = model.accessors.at(primitive.attributes.at("TANGENT"));
+	const auto& tangents_buffer_view = model.bufferViews.at(tangents_buffer_accessor.bufferView);
+	const auto& tangents_buffer = model.buffers.at(tangents_buffer_view.buffer);
+
+	//const auto& bitangents_buffer_accessor = model.accessors.at(primitive.attributes.at("BITANGENT"));
+	//const auto& bitangents_buffer_view = model.bufferViews.at(bitangents_buffer_accessor.bufferView);
+	//const auto& bitangents_buffer = model.buffers.at(bitangents_buffer_view.buffer);
+
+	auto positions_ptr = (glm::vec3*)(((size_t)positions_buffer.data.data()) + positions_buffer_view.byteOffset);
+	auto texcoord_ptr = (glm::vec2*)(((size_t)texcoord_buffer.data.data()) + texcoord_buffer_view.byteOffset);
+	auto normal_ptr = (glm::vec3*)(((size_t)normal_buffer.data.data()) + normal_buffer_view.byteOffset);
+	auto tangents_ptr = (glm::vec3*)(((size_t)tangents_buffer.data.data()) + tangents_buffer_view.byteOffset);
+	//auto bitangents_ptr = (glm::vec3*)(((size_t)bitangents_buffer.data.data()) + bitangents_buffer_view.byteOffset);
+
+	result.indices.reserve(index_buffer_accessor.count);
+
+	for (size_t i = 0; i < index_buffer_accessor.count; i++)
+	{
+		uint32_t index;
+
+		if (index_buf_stride == 2)
+			index = static_cast<uint32_t>(((uint16_t*)index_buf_data)[i]);
+		else
+			index = ((uint32_t*)index_buf_data)[i];
+
+		result.indices.push_back(index);
+	}
+
+	result.bounds = DrawBounds{
+		.min = glm::vec3(std::numeric_limits<float>::max()),
+		.max = glm::vec3(std::numeric_limits<float>::lowest())
+	};
+
+	result.vertices.reserve(positions_buffer_accessor.count);
+
+	for (size_t i = 0; i < positions_buffer_accessor.count; i++)
+	{
+		result.bounds.min = glm::min(result.bounds.min, positions_ptr[i]);
+		result.bounds.max = glm::max(result.bounds.max, positions_ptr[i]);
+
+		skygfx::utils::Mesh::Vertex vertex;
+
+		vertex.pos = positions_ptr[i];
+		vertex.normal = normal_ptr[i];
+		vertex.texcoord = texcoord_ptr[i];
+		vertex.color = { 1.0f, 1.0f, 1.0f, 1.0f }; // TODO: colors_ptr[i]
+		vertex.tangent = tangents_ptr[i];
+		//vertex.bitangent = bitangents_ptr[i];
+
+		result.vertices.push_back(vertex);
+	}
+
+	result.valid = true;
+	result.material = primitive.material;
+	result.topology = topology;
+	result.draw_command = skygfx::utils::commands::DrawMesh::DrawIndexedVerticesCommand{
+		.index_count = (uint32_t)index_count,
+		.index_offset = (uint32_t)index_offset
+	};
+
+	return result;
+}
+
+RenderBuffer::DrawData CreateDrawData(PrimitiveData&& primitive_data)
+{
+	MemoryScope memory_scope(MemoryCategory::GpuUploads);
+
+	auto mesh = skygfx::utils::Mesh();
+	mesh.setIndices(primitive_data.indices);
+	mesh.setVertices(primitive_data.vertices);
+
+	return RenderBuffer::DrawData{
+		.primitive = primitive_data.primitive,
+		.topology = primitive_data.topology,
+		.bounds = primitive_data.bounds,
+		.mesh = std::move(mesh),
+		.draw_command = primitive_data.draw_command
+	};
+}
+
+std::vector<const tinygltf::Primitive*> GetScenePrimitives(const tinygltf::Model& model)
+{
+	std::vector<const tinygltf::Primitive*> result;
+
+	for (auto node_index : model.scenes.at(0).nodes)
+	{
+		const auto& node = model.nodes.at(node_index);
+		const auto& mesh = model.meshes.at(node.mesh);
+
+		for (const auto& primitive : mesh.primitives)
+		{
+			result.push_back(&primitive);
+		}
+		// TODO: dont forget to draw childrens of node
+	}
+
+	return result;
+}
+
+static bool SkipImageData(tinygltf::Image* image, const int image_idx, std::string* err, std::string* warn,
+	int req_width, int req_height, const unsigned char* bytes, int size, void* user_data)
+{
+	return true;
+}
+
+std::optional<std::vector<PrimitiveData>> LoadScenePrimitives(const std::string& path, JobSystem& jobs)
+{
+	PROFILE_ZONE("load scene primitives");
+
+	// declared first, the model and the strings below are made of its blocks
+
+	HeapArena model_arena;
+	tinygltf::Model model;
+	tinygltf::TinyGLTF loader;
+	std::string err;
+	std::string warn;
+
+	loader.SetImageLoader(SkipImageData, nullptr);
+	loader.SetStreamingParser(true);
+
+	bool ok;
+
+	{
+		HeapArenaScope arena_scope(&model_arena);
+		ok = loader.LoadBinaryFromFile(&model, &err, &warn, path);
+	}
+
+	if (!ok || model.scenes.empty())
+		return std::nullopt;
+
+	auto primitives = GetScenePrimitives(model);
+	std::vector<PrimitiveData> result(primitives.size());
+
+	jobs.parallelFor((uint32_t)primitives.size(), 1, [&](uint32_t i) {
+		result[i] = ConvertPrimitive(model, *primitives[i]);
+		result[i].primitive = i;
+	});
+
+	return result;
+}
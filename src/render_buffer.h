@@ -0,0 +1,61 @@
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+#include <tiny_gltf.h>
+#include <skygfx/utils.h>
+#include "job_system.h"
+#include "texture_packer.h"
+#include "visibility.h"
+
+struct Material
+{
+	std::shared_ptr<skygfx::Texture> color_texture;
+	std::shared_ptr<skygfx::Texture> normal_texture;
+	std::shared_ptr<skygfx::Texture> metallic_roughness_texture;
+	TextureLayer color_layer;
+	TextureLayer normal_layer;
+	glm::vec4 color;
+};
+
+struct RenderBuffer
+{
+	struct DrawData
+	{
+		uint32_t primitive; // in scene primitive order, cpu geometry is not kept after upload
+		skygfx::Topology topology;
+		DrawBounds bounds;
+		skygfx::utils::Mesh mesh;
+		skygfx::utils::commands::DrawMesh::DrawCommand draw_command;
+	};
+
+	// materials in order of first use, so iteration does not depend on pointer hashes
+	std::vector<std::pair<std::shared_ptr<Material>, std::vector<DrawData>>> meshes;
+};
+
+struct PrimitiveData
+{
+	bool valid = false;
+	uint32_t primitive = 0;
+	int material;
+	skygfx::utils::Mesh::Vertices vertices;
+	skygfx::utils::Mesh::Indices indices;
+	skygfx::Topology topology;
+	DrawBounds bounds;
+	skygfx::utils::commands::DrawMesh::DrawCommand draw_command;
+};
+
+// reads only from the model, so primitives can be converted from any thread
+PrimitiveData ConvertPrimitive(const tinygltf::Model& model, const tinygltf::Primitive& primitive);
+
+// creates the gpu mesh and drops the cpu copy, main thread only
+RenderBuffer::DrawData CreateDrawData(PrimitiveData&& primitive_data);
+
+// primitives of the first scene in draw order, DrawData::primitive indexes this list
+std::vector<const tinygltf::Primitive*> GetScenePrimitives(const tinygltf::Model& model);
+
+// reads only the geometry of a scene file again, images are skipped,
+// for debug tools that need the cpu data after it was released
+std::optional<std::vector<PrimitiveData>> LoadScenePrimitives(const std::string& path, JobSystem& jobs);
@@ -0,0 +1,308 @@
+#include "scene_loader.h"
+#include "allocation_counter.h"
+#include "profiler.h"
+#include <algorithm>
+#include <iostream>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+SceneLoader::SceneLoader(const std::string& path, JobSystem& jobs) :
+	mPath(path),
+	mJobs(jobs)
+{
+	mThread = std::thread([this, path] {
+		load(path);
+	});
+}
+
+SceneLoader::~SceneLoader()
+{
+	if (mThread.joinable())
+		mThread.join();
+}
+
+bool SceneLoader::OnImageData(tinygltf::Image* image, const int image_idx, std::string* err, std::string* warn,
+	int req_width, int req_height, const unsigned char* bytes, int size, void* user_data)
+{
+	// runs on the loading thread in the middle of parsing, bytes may point
+	// into a temporary data uri buffer, so they are copied
+
+	auto self = static_cast<SceneLoader*>(user_data);
+	MemoryScope memory_scope(MemoryCategory::DecodedImages);
+	HeapArenaScope heap_scope(nullptr); // entries and jobs outlive the model
+
+	auto entry = self->mImages.emplace_back(std::make_unique<ImageEntry>(ImageEntry{
+		.index = image_idx,
+		.req_width = req_width,
+		.req_height = req_height,
+		.bytes = std::vector<unsigned char>(bytes, bytes + size)
+	})).get();
+
+	self->mJobs.schedule([self, entry] {
+		PROFILE_ZONE("decode image");
+		MemoryScope memory_scope(MemoryCategory::DecodedImages);
+
+		std::string err;
+		std::string warn;
+
+		entry->decoded = tinygltf::LoadImageData(&entry->image, entry->index, &err, &warn, entry->req_width,
+			entry->req_height, entry->bytes.data(), (int)entry->bytes.size(), nullptr);
+		entry->bytes = {};
+
+		std::lock_guard lock(self->mReadyMutex);
+		self->mReadyImages.push_back(entry);
+	}, &self->mCounter);
+
+	return true;
+}
+
+void SceneLoader::load(const std::string& path)
+{
+	SetProfilerThreadName("loader");
+	PROFILE_ZONE("load scene");
+
+	tinygltf::TinyGLTF loader;
+	std::string err;
+	std::string warn;
+
+	loader.SetImageLoader(OnImageData, this);
+	loader.SetStreamingParser(true);
+	loader.SetExternalFileThreads(ExternalFileThreads);
+
+#if defined(TINYGLTF_USE_IO_URING)
+	// external files go through io_uring past the page cache when the kernel
+	// allows it, the threads read whatever it cannot take
+	tinygltf::IoUringFileReader file_reader(64, true);
+
+	if (file_reader.IsValid())
+		loader.SetAsyncFsCallbacks(file_reader.GetCallbacks());
+#endif
+
+	bool ok;
+
+	{
+		PROFILE_ZONE("parse gltf");
+		MemoryScope memory_scope(MemoryCategory::GltfJson);
+		HeapArenaScope arena_scope(&mModelArena);
+		ok = loader.LoadBinaryFromFile(&mModel, &err, &warn, path);
+	}
+
+	for (const auto& buffer : mModel.buffers)
+	{
+		SetAllocationCategory(buffer.data.data(), MemoryCategory::GltfBuffers);
+	}
+
+	if (!ok || mModel.scenes.empty())
+	{
+		mJobs.wait(mCounter);
+		mError = err.empty() ? "no scenes in " + path : err;
+		mFailed = true;
+		mDone = true;
+		return;
+	}
+
+	mPrimitives = GetScenePrimitives(mModel);
+	mPrimitiveDatas.resize(mPrimitives.size());
+	mPrimitivesReady = std::make_unique<std::atomic<bool>[]>(mPrimitives.size());
+	mParsed.store(true, std::memory_order_release);
+
+	for (uint32_t i = 0; i < (uint32_t)mPrimitives.size(); i++)
+	{
+		mJobs.schedule([this, i] {
+			PROFILE_ZONE("convert primitive");
+			MemoryScope memory_scope(MemoryCategory::RenderBuffer);
+			mPrimitiveDatas[i] = ConvertPrimitive(mModel, *mPrimitives[i]);
+			mPrimitiveDatas[i].primitive = i;
+			mPrimitivesReady[i].store(true, std::memory_order_release);
+		}, &mCounter);
+	}
+
+	mJobs.wait(mCounter);
+	mDone.store(true, std::memory_order_release);
+}
+
+bool SceneLoader::update(RenderBuffer& render_buffer, uint32_t max_uploads)
+{
+	if (mFinished || !mParsed.load(std::memory_order_acquire))
+		return false;
+
+	PROFILE_ZONE("upload scene");
+	MemoryScope memory_scope(MemoryCategory::RenderBuffer);
+
+	// read before taking the ready list, nothing is added to it after mDone
+	auto done = mDone.load(std::memory_order_acquire);
+
+	{
+		std::lock_guard lock(mReadyMutex);
+		mPendingImages.insert(mPendingImages.end(), mReadyImages.begin(), mReadyImages.end());
+		mReadyImages.clear();
+	}
+
+	mProgress.images_total = (uint32_t)mModel.images.size();
+	mProgress.primitives_total = (uint32_t)mPrimitives.size();
+
+	uint32_t uploads = 0;
+	bool images_changed = false;
+	bool changed = false;
+
+	while (uploads < max_uploads && !mPendingImages.empty())
+	{
+		auto entry = mPendingImages.back();
+		mPendingImages.pop_back();
+		uploadImage(*entry);
+		mProgress.images += 1;
+		uploads += 1;
+		images_changed = true;
+	}
+
+	if (images_changed)
+	{
+		for (auto [material_index, slot] : mMaterialSlots)
+		{
+			updateMaterialTextures(*render_buffer.meshes.at(slot).first, material_index);
+		}
+		changed = true;
+	}
+
+	// primitives are added in scene order, so the draw order does not depend on job timing
+
+	while (uploads < max_uploads && mNextPrimitive < mPrimitives.size() &&
+		mPrimitivesReady[mNextPrimitive].load(std::memory_order_acquire))
+	{
+		auto& primitive_data = mPrimitiveDatas.at(mNextPrimitive);
+		mNextPrimitive += 1;
+		mProgress.primitives += 1;
+
+		if (!primitive_data.valid)
+			continue;
+
+		auto slot = getOrCreateMaterialSlot(render_buffer, primitive_data.material);
+		render_buffer.meshes.at(slot).second.push_back(CreateDrawData(std::move(primitive_data)));
+		uploads += 1;
+		changed = true;
+	}
+
+	if (done && mPendingImages.empty() && mNextPrimitive == mPrimitives.size())
+	{
+		finish(render_buffer);
+		changed = true;
+	}
+
+	return changed;
+}
+
+void SceneLoader::uploadImage(ImageEntry& entry)
+{
+	if (!entry.decoded)
+		return;
+
+	// the decoder wrote straight into these pixels, they go to the gpu from
+	// there and are released right after, only the metadata is kept
+
+	const auto& image = entry.image;
+	auto pixels = std::move(entry.image.image);
+	MemoryScope memory_scope(MemoryCategory::GpuUploads);
+
+	for (int i = 0; i < (int)mModel.textures.size(); i++)
+	{
+		if (mModel.textures.at(i).source != entry.index)
+			continue;
+
+		mTextures[i] = std::make_shared<skygfx::Texture>((uint32_t)image.width,
+			(uint32_t)image.height, skygfx::PixelFormat::RGBA8UNorm, (void*)pixels.data(), true);
+	}
+}
+
+size_t SceneLoader::getOrCreateMaterialSlot(RenderBuffer& render_buffer, int material_index)
+{
+	if (!mMaterialSlots.contains(material_index))
+	{
+		const auto& baseColorFactor = mModel.materials.at(material_index).pbrMetallicRoughness.baseColorFactor;
+
+		auto material = std::make_shared<Material>();
+		material->color = {
+			baseColorFactor.at(0),
+			baseColorFactor.at(1),
+			baseColorFactor.at(2),
+			baseColorFactor.at(3)
+		};
+		updateMaterialTextures(*material, material_index);
+		mMaterialSlots[material_index] = render_buffer.meshes.size();
+		render_buffer.meshes.push_back({ material, {} });
+	}
+
+	return mMaterialSlots.at(material_index);
+}
+
+void SceneLoader::updateMaterialTextures(Material& material, int material_index)
+{
+	const auto& gltf_material = mModel.materials.at(material_index);
+
+	auto get_texture = [&](int index) -> std::shared_ptr<skygfx::Texture> {
+		if (!mTextures.contains(index))
+			return nullptr;
+
+		return mTextures.at(index);
+	};
+
+	material.color_texture = get_texture(gltf_material.pbrMetallicRoughness.baseColorTexture.index);
+	material.normal_texture = get_texture(gltf_material.normalTexture.index);
+	material.metallic_roughness_texture = get_texture(gltf_material.pbrMetallicRoughness.metallicRoughnessTexture.index);
+}
+
+void SceneLoader::finish(RenderBuffer& render_buffer)
+{
+	mThread.join();
+
+	// hand decoded image metadata over to the model for texture packing,
+	// the pixels themselves were released once uploaded
+
+	for (auto& entry : mImages)
+	{
+		if (!entry->decoded)
+			continue;
+
+		auto& image = mModel.images.at(entry->index);
+		image.width = entry->image.width;
+		image.height = entry->image.height;
+		image.component = entry->image.component;
+		image.bits = entry->image.bits;
+		image.pixel_type = entry->image.pixel_type;
+	}
+
+	mImages.clear();
+	mPendingImages.clear();
+
+	mTexturePacking = PackTextures(mModel);
+
+	for (auto [material_index, slot] : mMaterialSlots)
+	{
+		const auto& gltf_material = mModel.materials.at(material_index);
+		auto& material = *render_buffer.meshes.at(slot).first;
+		material.color_layer = mTexturePacking.getLayer(gltf_material.pbrMetallicRoughness.baseColorTexture.index);
+		material.normal_layer = mTexturePacking.getLayer(gltf_material.normalTexture.index);
+	}
+
+	// everything lives on the gpu now, the model with its buffers
+	// and the converted geometry are not needed anymore
+
+	mModel = {};
+
+	// anything still alive keeps the chunks until its own delete
+	if (auto kept_blocks = mModelArena.reset(); kept_blocks != 0)
+		std::cout << "model arena kept by " << kept_blocks << " live blocks" << std::endl;
+
+	mPrimitives = {};
+	mPrimitiveDatas = {};
+	mPrimitivesReady.reset();
+	mTextures = {};
+	mMaterialSlots = {};
+
+#if defined(__GLIBC__)
+	malloc_trim(0);
+#endif
+
+	mFinished = true;
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <tiny_gltf.h>
+#include "allocation_counter.h"
+#include "job_system.h"
+#include "render_buffer.h"
+#include "texture_packer.h"
+
+// Loads a glTF scene in the background. Images are decoded by jobs while the
+// file is still being parsed, primitives are converted as soon as parsing is
+// done. The main thread calls update() every frame to turn finished items
+// into gpu resources, so the scene fills in while frames keep rendering.
+
+class SceneLoader
+{
+public:
+	// external buffers and images are read by this many threads while the
+	// file is parsed, disks need several reads in flight to reach full speed
+	static constexpr uint32_t ExternalFileThreads = 4;
+
+public:
+	struct Progress
+	{
+		uint32_t images = 0;
+		uint32_t images_total = 0;
+		uint32_t primitives = 0;
+		uint32_t primitives_total = 0;
+	};
+
+public:
+	// jobs must outlive the loader
+	SceneLoader(const std::string& path, JobSystem& jobs);
+	~SceneLoader();
+
+	SceneLoader(const SceneLoader&) = delete;
+	SceneLoader& operator=(const SceneLoader&) = delete;
+
+	// main thread only, uploads at most max_uploads images and primitives,
+	// returns true when the render buffer or its materials changed
+	bool update(RenderBuffer& render_buffer, uint32_t max_uploads);
+
+	bool isFinished() const { return mFinished; }
+	bool isFailed() const { return mFailed; }
+	const std::string& getError() const { return mError; }
+	const Progress& getProgress() const { return mProgress; }
+
+	// the model and cpu geometry are released when finished,
+	// LoadScenePrimitives reads the geometry again from this path
+	const std::string& getPath() const { return mPath; }
+	const TexturePacking& getTexturePacking() const { return mTexturePacking; }
+
+private:
+	struct ImageEntry
+	{
+		int index;
+		int req_width;
+		int req_height;
+		std::vector<unsigned char> bytes;
+		tinygltf::Image image;
+		bool decoded = false;
+	};
+
+	static bool OnImageData(tinygltf::Image* image, const int image_idx, std::string* err, std::string* warn,
+		int req_width, int req_height, const unsigned char* bytes, int size, void* user_data);
+
+	void load(const std::string& path);
+	void uploadImage(ImageEntry& entry);
+	size_t getOrCreateMaterialSlot(RenderBuffer& render_buffer, int material_index);
+	void updateMaterialTextures(Material& material, int material_index);
+	void finish(RenderBuffer& render_buffer);
+
+private:
+	std::string mPath;
+	JobSystem& mJobs;
+	JobSystem::Counter mCounter;
+	std::thread mThread;
+
+	// written by the loading thread, read by the main thread once mParsed is set,
+	// the model's small allocations live in the arena, which outlives it
+	HeapArena mModelArena;
+	tinygltf::Model mModel;
+	std::vector<std::unique_ptr<ImageEntry>> mImages;
+	std::vector<const tinygltf::Primitive*> mPrimitives;
+	std::vector<PrimitiveData> mPrimitiveDatas;
+	std::unique_ptr<std::atomic<bool>[]> mPrimitivesReady;
+	std::string mError;
+	std::atomic<bool> mParsed = false;
+	std::atomic<bool> mDone = false;
+	std::atomic<bool> mFailed = false;
+
+	std::mutex mReadyMutex;
+	std::vector<ImageEntry*> mReadyImages;
+
+	// main thread only
+	std::vector<ImageEntry*> mPendingImages;
+	uint32_t mNextPrimitive = 0;
+	std::unordered_map<int, std::shared_ptr<skygfx::Texture>> mTextures; // by glTF texture index
+	std::unordered_map<int, size_t> mMaterialSlots; // by glTF material index
+	TexturePacking mTexturePacking;
+	Progress mProgress;
+	bool mFinished = false;
+};
@@ -0,0 +1,48 @@
+#include "stress_lights.h"
+#include <random>
+
+std::vector<StressLight> CreateStressLights(uint32_t count, uint32_t seed)
+{
+	std::mt19937 random(seed);
+
+	auto range = [&](float min, float max) {
+		return std::uniform_real_distribution<float>(min, max)(random);
+	};
+
+	std::vector<StressLight> result;
+	result.reserve(count);
+
+	for (uint32_t i = 0; i < count; i++)
+	{
+		auto color = glm::normalize(glm::vec3{ range(0.0f, 1.0f), range(0.0f, 1.0f), range(0.0f, 1.0f) });
+		auto radius = range(64.0f, 256.0f);
+
+		auto center = glm::vec3{ range(-1300.0f, 1300.0f), range(16.0f, 1100.0f), range(-550.0f, 550.0f) };
+
+		auto light = skygfx::utils::PointLight();
+		light.position = center;
+		light.ambient = { 0.0f, 0.0f, 0.0f };
+		light.diffuse = color;
+		light.specular = color;
+		light.shininess = 32.0f;
+		light.constant_attenuation = 1.0f;
+		light.linear_attenuation = 0.0f;
+		light.quadratic_attenuation = 255.0f / (radius * radius); // 1/256 at radius
+
+		result.push_back({
+			.light = light,
+			.center = center,
+			.orbit = range(0.0f, 128.0f),
+			.speed = range(0.25f, 2.0f),
+			.phase = range(0.0f, glm::two_pi<float>())
+		});
+	}
+
+	return result;
+}
+
+void AnimateStressLight(StressLight& light, float time)
+{
+	auto angle = time * light.speed + light.phase;
+	light.light.position = light.center + glm::vec3{ glm::cos(angle), 0.0f, glm::sin(angle) } * light.orbit;
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <vector>
+#include <skygfx/utils.h>
+
+// Many small animated point lights scattered over the sponza atrium
+
+struct StressLight
+{
+	skygfx::utils::PointLight light;
+	glm::vec3 center;
+	float orbit;
+	float speed;
+	float phase;
+};
+
+constexpr uint32_t StressLightCount = 10000;
+
+std::vector<StressLight> CreateStressLights(uint32_t count, uint32_t seed = 1);
+void AnimateStressLight(StressLight& light, float time);
@@ -0,0 +1,103 @@
+#include "texture_packer.h"
+#include <iostream>
+#include <map>
+#include <tuple>
+
+TextureLayer TexturePacking::getLayer(int texture_index) const
+{
+	if (!layers.contains(texture_index))
+		return {};
+
+	return layers.at(texture_index);
+}
+
+float TexturePackingReport::getLayersPerPage() const
+{
+	if (pages == 0)
+		return 0.0f;
+
+	return (float)images / (float)pages;
+}
+
+float TexturePackingReport::getBindReduction() const
+{
+	if (texture_binds_unsorted == 0)
+		return 0.0f;
+
+	return 1.0f - ((float)page_binds_sorted / (float)texture_binds_unsorted);
+}
+
+static std::optional<skygfx::PixelFormat> GetPixelFormat(const tinygltf::Image& image)
+{
+	// images are uploaded as RGBA8UNorm, anything else is left unpacked
+
+	if (image.component == 4 && image.bits == 8 && image.pixel_type == TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE)
+		return skygfx::PixelFormat::RGBA8UNorm;
+
+	return std::nullopt;
+}
+
+TexturePacking PackTextures(const tinygltf::Model& model)
+{
+	TexturePacking result;
+
+	using PageKey = std::tuple<uint32_t, uint32_t, skygfx::PixelFormat>;
+
+	std::map<PageKey, int> pages_map;
+	std::unordered_map<int, TextureLayer> image_layers;
+
+	for (int i = 0; i < (int)model.images.size(); i++)
+	{
+		const auto& image = model.images.at(i);
+		auto format = GetPixelFormat(image);
+
+		// only metadata is read, the pixels may already be released after upload
+		if (!format.has_value() || image.width <= 0 || image.height <= 0)
+			continue;
+
+		auto key = PageKey{ (uint32_t)image.width, (uint32_t)image.height, format.value() };
+
+		if (!pages_map.contains(key))
+		{
+			pages_map[key] = (int)result.pages.size();
+			result.pages.push_back({
+				.width = (uint32_t)image.width,
+				.height = (uint32_t)image.height,
+				.format = format.value()
+			});
+		}
+
+		auto page_index = pages_map.at(key);
+		auto& page = result.pages.at(page_index);
+
+		image_layers[i] = { .page = page_index, .layer = (int)page.images.size() };
+		page.images.push_back(i);
+	}
+
+	for (int i = 0; i < (int)model.textures.size(); i++)
+	{
+		auto source = model.textures.at(i).source;
+
+		if (!image_layers.contains(source))
+			continue;
+
+		result.layers[i] = image_layers.at(source);
+	}
+
+	return result;
+}
+
+void PrintTexturePackingReport(const TexturePacking& packing, const TexturePackingReport& report)
+{
+	std::cout << "texture packing: " << report.images << " images in " << report.pages << " pages ("
+		<< report.getLayersPerPage() << " layers per page, " << (report.bytes / 1024 / 1024) << " mb)" << std::endl;
+
+	for (const auto& page : packing.pages)
+	{
+		std::cout << "  " << page.width << "x" << page.height << ": " << page.images.size() << " layers" << std::endl;
+	}
+
+	std::cout << "texture binds over " << report.draws << " draws: " << report.texture_binds_unsorted
+		<< " unsorted, " << report.texture_binds_sorted << " sorted, " << report.page_binds_sorted
+		<< " projected with pages (" << (int)(report.getBindReduction() * 100.0f) << "% less)" << std::endl;
+}
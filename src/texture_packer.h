@@ -0,0 +1,48 @@
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+#include <tiny_gltf.h>
+#include <skygfx/utils.h>
+
+// Groups same-sized, same-format glTF images into pages (texture arrays),
+// every image becomes one layer of its page.
+
+struct TextureLayer
+{
+	int page = -1;
+	int layer = -1;
+};
+
+struct TexturePacking
+{
+	struct Page
+	{
+		uint32_t width = 0;
+		uint32_t height = 0;
+		skygfx::PixelFormat format = skygfx::PixelFormat::RGBA8UNorm;
+		std::vector<int> images; // glTF image index per layer
+	};
+
+	std::vector<Page> pages;
+	std::unordered_map<int, TextureLayer> layers; // by glTF texture index
+
+	TextureLayer getLayer(int texture_index) const;
+};
+
+struct TexturePackingReport
+{
+	int images = 0;
+	int pages = 0;
+	size_t bytes = 0;
+	int draws = 0;
+	int texture_binds_unsorted = 0;
+	int texture_binds_sorted = 0;
+	int page_binds_sorted = 0;
+
+	float getLayersPerPage() const;
+	float getBindReduction() const;
+};
+
+TexturePacking PackTextures(const tinygltf::Model& model);
+void PrintTexturePackingReport(const TexturePacking& packing, const TexturePackingReport& report);
@@ -0,0 +1,65 @@
+#include "visibility.h"
+#include "profiler.h"
+
+bool Frustum::intersects(const DrawBounds& bounds) const
+{
+	for (const auto& plane : planes)
+	{
+		// corner of the box furthest along the plane normal
+
+		auto corner = glm::vec3{
+			plane.x >= 0.0f ? bounds.max.x : bounds.min.x,
+			plane.y >= 0.0f ? bounds.max.y : bounds.min.y,
+			plane.z >= 0.0f ? bounds.max.z : bounds.min.z
+		};
+
+		if (glm::dot(glm::vec3(plane), corner) + plane.w < 0.0f)
+			return false;
+	}
+
+	return true;
+}
+
+Frustum MakeFrustum(const CameraMatrices& camera)
+{
+	auto m = glm::transpose(camera.projection * camera.view);
+
+	Frustum result;
+	result.planes = {
+		m[3] + m[0], // left
+		m[3] - m[0], // right
+		m[3] + m[1], // bottom
+		m[3] - m[1], // top
+		m[3] + m[2], // near
+		m[3] - m[2]  // far
+	};
+
+	for (auto& plane : result.planes)
+	{
+		plane /= glm::length(glm::vec3(plane));
+	}
+
+	return result;
+}
+
+uint32_t CullDraws(const Frustum& frustum, std::span<const DrawBounds> bounds, std::span<uint32_t> visible_draws,
+	JobSystem& jobs)
+{
+	PROFILE_ZONE("cull draws");
+
+	// flags first, written in parallel into the output span, then compacted in place
+
+	jobs.parallelFor((uint32_t)bounds.size(), 64, [&](uint32_t i) {
+		visible_draws[i] = frustum.intersects(bounds[i]) ? 1 : 0;
+	});
+
+	uint32_t count = 0;
+
+	for (uint32_t i = 0; i < (uint32_t)bounds.size(); i++)
+	{
+		if (visible_draws[i])
+			visible_draws[count++] = i;
+	}
+
+	return count;
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <array>
+#include <span>
+#include "camera.h"
+#include "job_system.h"
+
+struct DrawBounds
+{
+	glm::vec3 min;
+	glm::vec3 max;
+};
+
+struct Frustum
+{
+	std::array<glm::vec4, 6> planes; // xyz points inside
+
+	bool intersects(const DrawBounds& bounds) const;
+};
+
+Frustum MakeFrustum(const CameraMatrices& camera);
+// writes indices of draws inside the frustum, returns their count
+uint32_t CullDraws(const Frustum& frustum, std::span<const DrawBounds> bounds, std::span<uint32_t> visible_draws,
+	JobSystem& jobs);